@@ -11,6 +11,7 @@ SHAPE_ORDERING = ['obj',
                   'ply',
                   'serialized',
                   'sphere',
+                  'spheres',
                   'cylinder',
                   'disk',
                   'rectangle']
@@ -51,6 +52,8 @@ SAMPLER_ORDERING = ['independent']
 
 INTEGRATOR_ORDERING = ['direct',
                        'path',
+                       'guided_path',
+                       'photonmapper',
                        'aov']
 
 FILM_ORDERING = ['hdrfilm']
@@ -644,6 +644,88 @@ public:
 };
 
 
+/**
+ * \brief Incrementally writes a tiled OpenEXR file
+ *
+ * In contrast to \ref Bitmap::write(), which encodes an image that is fully
+ * resident in memory, this class creates the file up front and accepts the
+ * image contents in the form of tile-aligned regions that can arrive in any
+ * order (e.g. as they are completed by a renderer). Compression of the tiles
+ * within a region is parallelized using OpenEXR's thread pool.
+ *
+ * All regions must have the pixel format and component format specified at
+ * construction time. The file is finalized when the writer is closed or
+ * destroyed, at which point every tile should have been written.
+ */
+class MTS_EXPORT_CORE TiledEXRWriter : public Object {
+public:
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a new tiled OpenEXR file
+     *
+     * \param path
+     *    Path of the output file
+     *
+     * \param size
+     *    Horizontal and vertical size of the image in pixels
+     *
+     * \param tile_size
+     *    Horizontal and vertical size of a tile in pixels
+     *
+     * \param prototype
+     *    Bitmap (e.g. the first tile) that specifies the pixel format,
+     *    component format, channel names and metadata of the file
+     *
+     * \param quality
+     *    Same meaning as for OpenEXR files in \ref Bitmap::write()
+     */
+    TiledEXRWriter(const fs::path &path, const Vector2u &size,
+                   const Vector2u &tile_size, const Bitmap *prototype,
+                   int quality = -1);
+
+    /**
+     * \brief Write a region of the image
+     *
+     * \c offset must be a multiple of the tile size, and the region must
+     * either consist of whole tiles or extend to the image boundary.
+     * This function may be called concurrently from multiple threads.
+     */
+    void write(const Point2u &offset, const Bitmap *bitmap);
+
+    /// Finalize the file. Further calls to \ref write() are not permitted.
+    void close();
+
+    /// Return the image size in pixels
+    const Vector2u &size() const { return m_size; }
+
+    /// Return the tile size in pixels
+    const Vector2u &tile_size() const { return m_tile_size; }
+
+    /// Return the number of tiles that have been written so far
+    size_t tiles_written() const;
+
+    /// Return the total number of tiles
+    size_t tile_count() const;
+
+    /// Return a string representation
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Finalizes the file if \ref close() was not called
+    virtual ~TiledEXRWriter();
+
+private:
+    struct TiledEXRWriterPrivate;
+    std::unique_ptr<TiledEXRWriterPrivate> d;
+    fs::path m_path;
+    Vector2u m_size;
+    Vector2u m_tile_size;
+};
+
+
 /**
  * \brief Accumulate the contents of a source bitmap into a
  * target bitmap with specified offsets for both.
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Process-wide cache of decoded scene assets
+ *
+ * Plugins that decode large payloads from disk (meshes, bitmaps, volumes)
+ * can register their decoded representation with this cache so that
+ * subsequent loads of the same file within one process are served from
+ * memory. This is useful when the same assets are loaded repeatedly, e.g.
+ * when rendering many variants of a scene from Python or in batch mode.
+ *
+ * Entries are keyed on the resolved file path, the file's modification time
+ * and size, and a plugin-specific string summarizing all properties that
+ * influence the decoded representation (e.g. the target variant or a
+ * transformation that is baked into the data). Cached objects are shared
+ * between all users and must be treated as immutable.
+ *
+ * When the total size of all entries exceeds \ref memory_limit(), the least
+ * recently used entries are evicted. Evicted objects that are still
+ * referenced elsewhere remain alive until they are released.
+ */
+class MTS_EXPORT_CORE AssetCache : public Object {
+public:
+    /**
+     * \brief Callback that decodes an asset on a cache miss
+     *
+     * The callback returns the decoded object and stores its (approximate)
+     * memory footprint in bytes in the provided argument.
+     */
+    using Loader = std::function<ref<Object>(size_t &)>;
+
+    /// Return the global asset cache (or \c nullptr if not initialized)
+    static AssetCache *instance() { return m_instance; }
+
+    /**
+     * \brief Look up an asset, decoding and inserting it on a cache miss
+     *
+     * \param path
+     *     Resolved path of the file backing the asset
+     *
+     * \param key
+     *     Plugin-specific string that summarizes all properties affecting
+     *     the decoded representation
+     *
+     * \param loader
+     *     Function that decodes the asset if it is not in the cache
+     */
+    ref<Object> get(const fs::path &path, const std::string &key,
+                    const Loader &loader);
+
+    /// Convenience template wrapper around \ref get()
+    template <typename T>
+    ref<T> get(const fs::path &path, const std::string &key, const Loader &loader) {
+        return static_cast<T *>(get(path, key, loader).get());
+    }
+
+    /// Return a cached asset or \c nullptr if it is not present
+    ref<Object> find(const fs::path &path, const std::string &key);
+
+    /// Insert an asset with the given memory footprint (in bytes)
+    void put(const fs::path &path, const std::string &key, Object *object,
+             size_t size);
+
+    /// Enable or disable the cache (disabling it also clears all entries)
+    void set_enabled(bool enabled);
+
+    /// Is the cache currently enabled?
+    bool enabled() const;
+
+    /// Set the maximum total size of all cached assets in bytes
+    void set_memory_limit(size_t limit);
+
+    /// Return the maximum total size of all cached assets in bytes
+    size_t memory_limit() const;
+
+    /// Return the total size of all cached assets in bytes
+    size_t memory_usage() const;
+
+    /// Return the number of cached assets
+    size_t entry_count() const;
+
+    /// Return the number of lookups that were served from the cache
+    size_t hit_count() const;
+
+    /// Return the number of lookups that required decoding the asset
+    size_t miss_count() const;
+
+    /**
+     * \brief Return a summary of all cached assets
+     *
+     * Each entry holds the file path, the plugin-specific key, and the
+     * memory footprint in bytes. Entries are sorted from most to least
+     * recently used.
+     */
+    std::vector<std::tuple<std::string, std::string, size_t>> entries() const;
+
+    /// Remove all cached assets
+    void clear();
+
+    /// Return a human-readable summary
+    std::string to_string() const override;
+
+    /// Create the global asset cache
+    static void static_initialization();
+
+    /// Release the global asset cache and all cached assets
+    static void static_shutdown();
+
+    MTS_DECLARE_CLASS()
+protected:
+    AssetCache();
+
+    /// Release all cached assets
+    ~AssetCache();
+
+private:
+    struct AssetCachePrivate;
+    std::unique_ptr<AssetCachePrivate> d;
+    static ref<AssetCache> m_instance;
+};
+
+NAMESPACE_END(mitsuba)
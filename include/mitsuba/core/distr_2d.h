@@ -2,6 +2,9 @@
 
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/stream.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -36,6 +39,10 @@ NAMESPACE_BEGIN(mitsuba)
  * via the \c Dimension template parameter). In this case, a higher-dimensional
  * discretization must be provided that will also be linearly interpolated in
  * these extra dimensions.
+ *
+ * Construction is parallelized over the rows of all slices. The resulting
+ * tables can be written to a \ref Stream and reloaded later on, which avoids
+ * the construction cost when the same data is loaded repeatedly.
  * =======================================================================
  */
 
@@ -82,6 +89,89 @@ protected:
         }
     }
 
+    /**
+     * Unserialize the parameter discretization from a binary data stream,
+     * after checking the type identifier \c tag written by \ref write_base()
+     */
+    Distribution2D(Stream *stream, const std::string &tag) {
+        std::string stream_tag;
+        stream->read(stream_tag);
+        if (stream_tag != tag)
+            Throw("%s(): serialized data has the wrong type (\"%s\")!", tag, stream_tag);
+
+        uint32_t dimension;
+        stream->read(dimension);
+        if (dimension != Dimension)
+            Throw("%s(): serialized data depends on %i parameters, expected %i!",
+                  tag, dimension, Dimension);
+
+        ScalarVector2u n_patches;
+        stream->read(n_patches.x());
+        stream->read(n_patches.y());
+        m_patch_size = 1.f / n_patches;
+        m_inv_patch_size = n_patches;
+
+        stream->read(m_slices);
+        for (size_t i = 0; i < Dimension; ++i) {
+            stream->read(m_param_strides[i]);
+            m_param_values[i] = read_storage(stream);
+        }
+    }
+
+    /// Serialize a type identifier and the parameter discretization
+    void write_base(Stream *stream, const std::string &tag) const {
+        stream->write(tag);
+        stream->write((uint32_t) Dimension);
+
+        ScalarVector2u n_patches(m_inv_patch_size);
+        stream->write(n_patches.x());
+        stream->write(n_patches.y());
+
+        stream->write(m_slices);
+        for (size_t i = 0; i < Dimension; ++i) {
+            stream->write(m_param_strides[i]);
+            write_storage(stream, m_param_values[i]);
+        }
+    }
+
+    /// Read a table of floating point values written by \ref write_storage()
+    static FloatStorage read_storage(Stream *stream) {
+        uint32_t size;
+        stream->read(size);
+        if (size == 0)
+            return FloatStorage();
+        FloatStorage storage = empty<FloatStorage>(size);
+        storage.managed();
+        stream->read_array(storage.data(), size);
+        return storage;
+    }
+
+    /// Write a table of floating point values to a binary data stream
+    static void write_storage(Stream *stream, const FloatStorage &storage) {
+        uint32_t size = (uint32_t) storage.size();
+        stream->write(size);
+        if (size > 0)
+            stream->write_array(storage.data(), size);
+    }
+
+    /**
+     * \brief Invoke <tt>func(slice, row)</tt> in parallel for the first
+     * \c rows rows of every slice, given the number of values per row
+     */
+    template <typename Func>
+    void parallel_rows(uint32_t rows, uint32_t row_size, Func func) const {
+        uint32_t count = m_slices * rows,
+                 grain = std::max(1u, ParallelGrainSize / std::max(row_size, 1u));
+
+        tbb::parallel_for(
+            tbb::blocked_range<uint32_t>(0u, count, grain),
+            [&](const tbb::blocked_range<uint32_t> &range) {
+                for (uint32_t i = range.begin(); i != range.end(); ++i)
+                    func(i / rows, i % rows);
+            }
+        );
+    }
+
     // Look up parameter-related indices and weights (if Dimension != 0)
     UInt32 interpolate_weights(const Float *param, Float *param_weight,
                                Mask active) const {
@@ -130,6 +220,9 @@ protected:
     static constexpr size_t DimensionInt = (Dimension != 0) ? Dimension : 1;
 #endif
 
+    /// Approximate number of values processed by a task during construction
+    static constexpr uint32_t ParallelGrainSize = 16384;
+
     /// Size of a bilinear patch in the unit square
     ScalarVector2f m_patch_size;
 
@@ -189,7 +282,8 @@ public:
     ENOKI_USING_MEMBERS(Base,
         Dimension, DimensionInt, m_patch_size, m_inv_patch_size,
         m_param_strides, m_param_values, m_slices,
-        interpolate_weights
+        interpolate_weights, parallel_rows, read_storage, write_storage,
+        write_base
     )
 
     Hierarchical2D() = default;
@@ -229,24 +323,41 @@ public:
 
         m_max_patch_index = n_patches - 1;
 
+        // Partial sums of the rows of each slice, and the resulting scale factors
+        std::unique_ptr<double[]> row_sum(new double[m_slices * size.y()]);
+        std::unique_ptr<ScalarFloat[]> scale(new ScalarFloat[m_slices]);
+
         if (!enable_sampling) {
             m_levels.reserve(1);
             m_levels.emplace_back(size, m_slices);
+            Level &l0 = m_levels[0];
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                uint32_t offset = m_levels[0].size * slice;
+            for (uint32_t slice = 0; slice < m_slices; ++slice)
+                scale[slice] = 1.f;
 
-                ScalarFloat scale = 1.f;
-                if (normalize) {
+            if (normalize) {
+                parallel_rows(size.y(), size.x(), [&](uint32_t slice, uint32_t y) {
+                    const ScalarFloat *in = data + l0.size * slice + y * size.x();
                     double sum = 0.0;
-                    for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                        sum += (double) data[offset + i];
-                    scale = hprod(n_patches) / (ScalarFloat) sum;
+                    for (uint32_t x = 0; x < size.x(); ++x)
+                        sum += (double) in[x];
+                    row_sum[slice * size.y() + y] = sum;
+                });
+
+                for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                    double sum = 0.0;
+                    for (uint32_t y = 0; y < size.y(); ++y)
+                        sum += row_sum[slice * size.y() + y];
+                    scale[slice] = hprod(n_patches) / (ScalarFloat) sum;
                 }
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    m_levels[0].data_ptr[offset + i] = data[offset + i] * scale;
             }
 
+            parallel_rows(size.y(), size.x(), [&](uint32_t slice, uint32_t y) {
+                uint32_t offset = l0.size * slice + y * size.x();
+                for (uint32_t x = 0; x < size.x(); ++x)
+                    l0.data_ptr[offset + x] = data[offset + x] * scale[slice];
+            });
+
             return;
         }
 
@@ -261,50 +372,91 @@ public:
             level_size = sr<1>(level_size);
         }
 
-        for (uint32_t slice = 0; slice < m_slices; ++slice) {
-            uint32_t offset0 = m_levels[0].size * slice,
-                     offset1 = m_levels[1].size * slice;
+        Level &l0 = m_levels[0], &l1 = m_levels[1];
 
-            // Integrate linear interpolant
-            const ScalarFloat *in = data + offset0;
+        // Integrate linear interpolant
+        parallel_rows(n_patches.y(), size.x(), [&](uint32_t slice, uint32_t y) {
+            const ScalarFloat *in = data + l0.size * slice + y * size.x();
+            uint32_t offset1 = l1.size * slice;
 
             double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
-                for (uint32_t x = 0; x < n_patches.x(); ++x) {
-                    ScalarFloat avg = (in[0] + in[1] + in[size.x()] +
-                                 in[size.x() + 1]) * .25f;
-                    sum += (double) avg;
-                    *(m_levels[1].ptr(ScalarVector2u(x, y)) + offset1) = avg;
-                    ++in;
-                }
-                ++in;
+            for (uint32_t x = 0; x < n_patches.x(); ++x) {
+                ScalarFloat avg = (in[x] + in[x + 1] + in[x + size.x()] +
+                                   in[x + size.x() + 1]) * .25f;
+                sum += (double) avg;
+                *(l1.ptr(ScalarVector2u(x, y)) + offset1) = avg;
             }
+            row_sum[slice * n_patches.y() + y] = sum;
+        });
 
-            // Copy and normalize fine resolution interpolant
-            ScalarFloat scale = normalize ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                m_levels[0].data_ptr[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                m_levels[1].data_ptr[offset1 + i] *= scale;
-
-            // Build a MIP hierarchy
-            level_size = n_patches;
-            for (uint32_t level = 2; level <= max_level + 1; ++level) {
-                const Level &l0 = m_levels[level - 1];
-                Level &l1 = m_levels[level];
-                offset0 = l0.size * slice;
-                offset1 = l1.size * slice;
-                level_size = sr<1>(level_size + 1u);
-
-                // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
-                    for (uint32_t x = 0; x < level_size.x(); ++x) {
-                        ScalarFloat *d1 = l1.ptr(ScalarVector2u(x, y)) + offset1;
-                        const ScalarFloat *d0 = l0.ptr(ScalarVector2u(x*2, y*2)) + offset0;
-                        *d1 = d0[0] + d0[1] + d0[2] + d0[3];
-                    }
+        for (uint32_t slice = 0; slice < m_slices; ++slice) {
+            double sum = 0.0;
+            for (uint32_t y = 0; y < n_patches.y(); ++y)
+                sum += row_sum[slice * n_patches.y() + y];
+            scale[slice] = normalize ? (ScalarFloat) (hprod(n_patches) / sum) : 1.f;
+        }
+
+        // Copy and normalize fine resolution interpolant
+        parallel_rows(size.y(), size.x(), [&](uint32_t slice, uint32_t y) {
+            uint32_t offset = l0.size * slice + y * size.x();
+            for (uint32_t x = 0; x < size.x(); ++x)
+                l0.data_ptr[offset + x] = data[offset + x] * scale[slice];
+        });
+
+        // .. the same for the patch averages (in their memory order)
+        parallel_rows(l1.size / l1.width, l1.width, [&](uint32_t slice, uint32_t y) {
+            ScalarFloat *out = l1.data_ptr + l1.size * slice + y * l1.width;
+            for (uint32_t x = 0; x < l1.width; ++x)
+                out[x] *= scale[slice];
+        });
+
+        // Build a MIP hierarchy
+        level_size = n_patches;
+        for (uint32_t level = 2; level <= max_level + 1; ++level) {
+            const Level &lc = m_levels[level - 1];
+            Level &lp = m_levels[level];
+            level_size = sr<1>(level_size + 1u);
+
+            // Downsample
+            parallel_rows(level_size.y(), level_size.x(), [&](uint32_t slice, uint32_t y) {
+                uint32_t offset0 = lc.size * slice,
+                         offset1 = lp.size * slice;
+                for (uint32_t x = 0; x < level_size.x(); ++x) {
+                    ScalarFloat *d1 = lp.ptr(ScalarVector2u(x, y)) + offset1;
+                    const ScalarFloat *d0 = lc.ptr(ScalarVector2u(x*2, y*2)) + offset0;
+                    *d1 = d0[0] + d0[1] + d0[2] + d0[3];
                 }
-            }
+            });
+        }
+    }
+
+    /// Unserialize a sample warping scheme from a binary data stream
+    Hierarchical2D(Stream *stream) : Base(stream, "Hierarchical2D") {
+        stream->read(m_max_patch_index.x());
+        stream->read(m_max_patch_index.y());
+
+        uint32_t level_count;
+        stream->read(level_count);
+        m_levels.reserve(level_count);
+        for (uint32_t i = 0; i < level_count; ++i) {
+            uint32_t size, width;
+            stream->read(size);
+            stream->read(width);
+            m_levels.emplace_back(size, width, read_storage(stream));
+        }
+    }
+
+    /// Serialize the sample warping scheme to a binary data stream
+    void write(Stream *stream) const {
+        write_base(stream, "Hierarchical2D");
+        stream->write(m_max_patch_index.x());
+        stream->write(m_max_patch_index.y());
+
+        stream->write((uint32_t) m_levels.size());
+        for (const Level &level : m_levels) {
+            stream->write(level.size);
+            stream->write(level.width);
+            write_storage(stream, level.data);
         }
     }
 
@@ -572,6 +724,11 @@ protected:
             data_ptr = data.data();
         }
 
+        Level(uint32_t level_size, uint32_t level_width, FloatStorage &&storage)
+            : size(level_size), width(level_width), data(std::move(storage)) {
+            data_ptr = data.data();
+        }
+
         /**
          * \brief Convert from 2D pixel coordinates to an index indicating how the
          * data is laid out in memory.
@@ -663,7 +820,8 @@ public:
 
     ENOKI_USING_MEMBERS(Base,
         Dimension, DimensionInt, m_patch_size, m_inv_patch_size,
-        m_param_strides, m_param_values, m_slices, interpolate_weights
+        m_param_strides, m_param_values, m_slices, interpolate_weights,
+        parallel_rows, read_storage, write_storage, write_base
     )
 
     Marginal2D() = default;
@@ -704,6 +862,11 @@ public:
         m_data = empty<FloatStorage>(m_slices * n_data);
         m_data.managed();
 
+        ScalarFloat *data_out = m_data.data();
+
+        // Normalization factor of each slice
+        std::unique_ptr<ScalarFloat[]> norm(new ScalarFloat[m_slices]);
+
         if (enable_sampling) {
             m_marg_cdf = empty<FloatStorage>(m_slices * n_marg);
             m_marg_cdf.managed();
@@ -712,99 +875,129 @@ public:
             m_cond_cdf.managed();
 
             ScalarFloat *marg_cdf = m_marg_cdf.data(),
-                        *cond_cdf = m_cond_cdf.data(),
-                        *data_out = m_data.data();
+                        *cond_cdf = m_cond_cdf.data();
 
-            std::unique_ptr<double[]> cond_cdf_sum(new double[h]);
+            /* The marginal/probability distribution computation
+               differs for the Continuous=false/true cases */
+            uint32_t n_cond_rows = Continuous ? h : (h - 1);
+            std::unique_ptr<double[]> cond_cdf_sum(new double[m_slices * h]);
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
+            // Construct conditional CDF
+            parallel_rows(n_cond_rows, w, [&](uint32_t slice, uint32_t y) {
+                const ScalarFloat *in = data + slice * n_data + y * w;
+                ScalarFloat *out = cond_cdf + slice * n_cond + y * (w - 1);
 
-                /* The marginal/probability distribution computation
-                   differs for the Continuous=false/true cases */
+                double accum = 0.0;
                 if constexpr (Continuous) {
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale_x * ((double) data[i] +
-                                                (double) data[i + 1]);
-                            cond_cdf[j] = (ScalarFloat) accum;
-                        }
-                        cond_cdf_sum[y] = accum;
+                    for (uint32_t x = 0; x < w - 1; ++x) {
+                        accum += scale_x * ((double) in[x] +
+                                            (double) in[x + 1]);
+                        out[x] = (ScalarFloat) accum;
                     }
-
-                    // Construct marginal CDF
-                    double accum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += scale_y * (cond_cdf_sum[y] + cond_cdf_sum[y + 1]);
-                        marg_cdf[y] = (ScalarFloat) accum;
-                    }
-
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
                 } else {
                     double scale = scale_x * scale_y;
-
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale * ((double) data[i] +
-                                              (double) data[i + 1] +
-                                              (double) data[i + w] +
-                                              (double) data[i + w + 1]);
-                            cond_cdf[j] = (ScalarFloat) accum;
-                        }
-                        cond_cdf_sum[y] = accum;
-                    }
-
-                    // Construct marginal CDF
-                    double accum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        accum += cond_cdf_sum[y];
-                        marg_cdf[y] = (ScalarFloat) accum;
+                    for (uint32_t x = 0; x < w - 1; ++x) {
+                        accum += scale * ((double) in[x] +
+                                          (double) in[x + 1] +
+                                          (double) in[x + w] +
+                                          (double) in[x + w + 1]);
+                        out[x] = (ScalarFloat) accum;
                     }
+                }
+                cond_cdf_sum[slice * h + y] = accum;
+            });
 
-                    if (normalize)
-                        norm = ScalarFloat(1.0 / accum);
+            // Construct marginal CDF
+            for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                const double *sum = cond_cdf_sum.get() + slice * h;
+                ScalarFloat *out = marg_cdf + slice * n_marg;
+
+                double accum = 0.0;
+                for (uint32_t y = 0; y < h - 1; ++y) {
+                    if constexpr (Continuous)
+                        accum += scale_y * (sum[y] + sum[y + 1]);
+                    else
+                        accum += sum[y];
+                    out[y] = (ScalarFloat) accum;
                 }
 
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf++ *= norm;
-                for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out++ = *data++ * norm;
+                norm[slice] = normalize ? ScalarFloat(1.0 / accum) : 1.f;
+                for (uint32_t y = 0; y < n_marg; ++y)
+                    out[y] *= norm[slice];
             }
+
+            parallel_rows(h, w, [&](uint32_t slice, uint32_t y) {
+                if (y < n_cond_rows) {
+                    ScalarFloat *out = cond_cdf + slice * n_cond + y * (w - 1);
+                    for (uint32_t x = 0; x < w - 1; ++x)
+                        out[x] *= norm[slice];
+                }
+
+                uint32_t offset = slice * n_data + y * w;
+                for (uint32_t x = 0; x < w; ++x)
+                    data_out[offset + x] = data[offset + x] * norm[slice];
+            });
         } else {
-            ScalarFloat *data_out = m_data.data();
+            for (uint32_t slice = 0; slice < m_slices; ++slice)
+                norm[slice] = 1.f;
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat norm = 1.f;
+            if (normalize) {
+                std::unique_ptr<double[]> row_sum(new double[m_slices * (h - 1)]);
 
-                if (normalize) {
+                parallel_rows(h - 1, w, [&](uint32_t slice, uint32_t y) {
+                    const ScalarFloat *in = data + slice * n_data + y * w;
                     double sum = 0.0;
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        size_t i = y * w;
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i) {
-                            sum += (double) data[i] +
-                                   (double) data[i + 1] +
-                                   (double) data[i + w] +
-                                   (double) data[i + w + 1];
-                        }
+                    for (uint32_t x = 0; x < w - 1; ++x) {
+                        sum += (double) in[x] +
+                               (double) in[x + 1] +
+                               (double) in[x + w] +
+                               (double) in[x + w + 1];
                     }
-                    norm = ScalarFloat(1.0 / (scale_x * scale_y * sum));
-                }
+                    row_sum[slice * (h - 1) + y] = sum;
+                });
 
-                for (uint32_t k = 0; k < n_data; ++k)
-                    *data_out++ = *data++ * norm;
+                for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                    double sum = 0.0;
+                    for (uint32_t y = 0; y < h - 1; ++y)
+                        sum += row_sum[slice * (h - 1) + y];
+                    norm[slice] = ScalarFloat(1.0 / (scale_x * scale_y * sum));
+                }
             }
+
+            parallel_rows(h, w, [&](uint32_t slice, uint32_t y) {
+                uint32_t offset = slice * n_data + y * w;
+                for (uint32_t x = 0; x < w; ++x)
+                    data_out[offset + x] = data[offset + x] * norm[slice];
+            });
         }
     }
 
+    /// Unserialize a sample warping scheme from a binary data stream
+    Marginal2D(Stream *stream) : Base(stream, type_tag()) {
+        stream->read(m_size.x());
+        stream->read(m_size.y());
+
+        uint8_t normalized;
+        stream->read(normalized);
+        m_normalized = normalized != 0;
+
+        m_data     = read_storage(stream);
+        m_marg_cdf = read_storage(stream);
+        m_cond_cdf = read_storage(stream);
+    }
+
+    /// Serialize the sample warping scheme to a binary data stream
+    void write(Stream *stream) const {
+        write_base(stream, type_tag());
+        stream->write(m_size.x());
+        stream->write(m_size.y());
+        stream->write((uint8_t) m_normalized);
+
+        write_storage(stream, m_data);
+        write_storage(stream, m_marg_cdf);
+        write_storage(stream, m_cond_cdf);
+    }
+
     /**
      * \brief Given a uniformly distributed 2D sample, draw a sample from the
      * distribution (parameterized by \c param if applicable)
@@ -1256,6 +1449,10 @@ protected:
                                     Float v0, Float v1) const {
         return sample * lerp(v0, v1, .5f * sample) * width;
     }
+
+    static const char *type_tag() {
+        return Continuous ? "MarginalContinuous2D" : "MarginalDiscrete2D";
+    }
 protected:
     /// Resolution of the discretized density function
     ScalarVector2u m_size;
@@ -286,7 +286,7 @@ template <typename Float_> struct CoreAliases {
         mask = true;
 
 #define MTS_MASKED_FUNCTION(profiler_phase, mask)                                                  \
-    ScopedPhase scope_phase(profiler_phase);                                                       \
+    ScopedPhase scope_phase(profiler_phase, this);                                                 \
     (void) mask;                                                                                   \
     if constexpr (is_scalar_v<Float>)                                                              \
         mask = true;
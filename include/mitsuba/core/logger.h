@@ -77,6 +77,62 @@ public:
     /// Return the current error level
     LogLevel error_level() const;
 
+    /**
+     * \brief Enable or disable asynchronous logging
+     *
+     * In asynchronous mode, formatted messages are pushed into a bounded
+     * lock-free queue that is drained by a background thread, hence threads
+     * that emit log messages never wait for each other or for slow appenders.
+     * When the queue is full, messages are dropped and their number is
+     * reported once space becomes available.
+     *
+     * Progress updates (\ref log_progress()) go through the same queue and
+     * hence remain ordered with respect to the messages of their thread.
+     *
+     * Messages of each thread are appended in order. Before an error is
+     * raised (via \ref log() or \c Throw), the raising thread waits until
+     * the queue has been flushed, so that all messages emitted prior to the
+     * exception become visible first. Appenders must hence not wait for
+     * resources (e.g. the Python GIL) that such a thread may hold.
+     *
+     * \param capacity
+     *     Maximum number of pending messages (rounded up to a power of two).
+     *     Only used when asynchronous mode is enabled for the first time.
+     */
+    void set_async(bool async, size_t capacity = 8192);
+
+    /// Is asynchronous logging enabled?
+    bool is_async() const;
+
+    /**
+     * \brief Pass all pending messages to the appenders (asynchronous mode)
+     *
+     * \param wait
+     *     When \c false, the function returns immediately if another thread
+     *     is currently invoking the appenders.
+     */
+    void flush(bool wait = true);
+
+    /**
+     * \brief Limit the number of messages emitted from the same call site
+     *
+     * At most \c count messages below the error level are processed per
+     * source location (file and line) in each time interval of the given
+     * length in seconds. Further messages are discarded and summarized by a
+     * note attached to the next message from that location that passes. A
+     * count of zero (the default) disables the limit.
+     */
+    void set_rate_limit(size_t count, float interval = 1.f);
+
+    /// Return the maximum number of messages per call site and time interval
+    size_t rate_limit() const;
+
+    /// Return the number of messages that were discarded due to the rate limit
+    size_t suppressed_count() const;
+
+    /// Return the number of messages that were dropped due to a full queue
+    size_t dropped_count() const;
+
     /// Add an appender to this logger
     void add_appender(Appender *appender);
 
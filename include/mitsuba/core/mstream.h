@@ -110,6 +110,12 @@ public:
     /// Return whether or not the memory stream owns the underlying buffer
     bool owns_buffer() const { return m_owns_buffer; }
 
+    /// Return a pointer to the underlying memory buffer
+    uint8_t *raw_buffer() { return m_data; }
+
+    /// Return a pointer to the underlying memory buffer (const version)
+    const uint8_t *raw_buffer() const { return m_data; }
+
     //! @}
     // =========================================================================
 
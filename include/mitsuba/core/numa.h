@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <functional>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Topology-aware parallel execution on NUMA (non-uniform memory
+ * access) systems
+ *
+ * On machines with several NUMA nodes (e.g. multi-socket servers), memory
+ * accesses to another node's memory are considerably slower. The functions in
+ * this namespace detect the node topology and provide a separate TBB task
+ * arena per node whose worker threads are pinned to the node's processors,
+ * so that work submitted to a node operates on memory that was allocated
+ * (first touched) by the same node.
+ *
+ * On single-node systems (and platforms without topology information), all
+ * functions fall back to a single node that contains all processors.
+ */
+NAMESPACE_BEGIN(numa)
+
+/// Return the number of NUMA nodes with at least one usable processor
+extern MTS_EXPORT_CORE size_t node_count();
+
+/// Return the logical processor IDs that belong to the given node
+extern MTS_EXPORT_CORE const std::vector<int> &node_cpus(size_t node);
+
+/// Return the node of the processor that is currently executing the calling thread
+extern MTS_EXPORT_CORE size_t current_node();
+
+/**
+ * \brief Enable or disable NUMA-aware execution
+ *
+ * Enabled by default. When disabled (or when the system has a single node),
+ * \ref parallel_for_nodes() runs the given function once in the default
+ * task arena.
+ */
+extern MTS_EXPORT_CORE void set_enabled(bool enabled);
+
+/// Is NUMA-aware execution enabled and are there several nodes?
+extern MTS_EXPORT_CORE bool enabled();
+
+/**
+ * \brief Return the number of worker threads assigned to a node
+ *
+ * The global thread count (\c __global_thread_count) is distributed among
+ * the nodes proportionally to their processor count.
+ */
+extern MTS_EXPORT_CORE size_t node_thread_count(size_t node);
+
+/**
+ * \brief Run a function concurrently on all NUMA nodes
+ *
+ * The function is invoked once per node (with the node index as argument)
+ * within a task arena whose workers are pinned to the node. Parallel
+ * constructs (e.g. <tt>tbb::parallel_for</tt>) used by the function execute
+ * on the workers of the same node. Returns once all invocations have
+ * finished; exceptions are propagated to the caller.
+ */
+extern MTS_EXPORT_CORE void
+parallel_for_nodes(const std::function<void(size_t)> &func);
+
+/// Release the per-node task arenas (called by \ref Thread::static_shutdown())
+extern MTS_EXPORT_CORE void static_shutdown();
+
+NAMESPACE_END(numa)
+NAMESPACE_END(mitsuba)
@@ -118,7 +118,13 @@ protected:
 private:
     mutable std::atomic<int> m_ref_count { 0 };
 
+    /// Identifies the instance in the samples of the \ref Profiler (0 if it has no label)
+    mutable uint32_t m_profiler_id = 0;
+
     static Class *m_class;
+
+    friend class Profiler;
+    friend struct ScopedPhase;
 };
 
 /**
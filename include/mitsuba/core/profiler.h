@@ -3,9 +3,15 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <atomic>
 
 #if !defined(MTS_PROFILE_HASH_SIZE)
-#  define MTS_PROFILE_HASH_SIZE 256
+#  define MTS_PROFILE_HASH_SIZE 4096
+#endif
+
+#if !defined(MTS_PROFILE_MAX_DEPTH)
+#  define MTS_PROFILE_MAX_DEPTH 16
 #endif
 
 NAMESPACE_BEGIN(mitsuba)
@@ -78,41 +84,161 @@ static_assert(std::extent_v<decltype(profiler_phase_id)> ==
                   int(ProfilerPhase::ProfilerPhaseCount),
               "Profiler phases and descriptions don't have matching length!");
 
+/// A sampled profile: list of call stacks of (phase, plugin label) frames and their sample counts
+using ProfilerSampleList =
+    std::vector<std::pair<std::vector<std::pair<std::string, std::string>>, size_t>>;
+
 #if defined(MTS_ENABLE_PROFILER)
+/// Single entry of the per-thread profiler call stack
+struct ProfilerFrame {
+    ProfilerPhase phase;
+    /// Profiler ID of the plugin instance that is being executed (or 0)
+    uint32_t object;
+};
+
+/// Per-thread state that is inspected by the profiler's signal handler
+struct ProfilerStack {
+    /// Bitmask of all active phases
+    uint64_t flags = 0;
+    /// Current stack depth (may exceed \ref MTS_PROFILE_MAX_DEPTH)
+    uint32_t depth = 0;
+    ProfilerFrame frames[MTS_PROFILE_MAX_DEPTH] { };
+};
+
 /* Inlining the access to a thread_local variable produces *awful* machine code
    with Clang on OSX. The combination of weak and noinline is needed to prevent
    the compiler from inlining it (just noinline does not seem to be enough). It
    is marked as 'const' because separate function calls always produce the same
    pointer. */
-extern MTS_EXPORT_CORE uint64_t *profiler_flags()
+extern MTS_EXPORT_CORE ProfilerStack *profiler_stack()
     __attribute__((noinline, weak, const));
 
+/**
+ * \brief Overwrite the contents of a profiler stack (e.g. to propagate it to
+ * a worker thread)
+ *
+ * The depth is cleared while the frames are copied, so that the signal
+ * handler never observes a partially copied stack.
+ */
+inline void profiler_assign_stack(ProfilerStack *stack, const ProfilerStack &value) {
+    stack->depth = 0;
+    std::atomic_signal_fence(std::memory_order_release);
+    stack->flags = value.flags;
+    for (uint32_t i = 0; i < MTS_PROFILE_MAX_DEPTH; ++i)
+        stack->frames[i] = value.frames[i];
+    std::atomic_signal_fence(std::memory_order_release);
+    stack->depth = value.depth;
+}
+
 struct ScopedPhase {
-    ScopedPhase(ProfilerPhase phase)
-        : m_target(profiler_flags()), m_flag(1ull << int(phase)) {
-        if ((*m_target & m_flag) == 0)
-            *m_target |= m_flag;
+    ScopedPhase(ProfilerPhase phase, const Object *object = nullptr)
+        : m_stack(profiler_stack()), m_flag(1ull << int(phase)) {
+        if ((m_stack->flags & m_flag) == 0)
+            m_stack->flags |= m_flag;
         else
             m_flag = 0;
+
+        uint32_t depth = m_stack->depth;
+        if (depth < MTS_PROFILE_MAX_DEPTH)
+            m_stack->frames[depth] =
+                ProfilerFrame{ phase, object ? object->m_profiler_id : 0u };
+        // Publish the frame before the signal handler can observe the new depth
+        std::atomic_signal_fence(std::memory_order_release);
+        m_stack->depth = depth + 1;
     }
 
     ~ScopedPhase() {
-        *m_target &= ~m_flag;
+        m_stack->depth--;
+        m_stack->flags &= ~m_flag;
     }
 
     ScopedPhase(const ScopedPhase &) = delete;
     ScopedPhase &operator=(const ScopedPhase &) = delete;
 
 private:
-    uint64_t* m_target;
-    uint64_t  m_flag;
+    ProfilerStack *m_stack;
+    uint64_t m_flag;
 };
 
+/**
+ * \brief Builtin sampling profiler
+ *
+ * The profiler periodically interrupts the process (100 Hz, using
+ * <tt>SIGPROF</tt>) and records the call stack of \ref ProfilerPhase entries
+ * of the interrupted thread. Each stack frame additionally refers to the
+ * plugin instance that was executing (e.g. the specific BSDF or texture), so
+ * that the time spent in a phase can be attributed to individual assets.
+ *
+ * Plugin instances are identified by a label of the form
+ * <tt>plugin_name:id</tt> that is registered when the plugin manager
+ * instantiates them (see \ref register_object()). The signal handler only
+ * records numeric IDs of the instances, which are never reused. Their labels
+ * are resolved when the samples are reported.
+ */
 class MTS_EXPORT_CORE Profiler : public Object {
 public:
+    /// Install the signal handler and start sampling
     static void static_initialization();
+
+    /// Stop sampling
     static void static_shutdown();
+
+    /// Start (or resume) sampling
+    static void start();
+
+    /// Stop sampling. Previously collected samples are retained.
+    static void stop();
+
+    /// Is the profiler currently collecting samples?
+    static bool running();
+
+    /// Discard all collected samples
+    static void reset();
+
+    /// Print a hierarchical, a flat, and a per-plugin report to the log
     static void print_report();
+
+    /**
+     * \brief Return all collected samples
+     *
+     * Each entry holds the call stack (a list of phase names and plugin
+     * labels, from the outermost to the innermost frame) and the number of
+     * samples that were taken with this stack. Samples recorded outside of
+     * any phase have an empty stack.
+     */
+    static ProfilerSampleList samples();
+
+    /**
+     * \brief Write the collected samples in the collapsed stack format
+     *
+     * The resulting file can be passed to \c flamegraph.pl or loaded into
+     * speedscope to visualize the profile as a flame graph.
+     */
+    static void write_flamegraph(const fs::path &path);
+
+    /**
+     * \brief Write the collected samples in the Chrome trace event format
+     *
+     * The aggregated profile is laid out as a flame chart on a single
+     * timeline, where the duration of each event corresponds to the time
+     * attributed to the associated call stack. The file can be loaded into
+     * <tt>chrome://tracing</tt> or Perfetto.
+     */
+    static void write_chrome_trace(const fs::path &path);
+
+    /// Associate a human-readable label with a plugin instance
+    static void register_object(const Object *object, const std::string &label);
+
+    /**
+     * \brief Mark the label of a plugin instance that is being destroyed
+     *
+     * This function is lock-free and called by \ref Object::~Object() for
+     * instances that have a label. Samples that were already attributed to
+     * the instance may still refer to the label, which is hence only
+     * discarded by the next call to \ref reset().
+     */
+    static void unregister_object(const Object *object);
+
     MTS_DECLARE_CLASS()
 private:
     Profiler() = delete;
@@ -121,12 +247,21 @@ private:
 #else
 
 /* Profiler not supported on this platform */
-struct ScopedPhase { ScopedPhase(ProfilerPhase) { } };
+struct ScopedPhase { ScopedPhase(ProfilerPhase, const Object * = nullptr) { } };
 class Profiler {
 public:
     static void static_initialization() { }
     static void static_shutdown() { }
+    static void start() { }
+    static void stop() { }
+    static bool running() { return false; }
+    static void reset() { }
     static void print_report() { }
+    static ProfilerSampleList samples() { return { }; }
+    static void write_flamegraph(const fs::path &) { }
+    static void write_chrome_trace(const fs::path &) { }
+    static void register_object(const Object *, const std::string &) { }
+    static void unregister_object(const Object *) { }
 };
 
 #endif
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <mitsuba/core/stream.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/** \brief \ref Stream implementation for TCP network connections
+ *
+ * Read operations block until the requested amount of data has arrived and
+ * throw an exception when the connection is closed by the peer (or when the
+ * timeout specified via \ref set_timeout() expires). Write operations send
+ * the data immediately (Nagle's algorithm is disabled), hence \ref flush() is
+ * a no-op.
+ *
+ * The stream uses network byte order by default.
+ */
+class MTS_EXPORT_CORE SocketStream : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+
+    /// Connect to the given host name (or IP address) and port
+    SocketStream(const std::string &host, int port);
+
+    /// Returns a string representation
+    std::string to_string() const override;
+
+    /** \brief Closes the stream and the underlying connection.
+     * No further read or write operations are permitted.
+     *
+     * This function is idempotent.
+     * It is called automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override { return m_socket == -1; }
+
+    // =========================================================================
+    //! @{ \name Socket stream-specific features
+    // =========================================================================
+
+    /// Return a description of the remote end of the connection ("host:port")
+    const std::string &peer() const { return m_peer; }
+
+    /**
+     * \brief Set the maximum amount of time (in seconds) that a read operation
+     * may wait for data. A value of zero disables the timeout (default).
+     */
+    void set_timeout(float timeout);
+
+    /**
+     * \brief Wait until data is available for reading (or the peer closed
+     * the connection)
+     *
+     * \param timeout
+     *     Maximum time to wait (in seconds). A negative value waits
+     *     indefinitely.
+     *
+     * \return \c false when the timeout expired.
+     */
+    bool poll(float timeout);
+
+    /// Return the number of bytes received so far
+    size_t received_bytes() const { return m_received; }
+
+    /// Return the number of bytes sent so far
+    size_t sent_bytes() const { return m_sent; }
+
+    //! @}
+    // =========================================================================
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    /**
+     * \brief Reads a specified amount of data from the connection.
+     * Blocks until all data has been received.
+     */
+    virtual void read(void *p, size_t size) override;
+
+    /// Sends a specified amount of data over the connection
+    virtual void write(const void *p, size_t size) override;
+
+    /// Unsupported. Always throws.
+    virtual void seek(size_t) override {
+        Throw("seek(): unsupported in a socket stream!");
+    }
+
+    /// Unsupported. Always throws.
+    virtual void truncate(size_t) override {
+        Throw("truncate(): unsupported in a socket stream!");
+    }
+
+    /// Returns the total number of bytes that were sent and received
+    virtual size_t tell() const override { return m_received + m_sent; }
+
+    /// Unsupported. Always throws.
+    virtual size_t size() const override {
+        Throw("size(): unsupported in a socket stream!");
+        return 0;
+    }
+
+    /// No-op since all data is sent immediately
+    virtual void flush() override { }
+
+    /// Always returns true, except if the stream is closed.
+    virtual bool can_write() const override { return !is_closed(); }
+
+    /// Always returns true, except if the stream is closed.
+    virtual bool can_read() const override { return !is_closed(); }
+
+    //! @}
+    // =========================================================================
+
+    MTS_DECLARE_CLASS()
+protected:
+    friend class ServerSocket;
+
+    /// Wrap a connected socket handle (used by \ref ServerSocket::accept())
+    SocketStream(intptr_t socket, const std::string &peer);
+
+    /// Protected destructor
+    virtual ~SocketStream();
+
+private:
+    intptr_t m_socket;
+    std::string m_peer;
+    size_t m_received, m_sent;
+};
+
+/**
+ * \brief Listens for incoming TCP connections and creates a
+ * \ref SocketStream for each of them
+ */
+class MTS_EXPORT_CORE ServerSocket : public Object {
+public:
+    /**
+     * \brief Listen for connections on the given port
+     *
+     * \param port
+     *     Port number. The value zero selects an unused port, which can be
+     *     queried using \ref port().
+     *
+     * \param address
+     *     Local address to bind to. An empty string accepts connections on
+     *     all network interfaces.
+     */
+    ServerSocket(int port, const std::string &address = "");
+
+    /// Return the port number on which the server listens for connections
+    int port() const { return m_port; }
+
+    /**
+     * \brief Wait for an incoming connection
+     *
+     * \param timeout
+     *     Maximum time to wait (in seconds). A negative value waits
+     *     indefinitely.
+     *
+     * \return
+     *     The new connection, or \c nullptr when the timeout expired.
+     */
+    ref<SocketStream> accept(float timeout = -1.f);
+
+    /// Stop listening for connections (idempotent)
+    void close();
+
+    /// Whether the server socket is closed
+    bool is_closed() const { return m_socket == -1; }
+
+    /// Returns a string representation
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor
+    virtual ~ServerSocket();
+
+private:
+    intptr_t m_socket;
+    int m_port;
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <atomic>
+
+#if !defined(MTS_STATS_HISTOGRAM_BINS)
+#  define MTS_STATS_HISTOGRAM_BINS 64
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// List of event counters that are maintained by the statistics subsystem
+enum class StatsCounter : int {
+    CameraRays = 0,             /* Rays generated by the sensor */
+    IntersectionRays,           /* Scene::ray_intersect() */
+    ShadowRays,                 /* Scene::ray_test() */
+    KDTreeInnerNodes,           /* kd-tree inner nodes visited during traversal */
+    KDTreeLeafNodes,            /* kd-tree leaf nodes visited during traversal */
+    PrimitiveTests,             /* Ray-primitive intersection tests */
+    RussianRoulette,            /* Paths terminated by Russian roulette */
+
+    StatsCounterCount
+};
+
+constexpr const char
+    *stats_counter_id[int(StatsCounter::StatsCounterCount)] = {
+        "Camera rays",
+        "Intersection rays",
+        "Shadow rays",
+        "kd-tree inner node visits",
+        "kd-tree leaf node visits",
+        "Primitive intersection tests",
+        "Russian roulette terminations"
+    };
+
+/// List of histograms that are maintained by the statistics subsystem
+enum class StatsHistogram : int {
+    PathDepth = 0,              /* Number of path vertices created at each depth */
+    PrimitiveTestsPerRay,       /* Primitive tests per kd-tree traversal (log2 bins) */
+
+    StatsHistogramCount
+};
+
+constexpr const char
+    *stats_histogram_id[int(StatsHistogram::StatsHistogramCount)] = {
+        "Path depth",
+        "Primitive tests per ray"
+    };
+
+/// Does the histogram use logarithmic (power of two) bins?
+constexpr bool stats_histogram_log2[int(StatsHistogram::StatsHistogramCount)] = {
+    false,
+    true
+};
+
+static_assert(std::extent_v<decltype(stats_counter_id)> ==
+                  int(StatsCounter::StatsCounterCount),
+              "Statistics counters and descriptions don't have matching length!");
+
+static_assert(std::extent_v<decltype(stats_histogram_id)> ==
+                  int(StatsHistogram::StatsHistogramCount),
+              "Statistics histograms and descriptions don't have matching length!");
+
+#if defined(MTS_ENABLE_STATISTICS)
+
+/// Evaluates its arguments only when statistics are enabled
+#define MTS_STATS(...) __VA_ARGS__
+
+/**
+ * \brief Per-thread storage of all counters and histograms
+ *
+ * Entries are only ever written by the owning thread. They use relaxed atomic
+ * loads and stores (which compile to plain memory accesses) so that other
+ * threads may safely read them when merging.
+ */
+struct StatsThreadData {
+    std::atomic<uint64_t> counters[int(StatsCounter::StatsCounterCount)];
+    std::atomic<uint64_t> histograms[int(StatsHistogram::StatsHistogramCount)]
+                                    [MTS_STATS_HISTOGRAM_BINS];
+};
+
+/* See the comment in profiler.h regarding the attributes of this function */
+extern MTS_EXPORT_CORE StatsThreadData *stats_thread_data()
+    __attribute__((noinline, weak, const));
+
+/// Add \c amount to a counter of the current thread
+inline void stats_add(StatsCounter counter, uint64_t amount) {
+    std::atomic<uint64_t> &value = stats_thread_data()->counters[int(counter)];
+    value.store(value.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+/// Record a value in a histogram of the current thread
+inline void stats_record(StatsHistogram histogram, uint64_t value) {
+    size_t bin = (size_t) value;
+    if (stats_histogram_log2[int(histogram)]) {
+        bin = 0;
+        while (value > 0) {
+            value >>= 1;
+            bin++;
+        }
+    }
+    bin = std::min(bin, (size_t) MTS_STATS_HISTOGRAM_BINS - 1);
+    std::atomic<uint64_t> &entry =
+        stats_thread_data()->histograms[int(histogram)][bin];
+    entry.store(entry.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+}
+
+/// Count the active lanes of a mask. Does nothing for GPU arrays.
+template <typename Mask>
+void stats_count(StatsCounter counter, const Mask &mask) {
+    if constexpr (is_cuda_array_v<Mask>) {
+        ENOKI_MARK_USED(counter);
+        ENOKI_MARK_USED(mask);
+    } else if constexpr (is_array_v<Mask>) {
+        stats_add(counter, (uint64_t) count(mask));
+    } else {
+        if (mask)
+            stats_add(counter, 1);
+    }
+}
+
+/// Record the active lanes of a value in a histogram. Does nothing for GPU arrays.
+template <typename Value, typename Mask>
+void stats_record(StatsHistogram histogram, const Value &value, const Mask &mask) {
+    if constexpr (is_cuda_array_v<Mask>) {
+        ENOKI_MARK_USED(histogram);
+        ENOKI_MARK_USED(value);
+        ENOKI_MARK_USED(mask);
+    } else if constexpr (is_array_v<Mask>) {
+        for (size_t i = 0; i < array_size_v<Mask>; ++i) {
+            if (mask.coeff(i))
+                stats_record(histogram, (uint64_t) value.coeff(i));
+        }
+    } else {
+        if (mask)
+            stats_record(histogram, (uint64_t) value);
+    }
+}
+
+/**
+ * \brief Accumulates a counter in a local variable and adds it to the
+ * per-thread statistics (and optionally a histogram) when going out of scope
+ *
+ * This avoids accessing thread-local storage in inner loops, e.g. during
+ * kd-tree traversal.
+ */
+struct ScopedStatsCounter {
+    ScopedStatsCounter(StatsCounter counter,
+                       StatsHistogram histogram = StatsHistogram::StatsHistogramCount)
+        : m_counter(counter), m_histogram(histogram) { }
+
+    ~ScopedStatsCounter() {
+        if (m_value > 0)
+            stats_add(m_counter, m_value);
+        if (m_histogram != StatsHistogram::StatsHistogramCount)
+            stats_record(m_histogram, m_value);
+    }
+
+    ScopedStatsCounter &operator++() { m_value++; return *this; }
+    ScopedStatsCounter &operator+=(uint64_t amount) { m_value += amount; return *this; }
+
+    ScopedStatsCounter(const ScopedStatsCounter &) = delete;
+    ScopedStatsCounter &operator=(const ScopedStatsCounter &) = delete;
+
+private:
+    StatsCounter m_counter;
+    StatsHistogram m_histogram;
+    uint64_t m_value = 0;
+};
+
+#else
+
+#define MTS_STATS(...)
+
+#endif
+
+/**
+ * \brief Render statistics (event counters and histograms)
+ *
+ * Performance-critical code paths (ray tracing, kd-tree traversal, path
+ * construction) update per-thread counters that are summed up by \ref merge()
+ * at the end of a rendering. The subsystem is compiled out unless Mitsuba is
+ * built with <tt>MTS_ENABLE_STATISTICS</tt>, in which case \ref enabled()
+ * returns \c true.
+ *
+ * For packet variants, kd-tree statistics refer to the traversal of a whole
+ * packet rather than to individual rays.
+ */
+class MTS_EXPORT_CORE Statistics {
+public:
+    /// Were statistics enabled at compile time?
+    static bool enabled();
+
+    /// Reset all counters and histograms (of all threads) and restart the timer
+    static void reset();
+
+    /// Sum up the counters of all threads and record the elapsed time
+    static void merge();
+
+    /// Return the value of a counter as of the last call to \ref merge()
+    static uint64_t counter(StatsCounter counter);
+
+    /// Return the bins of a histogram as of the last call to \ref merge()
+    static std::vector<uint64_t> histogram(StatsHistogram histogram);
+
+    /// Return the time between \ref reset() and \ref merge() in seconds
+    static float elapsed();
+
+    /// Return a human-readable summary of the merged statistics
+    static std::string report();
+
+    /// Return the merged statistics as a JSON string
+    static std::string to_json();
+
+    /// Write the merged statistics to a JSON file
+    static void write_json(const fs::path &path);
+
+private:
+    Statistics() = delete;
+};
+
+NAMESPACE_END(mitsuba)
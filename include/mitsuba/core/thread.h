@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/profiler.h>
 #include <memory>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -63,6 +64,17 @@ public:
     /// Return the core affinity
     int core_affinity() const;
 
+    /**
+     * \brief Restrict the thread to the processors of a NUMA node
+     *
+     * See \ref numa::node_cpus() for the processors that belong to each
+     * node. A value of -1 removes the restriction.
+     */
+    void set_numa_node(int node);
+
+    /// Return the NUMA node that the thread is restricted to (or -1)
+    int numa_node() const;
+
     /**
      * \brief Specify whether or not this thread is critical
      *
@@ -172,8 +184,12 @@ private:
 };
 
 /**
- * \brief Captures a thread environment (logger, file resolver, profiler flags).
+ * \brief Captures a thread environment (logger, file resolver, profiler stack).
  * Used with \ref ScopedSetThreadEnvironment
+ *
+ * The profiler stack includes the plugin instances of its frames, hence
+ * samples taken on worker threads remain attributed to the instance that
+ * launched the parallel work.
  */
 class MTS_EXPORT_CORE ThreadEnvironment {
     friend class ScopedSetThreadEnvironment;
@@ -186,7 +202,7 @@ private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t m_profiler_flags;
+    ProfilerStack m_profiler_stack;
 #endif
 };
 
@@ -203,7 +219,7 @@ private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t m_profiler_flags;
+    ProfilerStack m_profiler_stack;
 #endif
 };
 
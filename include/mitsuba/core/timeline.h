@@ -0,0 +1,98 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// A single phase of a rendering job recorded by the \ref Timeline
+struct MTS_EXPORT_CORE TimelineEvent {
+    /// Kind of phase (e.g. "plugin", "load", "accel", "render", "pass", "develop", "write")
+    std::string category;
+    /// Descriptive name (e.g. plugin name or file name)
+    std::string name;
+    /// Name of the thread that recorded the event
+    std::string thread;
+    /// Start time in seconds since the last call to \ref Timeline::reset()
+    double start;
+    /// Duration in seconds
+    double duration;
+    /// Resident set size of the process at the beginning of the phase (bytes)
+    size_t rss_start;
+    /// Resident set size of the process at the end of the phase (bytes)
+    size_t rss_end;
+    /// Peak resident set size of the process at the end of the phase (bytes)
+    size_t peak_rss;
+};
+
+/**
+ * \brief Structured timeline of the phases of a rendering job
+ *
+ * When enabled, plugin loading, object instantiation (which includes asset
+ * loading), acceleration data structure construction, rendering passes, film
+ * development and image output are recorded along with the resident memory
+ * of the process at their beginning and end. The result can be exported as
+ * JSON, e.g. to group jobs by memory footprint or to detect slow asset loads.
+ *
+ * Memory usage is tracked at the process level: the growth in resident
+ * memory during a phase serves as its allocation total, which also includes
+ * allocations by concurrently running phases.
+ */
+class MTS_EXPORT_CORE Timeline {
+public:
+    /// Enable or disable the recording of events (disabled by default)
+    static void set_enabled(bool enabled);
+
+    /// Is the recording of events enabled?
+    static bool enabled();
+
+    /// Remove all events and restart the clock
+    static void reset();
+
+    /// Return the time in seconds since the last call to \ref reset()
+    static double time();
+
+    /**
+     * \brief Record an event
+     *
+     * \param start
+     *     Start time of the phase as returned by \ref time()
+     *
+     * \param rss_start
+     *     Resident set size at the beginning of the phase
+     */
+    static void add(const std::string &category, const std::string &name,
+                    double start, size_t rss_start);
+
+    /// Return a copy of all events recorded since the last call to \ref reset()
+    static std::vector<TimelineEvent> events();
+
+    /// Return the events and a per-category summary as a JSON string
+    static std::string to_json();
+
+    /// Write the output of \ref to_json() to a file
+    static void write_json(const fs::path &path);
+
+private:
+    Timeline() = delete;
+};
+
+/// Records a \ref Timeline event that spans the lifetime of this object
+class MTS_EXPORT_CORE ScopedTimelineEvent {
+public:
+    ScopedTimelineEvent(const std::string &category, const std::string &name);
+    ~ScopedTimelineEvent();
+
+    ScopedTimelineEvent(const ScopedTimelineEvent &) = delete;
+    ScopedTimelineEvent &operator=(const ScopedTimelineEvent &) = delete;
+
+private:
+    bool m_active;
+    std::string m_category;
+    std::string m_name;
+    double m_start;
+    size_t m_rss_start;
+};
+
+NAMESPACE_END(mitsuba)
@@ -28,6 +28,12 @@ extern MTS_EXPORT_CORE std::string time_string(float time, bool precise = false)
 /// Turn a memory size into a human-readable string
 extern MTS_EXPORT_CORE std::string mem_string(size_t size, bool precise = false);
 
+/// Return the resident set size (physical memory usage) of the process in bytes
+extern MTS_EXPORT_CORE size_t current_rss();
+
+/// Return the peak resident set size of the process in bytes
+extern MTS_EXPORT_CORE size_t peak_rss();
+
 /// Returns 'true' if the application is running inside a debugger
 extern MTS_EXPORT_CORE bool detect_debugger();
 
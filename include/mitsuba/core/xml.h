@@ -29,16 +29,34 @@ using ParameterList = std::vector<std::pair<std::string, std::string>>;
  * \param update_scene
  *     When Mitsuba updates scene to a newer version, should the
  *     updated XML file be written back to disk?
+ *
+ * \param deferred
+ *     Build the dependency graph of the scene before instantiating
+ *     anything. Objects with an ID that are neither referenced by other
+ *     objects nor directly used by the scene (e.g. unused entries of a
+ *     material library) are skipped, and the remaining objects are
+ *     instantiated in parallel waves following the dependency order.
+ *
+ * \param write_compiled
+ *     When specified, a compiled version of the scene is written to this
+ *     path once all objects were instantiated successfully. It stores the
+ *     object graph with fully resolved properties, transformations and file
+ *     references, and can be passed to this function instead of the XML
+ *     file to skip XML parsing altogether. Compiled scenes are specific to
+ *     the variant and to the parameter values used to create them.
  */
 extern MTS_EXPORT_CORE ref<Object> load_file(const fs::path &path,
                                              const std::string &variant,
                                              ParameterList parameters = ParameterList(),
-                                             bool update_scene = false);
+                                             bool update_scene = false,
+                                             bool deferred = false,
+                                             const fs::path &write_compiled = fs::path());
 
-/// Load a Mitsuba scene from an XML string
+/// Load a Mitsuba scene from an XML string (see \ref load_file())
 extern MTS_EXPORT_CORE ref<Object> load_string(const std::string &string,
                                                const std::string &variant,
-                                               ParameterList parameters = ParameterList());
+                                               ParameterList parameters = ParameterList(),
+                                               bool deferred = false);
 
 NAMESPACE_END(xml)
 NAMESPACE_END(mitsuba)
@@ -204,6 +204,88 @@ static const char *__doc_mitsuba_ArgParser_parse = R"doc(Parse the given set of
 
 static const char *__doc_mitsuba_ArgParser_parse_2 = R"doc(Parse the given set of command line arguments)doc";
 
+static const char *__doc_mitsuba_AssetCache =
+R"doc(Process-wide cache of decoded scene assets
+
+Plugins that decode large payloads from disk (meshes, bitmaps, volumes)
+can register their decoded representation with this cache so that
+subsequent loads of the same file within one process are served from
+memory. This is useful when the same assets are loaded repeatedly,
+e.g. when rendering many variants of a scene from Python or in batch
+mode.
+
+Entries are keyed on the resolved file path, the file's modification
+time and size, and a plugin-specific string summarizing all properties
+that influence the decoded representation (e.g. the target variant or
+a transformation that is baked into the data). Cached objects are
+shared between all users and must be treated as immutable.
+
+When the total size of all entries exceeds memory_limit(), the least
+recently used entries are evicted. Evicted objects that are still
+referenced elsewhere remain alive until they are released.)doc";
+
+static const char *__doc_mitsuba_AssetCache_AssetCache = R"doc()doc";
+
+static const char *__doc_mitsuba_AssetCache_AssetCachePrivate = R"doc()doc";
+
+static const char *__doc_mitsuba_AssetCache_class = R"doc()doc";
+
+static const char *__doc_mitsuba_AssetCache_clear = R"doc(Remove all cached assets)doc";
+
+static const char *__doc_mitsuba_AssetCache_d = R"doc()doc";
+
+static const char *__doc_mitsuba_AssetCache_enabled = R"doc(Is the cache currently enabled?)doc";
+
+static const char *__doc_mitsuba_AssetCache_entries =
+R"doc(Return a summary of all cached assets
+
+Each entry holds the file path, the plugin-specific key, and the
+memory footprint in bytes. Entries are sorted from most to least
+recently used.)doc";
+
+static const char *__doc_mitsuba_AssetCache_entry_count = R"doc(Return the number of cached assets)doc";
+
+static const char *__doc_mitsuba_AssetCache_find = R"doc(Return a cached asset or ``nullptr`` if it is not present)doc";
+
+static const char *__doc_mitsuba_AssetCache_get =
+R"doc(Look up an asset, decoding and inserting it on a cache miss
+
+Parameter ``path``:
+    Resolved path of the file backing the asset
+
+Parameter ``key``:
+    Plugin-specific string that summarizes all properties affecting
+    the decoded representation
+
+Parameter ``loader``:
+    Function that decodes the asset if it is not in the cache)doc";
+
+static const char *__doc_mitsuba_AssetCache_get_2 = R"doc(Convenience template wrapper around get())doc";
+
+static const char *__doc_mitsuba_AssetCache_hit_count = R"doc(Return the number of lookups that were served from the cache)doc";
+
+static const char *__doc_mitsuba_AssetCache_instance = R"doc(Return the global asset cache (or ``nullptr`` if not initialized))doc";
+
+static const char *__doc_mitsuba_AssetCache_m_instance = R"doc()doc";
+
+static const char *__doc_mitsuba_AssetCache_memory_limit = R"doc(Return the maximum total size of all cached assets in bytes)doc";
+
+static const char *__doc_mitsuba_AssetCache_memory_usage = R"doc(Return the total size of all cached assets in bytes)doc";
+
+static const char *__doc_mitsuba_AssetCache_miss_count = R"doc(Return the number of lookups that required decoding the asset)doc";
+
+static const char *__doc_mitsuba_AssetCache_put = R"doc(Insert an asset with the given memory footprint (in bytes))doc";
+
+static const char *__doc_mitsuba_AssetCache_set_enabled = R"doc(Enable or disable the cache (disabling it also clears all entries))doc";
+
+static const char *__doc_mitsuba_AssetCache_set_memory_limit = R"doc(Set the maximum total size of all cached assets in bytes)doc";
+
+static const char *__doc_mitsuba_AssetCache_static_initialization = R"doc(Create the global asset cache)doc";
+
+static const char *__doc_mitsuba_AssetCache_static_shutdown = R"doc(Release the global asset cache and all cached assets)doc";
+
+static const char *__doc_mitsuba_AssetCache_to_string = R"doc(Return a human-readable summary)doc";
+
 static const char *__doc_mitsuba_AtomicFloat =
 R"doc(Atomic floating point data type
 
@@ -438,6 +520,30 @@ Parameter ``si``:
     surface position. The incident direction is obtained from the
     field ``si.wi``.)doc";
 
+static const char *__doc_mitsuba_BSDF_eval_pdf =
+R"doc(Jointly evaluate the BSDF f(wi, wo) and the probability per unit
+solid angle of sampling the outgoing direction ``wo``
+
+This method is equivalent to calling eval() and pdf() with the same
+arguments, but lets implementations share work between the two
+queries (e.g. texture lookups, Fresnel and microfacet terms). The
+default implementation simply invokes both methods.
+
+Parameter ``ctx``:
+    A context data structure describing which lobes to evalute, and
+    whether radiance or importance are being transported.
+
+Parameter ``si``:
+    A surface interaction data structure describing the underlying
+    surface position. The incident direction is obtained from the
+    field ``si.wi``.
+
+Parameter ``wo``:
+    The outgoing direction
+
+Returns:
+    A pair (value, pdf) containing the results of eval() and pdf().)doc";
+
 static const char *__doc_mitsuba_BSDF_flags = R"doc(Flags for all components combined.)doc";
 
 static const char *__doc_mitsuba_BSDF_flags_2 = R"doc(Flags for a specific component of this BSDF.)doc";
@@ -1041,6 +1147,103 @@ static const char *__doc_mitsuba_Bitmap_write_ppm = R"doc(Save a file using the
 
 static const char *__doc_mitsuba_Bitmap_write_rgbe = R"doc(Save a file using the RGBE file format)doc";
 
+static const char *__doc_mitsuba_BlockScheduler =
+R"doc(Cost-aware generator of image blocks to be rendered
+
+In contrast to Spiral, which hands out the blocks of each pass in a
+fixed order, this class orders the blocks of a pass by their estimated
+rendering cost so that the most expensive ones are processed first.
+Blocks whose cost is a large fraction of the work per worker are
+furthermore split into four sub-blocks, which lets idle workers pick
+up the remaining work of an expensive region instead of waiting for a
+single straggler at the end of the pass.
+
+Cost estimates are provided via set_cost() (e.g. from a low sample
+count prepass) and are refined using the measured rendering times
+reported to record_cost(), which affect the order of subsequent
+passes. Without any estimates, blocks are generated in spiral order.
+
+The block identifiers only depend on the pass, block and sub-block,
+hence they can be used to deterministically seed a sampler. Note
+however that the decision to split a block depends on the measured
+timings.)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_BlockScheduler =
+R"doc(Create a new block scheduler for the given size, offset into a larger
+frame, and block size
+
+Parameter ``worker_count``:
+    Number of workers processing the blocks, used to decide which
+    blocks should be split)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_Item = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_Item_cost = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_Item_id = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_Item_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_Item_size = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_block = R"doc(Return the offset and size of the block with the given index)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_block_count = R"doc(Return the number of blocks per pass (not counting sub-blocks))doc";
+
+static const char *__doc_mitsuba_BlockScheduler_build_pass =
+R"doc(Generate the work items of the given pass (expects the mutex to be
+held))doc";
+
+static const char *__doc_mitsuba_BlockScheduler_class = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_cost = R"doc(Return the estimated cost of the given block (negative if unknown))doc";
+
+static const char *__doc_mitsuba_BlockScheduler_id_count = R"doc(Return an upper bound for the identifiers returned by next_block())doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_block_count = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_block_size = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_blocks = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_cost = R"doc(Estimated cost per block (negative if unknown))doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_items = R"doc(Work items of the current pass, sorted by decreasing cost)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_mutex = R"doc(Protects the scheduler's state (thread safety).)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_next_item = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_order = R"doc(Block indices in spiral order (used as tie breaker))doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_pass_count = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_passes = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_size = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_m_worker_count = R"doc()doc";
+
+static const char *__doc_mitsuba_BlockScheduler_max_block_size = R"doc(Return the maximum block size)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_next_block =
+R"doc(Return the offset, size and unique identifer of the next block.
+
+A size of zero indicates that all passes are done.)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_record_cost =
+R"doc(Report the time that was needed to render the block with the given
+identifier (as returned by next_block())
+
+Updates the cost estimate of the corresponding block, taking into
+account that sub-blocks only cover a fraction of it.)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_reset = R"doc(Restart with the first pass. Does not affect the cost estimates.)doc";
+
+static const char *__doc_mitsuba_BlockScheduler_set_cost = R"doc(Set the estimated cost (e.g. in seconds) of the block with the given index)doc";
+
 static const char *__doc_mitsuba_BoundingBox =
 R"doc(Generic n-dimensional bounding box data structure
 
@@ -1501,6 +1704,82 @@ static const char *__doc_mitsuba_DefaultFormatter_set_has_log_level = R"doc(Shou
 
 static const char *__doc_mitsuba_DefaultFormatter_set_has_thread = R"doc(Should thread information be included? The default is yes.)doc";
 
+static const char *__doc_mitsuba_Denoiser =
+R"doc(Feature-guided denoiser for Monte Carlo renderings
+
+Implements an edge-avoiding à-trous wavelet filter in the spirit of
+spatiotemporal variance-guided filtering (SVGF, spatial part only).
+The noisy image is demodulated by the surface albedo (so that texture
+detail is not blurred) and then filtered by a sequence of sparse 5x5
+kernels with increasing footprint. The contribution of each neighbor
+is attenuated based on
+
+- the difference in luminance, relative to the estimated standard
+deviation of the noise,
+
+- the angle between the shading normals,
+
+- the difference in albedo.
+
+The per-pixel variance is filtered along with the image. When it is
+not available, it is estimated from the local neighborhood of each
+pixel.
+
+All bitmaps are expected to store ``float32`` values. Rows of the
+image are processed in parallel.)doc";
+
+static const char *__doc_mitsuba_Denoiser_Denoiser =
+R"doc(Create a denoiser
+
+Parameter ``iterations``:
+    Number of à-trous iterations. The footprint of the filter is ``4 *
+    2^iterations - 3`` pixels wide.
+
+Parameter ``sigma_color``:
+    Scale of the luminance edge-stopping function, in standard
+    deviations of the noise. Larger values filter more aggressively.
+
+Parameter ``sigma_normal``:
+    Exponent of the normal edge-stopping function. Larger values
+    preserve geometric edges more strongly.
+
+Parameter ``sigma_albedo``:
+    Scale of the albedo edge-stopping function.)doc";
+
+static const char *__doc_mitsuba_Denoiser_class = R"doc()doc";
+
+static const char *__doc_mitsuba_Denoiser_denoise =
+R"doc(Denoise an image
+
+Parameter ``color``:
+    Linear RGB image (the first three channels are used)
+
+Parameter ``albedo``:
+    Optional RGB albedo of the visible surfaces
+
+Parameter ``normal``:
+    Optional shading normals of the visible surfaces (need not be
+    normalized). Pixels without a surface should store zero.
+
+Parameter ``variance``:
+    Optional single-channel variance of the luminance of each pixel
+    (i.e. of the pixel estimate, not of the individual samples)
+
+Returns:
+    A denoised RGB image of the same size)doc";
+
+static const char *__doc_mitsuba_Denoiser_iterations = R"doc(Return the number of à-trous iterations)doc";
+
+static const char *__doc_mitsuba_Denoiser_m_iterations = R"doc()doc";
+
+static const char *__doc_mitsuba_Denoiser_m_sigma_albedo = R"doc()doc";
+
+static const char *__doc_mitsuba_Denoiser_m_sigma_color = R"doc()doc";
+
+static const char *__doc_mitsuba_Denoiser_m_sigma_normal = R"doc()doc";
+
+static const char *__doc_mitsuba_Denoiser_to_string = R"doc(Returns a string representation)doc";
+
 static const char *__doc_mitsuba_DirectionSample =
 R"doc(Record for solid-angle based area sampling techniques
 
@@ -1689,6 +1968,10 @@ static const char *__doc_mitsuba_Distribution2D_Distribution2D = R"doc()doc";
 
 static const char *__doc_mitsuba_Distribution2D_Distribution2D_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Distribution2D_Distribution2D_3 =
+R"doc(Unserialize the parameter discretization from a binary data stream,
+after checking the type identifier ``tag`` written by write_base())doc";
+
 static const char *__doc_mitsuba_Distribution2D_interpolate_weights = R"doc()doc";
 
 static const char *__doc_mitsuba_Distribution2D_m_inv_patch_size = R"doc(Inverse of the above)doc";
@@ -1701,6 +1984,16 @@ static const char *__doc_mitsuba_Distribution2D_m_patch_size = R"doc(Size of a b
 
 static const char *__doc_mitsuba_Distribution2D_m_slices = R"doc(Total number of slices (in case Dimension > 1))doc";
 
+static const char *__doc_mitsuba_Distribution2D_parallel_rows =
+R"doc(Invoke ``func(slice, row)`` in parallel for the first ``rows`` rows of
+every slice, given the number of values per row)doc";
+
+static const char *__doc_mitsuba_Distribution2D_read_storage = R"doc(Read a table of floating point values written by write_storage())doc";
+
+static const char *__doc_mitsuba_Distribution2D_write_base = R"doc(Serialize a type identifier and the parameter discretization)doc";
+
+static const char *__doc_mitsuba_Distribution2D_write_storage = R"doc(Write a table of floating point values to a binary data stream)doc";
+
 static const char *__doc_mitsuba_DummyStream =
 R"doc(Stream implementation that never writes to disk, but keeps track of
 the size of the content being written. It can be used, for example, to
@@ -2170,10 +2463,23 @@ static const char *__doc_mitsuba_Film_set_crop_window = R"doc(Set the size and o
 
 static const char *__doc_mitsuba_Film_set_destination_file = R"doc(Set the target filename (with or without extension))doc";
 
+static const char *__doc_mitsuba_Film_set_pass_count =
+R"doc(Specify how many times each pixel will be submitted via put()
+
+Integrators that render the image in several passes call this after
+prepare(). Films that write out finished regions while rendering use
+it to detect when a region will not receive further samples.)doc";
+
 static const char *__doc_mitsuba_Film_size =
 R"doc(Ignoring the crop window, return the resolution of the underlying
 sensor)doc";
 
+static const char *__doc_mitsuba_Film_streams_output =
+R"doc(Does the film write finished regions to disk while rendering?
+
+Such films finalize their output file in develop(), which hence must
+only be called once rendering has finished.)doc";
+
 static const char *__doc_mitsuba_Film_to_string = R"doc(//! @})doc";
 
 static const char *__doc_mitsuba_FilterBoundaryCondition =
@@ -2380,12 +2686,16 @@ interpolation in ``eval()`` is used). In this case, ``sample()`` and
 ``invert()`` can still be called without triggering undefined
 behavior, but they will not return meaningful results.)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_Hierarchical2D_3 = R"doc(Unserialize a sample warping scheme from a binary data stream)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_Level = R"doc()doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_Level_Level = R"doc()doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_Level_Level_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_Level_Level_3 = R"doc()doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_Level_data = R"doc()doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_Level_data_ptr = R"doc()doc";
@@ -2425,6 +2735,8 @@ Returns the warped sample and associated probability density.)doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_to_string = R"doc()doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_write = R"doc(Serialize the sample warping scheme to a binary data stream)doc";
+
 static const char *__doc_mitsuba_IOREntry = R"doc()doc";
 
 static const char *__doc_mitsuba_IOREntry_name = R"doc()doc";
@@ -2812,12 +3124,23 @@ static const char *__doc_mitsuba_Logger_clear_appenders = R"doc(Remove all appen
 
 static const char *__doc_mitsuba_Logger_d = R"doc()doc";
 
+static const char *__doc_mitsuba_Logger_dropped_count = R"doc(Return the number of messages that were dropped due to a full queue)doc";
+
 static const char *__doc_mitsuba_Logger_error_level = R"doc(Return the current error level)doc";
 
+static const char *__doc_mitsuba_Logger_flush =
+R"doc(Pass all pending messages to the appenders (asynchronous mode)
+
+Parameter ``wait``:
+    When ``False``, the function returns immediately if another thread
+    is currently invoking the appenders.)doc";
+
 static const char *__doc_mitsuba_Logger_formatter = R"doc(Return the logger's formatter implementation)doc";
 
 static const char *__doc_mitsuba_Logger_formatter_2 = R"doc(Return the logger's formatter implementation (const))doc";
 
+static const char *__doc_mitsuba_Logger_is_async = R"doc(Is asynchronous logging enabled?)doc";
+
 static const char *__doc_mitsuba_Logger_log =
 R"doc(Process a log message
 
@@ -2863,6 +3186,8 @@ Parameter ``ptr``:
 
 static const char *__doc_mitsuba_Logger_m_log_level = R"doc()doc";
 
+static const char *__doc_mitsuba_Logger_rate_limit = R"doc(Return the maximum number of messages per call site and time interval)doc";
+
 static const char *__doc_mitsuba_Logger_read_log =
 R"doc(Return the contents of the log file as a string
 
@@ -2870,6 +3195,28 @@ Throws a runtime exception upon failure)doc";
 
 static const char *__doc_mitsuba_Logger_remove_appender = R"doc(Remove an appender from this logger)doc";
 
+static const char *__doc_mitsuba_Logger_set_async =
+R"doc(Enable or disable asynchronous logging
+
+In asynchronous mode, formatted messages are pushed into a bounded
+lock-free queue that is drained by a background thread, hence threads
+that emit log messages never wait for each other or for slow
+appenders. When the queue is full, messages are dropped and their
+number is reported once space becomes available.
+
+Progress updates (log_progress()) go through the same queue and hence
+remain ordered with respect to the messages of their thread.
+
+Messages of each thread are appended in order. Before an error is
+raised (via log() or ``Throw``), the raising thread waits until the
+queue has been flushed, so that all messages emitted prior to the
+exception become visible first. Appenders must hence not wait for
+resources (e.g. the Python GIL) that such a thread may hold.
+
+Parameter ``capacity``:
+    Maximum number of pending messages (rounded up to a power of two).
+    Only used when asynchronous mode is enabled for the first time.)doc";
+
 static const char *__doc_mitsuba_Logger_set_error_level =
 R"doc(Set the error log level (this level and anything above will throw
 exceptions).
@@ -2882,10 +3229,21 @@ static const char *__doc_mitsuba_Logger_set_formatter = R"doc(Set the logger's f
 
 static const char *__doc_mitsuba_Logger_set_log_level = R"doc(Set the log level (everything below will be ignored))doc";
 
+static const char *__doc_mitsuba_Logger_set_rate_limit =
+R"doc(Limit the number of messages emitted from the same call site
+
+At most ``count`` messages below the error level are processed per
+source location (file and line) in each time interval of the given
+length in seconds. Further messages are discarded and summarized by a
+note attached to the next message from that location that passes. A
+count of zero (the default) disables the limit.)doc";
+
 static const char *__doc_mitsuba_Logger_static_initialization = R"doc(Initialize logging)doc";
 
 static const char *__doc_mitsuba_Logger_static_shutdown = R"doc(Shutdown logging)doc";
 
+static const char *__doc_mitsuba_Logger_suppressed_count = R"doc(Return the number of messages that were discarded due to the rate limit)doc";
+
 static const char *__doc_mitsuba_Marginal2D =
 R"doc(Implements a marginal sample warping scheme for 2D distributions with
 linear interpolation and an optional dependence on additional
@@ -2937,6 +3295,8 @@ not construct the cdf needed for sample warping, which saves memory in
 case this functionality is not needed (e.g. if only the interpolation
 in ``eval()`` is used).)doc";
 
+static const char *__doc_mitsuba_Marginal2D_Marginal2D_3 = R"doc(Unserialize a sample warping scheme from a binary data stream)doc";
+
 static const char *__doc_mitsuba_Marginal2D_eval =
 R"doc(Evaluate the density at position ``pos``. The distribution is
 parameterized by ``param`` if applicable.)doc";
@@ -2975,6 +3335,10 @@ static const char *__doc_mitsuba_Marginal2D_sample_segment = R"doc()doc";
 
 static const char *__doc_mitsuba_Marginal2D_to_string = R"doc()doc";
 
+static const char *__doc_mitsuba_Marginal2D_type_tag = R"doc()doc";
+
+static const char *__doc_mitsuba_Marginal2D_write = R"doc(Serialize the sample warping scheme to a binary data stream)doc";
+
 static const char *__doc_mitsuba_Medium = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_2 = R"doc()doc";
@@ -3209,6 +3573,10 @@ static const char *__doc_mitsuba_MemoryStream_m_size = R"doc(Current size of the
 
 static const char *__doc_mitsuba_MemoryStream_owns_buffer = R"doc(Return whether or not the memory stream owns the underlying buffer)doc";
 
+static const char *__doc_mitsuba_MemoryStream_raw_buffer = R"doc(Return a pointer to the underlying memory buffer)doc";
+
+static const char *__doc_mitsuba_MemoryStream_raw_buffer_2 = R"doc(Return a pointer to the underlying memory buffer (const version))doc";
+
 static const char *__doc_mitsuba_MemoryStream_read =
 R"doc(Reads a specified amount of data from the stream. Throws an exception
 if trying to read further than the current size of the contents.)doc";
@@ -3302,6 +3670,14 @@ static const char *__doc_mitsuba_Mesh_has_vertex_normals = R"doc(Does this mesh
 
 static const char *__doc_mitsuba_Mesh_has_vertex_texcoords = R"doc(Does this mesh have per-vertex texture coordinates?)doc";
 
+static const char *__doc_mitsuba_Mesh_load_cached =
+R"doc(Initialize the mesh geometry from the process-wide AssetCache
+
+Returns ``True`` if a previously decoded copy of the file at ``path``
+was found. The lookup accounts for the target variant, m_to_world and
+m_disable_vertex_normals; ``key`` should summarize any further
+loader-specific properties that affect the decoded geometry.)doc";
+
 static const char *__doc_mitsuba_Mesh_m_area_distr = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_bbox = R"doc()doc";
@@ -3371,6 +3747,8 @@ static const char *__doc_mitsuba_Mesh_recompute_vertex_normals = R"doc(Compute s
 
 static const char *__doc_mitsuba_Mesh_sample_position = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_store_cached = R"doc(Register the decoded mesh geometry with the process-wide AssetCache)doc";
+
 static const char *__doc_mitsuba_Mesh_surface_area = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable string representation of the shape contents.)doc";
@@ -3651,6 +4029,8 @@ static const char *__doc_mitsuba_Object_id = R"doc(Return an identifier of the c
 
 static const char *__doc_mitsuba_Object_inc_ref = R"doc(Increase the object's reference count by one)doc";
 
+static const char *__doc_mitsuba_Object_m_profiler_id = R"doc(Identifies the instance in the samples of the Profiler (0 if it has no label))doc";
+
 static const char *__doc_mitsuba_Object_m_ref_count = R"doc()doc";
 
 static const char *__doc_mitsuba_Object_parameters_changed =
@@ -3928,7 +4308,27 @@ an important 2D quantity, such as the texture coordinates on a
 triangle mesh or a position on the aperture of a sensor. When
 applicable, such positions are stored in the ``uv`` attribute.)doc";
 
-static const char *__doc_mitsuba_Profiler = R"doc()doc";
+static const char *__doc_mitsuba_Profiler =
+R"doc(Builtin sampling profiler
+
+The profiler periodically interrupts the process (100 Hz, using
+<tt>SIGPROF</tt>) and records the call stack of ProfilerPhase entries
+of the interrupted thread. Each stack frame additionally refers to the
+plugin instance that was executing (e.g. the specific BSDF or
+texture), so that the time spent in a phase can be attributed to
+individual assets.
+
+Plugin instances are identified by a label of the form
+<tt>plugin_name:id</tt> that is registered when the plugin manager
+instantiates them (see register_object()). The signal handler only
+records numeric IDs of the instances, which are never reused. Their
+labels are resolved when the samples are reported.)doc";
+
+static const char *__doc_mitsuba_ProfilerFrame = R"doc(Single entry of the per-thread profiler call stack)doc";
+
+static const char *__doc_mitsuba_ProfilerFrame_object = R"doc(Profiler ID of the plugin instance that is being executed (or 0))doc";
+
+static const char *__doc_mitsuba_ProfilerFrame_phase = R"doc()doc";
 
 static const char *__doc_mitsuba_ProfilerPhase =
 R"doc(List of 'phases' that are handled by the profiler. Note that a partial
@@ -3983,15 +4383,63 @@ static const char *__doc_mitsuba_ProfilerPhase_TextureEvaluate = R"doc()doc";
 
 static const char *__doc_mitsuba_ProfilerPhase_TextureSample = R"doc()doc";
 
+static const char *__doc_mitsuba_ProfilerStack = R"doc(Per-thread state that is inspected by the profiler's signal handler)doc";
+
+static const char *__doc_mitsuba_ProfilerStack_depth = R"doc(Current stack depth (may exceed MTS_PROFILE_MAX_DEPTH))doc";
+
+static const char *__doc_mitsuba_ProfilerStack_flags = R"doc(Bitmask of all active phases)doc";
+
+static const char *__doc_mitsuba_ProfilerStack_frames = R"doc()doc";
+
 static const char *__doc_mitsuba_Profiler_Profiler = R"doc()doc";
 
 static const char *__doc_mitsuba_Profiler_class = R"doc()doc";
 
-static const char *__doc_mitsuba_Profiler_print_report = R"doc()doc";
+static const char *__doc_mitsuba_Profiler_print_report = R"doc(Print a hierarchical, a flat, and a per-plugin report to the log)doc";
+
+static const char *__doc_mitsuba_Profiler_register_object = R"doc(Associate a human-readable label with a plugin instance)doc";
+
+static const char *__doc_mitsuba_Profiler_reset = R"doc(Discard all collected samples)doc";
+
+static const char *__doc_mitsuba_Profiler_running = R"doc(Is the profiler currently collecting samples?)doc";
+
+static const char *__doc_mitsuba_Profiler_samples =
+R"doc(Return all collected samples
+
+Each entry holds the call stack (a list of phase names and plugin
+labels, from the outermost to the innermost frame) and the number of
+samples that were taken with this stack. Samples recorded outside of
+any phase have an empty stack.)doc";
+
+static const char *__doc_mitsuba_Profiler_start = R"doc(Start (or resume) sampling)doc";
+
+static const char *__doc_mitsuba_Profiler_static_initialization = R"doc(Install the signal handler and start sampling)doc";
+
+static const char *__doc_mitsuba_Profiler_static_shutdown = R"doc(Stop sampling)doc";
+
+static const char *__doc_mitsuba_Profiler_stop = R"doc(Stop sampling. Previously collected samples are retained.)doc";
+
+static const char *__doc_mitsuba_Profiler_unregister_object =
+R"doc(Mark the label of a plugin instance that is being destroyed
+
+This function is lock-free and called by Object::~Object() for
+instances that have a label. Samples that were already attributed to
+the instance may still refer to the label, which is hence only
+discarded by the next call to reset().)doc";
+
+static const char *__doc_mitsuba_Profiler_write_chrome_trace =
+R"doc(Write the collected samples in the Chrome trace event format
 
-static const char *__doc_mitsuba_Profiler_static_initialization = R"doc()doc";
+The aggregated profile is laid out as a flame chart on a single
+timeline, where the duration of each event corresponds to the time
+attributed to the associated call stack. The file can be loaded into
+<tt>chrome://tracing</tt> or Perfetto.)doc";
 
-static const char *__doc_mitsuba_Profiler_static_shutdown = R"doc()doc";
+static const char *__doc_mitsuba_Profiler_write_flamegraph =
+R"doc(Write the collected samples in the collapsed stack format
+
+The resulting file can be passed to ``flamegraph.pl`` or loaded into
+speedscope to visualize the profile as a flame graph.)doc";
 
 static const char *__doc_mitsuba_ProgressReporter =
 R"doc(General-purpose progress reporter
@@ -4679,12 +5127,30 @@ R"doc(For integrators that return one or more arbitrary output variables
 (AOVs), this function specifies a list of associated channel names.
 The default implementation simply returns an empty vector.)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_block_size = R"doc(Return the size of the (square) image blocks rendered by render())doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_cancel = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_estimate_block_costs =
+R"doc(Estimate the rendering cost of the blocks of the given schedulers
+using a sparse prepass
+
+A small stratified subset of the pixels of each block is rendered with
+a single sample, and the time taken is extrapolated to the full block
+at ``sample_count`` samples per pixel. The prepass results are
+discarded.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_block_size = R"doc(Size of (square) image blocks to render per core.)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_m_cost_schedule =
+R"doc(Order blocks by their estimated cost instead of using a spiral
+
+When set, a sparse prepass estimates the cost of each block, and the
+blocks are handed out by a BlockScheduler, which processes expensive
+blocks first and splits them into sub-blocks.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_hide_emitters = R"doc(Flag for disabling direct visibility of emitters)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_m_render_timer = R"doc(Timer used to enforce the timeout.)doc";
@@ -4702,9 +5168,38 @@ R"doc(Maximum amount of time to spend rendering (excluding scene parsing).
 
 Specified in seconds. A negative values indicates no timeout.)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_pass_finished =
+R"doc(Called by render() in progressive mode after each pass that completed
+before the timeout
+
+No rendering threads are active at this point, hence integrators that
+learn from the samples of the previous passes (e.g. to guide the
+sampling of paths) can safely update their data structures here. The
+default implementation does nothing.
+
+Parameter ``pass``:
+    Index of the completed pass (starting at zero)
+
+Parameter ``pass_sample_count``:
+    Number of samples per pixel of the completed pass)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_render = R"doc(//! @{ \name Integrator interface implementation)doc";
 
-static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
+static const char *__doc_mitsuba_SamplingIntegrator_render_block =
+R"doc(Render a single image block
+
+The block's offset and size determine the rendered pixels. The sampler
+should be seeded with a unique identifier of the block beforehand so
+that the result is deterministic. This is the unit of work of
+render(), and it is also used to render blocks on behalf of another
+process in distributed rendering.
+
+Parameter ``aovs``:
+    Scratch space for at least ``aov_names().size() + 5`` entries
+
+Parameter ``sample_count``:
+    Number of samples per pixel, or ``size_t(-1)`` to use the sample
+    count of the sampler)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
 
@@ -4749,6 +5244,31 @@ Remark:
     mask, aov) = integrator.sample(scene, sampler, ray, medium,
     active) ``)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_sample_emitter_direction_ris =
+R"doc(Sample a direction towards an emitter for next event estimation using
+resampled importance sampling (RIS)
+
+Draws ``candidate_count`` directions using
+Scene::sample_emitter_direction() without testing their visibility,
+selects one of them with a weighted reservoir proportionally to its
+unshadowed contribution ``BSDF * Le / pdf``, and only traces a shadow
+ray towards the selected direction. This reduces the noise per shadow
+ray considerably in scenes with many emitters.
+
+The return value has the same meaning as that of
+Scene::sample_emitter_direction(): the product of the emitter weight
+and the BSDF value in direction ``ds.d`` is an unbiased estimate of the
+direct illumination. ``ds.pdf`` is the density of the candidates, which
+should be used for multiple importance sampling. A single candidate
+falls back to Scene::sample_emitter_direction().)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_samples_per_pass =
+R"doc(Return the number of samples per pixel that render() computes in each
+pass over the image blocks
+
+Throws when the total sample count is not a multiple of the
+``samples_per_pass`` parameter.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_should_stop =
 R"doc(Indicates whether cancel() or a timeout have occured. Should be
 checked regularly in the integrator's main loop so that timeouts are
@@ -4909,10 +5429,33 @@ static const char *__doc_mitsuba_ScopedPhase_ScopedPhase_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_m_flag = R"doc()doc";
 
-static const char *__doc_mitsuba_ScopedPhase_m_target = R"doc()doc";
+static const char *__doc_mitsuba_ScopedPhase_m_stack = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_operator_assign = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedStatsCounter =
+R"doc(Accumulates a counter in a local variable and adds it to the per-
+thread statistics (and optionally a histogram) when going out of scope
+
+This avoids accessing thread-local storage in inner loops, e.g. during
+kd-tree traversal.)doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_ScopedStatsCounter = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_ScopedStatsCounter_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_m_counter = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_m_histogram = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_m_value = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_operator_assign = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_operator_iadd = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedStatsCounter_operator_inc = R"doc()doc";
+
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment =
 R"doc(RAII-style class to temporarily switch to another thread's logger/file
 resolver)doc";
@@ -4925,10 +5468,12 @@ static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_file_resolver = R"
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_logger = R"doc()doc";
 
-static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_profiler_flags = R"doc()doc";
+static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_profiler_stack = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_operator_assign = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedTimelineEvent = R"doc(Records a Timeline event that spans the lifetime of this object)doc";
+
 static const char *__doc_mitsuba_Sensor = R"doc()doc";
 
 static const char *__doc_mitsuba_Sensor_2 = R"doc()doc";
@@ -5022,6 +5567,45 @@ static const char *__doc_mitsuba_Sensor_shutter_open_time = R"doc(Return the len
 
 static const char *__doc_mitsuba_Sensor_traverse = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_ServerSocket =
+R"doc(Listens for incoming TCP connections and creates a SocketStream for
+each of them)doc";
+
+static const char *__doc_mitsuba_ServerSocket_ServerSocket =
+R"doc(Listen for connections on the given port
+
+Parameter ``port``:
+    Port number. The value zero selects an unused port, which can be
+    queried using port().
+
+Parameter ``address``:
+    Local address to bind to. An empty string accepts connections on
+    all network interfaces.)doc";
+
+static const char *__doc_mitsuba_ServerSocket_accept =
+R"doc(Wait for an incoming connection
+
+Parameter ``timeout``:
+    Maximum time to wait (in seconds). A negative value waits
+    indefinitely.
+
+Returns:
+    The new connection, or ``nullptr`` when the timeout expired.)doc";
+
+static const char *__doc_mitsuba_ServerSocket_class = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_close = R"doc(Stop listening for connections (idempotent))doc";
+
+static const char *__doc_mitsuba_ServerSocket_is_closed = R"doc(Whether the server socket is closed)doc";
+
+static const char *__doc_mitsuba_ServerSocket_m_port = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_m_socket = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_port = R"doc(Return the port number on which the server listens for connections)doc";
+
+static const char *__doc_mitsuba_ServerSocket_to_string = R"doc(Returns a string representation)doc";
+
 static const char *__doc_mitsuba_Shape =
 R"doc(Base class of all geometric shapes in Mitsuba
 
@@ -5039,10 +5623,52 @@ static const char *__doc_mitsuba_ShapeKDTree_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_3 = R"doc()doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_LeafBlocks =
+R"doc(Location of the triangles and spheres of a leaf node in the lists of
+blocks)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_LeafBlocks_sphere_block_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_LeafBlocks_sphere_count = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_LeafBlocks_triangle_block_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_LeafBlocks_triangle_count = R"doc()doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_ShapeKDTree =
 R"doc(Create an empty kd-tree and take build-related parameters from
 ``props``.)doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_SphereBlock =
+R"doc(Centers and radii of up to SphereBlockSize spherical primitives (see
+Shape::primitive_sphere()) of a leaf node in SoA layout
+
+Unused lanes store NaN centers, which are never intersected.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_SphereBlock_center = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_SphereBlock_prim_index = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_SphereBlock_radius = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_SphereBlock_shape_index = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock =
+R"doc(Precomputed vertex data of up to TriangleBlockSize triangles of a
+leaf node in SoA layout
+
+Unused lanes store degenerate triangles, which are never intersected.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock_e1 = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock_e2 = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock_p0 = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock_prim_index = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_TriangleBlock_shape_index = R"doc()doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_add_shape = R"doc(Register a new shape with the kd-tree (to be called before build()))doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_bbox = R"doc(Return the bounding box of the i-th primitive)doc";
@@ -5051,6 +5677,11 @@ static const char *__doc_mitsuba_ShapeKDTree_bbox_2 = R"doc(Return the (clipped)
 
 static const char *__doc_mitsuba_ShapeKDTree_build = R"doc(Build the kd-tree)doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_build_leaf_blocks =
+R"doc(Move the mesh triangles and then the spherical primitives of each
+leaf node to the front of its index range and precompute their data in
+SIMD-friendly blocks)doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_class = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_create_surface_interaction =
@@ -5070,10 +5701,42 @@ R"doc(Check whether a primitive is intersected by the given ray.
 Some temporary space is supplied to store data that can later be used
 to create a detailed intersection record.)doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_intersect_sphere_block =
+R"doc(Intersect a ray against a block of spheres
+
+Only used by scalar variants. The quadratic is solved in single
+precision using the numerically robust formulation of Haines et al.
+("Precision Improvements for Ray/Sphere Intersection", Ray Tracing
+Gems, 2019), and the hit conventions of the ``sphere`` shape are
+followed (rays starting inside a sphere hit its far side). Returns the
+closest hit within the ray segment and fills the ``cache`` like
+intersect_prim().)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_intersect_triangle_block =
+R"doc(Intersect a ray against a block of triangles using a SIMD version of
+the Moeller-Trumbore test of Mesh::ray_intersect_triangle()
+
+Only used by scalar variants. Returns the closest hit within the ray
+segment and fills the ``cache`` like intersect_prim().)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_leaf_blocks = R"doc(Blocks of each leaf node, indexed by the leaf's primitive offset)doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_m_primitive_map = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_m_shapes = R"doc()doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_m_sphere_blocks = R"doc(Sphere blocks of all leaf nodes)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_sphere_blocks_enabled =
+R"doc(Precompute sphere blocks for the leaf intersection of scalar
+variants?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_triangle_blocks = R"doc(Triangle blocks of all leaf nodes)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_triangle_blocks_enabled =
+R"doc(Precompute triangle blocks for the leaf intersection of scalar
+variants?)doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_primitive_count = R"doc(Return the number of registered primitives)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_ray_intersect = R"doc()doc";
@@ -5238,6 +5901,19 @@ R"doc(Returns the number of sub-primitives that make up this shape
 Remark:
     The default implementation simply returns ``1``)doc";
 
+static const char *__doc_mitsuba_Shape_primitive_sphere =
+R"doc(Return the sphere described by a single shape primitive, if the
+primitive is a sphere
+
+The kd-tree of scalar variants uses this to intersect the spheres of
+its leaf nodes in SIMD-sized blocks. The ray must then hit the
+primitive exactly when it hits the returned sphere, and
+fill_surface_interaction() may not rely on the ``cache``.
+
+Remark:
+    The default implementation returns an empty sphere, i.e. the
+    primitive is intersected using ray_intersect_primitive())doc";
+
 static const char *__doc_mitsuba_Shape_ray_intersect =
 R"doc(Fast ray intersection test
 
@@ -5267,6 +5943,19 @@ single shape is desired.
 Parameter ``ray``:
     The ray to be tested for an intersection)doc";
 
+static const char *__doc_mitsuba_Shape_ray_intersect_primitive =
+R"doc(Fast ray intersection test against a single primitive
+
+Used by the kd-tree to intersect the primitives of shapes that consist
+of several of them (see primitive_count()). The ``cache`` is filled
+like in ray_intersect(). The index of the primitive will be available
+in SurfaceInteraction::prim_index when fill_surface_interaction() is
+called.
+
+Remark:
+    The default implementation ignores ``index`` and forwards the call
+    to ray_intersect())doc";
+
 static const char *__doc_mitsuba_Shape_ray_test =
 R"doc(Fast ray shadow test
 
@@ -5283,6 +5972,13 @@ possible.
 Parameter ``ray``:
     The ray to be tested for an intersection)doc";
 
+static const char *__doc_mitsuba_Shape_ray_test_primitive =
+R"doc(Fast ray shadow test against a single primitive
+
+Remark:
+    The default implementation ignores ``index`` and forwards the call
+    to ray_test())doc";
+
 static const char *__doc_mitsuba_Shape_sample_direction =
 R"doc(Sample a direction towards this shape with respect to solid angles
 measured at a reference position within the scene
@@ -5341,6 +6037,83 @@ The default implementation throws an exception.)doc";
 
 static const char *__doc_mitsuba_Shape_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_SocketStream =
+R"doc(Stream implementation for TCP network connections
+
+Read operations block until the requested amount of data has arrived
+and throw an exception when the connection is closed by the peer (or
+when the timeout specified via set_timeout() expires). Write
+operations send the data immediately (Nagle's algorithm is disabled),
+hence flush() is a no-op.
+
+The stream uses network byte order by default.)doc";
+
+static const char *__doc_mitsuba_SocketStream_SocketStream = R"doc(Connect to the given host name (or IP address) and port)doc";
+
+static const char *__doc_mitsuba_SocketStream_SocketStream_2 = R"doc(Wrap a connected socket handle (used by ServerSocket::accept()))doc";
+
+static const char *__doc_mitsuba_SocketStream_can_read = R"doc(Always returns true, except if the stream is closed.)doc";
+
+static const char *__doc_mitsuba_SocketStream_can_write = R"doc(Always returns true, except if the stream is closed.)doc";
+
+static const char *__doc_mitsuba_SocketStream_class = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_close =
+R"doc(Closes the stream and the underlying connection. No further read or
+write operations are permitted.
+
+This function is idempotent. It is called automatically by the
+destructor.)doc";
+
+static const char *__doc_mitsuba_SocketStream_flush = R"doc(No-op since all data is sent immediately)doc";
+
+static const char *__doc_mitsuba_SocketStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_SocketStream_m_peer = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_received = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_sent = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_socket = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_peer = R"doc(Return a description of the remote end of the connection ("host:port"))doc";
+
+static const char *__doc_mitsuba_SocketStream_poll =
+R"doc(Wait until data is available for reading (or the peer closed the
+connection)
+
+Parameter ``timeout``:
+    Maximum time to wait (in seconds). A negative value waits
+    indefinitely.
+
+Returns:
+    ``False`` when the timeout expired.)doc";
+
+static const char *__doc_mitsuba_SocketStream_read =
+R"doc(Reads a specified amount of data from the connection. Blocks until all
+data has been received.)doc";
+
+static const char *__doc_mitsuba_SocketStream_received_bytes = R"doc(Return the number of bytes received so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_seek = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_SocketStream_sent_bytes = R"doc(Return the number of bytes sent so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_set_timeout =
+R"doc(Set the maximum amount of time (in seconds) that a read operation may
+wait for data. A value of zero disables the timeout (default).)doc";
+
+static const char *__doc_mitsuba_SocketStream_size = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_SocketStream_tell = R"doc(Returns the total number of bytes that were sent and received)doc";
+
+static const char *__doc_mitsuba_SocketStream_to_string = R"doc(Returns a string representation)doc";
+
+static const char *__doc_mitsuba_SocketStream_truncate = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_SocketStream_write = R"doc(Sends a specified amount of data over the connection)doc";
+
 static const char *__doc_mitsuba_Spectrum =
 R"doc(//! @{ \name Data types for spectral quantities with sampled
 wavelengths)doc";
@@ -5419,6 +6192,75 @@ static const char *__doc_mitsuba_Spiral_set_passes =
 R"doc(Sets the number of time the spiral should automatically reset. Not
 affected by a call to reset.)doc";
 
+static const char *__doc_mitsuba_Statistics =
+R"doc(Render statistics (event counters and histograms)
+
+Performance-critical code paths (ray tracing, kd-tree traversal, path
+construction) update per-thread counters that are summed up by
+merge() at the end of a rendering. The subsystem is compiled out
+unless Mitsuba is built with <tt>MTS_ENABLE_STATISTICS</tt>, in which
+case enabled() returns ``True``.
+
+For packet variants, kd-tree statistics refer to the traversal of a
+whole packet rather than to individual rays.)doc";
+
+static const char *__doc_mitsuba_Statistics_Statistics = R"doc()doc";
+
+static const char *__doc_mitsuba_Statistics_counter = R"doc(Return the value of a counter as of the last call to merge())doc";
+
+static const char *__doc_mitsuba_Statistics_elapsed = R"doc(Return the time between reset() and merge() in seconds)doc";
+
+static const char *__doc_mitsuba_Statistics_enabled = R"doc(Were statistics enabled at compile time?)doc";
+
+static const char *__doc_mitsuba_Statistics_histogram = R"doc(Return the bins of a histogram as of the last call to merge())doc";
+
+static const char *__doc_mitsuba_Statistics_merge = R"doc(Sum up the counters of all threads and record the elapsed time)doc";
+
+static const char *__doc_mitsuba_Statistics_report = R"doc(Return a human-readable summary of the merged statistics)doc";
+
+static const char *__doc_mitsuba_Statistics_reset = R"doc(Reset all counters and histograms (of all threads) and restart the timer)doc";
+
+static const char *__doc_mitsuba_Statistics_to_json = R"doc(Return the merged statistics as a JSON string)doc";
+
+static const char *__doc_mitsuba_Statistics_write_json = R"doc(Write the merged statistics to a JSON file)doc";
+
+static const char *__doc_mitsuba_StatsCounter = R"doc(List of event counters that are maintained by the statistics subsystem)doc";
+
+static const char *__doc_mitsuba_StatsCounter_CameraRays = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_IntersectionRays = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_KDTreeInnerNodes = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_KDTreeLeafNodes = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_PrimitiveTests = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_RussianRoulette = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_ShadowRays = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_StatsCounterCount = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsHistogram = R"doc(List of histograms that are maintained by the statistics subsystem)doc";
+
+static const char *__doc_mitsuba_StatsHistogram_PathDepth = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsHistogram_PrimitiveTestsPerRay = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsHistogram_StatsHistogramCount = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsThreadData =
+R"doc(Per-thread storage of all counters and histograms
+
+Entries are only ever written by the owning thread. They use relaxed
+atomic loads and stores (which compile to plain memory accesses) so
+that other threads may safely read them when merging.)doc";
+
+static const char *__doc_mitsuba_StatsThreadData_counters = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsThreadData_histograms = R"doc()doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -6648,8 +7490,12 @@ additional state (Loggers, Path resolvers, etc.) that is inherited
 when a thread launches another thread.)doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment =
-R"doc(Captures a thread environment (logger, file resolver, profiler flags).
-Used with ScopedSetThreadEnvironment)doc";
+R"doc(Captures a thread environment (logger, file resolver, profiler stack).
+Used with ScopedSetThreadEnvironment
+
+The profiler stack includes the plugin instances of its frames, hence
+samples taken on worker threads remain attributed to the instance that
+launched the parallel work.)doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment_ThreadEnvironment = R"doc()doc";
 
@@ -6659,7 +7505,7 @@ static const char *__doc_mitsuba_ThreadEnvironment_m_file_resolver = R"doc()doc"
 
 static const char *__doc_mitsuba_ThreadEnvironment_m_logger = R"doc()doc";
 
-static const char *__doc_mitsuba_ThreadEnvironment_m_profiler_flags = R"doc()doc";
+static const char *__doc_mitsuba_ThreadEnvironment_m_profiler_stack = R"doc()doc";
 
 static const char *__doc_mitsuba_ThreadEnvironment_operator_assign = R"doc()doc";
 
@@ -6852,6 +7698,117 @@ static const char *__doc_mitsuba_Thread_unregister_external_thread = R"doc(Unreg
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TiledEXRWriter =
+R"doc(Incrementally writes a tiled OpenEXR file
+
+In contrast to Bitmap::write(), which encodes an image that is fully
+resident in memory, this class creates the file up front and accepts
+the image contents in the form of tile-aligned regions that can arrive
+in any order (e.g. as they are completed by a renderer). Compression
+of the tiles within a region is parallelized using OpenEXR's thread
+pool.
+
+All regions must have the pixel format and component format specified
+at construction time. The file is finalized when the writer is closed
+or destroyed, at which point every tile should have been written.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_TiledEXRWriter =
+R"doc(Create a new tiled OpenEXR file
+
+Parameter ``path``:
+    Path of the output file
+
+Parameter ``size``:
+    Horizontal and vertical size of the image in pixels
+
+Parameter ``tile_size``:
+    Horizontal and vertical size of a tile in pixels
+
+Parameter ``prototype``:
+    Bitmap (e.g. the first tile) that specifies the pixel format,
+    component format, channel names and metadata of the file
+
+Parameter ``quality``:
+    Same meaning as for OpenEXR files in Bitmap::write())doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_close = R"doc(Finalize the file. Further calls to write() are not permitted.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_size = R"doc(Return the image size in pixels)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tile_count = R"doc(Return the total number of tiles)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tile_size = R"doc(Return the tile size in pixels)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tiles_written = R"doc(Return the number of tiles that have been written so far)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_to_string = R"doc(Return a string representation)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_write =
+R"doc(Write a region of the image
+
+``offset`` must be a multiple of the tile size, and the region must
+either consist of whole tiles or extend to the image boundary. This
+function may be called concurrently from multiple threads.)doc";
+
+static const char *__doc_mitsuba_Timeline =
+R"doc(Structured timeline of the phases of a rendering job
+
+When enabled, plugin loading, object instantiation (which includes
+asset loading), acceleration data structure construction, rendering
+passes, film development and image output are recorded along with the
+resident memory of the process at their beginning and end. The result
+can be exported as JSON, e.g. to group jobs by memory footprint or to
+detect slow asset loads.
+
+Memory usage is tracked at the process level: the growth in resident
+memory during a phase serves as its allocation total, which also
+includes allocations by concurrently running phases.)doc";
+
+static const char *__doc_mitsuba_TimelineEvent = R"doc(A single phase of a rendering job recorded by the Timeline)doc";
+
+static const char *__doc_mitsuba_TimelineEvent_category = R"doc(Kind of phase (e.g. "plugin", "load", "accel", "render", "pass", "develop", "write"))doc";
+
+static const char *__doc_mitsuba_TimelineEvent_duration = R"doc(Duration in seconds)doc";
+
+static const char *__doc_mitsuba_TimelineEvent_name = R"doc(Descriptive name (e.g. plugin name or file name))doc";
+
+static const char *__doc_mitsuba_TimelineEvent_peak_rss = R"doc(Peak resident set size of the process at the end of the phase (bytes))doc";
+
+static const char *__doc_mitsuba_TimelineEvent_rss_end = R"doc(Resident set size of the process at the end of the phase (bytes))doc";
+
+static const char *__doc_mitsuba_TimelineEvent_rss_start = R"doc(Resident set size of the process at the beginning of the phase (bytes))doc";
+
+static const char *__doc_mitsuba_TimelineEvent_start = R"doc(Start time in seconds since the last call to Timeline::reset())doc";
+
+static const char *__doc_mitsuba_TimelineEvent_thread = R"doc(Name of the thread that recorded the event)doc";
+
+static const char *__doc_mitsuba_Timeline_Timeline = R"doc()doc";
+
+static const char *__doc_mitsuba_Timeline_add =
+R"doc(Record an event
+
+Parameter ``start``:
+    Start time of the phase as returned by time()
+
+Parameter ``rss_start``:
+    Resident set size at the beginning of the phase)doc";
+
+static const char *__doc_mitsuba_Timeline_enabled = R"doc(Is the recording of events enabled?)doc";
+
+static const char *__doc_mitsuba_Timeline_events = R"doc(Return a copy of all events recorded since the last call to reset())doc";
+
+static const char *__doc_mitsuba_Timeline_reset = R"doc(Remove all events and restart the clock)doc";
+
+static const char *__doc_mitsuba_Timeline_set_enabled = R"doc(Enable or disable the recording of events (disabled by default))doc";
+
+static const char *__doc_mitsuba_Timeline_time = R"doc(Return the time in seconds since the last call to reset())doc";
+
+static const char *__doc_mitsuba_Timeline_to_json = R"doc(Return the events and a per-category summary as a JSON string)doc";
+
+static const char *__doc_mitsuba_Timeline_write_json = R"doc(Write the output of to_json() to a file)doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -7043,6 +8000,26 @@ static const char *__doc_mitsuba_Vector_operator_assign_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Volume = R"doc(Abstract base class for spatially-varying 3D textures.)doc";
 
+static const char *__doc_mitsuba_VolumeData =
+R"doc(Decoded contents of a Mitsuba binary volume file
+
+Instances are immutable and shared between all volumes that reference
+the same file through the AssetCache.)doc";
+
+static const char *__doc_mitsuba_VolumeData_VolumeData = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeData_class = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeData_data = R"doc(Return a pointer to the (interleaved) grid values)doc";
+
+static const char *__doc_mitsuba_VolumeData_m_data = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeData_m_metadata = R"doc()doc";
+
+static const char *__doc_mitsuba_VolumeData_metadata = R"doc(Return the metadata stored in the file header)doc";
+
+static const char *__doc_mitsuba_VolumeData_size = R"doc(Return the total number of stored values)doc";
+
 static const char *__doc_mitsuba_Volume_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Volume_3 = R"doc()doc";
@@ -7399,6 +8376,11 @@ static const char *__doc_mitsuba_filesystem_is_regular_file =
 R"doc(Checks if ``p`` points to a regular file, as opposed to a directory or
 symlink.)doc";
 
+static const char *__doc_mitsuba_filesystem_last_write_time =
+R"doc(Returns the time of the last modification of the file at ``p`` in
+nanoseconds since the epoch. Precision is limited to seconds on
+Windows. Failure to stat the file is treated as an error.)doc";
+
 static const char *__doc_mitsuba_filesystem_path =
 R"doc(Represents a path to a filesystem resource. On construction, the path
 is parsed and stored in a system-agnostic representation. The path can
@@ -8308,7 +9290,14 @@ static const char *__doc_mitsuba_pdf_uniform_spectrum = R"doc()doc";
 
 static const char *__doc_mitsuba_pdf_uniform_spectrum_2 = R"doc()doc";
 
-static const char *__doc_mitsuba_profiler_flags = R"doc()doc";
+static const char *__doc_mitsuba_profiler_assign_stack =
+R"doc(Overwrite the contents of a profiler stack (e.g. to propagate it to a
+worker thread)
+
+The depth is cleared while the frames are copied, so that the signal
+handler never observes a partially copied stack.)doc";
+
+static const char *__doc_mitsuba_profiler_stack = R"doc()doc";
 
 static const char *__doc_mitsuba_quad_composite_simpson =
 R"doc(Computes the nodes and weights of a composite Simpson quadrature rule
@@ -9068,6 +10057,18 @@ static const char *__doc_mitsuba_srgb_to_xyz = R"doc(Convert ITU-R Rec. BT.709 l
 
 static const char *__doc_mitsuba_srgb_to_xyz_2 = R"doc(Convert ITU-R Rec. BT.709 linear RGB to XYZ tristimulus values)doc";
 
+static const char *__doc_mitsuba_stats_add = R"doc(Add ``amount`` to a counter of the current thread)doc";
+
+static const char *__doc_mitsuba_stats_count = R"doc(Count the active lanes of a mask. Does nothing for GPU arrays.)doc";
+
+static const char *__doc_mitsuba_stats_record = R"doc(Record a value in a histogram of the current thread)doc";
+
+static const char *__doc_mitsuba_stats_record_2 =
+R"doc(Record the active lanes of a value in a histogram. Does nothing for GPU
+arrays.)doc";
+
+static const char *__doc_mitsuba_stats_thread_data = R"doc()doc";
+
 static const char *__doc_mitsuba_string_ends_with = R"doc(Check if the given string ends with a specified suffix)doc";
 
 static const char *__doc_mitsuba_string_indent = R"doc(Indent every line of a string by some number of spaces)doc";
@@ -9118,6 +10119,8 @@ identity function.)doc";
 
 static const char *__doc_mitsuba_util_core_count = R"doc(Determine the number of available CPU cores (including virtual cores))doc";
 
+static const char *__doc_mitsuba_util_current_rss = R"doc(Return the resident set size (physical memory usage) of the process in bytes)doc";
+
 static const char *__doc_mitsuba_util_detect_debugger = R"doc(Returns 'true' if the application is running inside a debugger)doc";
 
 static const char *__doc_mitsuba_util_info_build = R"doc(Return human-readable information about the Mitsuba build)doc";
@@ -9130,6 +10133,8 @@ static const char *__doc_mitsuba_util_library_path = R"doc(Return the absolute p
 
 static const char *__doc_mitsuba_util_mem_string = R"doc(Turn a memory size into a human-readable string)doc";
 
+static const char *__doc_mitsuba_util_peak_rss = R"doc(Return the peak resident set size of the process in bytes)doc";
+
 static const char *__doc_mitsuba_util_terminal_width = R"doc(Determine the width of the terminal window that is used to run Mitsuba)doc";
 
 static const char *__doc_mitsuba_util_time_string =
@@ -9339,9 +10344,25 @@ Parameter ``variant``:
 
 Parameter ``update_scene``:
     When Mitsuba updates scene to a newer version, should the updated
-    XML file be written back to disk?)doc";
-
-static const char *__doc_mitsuba_xml_load_string = R"doc(Load a Mitsuba scene from an XML string)doc";
+    XML file be written back to disk?
+
+Parameter ``deferred``:
+    Build the dependency graph of the scene before instantiating
+    anything. Objects with an ID that are neither referenced by other
+    objects nor directly used by the scene (e.g. unused entries of a
+    material library) are skipped, and the remaining objects are
+    instantiated in parallel waves following the dependency order.
+
+Parameter ``write_compiled``:
+    When specified, a compiled version of the scene is written to this
+    path once all objects were instantiated successfully. It stores the
+    object graph with fully resolved properties, transformations and
+    file references, and can be passed to this function instead of the
+    XML file to skip XML parsing altogether. Compiled scenes are
+    specific to the variant and to the parameter values used to create
+    them.)doc";
+
+static const char *__doc_mitsuba_xml_load_string = R"doc(Load a Mitsuba scene from an XML string (see load_file()))doc";
 
 static const char *__doc_mitsuba_xyz_to_srgb = R"doc(Convert XYZ tristimulus values to ITU-R Rec. BT.709 linear RGB)doc";
 
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/spiral.h>
+#include <tbb/spin_mutex.h>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Cost-aware generator of image blocks to be rendered
+ *
+ * In contrast to \ref Spiral, which hands out the blocks of each pass in a
+ * fixed order, this class orders the blocks of a pass by their estimated
+ * rendering cost so that the most expensive ones are processed first. Blocks
+ * whose cost is a large fraction of the work per worker are furthermore split
+ * into four sub-blocks, which lets idle workers pick up the remaining work of
+ * an expensive region instead of waiting for a single straggler at the end of
+ * the pass.
+ *
+ * Cost estimates are provided via \ref set_cost() (e.g. from a low sample
+ * count prepass) and are refined using the measured rendering times reported
+ * to \ref record_cost(), which affect the order of subsequent passes. Without
+ * any estimates, blocks are generated in spiral order.
+ *
+ * The block identifiers only depend on the pass, block and sub-block, hence
+ * they can be used to deterministically seed a sampler. Note however that the
+ * decision to split a block depends on the measured timings.
+ *
+ * \ingroup librender
+ */
+class MTS_EXPORT_RENDER BlockScheduler : public Object {
+public:
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a new block scheduler for the given size, offset into a
+     * larger frame, and block size
+     *
+     * \param worker_count
+     *     Number of workers processing the blocks, used to decide which blocks
+     *     should be split
+     */
+    BlockScheduler(Vector2i size, Vector2i offset, size_t block_size,
+                   size_t passes = 1, size_t worker_count = 1);
+
+    /// Return the maximum block size
+    size_t max_block_size() const { return m_block_size; }
+
+    /// Return the number of blocks per pass (not counting sub-blocks)
+    size_t block_count() const { return m_block_count; }
+
+    /// Return an upper bound for the identifiers returned by \ref next_block()
+    size_t id_count() const { return m_block_count * m_passes * 5; }
+
+    /// Return the offset and size of the block with the given index
+    std::pair<Vector2i, Vector2i> block(size_t index) const;
+
+    /// Set the estimated cost (e.g. in seconds) of the block with the given index
+    void set_cost(size_t index, float cost);
+
+    /// Return the estimated cost of the given block (negative if unknown)
+    float cost(size_t index) const;
+
+    /**
+     * \brief Report the time that was needed to render the block with the
+     * given identifier (as returned by \ref next_block())
+     *
+     * Updates the cost estimate of the corresponding block, taking into
+     * account that sub-blocks only cover a fraction of it.
+     */
+    void record_cost(size_t block_id, float cost);
+
+    /// Restart with the first pass. Does not affect the cost estimates.
+    void reset();
+
+    /**
+     * \brief Return the offset, size and unique identifer of the next block.
+     *
+     * A size of zero indicates that all passes are done.
+     */
+    std::tuple<Vector2i, Vector2i, size_t> next_block();
+
+    MTS_DECLARE_CLASS()
+protected:
+    struct Item {
+        Vector2i offset, size;
+        size_t id;
+        float cost;
+    };
+
+    /// Generate the work items of the given pass (expects the mutex to be held)
+    void build_pass(size_t pass);
+
+protected:
+    size_t m_block_count,   //< Number of blocks per pass
+           m_block_size,    //< Size of the (square) blocks (in pixels)
+           m_passes,        //< Total number of passes
+           m_worker_count;  //< Number of workers processing the blocks
+
+    Vector2i m_size,        //< Size of the 2D image (in pixels).
+             m_offset,      //< Offset to the crop region on the sensor (pixels).
+             m_blocks;      //< Number of blocks in each direction.
+
+    /// Block indices in spiral order (used as tie breaker)
+    std::vector<uint32_t> m_order;
+
+    /// Estimated cost per block (negative if unknown)
+    std::vector<float> m_cost;
+
+    /// Work items of the current pass, sorted by decreasing cost
+    std::vector<Item> m_items;
+    size_t m_next_item, m_pass_count;
+
+    /// Protects the scheduler's state (thread safety).
+    mutable tbb::spin_mutex m_mutex;
+};
+
+NAMESPACE_END(mitsuba)
@@ -393,6 +393,35 @@ public:
                       const Vector3f &wo,
                       Mask active = true) const = 0;
 
+    /**
+     * \brief Jointly evaluate the BSDF f(wi, wo) and the probability per unit
+     * solid angle of sampling the outgoing direction \c wo
+     *
+     * This method is equivalent to calling \ref eval() and \ref pdf() with
+     * the same arguments, but lets implementations share work between the two
+     * queries (e.g. texture lookups, Fresnel and microfacet terms). The default
+     * implementation simply invokes both methods.
+     *
+     * \param ctx
+     *     A context data structure describing which lobes to evalute,
+     *     and whether radiance or importance are being transported.
+     *
+     * \param si
+     *     A surface interaction data structure describing the underlying
+     *     surface position. The incident direction is obtained from
+     *     the field <tt>si.wi</tt>.
+     *
+     * \param wo
+     *     The outgoing direction
+     *
+     * \return A pair (value, pdf) containing the results of \ref eval() and
+     *     \ref pdf().
+     */
+    virtual std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                                const SurfaceInteraction3f &si,
+                                                const Vector3f &wo,
+                                                Mask active = true) const;
+
     /**
      * \brief Evaluate un-scattered transmission component of the BSDF
      *
@@ -521,6 +550,7 @@ ENOKI_STRUCT_SUPPORT(mitsuba::BSDFSample3, wo, pdf, eta,
 ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::BSDF)
     ENOKI_CALL_SUPPORT_METHOD(sample)
     ENOKI_CALL_SUPPORT_METHOD(eval)
+    ENOKI_CALL_SUPPORT_METHOD(eval_pdf)
     ENOKI_CALL_SUPPORT_METHOD(eval_null_transmission)
     ENOKI_CALL_SUPPORT_METHOD(pdf)
     ENOKI_CALL_SUPPORT_GETTER(flags, m_flags)
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/object.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Feature-guided denoiser for Monte Carlo renderings
+ *
+ * Implements an edge-avoiding à-trous wavelet filter in the spirit of
+ * spatiotemporal variance-guided filtering (SVGF, spatial part only). The
+ * noisy image is demodulated by the surface albedo (so that texture detail
+ * is not blurred) and then filtered by a sequence of sparse 5x5 kernels with
+ * increasing footprint. The contribution of each neighbor is attenuated
+ * based on
+ *
+ * - the difference in luminance, relative to the estimated standard
+ *   deviation of the noise,
+ * - the angle between the shading normals,
+ * - the difference in albedo.
+ *
+ * The per-pixel variance is filtered along with the image. When it is not
+ * available, it is estimated from the local neighborhood of each pixel.
+ *
+ * All bitmaps are expected to store \c float32 values. Rows of the image are
+ * processed in parallel.
+ *
+ * \ingroup librender
+ */
+class MTS_EXPORT_RENDER Denoiser : public Object {
+public:
+    /**
+     * \brief Create a denoiser
+     *
+     * \param iterations
+     *     Number of à-trous iterations. The footprint of the filter is
+     *     <tt>4 * 2^iterations - 3</tt> pixels wide.
+     *
+     * \param sigma_color
+     *     Scale of the luminance edge-stopping function, in standard
+     *     deviations of the noise. Larger values filter more aggressively.
+     *
+     * \param sigma_normal
+     *     Exponent of the normal edge-stopping function. Larger values
+     *     preserve geometric edges more strongly.
+     *
+     * \param sigma_albedo
+     *     Scale of the albedo edge-stopping function.
+     */
+    Denoiser(size_t iterations = 5, float sigma_color = 4.f,
+             float sigma_normal = 128.f, float sigma_albedo = .1f);
+
+    /**
+     * \brief Denoise an image
+     *
+     * \param color
+     *     Linear RGB image (the first three channels are used)
+     *
+     * \param albedo
+     *     Optional RGB albedo of the visible surfaces
+     *
+     * \param normal
+     *     Optional shading normals of the visible surfaces (need not be
+     *     normalized). Pixels without a surface should store zero.
+     *
+     * \param variance
+     *     Optional single-channel variance of the luminance of each pixel
+     *     (i.e. of the pixel estimate, not of the individual samples)
+     *
+     * \return A denoised RGB image of the same size
+     */
+    ref<Bitmap> denoise(const Bitmap *color,
+                        const Bitmap *albedo = nullptr,
+                        const Bitmap *normal = nullptr,
+                        const Bitmap *variance = nullptr) const;
+
+    /// Return the number of à-trous iterations
+    size_t iterations() const { return m_iterations; }
+
+    /// Returns a string representation
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~Denoiser() { }
+
+protected:
+    size_t m_iterations;
+    float m_sigma_color;
+    float m_sigma_normal;
+    float m_sigma_albedo;
+};
+
+NAMESPACE_END(mitsuba)
@@ -25,9 +25,26 @@ public:
     /// Configure the film for rendering a specified set of channels
     virtual void prepare(const std::vector<std::string> &channels) = 0;
 
+    /**
+     * \brief Specify how many times each pixel will be submitted via \ref put()
+     *
+     * Integrators that render the image in several passes call this after
+     * \ref prepare(). Films that write out finished regions while rendering
+     * use it to detect when a region will not receive further samples.
+     */
+    virtual void set_pass_count(size_t /* count */) { }
+
     /// Merge an image block into the film
     virtual void put(const ImageBlock *block) = 0;
 
+    /**
+     * \brief Does the film write finished regions to disk while rendering?
+     *
+     * Such films finalize their output file in \ref develop(), which hence
+     * must only be called once rendering has finished.
+     */
+    virtual bool streams_output() const { return false; }
+
     /// Develop the film and write the result to the previously specified filename
     virtual void develop() = 0;
 
@@ -7,6 +7,7 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+class BlockScheduler;
 class DifferentiableParameters;
 struct BSDFContext;
 template <typename Float, typename Spectrum> class BSDF;
@@ -70,7 +70,7 @@ template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER SamplingIntegrator : public Integrator<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(Integrator)
-    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler)
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler, BSDFPtr)
 
     /**
      * \brief Sample the incident radiance along a ray.
@@ -148,11 +148,26 @@ public:
     //! @}
     // =========================================================================
 
-    MTS_DECLARE_CLASS()
-protected:
-    SamplingIntegrator(const Properties &props);
-    virtual ~SamplingIntegrator();
+    // =========================================================================
+    //! @{ \name Block-based rendering
+    // =========================================================================
 
+    /**
+     * \brief Render a single image block
+     *
+     * The block's offset and size determine the rendered pixels. The sampler
+     * should be seeded with a unique identifier of the block beforehand so
+     * that the result is deterministic. This is the unit of work of \ref
+     * render(), and it is also used to render blocks on behalf of another
+     * process in distributed rendering.
+     *
+     * \param aovs
+     *    Scratch space for at least <tt>aov_names().size() + 5</tt> entries
+     *
+     * \param sample_count
+     *    Number of samples per pixel, or <tt>size_t(-1)</tt> to use the
+     *    sample count of the sampler
+     */
     virtual void render_block(const Scene *scene,
                               const Sensor *sensor,
                               Sampler *sampler,
@@ -160,6 +175,26 @@ protected:
                               Float *aovs,
                               size_t sample_count = size_t(-1)) const;
 
+    /// Return the size of the (square) image blocks rendered by \ref render()
+    uint32_t block_size() const { return m_block_size; }
+
+    /**
+     * \brief Return the number of samples per pixel that \ref render()
+     * computes in each pass over the image blocks
+     *
+     * Throws when the total sample count is not a multiple of the
+     * \c samples_per_pass parameter.
+     */
+    size_t samples_per_pass(size_t total_sample_count) const;
+
+    //! @}
+    // =========================================================================
+
+    MTS_DECLARE_CLASS()
+protected:
+    SamplingIntegrator(const Properties &props);
+    virtual ~SamplingIntegrator();
+
     void render_sample(const Scene *scene,
                        const Sensor *sensor,
                        Sampler *sampler,
@@ -169,6 +204,66 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /**
+     * \brief Estimate the rendering cost of the blocks of the given
+     * schedulers using a sparse prepass
+     *
+     * A small stratified subset of the pixels of each block is rendered with
+     * a single sample, and the time taken is extrapolated to the full block
+     * at \c sample_count samples per pixel. The prepass results are discarded.
+     */
+    void estimate_block_costs(const Scene *scene,
+                              Sensor *sensor,
+                              const std::vector<ref<BlockScheduler>> &schedulers,
+                              size_t channel_count,
+                              bool has_aovs,
+                              size_t sample_count) const;
+
+    /**
+     * \brief Called by \ref render() in progressive mode after each pass
+     * that completed before the timeout
+     *
+     * No rendering threads are active at this point, hence integrators that
+     * learn from the samples of the previous passes (e.g. to guide the
+     * sampling of paths) can safely update their data structures here. The
+     * default implementation does nothing.
+     *
+     * \param pass
+     *    Index of the completed pass (starting at zero)
+     *
+     * \param pass_sample_count
+     *    Number of samples per pixel of the completed pass
+     */
+    virtual void pass_finished(const Scene *scene, size_t pass,
+                               size_t pass_sample_count);
+
+    /**
+     * \brief Sample a direction towards an emitter for next event estimation
+     * using resampled importance sampling (RIS)
+     *
+     * Draws \c candidate_count directions using \ref
+     * Scene::sample_emitter_direction() without testing their visibility,
+     * selects one of them with a weighted reservoir proportionally to its
+     * unshadowed contribution <tt>BSDF * Le / pdf</tt>, and only traces a
+     * shadow ray towards the selected direction. This reduces the noise per
+     * shadow ray considerably in scenes with many emitters.
+     *
+     * The return value has the same meaning as that of \ref
+     * Scene::sample_emitter_direction(): the product of the emitter weight and
+     * the BSDF value in direction \c ds.d is an unbiased estimate of the
+     * direct illumination. \c ds.pdf is the density of the candidates, which
+     * should be used for multiple importance sampling. A single candidate
+     * falls back to Scene::sample_emitter_direction().
+     */
+    std::pair<DirectionSample3f, Spectrum>
+    sample_emitter_direction_ris(const Scene *scene,
+                                 const SurfaceInteraction3f &si,
+                                 const BSDFPtr &bsdf,
+                                 const BSDFContext &ctx,
+                                 Sampler *sampler,
+                                 size_t candidate_count,
+                                 Mask active = true) const;
+
 protected:
     /// Integrators should stop all work when this flag is set to true.
     bool m_stop;
@@ -181,6 +276,7 @@ protected:
      *
      * Must be a multiple of the total sample count per pixel.
      * If set to (size_t) -1, all the work is done in a single pass (default).
+     * In progressive mode, this is the sample count of the first pass.
      */
     uint32_t m_samples_per_pass;
 
@@ -196,6 +292,35 @@ protected:
 
     /// Flag for disabling direct visibility of emitters
     bool m_hide_emitters;
+
+    /**
+     * \brief Order blocks by their estimated cost instead of using a spiral
+     *
+     * When set, a sparse prepass estimates the cost of each block, and the
+     * blocks are handed out by a \ref BlockScheduler, which processes
+     * expensive blocks first and splits them into sub-blocks.
+     */
+    bool m_cost_schedule;
+
+    /**
+     * \brief Render the image progressively
+     *
+     * Each pass covers the whole image, and the sample count of the passes
+     * doubles, starting at \ref m_samples_per_pass (or one sample). Passes
+     * that would not finish before the timeout are shortened or skipped, and
+     * an interrupted pass is discarded, so that the image is uniformly
+     * converged at any point in time. Requires an additional buffer of the
+     * size of the film.
+     */
+    bool m_progressive;
+
+    /**
+     * \brief Develop the film after each progressive pass
+     *
+     * This writes a preview of the image to the destination file. Ignored
+     * (with a warning) when the film streams its output while rendering.
+     */
+    bool m_preview;
 };
 
 /*
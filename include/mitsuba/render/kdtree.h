@@ -7,6 +7,7 @@
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/ray.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
@@ -2041,6 +2042,58 @@ public:
     /// Build the kd-tree
     void build();
 
+    /**
+     * \brief Number of triangles that are intersected at once by the leaf
+     * intersection routine of scalar variants (the SIMD width)
+     */
+    static constexpr size_t TriangleBlockSize = Packet<float>::Size;
+
+    using TriangleFloat  = Packet<ScalarFloat, TriangleBlockSize>;
+    using TriangleVector = Vector<TriangleFloat, 3>;
+
+    /**
+     * \brief Precomputed vertex data of up to \ref TriangleBlockSize
+     * triangles of a leaf node in SoA layout
+     *
+     * Unused lanes store degenerate triangles, which are never intersected.
+     */
+    struct TriangleBlock {
+        TriangleVector p0, e1, e2;
+        Index shape_index[TriangleBlockSize];
+        Index prim_index[TriangleBlockSize];
+    };
+
+    /**
+     * \brief Number of spheres that are intersected at once by the leaf
+     * intersection routine of scalar variants (the SIMD width)
+     */
+    static constexpr size_t SphereBlockSize = Packet<float>::Size;
+
+    using SphereFloat  = Packet<ScalarFloat, SphereBlockSize>;
+    using SphereVector = Vector<SphereFloat, 3>;
+
+    /**
+     * \brief Centers and radii of up to \ref SphereBlockSize spherical
+     * primitives (see \ref Shape::primitive_sphere()) of a leaf node in SoA
+     * layout
+     *
+     * Unused lanes store NaN centers, which are never intersected.
+     */
+    struct SphereBlock {
+        SphereVector center;
+        SphereFloat radius;
+        Index shape_index[SphereBlockSize];
+        Index prim_index[SphereBlockSize];
+    };
+
+    /// Location of the triangles and spheres of a leaf node in the lists of blocks
+    struct LeafBlocks {
+        Index triangle_block_offset;
+        Index triangle_count;
+        Index sphere_block_offset;
+        Index sphere_count;
+    };
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2091,6 +2144,11 @@ public:
         KDStackEntry stack[MTS_KD_MAXDEPTH];
         int32_t stack_index = 0;
 
+        MTS_STATS(ScopedStatsCounter stats_inner(StatsCounter::KDTreeInnerNodes),
+                                     stats_leaves(StatsCounter::KDTreeLeafNodes),
+                                     stats_prims(StatsCounter::PrimitiveTests,
+                                                 StatsHistogram::PrimitiveTestsPerRay));
+
         // True if an intersection has been found
         bool hit = false;
 
@@ -2103,6 +2161,7 @@ public:
         const KDNode *node = m_nodes.get();
         while (mint <= maxt) {
             if (likely(!node->leaf())) { // Inner node
+                MTS_STATS(++stats_inner);
                 const Float split   = node->split();
                 const uint32_t axis = node->axis();
 
@@ -2139,10 +2198,58 @@ public:
                 maxt = t_plane;
                 continue;
             } else if (node->primitive_count() > 0) { // Arrived at a leaf node
+                MTS_STATS(++stats_leaves);
                 Index prim_start = node->primitive_offset();
                 Index prim_end = prim_start + node->primitive_count();
+
+                /* Mesh triangles and spheres come first in each leaf and are
+                   intersected in blocks using the precomputed data */
+                if (!m_leaf_blocks.empty()) {
+                    const LeafBlocks &leaf = m_leaf_blocks[prim_start];
+                    Index block_end = leaf.triangle_block_offset +
+                        (leaf.triangle_count + Index(TriangleBlockSize) - 1) /
+                            Index(TriangleBlockSize);
+                    MTS_STATS(stats_prims += leaf.triangle_count + leaf.sphere_count);
+
+                    for (Index b = leaf.triangle_block_offset; b < block_end; ++b) {
+                        bool prim_hit;
+                        Float prim_t;
+                        std::tie(prim_hit, prim_t) =
+                            intersect_triangle_block<ShadowRay>(m_triangle_blocks[b], ray, cache);
+
+                        if (unlikely(prim_hit)) {
+                            if (ShadowRay)
+                                return { true, prim_t };
+
+                            ray.maxt = prim_t;
+                            hit = true;
+                        }
+                    }
+
+                    block_end = leaf.sphere_block_offset +
+                        (leaf.sphere_count + Index(SphereBlockSize) - 1) /
+                            Index(SphereBlockSize);
+
+                    for (Index b = leaf.sphere_block_offset; b < block_end; ++b) {
+                        bool prim_hit;
+                        Float prim_t;
+                        std::tie(prim_hit, prim_t) =
+                            intersect_sphere_block<ShadowRay>(m_sphere_blocks[b], ray, cache);
+
+                        if (unlikely(prim_hit)) {
+                            if (ShadowRay)
+                                return { true, prim_t };
+
+                            ray.maxt = prim_t;
+                            hit = true;
+                        }
+                    }
+                    prim_start += leaf.triangle_count + leaf.sphere_count;
+                }
+
                 for (Index i = prim_start; i < prim_end; i++) {
                     Index prim_index = m_indices[i];
+                    MTS_STATS(++stats_prims);
 
                     bool prim_hit;
                     Float prim_t;
@@ -2191,6 +2298,11 @@ public:
         KDStackEntry stack[MTS_KD_MAXDEPTH];
         int32_t stack_index = 0;
 
+        MTS_STATS(ScopedStatsCounter stats_inner(StatsCounter::KDTreeInnerNodes),
+                                     stats_leaves(StatsCounter::KDTreeLeafNodes),
+                                     stats_prims(StatsCounter::PrimitiveTests,
+                                                 StatsHistogram::PrimitiveTestsPerRay));
+
         // True if an intersection has been found
         Mask hit = false;
 
@@ -2208,6 +2320,7 @@ public:
 
             if (likely(any(active))) {
                 if (likely(!node->leaf())) { // Inner node
+                    MTS_STATS(++stats_inner);
                     const scalar_t<Float> split = node->split();
                     const uint32_t axis = node->axis();
 
@@ -2265,10 +2378,12 @@ public:
                     node = n_cur;
                     continue;
                 } else if (node->primitive_count() > 0) { // Arrived at a leaf node
+                    MTS_STATS(++stats_leaves);
                     Index prim_start = node->primitive_offset();
                     Index prim_end = prim_start + node->primitive_count();
                     for (Index i = prim_start; i < prim_end; i++) {
                         Index prim_index = m_indices[i];
+                        MTS_STATS(++stats_prims);
 
                         Mask prim_hit;
                         Float prim_t;
@@ -2425,9 +2540,9 @@ protected:
             std::tie(hit, u, v, t) = ((const Mesh *) shape)
                     ->ray_intersect_triangle(prim_index, ray, active);
         else if (ShadowRay)
-            hit = shape->ray_test(ray, active);
+            hit = shape->ray_test_primitive(prim_index, ray, active);
         else
-            std::tie(hit, t) = shape->ray_intersect(ray, cache + 2, active);
+            std::tie(hit, t) = shape->ray_intersect_primitive(prim_index, ray, cache + 2, active);
 
         if (!ShadowRay && any(hit)) {
             Float shape_index_v = reinterpret_array<Float>(UInt(shape_index));
@@ -2455,9 +2570,153 @@ protected:
         return { hit, t };
     }
 
+    /**
+     * \brief Intersect a ray against a block of triangles using a SIMD
+     * version of the Moeller-Trumbore test of \ref Mesh::ray_intersect_triangle()
+     *
+     * Only used by scalar variants. Returns the closest hit within the ray
+     * segment and fills the \c cache like \ref intersect_prim().
+     */
+    template <bool ShadowRay = false>
+    MTS_INLINE std::pair<bool, Float>
+    intersect_triangle_block(const TriangleBlock &block, const Ray3f &ray,
+                             Float *cache) const {
+        if constexpr (!is_array_v<Float>) {
+            using UInt = uint_array_t<Float>;
+            TriangleVector d(ray.d), o(ray.o);
+
+            TriangleVector pvec = cross(d, block.e2);
+            TriangleFloat inv_det = 1.f / dot(block.e1, pvec);
+
+            TriangleVector tvec = o - block.p0;
+            TriangleFloat u = dot(tvec, pvec) * inv_det;
+            auto active = u >= 0.f && u <= 1.f;
+
+            TriangleVector qvec = cross(tvec, block.e1);
+            TriangleFloat v = dot(d, qvec) * inv_det;
+            active &= v >= 0.f && u + v <= 1.f;
+
+            TriangleFloat t = dot(block.e2, qvec) * inv_det;
+            active &= t >= ray.mint && t <= ray.maxt;
+
+            if (likely(none(active)))
+                return { false, 0.f };
+
+            t = select(active, t, math::Infinity<ScalarFloat>);
+            ScalarFloat t_min = hmin(t);
+
+            if (!ShadowRay) {
+                Assert(cache != nullptr);
+                for (size_t k = 0; k < TriangleBlockSize; ++k) {
+                    if (t.coeff(k) == t_min) {
+                        cache[0] = reinterpret_array<Float>(UInt(block.shape_index[k]));
+                        cache[1] = reinterpret_array<Float>(UInt(block.prim_index[k]));
+                        cache[2] = u.coeff(k);
+                        cache[3] = v.coeff(k);
+                        break;
+                    }
+                }
+            }
+
+            return { true, t_min };
+        } else {
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(ray);
+            ENOKI_MARK_USED(cache);
+            Throw("intersect_triangle_block(): only supported in scalar variants!");
+        }
+    }
+
+    /**
+     * \brief Intersect a ray against a block of spheres
+     *
+     * Only used by scalar variants. The quadratic is solved in single
+     * precision using the numerically robust formulation of Haines et al.
+     * ("Precision Improvements for Ray/Sphere Intersection", Ray Tracing Gems,
+     * 2019), and the hit conventions of the \c sphere shape are followed
+     * (rays starting inside a sphere hit its far side). Returns the closest
+     * hit within the ray segment and fills the \c cache like \ref
+     * intersect_prim().
+     */
+    template <bool ShadowRay = false>
+    MTS_INLINE std::pair<bool, Float>
+    intersect_sphere_block(const SphereBlock &block, const Ray3f &ray,
+                           Float *cache) const {
+        if constexpr (!is_array_v<Float>) {
+            using UInt = uint_array_t<Float>;
+            SphereVector d(ray.d);
+
+            SphereVector f = SphereVector(ray.o) - block.center;
+            ScalarFloat a = squared_norm(ray.d);
+            SphereFloat b = -dot(f, d),
+                        r2 = sqr(block.radius);
+
+            // Discriminant based on the distance between the line and the center
+            SphereFloat disc = r2 - squared_norm(fmadd(d, b * (1.f / a), f));
+            auto active = disc >= 0.f; // false for NaN (unused) lanes
+
+            if (likely(none(active)))
+                return { false, 0.f };
+
+            SphereFloat q = b + copysign(sqrt(a * max(disc, 0.f)), b),
+                        c = squared_norm(f) - r2,
+                        t0 = c / q, t1 = q * (1.f / a),
+                        near_t = min(t0, t1), far_t = max(t0, t1);
+
+            // Sphere doesn't intersect with the segment on the ray
+            active &= near_t <= ray.maxt && far_t >= ray.mint;
+
+            // Sphere fully contains the segment of the ray
+            active &= !(near_t < ray.mint && far_t > ray.maxt);
+
+            if (likely(none(active)))
+                return { false, 0.f };
+
+            SphereFloat t = select(active, select(near_t < ray.mint, far_t, near_t),
+                                   math::Infinity<ScalarFloat>);
+            ScalarFloat t_min = hmin(t);
+
+            if (!ShadowRay) {
+                Assert(cache != nullptr);
+                for (size_t k = 0; k < SphereBlockSize; ++k) {
+                    if (t.coeff(k) == t_min) {
+                        cache[0] = reinterpret_array<Float>(UInt(block.shape_index[k]));
+                        cache[1] = reinterpret_array<Float>(UInt(block.prim_index[k]));
+                        break;
+                    }
+                }
+            }
+
+            return { true, t_min };
+        } else {
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(ray);
+            ENOKI_MARK_USED(cache);
+            Throw("intersect_sphere_block(): only supported in scalar variants!");
+        }
+    }
+
+    /**
+     * \brief Move the mesh triangles and then the spherical primitives of
+     * each leaf node to the front of its index range and precompute their
+     * data in SIMD-friendly blocks
+     */
+    void build_leaf_blocks();
+
 protected:
     std::vector<ref<Shape>> m_shapes;
     std::vector<Size> m_primitive_map;
+
+    /// Precompute triangle blocks for the leaf intersection of scalar variants?
+    bool m_triangle_blocks_enabled = true;
+    /// Precompute sphere blocks for the leaf intersection of scalar variants?
+    bool m_sphere_blocks_enabled = true;
+    /// Triangle blocks of all leaf nodes
+    std::vector<TriangleBlock> m_triangle_blocks;
+    /// Sphere blocks of all leaf nodes
+    std::vector<SphereBlock> m_sphere_blocks;
+    /// Blocks of each leaf node, indexed by the leaf's primitive offset
+    std::vector<LeafBlocks> m_leaf_blocks;
 };
 
 MTS_EXTERN_CLASS_RENDER(ShapeKDTree)
@@ -301,6 +301,19 @@ protected:
     inline Mesh() { m_mesh = true; }
     virtual ~Mesh();
 
+    /**
+     * \brief Initialize the mesh geometry from the process-wide \ref AssetCache
+     *
+     * Returns \c true if a previously decoded copy of the file at \c path
+     * was found. The lookup accounts for the target variant, \ref m_to_world
+     * and \ref m_disable_vertex_normals; \c key should summarize any further
+     * loader-specific properties that affect the decoded geometry.
+     */
+    bool load_cached(const fs::path &path, const std::string &key);
+
+    /// Register the decoded mesh geometry with the process-wide \ref AssetCache
+    void store_cached(const fs::path &path, const std::string &key) const;
+
     /**
      * \brief Build internal tables for sampling uniformly wrt. area.
      *
@@ -2,6 +2,7 @@
 
 #include <mitsuba/render/records.h>
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/bsphere.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -148,6 +149,32 @@ public:
      */
     virtual Mask ray_test(const Ray3f &ray, Mask active = true) const;
 
+    /**
+     * \brief Fast ray intersection test against a single primitive
+     *
+     * Used by the kd-tree to intersect the primitives of shapes that consist
+     * of several of them (see \ref primitive_count()). The \c cache is
+     * filled like in \ref ray_intersect(). The index of the primitive will
+     * be available in \ref SurfaceInteraction::prim_index when \ref
+     * fill_surface_interaction() is called.
+     *
+     * \remark The default implementation ignores \c index and forwards the
+     * call to \ref ray_intersect()
+     */
+    virtual std::pair<Mask, Float> ray_intersect_primitive(ScalarIndex index,
+                                                           const Ray3f &ray,
+                                                           Float *cache,
+                                                           Mask active = true) const;
+
+    /**
+     * \brief Fast ray shadow test against a single primitive
+     *
+     * \remark The default implementation ignores \c index and forwards the
+     * call to \ref ray_test()
+     */
+    virtual Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray,
+                                    Mask active = true) const;
+
     /**
      * \brief Given a surface intersection found by \ref ray_intersect(), fill
      * a \ref SurfaceInteraction data structure with detailed information
@@ -210,6 +237,20 @@ public:
      */
     virtual ScalarBoundingBox3f bbox(ScalarIndex index, const ScalarBoundingBox3f &clip) const;
 
+    /**
+     * \brief Return the sphere described by a single shape primitive, if
+     * the primitive is a sphere
+     *
+     * The kd-tree of scalar variants uses this to intersect the spheres of
+     * its leaf nodes in SIMD-sized blocks. The ray must then hit the
+     * primitive exactly when it hits the returned sphere, and \ref
+     * fill_surface_interaction() may not rely on the \c cache.
+     *
+     * \remark The default implementation returns an empty sphere, i.e. the
+     * primitive is intersected using \ref ray_intersect_primitive()
+     */
+    virtual ScalarBoundingSphere3f primitive_sphere(ScalarIndex index) const;
+
     /**
      * \brief Return the shape's surface area.
      *
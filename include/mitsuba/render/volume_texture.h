@@ -25,4 +25,33 @@ struct VolumeMetadata {
     float max;
 };
 
+/**
+ * \brief Decoded contents of a Mitsuba binary volume file
+ *
+ * Instances are immutable and shared between all volumes that reference the
+ * same file through the \ref AssetCache.
+ */
+class MTS_EXPORT_RENDER VolumeData : public Object {
+public:
+    VolumeData(const VolumeMetadata &metadata, std::unique_ptr<float[]> data)
+        : m_metadata(metadata), m_data(std::move(data)) { }
+
+    /// Return the metadata stored in the file header
+    const VolumeMetadata &metadata() const { return m_metadata; }
+
+    /// Return a pointer to the (interleaved) grid values
+    const float *data() const { return m_data.get(); }
+
+    /// Return the total number of stored values
+    size_t size() const { return hprod(m_metadata.shape) * m_metadata.channel_count; }
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~VolumeData() = default;
+
+private:
+    VolumeMetadata m_metadata;
+    std::unique_ptr<float[]> m_data;
+};
+
 NAMESPACE_END(mitsuba)
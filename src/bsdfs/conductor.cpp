@@ -285,6 +285,13 @@ public:
         return 0.f;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext & /*ctx*/,
+                                        const SurfaceInteraction3f & /*si*/,
+                                        const Vector3f & /*wo*/,
+                                        Mask /*active*/) const override {
+        return { 0.f, 0.f };
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("specular_reflectance", m_specular_reflectance.get());
         callback->put_object("eta", m_eta.get());
@@ -325,6 +325,13 @@ public:
         return 0.f;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext & /* ctx */,
+                                        const SurfaceInteraction3f & /* si */,
+                                        const Vector3f & /* wo */,
+                                        Mask /* active */) const override {
+        return { 0.f, 0.f };
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("eta", m_eta);
         if (m_specular_reflectance)
@@ -1,5 +1,6 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/tensor.h>
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/core/warp.h>
@@ -99,52 +100,70 @@ public:
                 (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
         }
 
-        // Construct NDF interpolant data structure
-        m_ndf = Warp2D0(
-            (ScalarFloat *) ndf.data,
-            ScalarVector2u(ndf.shape[1], ndf.shape[0]),
-            { }, { }, false, false
-        );
-
-        // Construct projected surface area interpolant data structure
-        m_sigma = Warp2D0(
-            (ScalarFloat *) sigma.data,
-            ScalarVector2u(sigma.shape[1], sigma.shape[0]),
-            { }, { }, false, false
-        );
-
-        // Construct VNDF warp data structure
-        m_vndf = Warp2D2(
-            (ScalarFloat *) vndf.data,
-            ScalarVector2u(vndf.shape[3], vndf.shape[2]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data }}
-        );
-
-        // Construct Luminance warp data structure
-        m_luminance = Warp2D2(
-            (ScalarFloat *) luminance.data,
-            ScalarVector2u(luminance.shape[3], luminance.shape[2]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data }}
-        );
-
-        // Construct spectral interpolant
-        m_spectra = Warp2D3(
-            (ScalarFloat *) spectra.data,
-            ScalarVector2u(spectra.shape[4], spectra.shape[3]),
-            {{ (uint32_t) phi_i.shape[0],
-               (uint32_t) theta_i.shape[0],
-               (uint32_t) wavelengths.shape[0] }},
-            {{ (const ScalarFloat *) phi_i.data,
-               (const ScalarFloat *) theta_i.data,
-               (const ScalarFloat *) wavelengths.data }},
-            false, false
-        );
+        /* The interpolants can optionally be stored in a cache file (given by
+           the 'cache_file' parameter), which avoids rebuilding them on
+           subsequent loads of the same material. The cache is identified by
+           the resolved path and modification time of the input file. */
+        fs::path cache_path;
+        if (props.has_property("cache_file"))
+            cache_path = fs->resolve(props.string("cache_file"));
+        std::string cache_key = tfm::format("measured:%s:%i:%i:%s",
+                                            fs::absolute(file_path).string(),
+                                            fs::file_size(file_path),
+                                            fs::last_write_time(file_path),
+                                            struct_type_v<ScalarFloat>);
+
+        if (cache_path.empty() || !read_cache(cache_path, cache_key)) {
+            // Construct NDF interpolant data structure
+            m_ndf = Warp2D0(
+                (ScalarFloat *) ndf.data,
+                ScalarVector2u(ndf.shape[1], ndf.shape[0]),
+                { }, { }, false, false
+            );
+
+            // Construct projected surface area interpolant data structure
+            m_sigma = Warp2D0(
+                (ScalarFloat *) sigma.data,
+                ScalarVector2u(sigma.shape[1], sigma.shape[0]),
+                { }, { }, false, false
+            );
+
+            // Construct VNDF warp data structure
+            m_vndf = Warp2D2(
+                (ScalarFloat *) vndf.data,
+                ScalarVector2u(vndf.shape[3], vndf.shape[2]),
+                {{ (uint32_t) phi_i.shape[0],
+                   (uint32_t) theta_i.shape[0] }},
+                {{ (const ScalarFloat *) phi_i.data,
+                   (const ScalarFloat *) theta_i.data }}
+            );
+
+            // Construct Luminance warp data structure
+            m_luminance = Warp2D2(
+                (ScalarFloat *) luminance.data,
+                ScalarVector2u(luminance.shape[3], luminance.shape[2]),
+                {{ (uint32_t) phi_i.shape[0],
+                   (uint32_t) theta_i.shape[0] }},
+                {{ (const ScalarFloat *) phi_i.data,
+                   (const ScalarFloat *) theta_i.data }}
+            );
+
+            // Construct spectral interpolant
+            m_spectra = Warp2D3(
+                (ScalarFloat *) spectra.data,
+                ScalarVector2u(spectra.shape[4], spectra.shape[3]),
+                {{ (uint32_t) phi_i.shape[0],
+                   (uint32_t) theta_i.shape[0],
+                   (uint32_t) wavelengths.shape[0] }},
+                {{ (const ScalarFloat *) phi_i.data,
+                   (const ScalarFloat *) theta_i.data,
+                   (const ScalarFloat *) wavelengths.data }},
+                false, false
+            );
+
+            if (!cache_path.empty())
+                write_cache(cache_path, cache_key);
+        }
 
         std::string description_str(
             (const char *) description.data,
@@ -380,6 +399,78 @@ public:
 #endif // MTS_SAMPLE_DIFFUSE
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo_,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Vector3f wi = si.wi, wo = wo_;
+
+        active &= Frame3f::cos_theta(wi) > 0.f &&
+                Frame3f::cos_theta(wo) > 0.f;
+
+        if (!ctx.is_enabled(BSDFFlags::GlossyReflection) || none_or<false>(active))
+            return { Spectrum(0.f), 0.f };
+
+        if (m_reduction >= 2) {
+            Float sy = wi.y(),
+                sx = (m_reduction == 4) ? wi.x() : sy;
+
+            wi.x() = mulsign_neg(wi.x(), sx);
+            wi.y() = mulsign_neg(wi.y(), sy);
+            wo.x() = mulsign_neg(wo.x(), sx);
+            wo.y() = mulsign_neg(wo.y(), sy);
+        }
+
+        Vector3f m = normalize(wo + wi);
+
+        // Cartesian -> spherical coordinates
+        Float theta_i = elevation(wi),
+            phi_i   = atan2(wi.y(), wi.x()),
+            theta_m = elevation(m),
+            phi_m   = atan2(m.y(), m.x());
+
+        // Spherical coordinates -> unit coordinate system
+        Vector2f u_wi(theta2u(theta_i), phi2u(phi_i)),
+                u_m (theta2u(theta_m), phi2u(
+                    m_isotropic ? (phi_m - phi_i) : phi_m));
+
+        u_m[1] = u_m[1] - floor(u_m[1]);
+
+        // The inversion of the VNDF warp is shared by both queries
+        Float params[2] = { phi_i, theta_i };
+        auto [sample, vndf_pdf] = m_vndf.invert(u_m, params, active);
+
+        UnpolarizedSpectrum spec;
+        for (size_t i = 0; i < array_size_v<UnpolarizedSpectrum>; ++i) {
+            Float params_spec[3] = { phi_i, theta_i, si.wavelengths[i] };
+            spec[i] = m_spectra.eval(sample, params_spec, active);
+        }
+
+        if (m_jacobian)
+            spec *= m_ndf.eval(u_m, params, active) /
+                    (4 * m_sigma.eval(u_wi, params, active));
+
+#if MTS_SAMPLE_DIFFUSE == 1
+        ENOKI_MARK_USED(vndf_pdf);
+        Float pdf = warp::square_to_cosine_hemisphere_pdf(wo);
+#else // MTS_SAMPLE_DIFFUSE
+        Float pdf = 1.f;
+        #if MTS_SAMPLE_LUMINANCE == 1
+        pdf = m_luminance.eval(sample, params, active);
+        #endif
+
+        Float jacobian =
+            enoki::max(2.f * sqr(math::Pi<Float>) * u_m.x() * Frame3f::sin_theta(m), 1e-6f) * 4.f *
+            dot(wi, m);
+
+        pdf = vndf_pdf * pdf / jacobian;
+#endif // MTS_SAMPLE_DIFFUSE
+
+        return { unpolarized<Spectrum>(spec) & active, select(active, pdf, 0.f) };
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "Measured[" << std::endl
@@ -395,6 +486,52 @@ public:
 
     MTS_DECLARE_CLASS()
 private:
+    /**
+     * Load the interpolants from a cache file written by \ref write_cache().
+     * Returns \c false when the file doesn't exist or was created from a
+     * different input.
+     */
+    bool read_cache(const fs::path &path, const std::string &key) {
+        if (!fs::exists(path))
+            return false;
+        try {
+            ref<FileStream> stream = new FileStream(path, FileStream::ERead);
+            std::string stream_key;
+            stream->read(stream_key);
+            if (stream_key != key) {
+                Log(Info, "\"%s\": cache was created from a different input, rebuilding it ..",
+                    path.filename().string());
+                return false;
+            }
+            m_ndf       = Warp2D0(stream);
+            m_sigma     = Warp2D0(stream);
+            m_vndf      = Warp2D2(stream);
+            m_luminance = Warp2D2(stream);
+            m_spectra   = Warp2D3(stream);
+        } catch (const std::exception &e) {
+            Log(Warn, "\"%s\": could not read cache (%s), rebuilding it ..",
+                path.filename().string(), e.what());
+            return false;
+        }
+        Log(Debug, "Loaded \"%s\" from cache \"%s\"", m_name, path.filename().string());
+        return true;
+    }
+
+    /// Write the interpolants to a cache file
+    void write_cache(const fs::path &path, const std::string &key) const {
+        try {
+            ref<FileStream> stream = new FileStream(path, FileStream::ETruncReadWrite);
+            stream->write(key);
+            m_ndf.write(stream);
+            m_sigma.write(stream);
+            m_vndf.write(stream);
+            m_luminance.write(stream);
+            m_spectra.write(stream);
+        } catch (const std::exception &e) {
+            Log(Warn, "\"%s\": could not write cache: %s", path.string(), e.what());
+        }
+    }
+
     template <typename Value> Value u2theta(Value u) const {
         return sqr(u) * (math::Pi<Float> / 2.f);
     }
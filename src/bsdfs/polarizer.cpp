@@ -130,6 +130,13 @@ public:
         return 0.f;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &/* ctx */,
+                                        const SurfaceInteraction3f &/* si */,
+                                        const Vector3f &/* wo */,
+                                        Mask /* active */) const override {
+        return { 0.f, 0.f };
+    }
+
     Spectrum eval_null_transmission(const SurfaceInteraction3f &si, Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
 
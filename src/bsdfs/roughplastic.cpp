@@ -267,11 +267,10 @@ public:
             masked(bs.sampled_type, sample_diffuse) = +BSDFFlags::DiffuseReflection;
         }
 
-        bs.pdf = pdf(ctx, si, bs.wo, active);
+        std::tie(result, bs.pdf) = eval_pdf(ctx, si, bs.wo, active);
         active &= bs.pdf > 0.f;
-        result = eval(ctx, si, bs.wo, active);
 
-        return { bs, select(active, unpolarized<Spectrum>(result) / bs.pdf, 0.f) };
+        return { bs, select(active, result / bs.pdf, 0.f) };
     }
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -387,6 +386,86 @@ public:
         return result;
     }
 
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        bool has_specular = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             has_diffuse  = ctx.is_enabled(BSDFFlags::DiffuseReflection, 1);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        active &= cos_theta_i > 0.f && cos_theta_o > 0.f;
+
+        if (unlikely((!has_specular && !has_diffuse) || none_or<false>(active)))
+            return { 0.f, 0.f };
+
+        // The transmittance lookup is shared by the diffuse term and the lobe selection
+        Float t_i = lerp_gather(m_external_transmittance.data(), cos_theta_i,
+                                MTS_ROUGH_TRANSMITTANCE_RES, active);
+
+        Float prob_specular = (1.f - t_i) * m_specular_sampling_weight,
+              prob_diffuse  = t_i * (1.f - m_specular_sampling_weight);
+
+        if (unlikely(has_specular != has_diffuse))
+            prob_specular = has_specular ? 1.f : 0.f;
+        else
+            prob_specular = prob_specular / (prob_specular + prob_diffuse);
+        prob_diffuse = 1.f - prob_specular;
+
+        // Calculate the reflection half-vector
+        Vector3f H = normalize(wo + si.wi);
+
+        MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
+
+        // Evaluate the microfacet normal distribution and shadowing-masking terms once
+        Float D = distr.eval(H),
+              G1_i = distr.smith_g1(si.wi, H);
+
+        UnpolarizedSpectrum value(0.f);
+        if (has_specular) {
+            // Fresnel term
+            Float F = std::get<0>(fresnel(dot(si.wi, H), Float(m_eta)));
+
+            // Smith's shadow-masking function
+            Float G = G1_i * distr.smith_g1(wo, H);
+
+            // Calculate the specular reflection component
+            UnpolarizedSpectrum spec = F * D * G / (4.f * cos_theta_i);
+
+            if (m_specular_reflectance)
+                spec *= m_specular_reflectance->eval(si, active);
+
+            value += spec;
+        }
+
+        if (has_diffuse) {
+            Float t_o = lerp_gather(m_external_transmittance.data(), cos_theta_o,
+                                    MTS_ROUGH_TRANSMITTANCE_RES, active);
+
+            UnpolarizedSpectrum diff = m_diffuse_reflectance->eval(si, active);
+            diff /= 1.f - (m_nonlinear ? (diff * m_internal_reflectance)
+                                       : UnpolarizedSpectrum(m_internal_reflectance));
+
+            value += diff * (math::InvPi<Float> * m_inv_eta_2 * cos_theta_o * t_i * t_o);
+        }
+
+        Float pdf;
+        if (m_sample_visible)
+            pdf = D * G1_i / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H) / (4.f * dot(wo, H));
+        pdf *= prob_specular;
+
+        pdf += prob_diffuse * warp::square_to_cosine_hemisphere_pdf(wo);
+
+        return { select(active, unpolarized<Spectrum>(value), 0.f),
+                 select(active, pdf, 0.f) };
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_parameter("alpha", m_alpha);
         callback->put_parameter("eta", m_eta);
@@ -1,6 +1,8 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/bsphere.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/render/emitter.h>
@@ -28,6 +30,12 @@ Environment emitter (:monosp:`envmap`)
  * - to_world
    - |transform|
    - Specifies an optional emitter-to-world transformation.  (Default: none, i.e. emitter space = world space)
+ * - cache_file
+   - |string|
+   - Optional file that stores the converted image and its sampling tables. It is created on the
+     first load and reused afterwards, which avoids decoding the image and rebuilding the tables.
+     It is rebuilt when it was created from a different file, or when the input image was modified
+     since then. (Default: none)
 
 This plugin provides a HDRI (high dynamic range imaging) environment map,
 which is a type of light source that is well-suited for representing "natural"
@@ -71,54 +79,28 @@ public:
 
         FileResolver *fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
-
-        ref<Bitmap> bitmap = new Bitmap(file_path);
-
-        /* Convert to linear RGBA float bitmap, will undergo further
-           conversion into coefficients of a spectral upsampling model below */
-        bitmap = bitmap->convert(Bitmap::PixelFormat::RGBA, struct_type_v<ScalarFloat>, false);
         m_filename = file_path.filename().string();
 
-        std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[bitmap->pixel_count()]);
-
-        ScalarFloat *ptr     = (ScalarFloat *) bitmap->data(),
-                    *lum_ptr = (ScalarFloat *) luminance.get();
-
-        for (size_t y = 0; y < bitmap->size().y(); ++y) {
-            ScalarFloat sin_theta =
-                std::sin(y / ScalarFloat(bitmap->size().y() - 1) * math::Pi<ScalarFloat>);
-
-            for (size_t x = 0; x < bitmap->size().x(); ++x) {
-                ScalarColor3f rgb = load_unaligned<ScalarVector3f>(ptr);
-                ScalarFloat lum   = mitsuba::luminance(rgb);
-
-                ScalarVector4f coeff;
-                if constexpr (is_monochromatic_v<Spectrum>) {
-                    coeff = ScalarVector4f(lum, lum, lum, 1.f);
-                } else if constexpr (is_rgb_v<Spectrum>) {
-                    coeff = concat(rgb, ScalarFloat(1.f));
-                } else {
-                    static_assert(is_spectral_v<Spectrum>);
-                    /* Evaluate the spectral upsampling model. This requires a
-                       reflectance value (colors in [0, 1]) which is accomplished here by
-                       scaling. We use a color where the highest component is 50%,
-                       which generally yields a fairly smooth spectrum. */
-                    ScalarFloat scale = hmax(rgb) * 2.f;
-                    ScalarColor3f rgb_norm = rgb / std::max((ScalarFloat) 1e-8, scale);
-                    coeff = concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
-                }
-
-                *lum_ptr++ = lum * sin_theta;
-                store(ptr, coeff);
-                ptr += 4;
-            }
+        fs::path cache_path;
+        if (props.has_property("cache_file"))
+            cache_path = fs->resolve(props.string("cache_file"));
+        /* Identify the input by its resolved path and modification time, so
+           that the cache is neither shared between distinct files with the
+           same name nor reused after the file was edited in place */
+        std::string cache_key = tfm::format(
+            "envmap:%s:%i:%i:%s:%s", fs::absolute(file_path).string(),
+            fs::file_size(file_path), fs::last_write_time(file_path),
+            struct_type_v<ScalarFloat>,
+            is_spectral_v<Spectrum> ? "spectral" :
+            (is_monochromatic_v<Spectrum> ? "mono" : "rgb"));
+
+        if (cache_path.empty() || !read_cache(cache_path, cache_key)) {
+            build(file_path);
+            if (!cache_path.empty())
+                write_cache(cache_path, cache_key);
         }
 
-        m_resolution = bitmap->size();
-        m_data = DynamicBuffer<Float>::copy(bitmap->data(), hprod(m_resolution) * 4);
-
         m_scale = props.float_("scale", 1.f);
-        m_warp = Warp(luminance.get(), m_resolution);
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
     }
@@ -316,6 +298,120 @@ protected:
 
     MTS_DECLARE_CLASS()
 protected:
+    /// Convert the image into spectral coefficients and build the sampling tables
+    void build(const fs::path &file_path) {
+        /* Convert to linear RGBA float bitmap, will undergo further
+           conversion into coefficients of a spectral upsampling model below.
+           The converted bitmap is shared with other instances via the asset cache. */
+        auto load = [&](size_t &size) -> ref<Object> {
+            ref<Bitmap> bitmap = new Bitmap(file_path);
+            bitmap = bitmap->convert(Bitmap::PixelFormat::RGBA,
+                                     struct_type_v<ScalarFloat>, false);
+            size = bitmap->buffer_size();
+            return bitmap.get();
+        };
+
+        ref<Bitmap> bitmap;
+        AssetCache *cache = AssetCache::instance();
+        if (cache) {
+            std::string key = tfm::format("rgba:%s", struct_type_v<ScalarFloat>);
+            bitmap = cache->get<Bitmap>(file_path, key, load);
+        } else {
+            size_t size;
+            bitmap = static_cast<Bitmap *>(load(size).get());
+        }
+
+        std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[bitmap->pixel_count()]),
+                                       data(new ScalarFloat[bitmap->pixel_count() * 4]);
+
+        const ScalarFloat *ptr = (const ScalarFloat *) bitmap->data();
+        ScalarFloat *data_ptr  = data.get(),
+                    *lum_ptr   = luminance.get();
+
+        for (size_t y = 0; y < bitmap->size().y(); ++y) {
+            ScalarFloat sin_theta =
+                std::sin(y / ScalarFloat(bitmap->size().y() - 1) * math::Pi<ScalarFloat>);
+
+            for (size_t x = 0; x < bitmap->size().x(); ++x) {
+                ScalarColor3f rgb = load_unaligned<ScalarVector3f>(ptr);
+                ScalarFloat lum   = mitsuba::luminance(rgb);
+
+                ScalarVector4f coeff;
+                if constexpr (is_monochromatic_v<Spectrum>) {
+                    coeff = ScalarVector4f(lum, lum, lum, 1.f);
+                } else if constexpr (is_rgb_v<Spectrum>) {
+                    coeff = concat(rgb, ScalarFloat(1.f));
+                } else {
+                    static_assert(is_spectral_v<Spectrum>);
+                    /* Evaluate the spectral upsampling model. This requires a
+                       reflectance value (colors in [0, 1]) which is accomplished here by
+                       scaling. We use a color where the highest component is 50%,
+                       which generally yields a fairly smooth spectrum. */
+                    ScalarFloat scale = hmax(rgb) * 2.f;
+                    ScalarColor3f rgb_norm = rgb / std::max((ScalarFloat) 1e-8, scale);
+                    coeff = concat((ScalarColor3f) srgb_model_fetch(rgb_norm), scale);
+                }
+
+                *lum_ptr++ = lum * sin_theta;
+                store_unaligned(data_ptr, coeff);
+                data_ptr += 4;
+                ptr += 4;
+            }
+        }
+
+        m_resolution = bitmap->size();
+        m_data = DynamicBuffer<Float>::copy(data.get(), hprod(m_resolution) * 4);
+        m_warp = Warp(luminance.get(), m_resolution);
+    }
+
+    /**
+     * Load the converted image and the sampling tables from a cache file
+     * written by \ref write_cache(). Returns \c false when the file doesn't
+     * exist or was created from a different input.
+     */
+    bool read_cache(const fs::path &path, const std::string &key) {
+        if (!fs::exists(path))
+            return false;
+        try {
+            ref<FileStream> stream = new FileStream(path, FileStream::ERead);
+            std::string stream_key;
+            stream->read(stream_key);
+            if (stream_key != key) {
+                Log(Info, "\"%s\": cache was created from a different input, rebuilding it ..",
+                    path.filename().string());
+                return false;
+            }
+            stream->read(m_resolution.x());
+            stream->read(m_resolution.y());
+            size_t size = hprod(m_resolution) * 4;
+            std::unique_ptr<ScalarFloat[]> data(new ScalarFloat[size]);
+            stream->read_array(data.get(), size);
+            m_data = DynamicBuffer<Float>::copy(data.get(), size);
+            m_warp = Warp(stream);
+        } catch (const std::exception &e) {
+            Log(Warn, "\"%s\": could not read cache (%s), rebuilding it ..",
+                path.filename().string(), e.what());
+            return false;
+        }
+        Log(Debug, "Loaded \"%s\" from cache \"%s\"", m_filename, path.filename().string());
+        return true;
+    }
+
+    /// Write the converted image and the sampling tables to a cache file
+    void write_cache(const fs::path &path, const std::string &key) {
+        try {
+            m_data.managed();
+            ref<FileStream> stream = new FileStream(path, FileStream::ETruncReadWrite);
+            stream->write(key);
+            stream->write(m_resolution.x());
+            stream->write(m_resolution.y());
+            stream->write_array((const ScalarFloat *) m_data.data(), hprod(m_resolution) * 4);
+            m_warp.write(stream);
+        } catch (const std::exception &e) {
+            Log(Warn, "\"%s\": could not write cache: %s", path.string(), e.what());
+        }
+    }
+
     std::string m_filename;
     ScalarBoundingSphere3f m_bsphere;
     DynamicBuffer<Float> m_data;
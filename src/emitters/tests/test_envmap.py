@@ -0,0 +1,71 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def write_envmap(path, seed=0, width=16):
+    from mitsuba.core import Bitmap
+
+    rng = np.random.RandomState(seed)
+    Bitmap(rng.uniform(0, 4, (width // 2, width, 3)).astype(np.float32)).write(path)
+    return path
+
+
+def create_envmap(filename, cache_file=None):
+    from mitsuba.core.xml import load_string
+
+    cache = '' if cache_file is None else \
+        '<string name="cache_file" value="%s"/>' % cache_file
+    return load_string("""<emitter version='2.0.0' type='envmap'>
+        <string name="filename" value="{}"/>
+        {}
+    </emitter>""".format(filename, cache))
+
+
+def samples(emitter):
+    result = []
+    for u in np.linspace(0.05, 0.95, 7):
+        for v in np.linspace(0.05, 0.95, 7):
+            ray, weight = emitter.sample_ray(0, 0.5, [0.3, 0.7], [u, v])
+            result.append(np.concatenate([np.array(ray.d), np.array(weight)]))
+    return np.array(result)
+
+
+def test01_cache_file(variant_scalar_rgb, tmpdir):
+    import os
+
+    # PFM images are uncompressed, their size only depends on the resolution
+    filename = write_envmap(str(tmpdir.join('envmap.pfm')))
+    cache_file = str(tmpdir.join('envmap.cache'))
+    reference = samples(create_envmap(filename))
+
+    # The first load writes the cache, the second one reads it
+    assert ek.allclose(samples(create_envmap(filename, cache_file)), reference)
+    assert os.path.exists(cache_file)
+    assert ek.allclose(samples(create_envmap(filename, cache_file)), reference)
+
+    # A corrupt cache is rebuilt
+    with open(cache_file, 'wb') as f:
+        f.write(b'invalid')
+    assert ek.allclose(samples(create_envmap(filename, cache_file)), reference)
+    assert os.path.getsize(cache_file) > 100
+
+    # So is the cache of an image whose size changed
+    write_envmap(filename, seed=1, width=32)
+    reference = samples(create_envmap(filename))
+    assert ek.allclose(samples(create_envmap(filename, cache_file)), reference)
+
+    # .. or that was edited in place without changing its size
+    stat = os.stat(filename)
+    write_envmap(filename, seed=2, width=32)
+    assert os.path.getsize(filename) == stat.st_size
+    os.utime(filename, ns=(stat.st_atime_ns, stat.st_mtime_ns + 10**9))
+    reference = samples(create_envmap(filename))
+    assert ek.allclose(samples(create_envmap(filename, cache_file)), reference)
+
+    # A file with the same name and size in another directory doesn't reuse it
+    other = write_envmap(str(tmpdir.mkdir('other').join('envmap.pfm')),
+                         seed=3, width=32)
+    reference = samples(create_envmap(other))
+    assert ek.allclose(samples(create_envmap(other, cache_file)), reference)
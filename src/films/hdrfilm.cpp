@@ -3,9 +3,13 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/timeline.h>
+#include <mitsuba/render/denoiser.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/spiral.h>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -45,6 +49,28 @@ High dynamic range film (:monosp:`hdrfilm`)
    - If set to |true|, regions slightly outside of the film plane will also be sampled. This may
      improve the image quality at the edges, especially when using very large reconstruction
      filters. In general, this is not needed though. (Default: |false|, i.e. disabled)
+ * - tile_size
+   - |int|
+   - When set to a nonzero value, OpenEXR output is written as a tiled file with square tiles
+     of the given size, whose compression is distributed over all cores. (Default: 0, i.e.
+     scanline-based output, or the render block size when :monosp:`stream` is enabled)
+ * - stream
+   - |bool|
+   - If set to |true|, tiles of the OpenEXR output are compressed and written to disk while
+     rendering, as soon as no further samples can contribute to them. Developing the film
+     then only needs to write the remaining tiles (if any). (Default: |false|)
+ * - denoise
+   - |bool|
+   - If set to |true|, the image is denoised when the film is developed, guided by the
+     AOVs given by the following parameters (if present). (Default: |false|)
+ * - denoise_albedo, denoise_normal, denoise_moment
+   - |string|
+   - Names of the albedo, shading normal and second moment AOVs used by the denoiser.
+     (Default: :monosp:`albedo`, :monosp:`normal` and :monosp:`moment`)
+ * - denoise_iterations
+   - |int|
+   - Number of iterations of the denoising filter. Each iteration doubles its footprint.
+     (Default: 5)
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -77,6 +103,18 @@ When RGB(A) output is selected, the measured spectral power distributions are
 converted to linear RGB based on the CIE 1931 XYZ color matching curves and
 the ITU-R Rec. BT.709-3 primaries with a D65 white point.
 
+For very large images, the :monosp:`stream` parameter avoids the time and memory needed to
+convert and encode the entire image once rendering has finished. The file on disk is only
+complete once the film has been developed.
+
+The :monosp:`denoise` parameter enables a feature-guided denoising filter (see
+:monosp:`Denoiser`) that is applied to the color channels before they are written out, while
+AOVs are stored unchanged. It is most effective with the albedo, shading normal and second
+moment AOVs of the :ref:`aov <integrator-aov>` integrator, for example
+:monosp:`albedo:albedo,normal:sh_normal,moment:moment`. Without the second moment, the noise
+level is estimated from the neighborhood of each pixel. Denoising is not supported together
+with :monosp:`stream`.
+
 The following XML snippet discribes a film that writes a full-HD RGBA OpenEXR file:
 
 .. code-block:: xml
@@ -177,6 +215,34 @@ public:
                 m_component_format = Struct::Type::Float32;
             }
         }
+
+        m_stream = props.bool_("stream", false);
+        int tile_size = props.int_("tile_size", m_stream ? MTS_BLOCK_SIZE : 0);
+        if (tile_size < 0 || (m_stream && tile_size == 0))
+            Throw("The \"tile_size\" parameter must be positive!");
+        m_tile_size = (uint32_t) tile_size;
+
+        if (m_tile_size > 0 && m_file_format != Bitmap::FileFormat::OpenEXR)
+            Throw("Tiled output requires file_format=\"openexr\"!");
+
+        if (m_stream && is_cuda_array_v<Float>) {
+            Log(Warn, "Streaming output is not supported in GPU mode, disabling..");
+            m_stream = false;
+        }
+
+        if (props.bool_("denoise", false)) {
+            if (m_stream) {
+                Log(Warn, "Denoising is not supported together with streaming output, disabling..");
+            } else {
+                int iterations = props.int_("denoise_iterations", 5);
+                if (iterations < 1)
+                    Throw("The \"denoise_iterations\" parameter must be positive!");
+                m_denoiser = new Denoiser((size_t) iterations);
+            }
+        }
+        m_denoise_albedo = props.string("denoise_albedo", "albedo");
+        m_denoise_normal = props.string("denoise_normal", "normal");
+        m_denoise_moment = props.string("denoise_moment", "moment");
     }
 
     void set_destination_file(const fs::path &dest_file) override {
@@ -198,11 +264,72 @@ public:
         m_storage->set_offset(m_crop_offset);
         m_storage->clear();
         m_channels = channels;
+        m_pass_count = 1;
+
+        if (m_denoiser) {
+            m_albedo_channel = find_channels(m_denoise_albedo, { ".R", ".G", ".B" });
+            m_normal_channel = find_channels(m_denoise_normal, { ".X", ".Y", ".Z" });
+            m_moment_channel = find_channels(m_denoise_moment, { "" });
+            if (m_albedo_channel < 0 && m_normal_channel < 0)
+                Log(Warn, "Denoising without albedo and normal AOVs, edges may be blurred.");
+        }
+
+        if (m_stream) {
+            m_tile_count = (m_crop_size + (int) m_tile_size - 1) / (int) m_tile_size;
+            m_tile_pixels.assign(hprod(m_tile_count), 0);
+            m_tile_state.assign(hprod(m_tile_count), TileState::Pending);
+            m_writer = nullptr;
+        }
+    }
+
+    void set_pass_count(size_t count) override {
+        m_pass_count = count;
     }
 
+    bool streams_output() const override { return m_stream; }
+
     void put(const ImageBlock *block) override {
         Assert(m_storage != nullptr);
-        m_storage->put(block);
+        if (!m_stream) {
+            m_storage->put(block);
+            return;
+        }
+
+        std::vector<ScalarVector2i> finished;
+
+        /* Critical section: accumulate and determine which tiles will not
+           receive any further contributions */ {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_storage->put(block);
+
+            ScalarVector2i start = max(block->offset() - m_crop_offset, 0),
+                           end   = min(block->offset() - m_crop_offset + block->size(),
+                                       m_crop_size);
+            if (any(end <= start))
+                return;
+
+            int ts = (int) m_tile_size;
+            ScalarVector2i tile_start = start / ts,
+                           tile_end   = (end - 1) / ts;
+
+            for (int ty = tile_start.y(); ty <= tile_end.y(); ++ty) {
+                for (int tx = tile_start.x(); tx <= tile_end.x(); ++tx) {
+                    ScalarVector2i tile(tx, ty),
+                                   tile_min = max(tile * ts, start),
+                                   tile_max = min((tile + 1) * ts, end);
+                    size_t index = tile_index(tile);
+                    m_tile_pixels[index] += hprod(tile_max - tile_min);
+                    if (m_tile_pixels[index] ==
+                        hprod(tile_size(tile)) * m_pass_count) {
+                        m_tile_state[index] = TileState::Complete;
+                        claim_finished_tiles(tile, finished);
+                    }
+                }
+            }
+        }
+
+        for (const ScalarVector2i &tile : finished)
+            write_tile(tile);
     }
 
     bool develop(const ScalarPoint2i  &source_offset,
@@ -257,11 +384,91 @@ public:
         if (raw)
             return source;
 
+        if (m_denoiser)
+            source = denoise(source);
+
+        return develop_bitmap(source);
+    }
+
+    void develop() override {
+        if (m_dest_file.empty())
+            Throw("Destination file not specified, cannot develop.");
+
+        if (m_stream) {
+            ScopedTimelineEvent timeline_event("write", output_path(m_dest_file).string());
+
+            // Write tiles that were not streamed yet (e.g. if rendering was interrupted)
+            for (int ty = 0; ty < m_tile_count.y(); ++ty) {
+                for (int tx = 0; tx < m_tile_count.x(); ++tx) {
+                    ScalarVector2i tile(tx, ty);
+                    if (m_tile_state[tile_index(tile)] != TileState::Written) {
+                        m_tile_state[tile_index(tile)] = TileState::Written;
+                        write_tile(tile);
+                    }
+                }
+            }
+
+            Log(Info, "\U00002714  Finished streaming \"%s\"", output_path(m_dest_file).string());
+            if (m_writer) {
+                m_writer->close();
+                m_writer = nullptr;
+            }
+            return;
+        }
+
+        fs::path filename = output_path(m_dest_file);
+        Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
+
+        ref<Bitmap> target;
+        /* Convert the accumulated samples into the output format */ {
+            ScopedTimelineEvent timeline_event("develop", filename.filename().string());
+            target = bitmap();
+        }
+
+        ScopedTimelineEvent timeline_event("write", filename.string());
+        if (m_tile_size > 0) {
+            ref<TiledEXRWriter> writer = new TiledEXRWriter(
+                filename, target->size(), ScalarVector2u(m_tile_size), target);
+            writer->write(ScalarPoint2u(0), target);
+            writer->close();
+        } else {
+            target->write(filename, m_file_format);
+        }
+    }
+
+    bool destination_exists(const fs::path &base_name) const override {
+        return fs::exists(output_path(base_name));
+    }
+
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "HDRFilm[" << std::endl
+            << "  size = " << m_size        << "," << std::endl
+            << "  crop_size = " << m_crop_size   << "," << std::endl
+            << "  crop_offset = " << m_crop_offset << "," << std::endl
+            << "  high_quality_edges = " << m_high_quality_edges << "," << std::endl
+            << "  filter = " << m_filter << "," << std::endl
+            << "  file_format = " << m_file_format << "," << std::endl
+            << "  pixel_format = " << m_pixel_format << "," << std::endl
+            << "  component_format = " << m_component_format << "," << std::endl
+            << "  tile_size = " << m_tile_size << "," << std::endl
+            << "  stream = " << m_stream << "," << std::endl
+            << "  denoiser = " << (m_denoiser ? string::indent(m_denoiser->to_string()) : "none") << "," << std::endl
+            << "  dest_file = \"" << m_dest_file << "\"" << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Convert the raw contents of the film (or a region of it) into the output format
+    ref<Bitmap> develop_bitmap(Bitmap *source) const {
         bool has_aovs = m_channels.size() != 5;
 
         ref<Bitmap> target = new Bitmap(
             has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            m_component_format, m_storage->size(),
+            m_component_format, source->size(),
             has_aovs ? (m_storage->channel_count() - 1) : 0);
 
         if (has_aovs) {
@@ -314,31 +521,96 @@ public:
         source->convert(target);
 
         return target;
-     };
-
-    void develop() override {
-        if (m_dest_file.empty())
-            Throw("Destination file not specified, cannot develop.");
+    }
 
-        fs::path filename = m_dest_file;
-        std::string proper_extension;
-        if (m_file_format == Bitmap::FileFormat::OpenEXR)
-            proper_extension = ".exr";
-        else if (m_file_format == Bitmap::FileFormat::RGBE)
-            proper_extension = ".rgbe";
-        else
-            proper_extension = ".pfm";
+    /**
+     * \brief Return the index of the first of a consecutive sequence of
+     * channels named <tt>prefix + suffix</tt> (or -1 if not present)
+     */
+    int find_channels(const std::string &prefix,
+                      const std::vector<std::string> &suffixes) const {
+        for (size_t i = 5; i + suffixes.size() <= m_channels.size(); ++i) {
+            bool match = true;
+            for (size_t k = 0; k < suffixes.size(); ++k)
+                match &= m_channels[i + k] == prefix + suffixes[k];
+            if (match)
+                return (int) i;
+        }
+        return -1;
+    }
 
-        std::string extension = string::to_lower(filename.extension().string());
-        if (extension != proper_extension)
-            filename.replace_extension(proper_extension);
+    /**
+     * \brief Return a copy of the raw contents of the film (see \ref
+     * bitmap()) whose color channels were denoised
+     */
+    ref<Bitmap> denoise(const Bitmap *source) const {
+        size_t channel_count = m_channels.size(),
+               pixel_count   = source->pixel_count();
+        const ScalarFloat *data = (const ScalarFloat *) source->data();
+        ScalarVector2u size = source->size();
+
+        auto make_bitmap = [&](int channel, size_t count) -> ref<Bitmap> {
+            if (channel < 0)
+                return nullptr;
+            return new Bitmap(count == 1 ? Bitmap::PixelFormat::Y : Bitmap::PixelFormat::RGB,
+                              Struct::Type::Float32, size);
+        };
+
+        ref<Bitmap> color    = make_bitmap(0, 3),
+                    albedo   = make_bitmap(m_albedo_channel, 3),
+                    normal   = make_bitmap(m_normal_channel, 3),
+                    variance = make_bitmap(m_moment_channel, 1);
+
+        // Normalize by the accumulated sample weight and convert to linear sRGB
+        for (size_t i = 0; i < pixel_count; ++i) {
+            const ScalarFloat *pixel = data + i * channel_count;
+            ScalarFloat inv_weight = pixel[4] > 0.f ? 1.f / pixel[4] : 0.f;
+
+            ScalarColor3f xyz(pixel[0], pixel[1], pixel[2]),
+                          rgb = xyz_to_srgb(xyz * inv_weight);
+            float *c = (float *) color->data() + 3 * i;
+            for (int k = 0; k < 3; ++k)
+                c[k] = (float) rgb[k];
+
+            if (albedo) {
+                float *a = (float *) albedo->data() + 3 * i;
+                for (int k = 0; k < 3; ++k)
+                    a[k] = (float) (pixel[m_albedo_channel + k] * inv_weight);
+            }
+            if (normal) {
+                float *n = (float *) normal->data() + 3 * i;
+                for (int k = 0; k < 3; ++k)
+                    n[k] = (float) (pixel[m_normal_channel + k] * inv_weight);
+            }
+            if (variance) {
+                /* Variance of the pixel estimate, assuming that the weight
+                   approximates the number of samples */
+                ScalarFloat mean = xyz.y() * inv_weight,
+                            second_moment = pixel[m_moment_channel] * inv_weight;
+                ((float *) variance->data())[i] =
+                    (float) (std::max(second_moment - mean * mean, ScalarFloat(0)) * inv_weight);
+            }
+        }
 
-        Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
+        ref<Bitmap> denoised = m_denoiser->denoise(color, albedo, normal, variance);
+
+        // Write the result back as weighted XYZ values
+        ref<Bitmap> result = new Bitmap(*source);
+        ScalarFloat *out = (ScalarFloat *) result->data();
+        const float *rgb_out = (const float *) denoised->data();
+        for (size_t i = 0; i < pixel_count; ++i) {
+            ScalarFloat *pixel = out + i * channel_count;
+            ScalarColor3f rgb(rgb_out[3 * i], rgb_out[3 * i + 1], rgb_out[3 * i + 2]),
+                          xyz = srgb_to_xyz(rgb) * pixel[4];
+            for (int k = 0; k < 3; ++k)
+                pixel[k] = xyz[k];
+        }
 
-        bitmap()->write(filename, m_file_format);
+        return result;
     }
 
-    bool destination_exists(const fs::path &base_name) const override {
+    /// Append the proper extension for the output file format
+    fs::path output_path(const fs::path &base_name) const {
         std::string proper_extension;
         if (m_file_format == Bitmap::FileFormat::OpenEXR)
             proper_extension = ".exr";
@@ -353,33 +625,115 @@ public:
         if (extension != proper_extension)
             filename.replace_extension(proper_extension);
 
-        return fs::exists(filename);
+        return filename;
     }
 
-    std::string to_string() const override {
-        std::ostringstream oss;
-        oss << "HDRFilm[" << std::endl
-            << "  size = " << m_size        << "," << std::endl
-            << "  crop_size = " << m_crop_size   << "," << std::endl
-            << "  crop_offset = " << m_crop_offset << "," << std::endl
-            << "  high_quality_edges = " << m_high_quality_edges << "," << std::endl
-            << "  filter = " << m_filter << "," << std::endl
-            << "  file_format = " << m_file_format << "," << std::endl
-            << "  pixel_format = " << m_pixel_format << "," << std::endl
-            << "  component_format = " << m_component_format << "," << std::endl
-            << "  dest_file = \"" << m_dest_file << "\"" << std::endl
-            << "]";
-        return oss.str();
+    size_t tile_index(const ScalarVector2i &tile) const {
+        return tile.x() + tile.y() * (size_t) m_tile_count.x();
     }
 
-    MTS_DECLARE_CLASS()
-protected:
+    /// Size of a tile in pixels (smaller at the boundary of the film)
+    ScalarVector2i tile_size(const ScalarVector2i &tile) const {
+        ScalarVector2i offset = tile * (int) m_tile_size;
+        return min(ScalarVector2i((int) m_tile_size), m_crop_size - offset);
+    }
+
+    /**
+     * \brief Mark tiles as written once they are complete, and once all tiles
+     * that can reach them through the reconstruction filter are complete.
+     *
+     * Must be called with \c m_mutex held after \c tile was completed.
+     */
+    void claim_finished_tiles(const ScalarVector2i &tile,
+                              std::vector<ScalarVector2i> &finished) {
+        int reach = ((int) m_filter->border_size() + (int) m_tile_size - 1) /
+                    (int) m_tile_size;
+
+        auto is_complete = [&](const ScalarVector2i &t) {
+            for (int y = std::max(t.y() - reach, 0);
+                 y <= std::min(t.y() + reach, m_tile_count.y() - 1); ++y)
+                for (int x = std::max(t.x() - reach, 0);
+                     x <= std::min(t.x() + reach, m_tile_count.x() - 1); ++x)
+                    if (m_tile_state[tile_index(ScalarVector2i(x, y))] == TileState::Pending)
+                        return false;
+            return true;
+        };
+
+        for (int y = std::max(tile.y() - reach, 0);
+             y <= std::min(tile.y() + reach, m_tile_count.y() - 1); ++y) {
+            for (int x = std::max(tile.x() - reach, 0);
+                 x <= std::min(tile.x() + reach, m_tile_count.x() - 1); ++x) {
+                ScalarVector2i t(x, y);
+                TileState &state = m_tile_state[tile_index(t)];
+                if (state == TileState::Complete && is_complete(t)) {
+                    state = TileState::Written;
+                    finished.push_back(t);
+                }
+            }
+        }
+    }
+
+    /// Convert a tile of the film and pass it to the OpenEXR writer
+    void write_tile(const ScalarVector2i &tile) {
+        ScalarVector2i offset = tile * (int) m_tile_size;
+        ScalarVector2i size = tile_size(tile);
+        size_t channel_count = m_storage->channel_count();
+
+        ref<Bitmap> source = new Bitmap(
+            m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
+                                   : Bitmap::PixelFormat::XYZAW,
+            struct_type_v<ScalarFloat>, size, channel_count);
+
+        const ScalarFloat *src = (const ScalarFloat *) m_storage->data().managed().data();
+        ScalarFloat *dst = (ScalarFloat *) source->data();
+        for (int y = 0; y < size.y(); ++y)
+            memcpy(dst + y * size.x() * channel_count,
+                   src + ((offset.y() + y) * (size_t) m_crop_size.x() + offset.x()) * channel_count,
+                   size.x() * channel_count * sizeof(ScalarFloat));
+
+        ref<Bitmap> target = develop_bitmap(source);
+
+        /* Critical section: create the output file once the layout is known */ {
+            std::lock_guard<std::mutex> guard(m_writer_mutex);
+            if (!m_writer) {
+                if (m_dest_file.empty())
+                    Throw("Destination file not specified, cannot stream tiles.");
+                m_writer = new TiledEXRWriter(output_path(m_dest_file), m_crop_size,
+                                              ScalarVector2u(m_tile_size), target);
+            }
+        }
+
+        m_writer->write(ScalarPoint2u(offset), target);
+    }
+
+    enum class TileState : uint8_t { Pending, Complete, Written };
+
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
     fs::path m_dest_file;
     ref<ImageBlock> m_storage;
     std::vector<std::string> m_channels;
+
+    /// Tile size of OpenEXR output (zero: scanline-based output)
+    uint32_t m_tile_size;
+    /// Stream finished tiles to disk while rendering?
+    bool m_stream;
+    /// Number of times that each pixel is submitted via put()
+    size_t m_pass_count = 1;
+    ScalarVector2i m_tile_count;
+    /// Number of (interior) block pixels received per tile
+    std::vector<size_t> m_tile_pixels;
+    std::vector<TileState> m_tile_state;
+    ref<TiledEXRWriter> m_writer;
+    std::mutex m_mutex, m_writer_mutex;
+
+    /// Denoiser applied when developing the film (if enabled)
+    ref<Denoiser> m_denoiser;
+    /// Names of the AOVs that guide the denoiser
+    std::string m_denoise_albedo, m_denoise_normal, m_denoise_moment;
+    /// Indices of the first channel of each of these AOVs (-1: not present)
+    int m_albedo_channel = -1, m_normal_channel = -1, m_moment_channel = -1;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
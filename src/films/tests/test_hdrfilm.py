@@ -142,3 +142,139 @@ def test03_develop(variant_scalar_rgb, file_format, tmpdir):
             assert ek.allclose(img[:, :, :3], contents[:, :, :3], atol=1e-5)
         # Alpha channel was ignored, alpha and weights should default to 1.0.
         assert ek.allclose(img[:, :, 3:5], 1.0, atol=1e-6)
+
+
+def test04_develop_streaming(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """Submit the image in blocks while tiles are streamed to a tiled OpenEXR file"""
+    np.random.seed(1234)
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="41"/>
+            <integer name="height" value="37"/>
+            <string name="pixel_format" value="rgba"/>
+            <string name="component_format" value="float32"/>
+            <boolean name="stream" value="true"/>
+            <integer name="tile_size" value="16"/>
+            <rfilter type="box"/>
+        </film>""")
+    contents = np.random.uniform(size=(film.size()[1], film.size()[0], 5))
+    contents[:, :, 4] = 1.0
+
+    filename = str(tmpdir.join('test_image.exr'))
+    film.set_destination_file(filename)
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    block_size = 8
+    for y0 in range(0, film.size()[1], block_size):
+        for x0 in range(0, film.size()[0], block_size):
+            w = min(block_size, film.size()[0] - x0)
+            h = min(block_size, film.size()[1] - y0)
+            block = ImageBlock([w, h], 5, film.reconstruction_filter())
+            block.clear()
+            block.set_offset([x0, y0])
+            for y in range(y0, y0 + h):
+                for x in range(x0, x0 + w):
+                    block.put([x + 0.5, y + 0.5], contents[y, x, :])
+            film.put(block)
+
+    film.develop()
+
+    other = Bitmap(filename).convert(Bitmap.PixelFormat.XYZAW, Struct.Type.Float32, srgb_gamma=False)
+    assert ek.allclose(np.array(other, copy=False), contents, atol=1e-5)
+
+
+def test05_develop_denoised(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """Denoise a noisy constant image guided by the albedo AOV"""
+    np.random.seed(1234)
+    contents = np.zeros((24, 32, 8))
+    contents[:, :, 0:3] = 0.5 + 0.05 * np.random.normal(size=(24, 32, 3))
+    contents[:, :, 3:5] = 1.0
+    contents[:, :, 5:8] = 0.5
+
+    images = []
+    for denoise in ['false', 'true']:
+        film = load_string("""<film version="2.0.0" type="hdrfilm">
+                <integer name="width" value="32"/>
+                <integer name="height" value="24"/>
+                <string name="component_format" value="float32"/>
+                <boolean name="denoise" value="{}"/>
+                <rfilter type="box"/>
+            </film>""".format(denoise))
+
+        block = ImageBlock(film.size(), 8, film.reconstruction_filter())
+        block.clear()
+        for y in range(film.size()[1]):
+            for x in range(film.size()[0]):
+                block.put([x + 0.5, y + 0.5], contents[y, x, :])
+
+        film.prepare(['X', 'Y', 'Z', 'A', 'W', 'albedo.R', 'albedo.G', 'albedo.B'])
+        film.put(block)
+
+        filename = str(tmpdir.join('test_image_{}.exr'.format(denoise)))
+        film.set_destination_file(filename)
+        film.develop()
+        images.append(np.array(Bitmap(filename), copy=True))
+
+    # The color channels (R, G, B) are filtered, the AOVs are written unchanged
+    noisy, denoised = images
+    std = lambda img: np.std(img[:, :, 0:3], axis=(0, 1))
+    mean = lambda img: np.mean(img[:, :, 0:3], axis=(0, 1))
+    assert np.all(std(denoised) < 0.25 * std(noisy))
+    assert ek.allclose(mean(denoised), mean(noisy), rtol=2e-2)
+    assert ek.allclose(denoised[:, :, 4:7], noisy[:, :, 4:7])
+
+
+def test06_progressive_streaming(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap
+    import numpy as np
+
+    """Progressive previews must not finalize the output of a streaming film"""
+    images = []
+    for stream in ['false', 'true']:
+        scene = load_string("""<scene version='2.0.0'>
+            <integrator type="path">
+                <boolean name="progressive" value="true"/>
+                <boolean name="preview" value="true"/>
+            </integrator>
+            <sensor type="perspective">
+                <transform name="to_world">
+                    <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                </transform>
+                <film type="hdrfilm">
+                    <integer name="width" value="40"/>
+                    <integer name="height" value="24"/>
+                    <string name="component_format" value="float32"/>
+                    <boolean name="stream" value="{}"/>
+                    <integer name="tile_size" value="16"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="7"/>
+                </sampler>
+            </sensor>
+            <emitter type="constant"/>
+            <shape type="sphere"/>
+        </scene>""".format(stream))
+        sensor = scene.sensors()[0]
+        film = sensor.film()
+        assert film.streams_output() == (stream == 'true')
+
+        filename = str(tmpdir.join('progressive_{}.exr'.format(stream)))
+        film.set_destination_file(filename)
+        assert scene.integrator().render(scene, sensor) is True
+        film.develop()
+        images.append(np.array(Bitmap(filename), copy=True))
+
+    # Passes of 1, 2 and 4 samples with identical seeds yield the same image
+    assert images[0].shape == (24, 40, 4)
+    assert np.mean(images[0][:, :, :3]) > 0
+    assert ek.allclose(images[0], images[1], rtol=1e-4, atol=1e-5)
@@ -1,3 +1,4 @@
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 
@@ -58,6 +59,20 @@ Currently, the following AOVs types are available:
     - :monosp:`sh_normal`: Shading normal.
     - :monosp:`dp_du`, :monosp:`dp_dv`: Position partials wrt. the UV parameterization.
     - :monosp:`duv_dx`, :monosp:`duv_dy`: UV partials wrt. changes in screen-space.
+    - :monosp:`albedo`: Directional albedo of the visible surface (RGB), estimated using one
+      BSDF sample per camera ray.
+    - :monosp:`moment`: Second moment of the luminance computed by the first nested integrator.
+      Together with the image itself, it provides the per-pixel variance.
+
+The albedo, shading normal and moment AOVs can guide the denoiser of the
+:ref:`hdrfilm <film-hdrfilm>` plugin:
+
+.. code-block:: xml
+
+    <integrator type="aov">
+        <string name="aovs" value="albedo:albedo,normal:sh_normal,moment:moment"/>
+        <integrator type="path" name="image"/>
+    </integrator>
 
  */
 
@@ -65,7 +80,7 @@ template <typename Float, typename Spectrum>
 class AOVIntegrator final : public SamplingIntegrator<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(SamplingIntegrator)
-    MTS_IMPORT_TYPES(Scene, Sampler, Medium)
+    MTS_IMPORT_TYPES(Scene, Sampler, Medium, BSDFPtr)
 
     enum class Type {
         Depth,
@@ -77,6 +92,8 @@ public:
         dPdV,
         dUVdx,
         dUVdy,
+        Albedo,
+        Moment,
         IntegratorRGBA
     };
 
@@ -129,6 +146,14 @@ public:
                 m_aov_types.push_back(Type::dUVdy);
                 m_aov_names.push_back(item[0] + ".U");
                 m_aov_names.push_back(item[0] + ".V");
+            } else if (item[1] == "albedo") {
+                m_aov_types.push_back(Type::Albedo);
+                m_aov_names.push_back(item[0] + ".R");
+                m_aov_names.push_back(item[0] + ".G");
+                m_aov_names.push_back(item[0] + ".B");
+            } else if (item[1] == "moment") {
+                m_aov_types.push_back(Type::Moment);
+                m_aov_names.push_back(item[0]);
             } else {
                 Throw("Invalid AOV type \"%s\"!", item[1]);
             }
@@ -151,6 +176,10 @@ public:
 
         if (m_aov_names.empty())
             Log(Warn, "No AOVs were specified!");
+
+        if (m_integrators.empty() &&
+            std::find(m_aov_types.begin(), m_aov_types.end(), Type::Moment) != m_aov_types.end())
+            Throw("The \"moment\" AOV requires a nested integrator!");
     }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
@@ -168,6 +197,10 @@ public:
         si[!active] = zero<SurfaceInteraction3f>();
         size_t ctr = 0;
 
+        // The second moment is only known once the first nested integrator ran
+        Float *moment = nullptr;
+        Float luminance_0 = 0.f;
+
         for (size_t i = 0; i < m_aov_types.size(); ++i) {
             switch (m_aov_types[i]) {
                 case Type::Depth:
@@ -219,31 +252,46 @@ public:
                     *aovs++ = si.duv_dy.y();
                     break;
 
+                case Type::Albedo: {
+                        Float sample_1 = sampler->next_1d(active);
+                        Point2f sample_2 = sampler->next_2d(active);
+
+                        /* The weight of a BSDF sample is an unbiased estimate
+                           of the directional albedo. Rays that left the scene
+                           don't have a BSDF (their shape pointer is null). */
+                        Color3f rgb = 0.f;
+                        if (any_or<true>(active)) {
+                            BSDFContext ctx;
+                            BSDFPtr bsdf = si.bsdf(ray);
+                            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sample_1,
+                                                               sample_2, active);
+                            ENOKI_MARK_USED(bs);
+                            rgb = to_rgb(depolarize(bsdf_val), ray.wavelengths, active);
+                            rgb[!active] = 0.f;
+                        }
+                        *aovs++ = rgb.r(); *aovs++ = rgb.g(); *aovs++ = rgb.b();
+                    }
+                    break;
+
+                case Type::Moment:
+                    moment = aovs++;
+                    break;
+
                 case Type::IntegratorRGBA: {
                         std::pair<Spectrum, Mask> result_sub =
                             m_integrators[ctr].first->sample(scene, sampler, ray, medium, aovs, active);
                         aovs += m_integrators[ctr].second;
 
-                        UnpolarizedSpectrum spec_u = depolarize(result_sub.first);
-
-                        Color3f rgb;
-                        if constexpr (is_monochromatic_v<Spectrum>) {
-                            rgb = spec_u.x();
-                        } else if constexpr (is_rgb_v<Spectrum>) {
-                            rgb = spec_u;
-                        } else {
-                            static_assert(is_spectral_v<Spectrum>);
-                            /// Note: this assumes that sensor used sample_rgb_spectrum() to generate 'ray.wavelengths'
-                            auto pdf = pdf_rgb_spectrum(ray.wavelengths);
-                            spec_u *= select(neq(pdf, 0.f), rcp(pdf), 0.f);
-                            rgb = xyz_to_srgb(spectrum_to_xyz(spec_u, ray.wavelengths, active));
-                        }
+                        Color3f rgb = to_rgb(depolarize(result_sub.first), ray.wavelengths,
+                                             active);
 
                         *aovs++ = rgb.r(); *aovs++ = rgb.g(); *aovs++ = rgb.b();
                         *aovs++ = select(result_sub.second, Float(1.f), Float(0.f));
 
-                        if (ctr == 0)
+                        if (ctr == 0) {
                             result = result_sub;
+                            luminance_0 = luminance(rgb);
+                        }
 
                         ctr++;
                     }
@@ -251,6 +299,9 @@ public:
             }
         }
 
+        if (moment)
+            *moment = sqr(luminance_0);
+
         return result;
     }
 
@@ -280,6 +331,27 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+private:
+    /// Convert a (radiance or reflectance) spectrum into linear sRGB
+    Color3f to_rgb(UnpolarizedSpectrum spec_u, const Wavelength &wavelengths,
+                   Mask active) const {
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            ENOKI_MARK_USED(active);
+            return spec_u.x();
+        } else if constexpr (is_rgb_v<Spectrum>) {
+            ENOKI_MARK_USED(wavelengths);
+            ENOKI_MARK_USED(active);
+            return spec_u;
+        } else {
+            static_assert(is_spectral_v<Spectrum>);
+            /// Note: this assumes that sensor used sample_rgb_spectrum() to generate 'ray.wavelengths'
+            auto pdf = pdf_rgb_spectrum(wavelengths);
+            spec_u *= select(neq(pdf, 0.f), rcp(pdf), 0.f);
+            return xyz_to_srgb(spectrum_to_xyz(spec_u, wavelengths, active));
+        }
+    }
+
 private:
     std::vector<Type> m_aov_types;
     std::vector<std::string> m_aov_names;
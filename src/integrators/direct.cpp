@@ -29,6 +29,11 @@ Direct illumination integrator (:monosp:`direct`)
    - Optional more fine-grained parameter: specifies the number of samples that should be generated
      using the BSDF sampling strategies implemented by the scene's surfaces.
      (Default: set to the value of :monosp:`shading_samples`)
+ * - emitter_candidates
+   - |int|
+   - Number of candidates drawn for each emitter sample, out of which a single one is selected
+     by *resampled importance sampling* and tested for visibility. See the
+     :ref:`path tracer <integrator-path>` for details. (Default: 1)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters.
@@ -68,7 +73,7 @@ or BSDF sampling-only integrator.
 template <typename Float, typename Spectrum>
 class DirectIntegrator : public SamplingIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(SamplingIntegrator, m_hide_emitters)
+    MTS_IMPORT_BASE(SamplingIntegrator, m_hide_emitters, sample_emitter_direction_ris)
     MTS_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
 
     // =============================================================
@@ -95,6 +100,11 @@ public:
         if (m_emitter_samples + m_bsdf_samples == 0)
             Throw("Must have at least 1 BSDF or emitter sample!");
 
+        /// Number of candidates resampled to each emitter sample
+        m_emitter_candidates = props.size_("emitter_candidates", 1);
+        if (m_emitter_candidates == 0)
+            Throw("\"emitter_candidates\" must be positive!");
+
         size_t sum    = m_emitter_samples + m_bsdf_samples;
         m_weight_bsdf = 1.f / (ScalarFloat) m_bsdf_samples;
         m_weight_lum  = 1.f / (ScalarFloat) m_emitter_samples;
@@ -137,20 +147,17 @@ public:
                 Mask active_e = sample_emitter;
                 DirectionSample3f ds;
                 Spectrum emitter_val;
-                std::tie(ds, emitter_val) = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
+                std::tie(ds, emitter_val) = sample_emitter_direction_ris(
+                    scene, si, bsdf, ctx, sampler, m_emitter_candidates, active_e);
                 active_e &= neq(ds.pdf, 0.f);
 
-                // Query the BSDF for that emitter-sampled direction
+                /* Query the BSDF for that emitter-sampled direction and determine
+                   the probability of having sampled that same direction using
+                   BSDF sampling. */
                 Vector3f wo = si.to_local(ds.d);
-
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
+                auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
                 bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
-                /* Determine probability of having sampled that same
-                   direction using BSDF sampling. */
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-
                 Float mis = select(ds.delta, Float(1.f), mis_weight(
                     ds.pdf * m_frac_lum, bsdf_pdf * m_frac_bsdf) * m_weight_lum);
                 result[active_e] += mis * bsdf_val * emitter_val;
@@ -200,7 +207,8 @@ public:
         std::ostringstream oss;
         oss << "DirectIntegrator[" << std::endl
             << "  emitter_samples = " << m_emitter_samples << "," << std::endl
-            << "  bsdf_samples = " << m_bsdf_samples << std::endl
+            << "  bsdf_samples = " << m_bsdf_samples << "," << std::endl
+            << "  emitter_candidates = " << m_emitter_candidates << std::endl
             << "]";
         return oss.str();
     }
@@ -215,6 +223,7 @@ public:
 private:
     size_t m_emitter_samples;
     size_t m_bsdf_samples;
+    size_t m_emitter_candidates;
     ScalarFloat m_frac_bsdf, m_frac_lum;
     ScalarFloat m_weight_bsdf, m_weight_lum;
 };
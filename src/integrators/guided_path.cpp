@@ -0,0 +1,453 @@
+#include <enoki/stl.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include "sdtree.h"
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-guided_path:
+
+Guided path tracer (:monosp:`guided_path`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - bsdf_sampling_fraction
+   - |float|
+   - Probability of sampling the BSDF instead of the learned distribution of incident
+     radiance. (Default: 0.5)
+ * - spatial_threshold
+   - |float|
+   - Scale factor :math:`c` of the number of recorded samples above which a spatial
+     cell is split, which is :math:`c\sqrt{k}` for passes of :math:`k` samples per
+     pixel. (Default: 12000)
+ * - directional_threshold
+   - |float|
+   - Fraction of the energy of a directional distribution above which a quadrant
+     is subdivided. (Default: 0.01)
+ * - adrrs
+   - |bool|
+   - Use the learned incident radiance to drive Russian roulette and splitting of the
+     paths. (Default: |false|)
+ * - max_split
+   - |int|
+   - Maximum number of branches into which a path is split at a single vertex when
+     ``adrrs`` is enabled. (Default: 8)
+
+This integrator extends the :ref:`path tracer <integrator-path>` with the *practical path
+guiding* technique of Müller et al. :cite:`Muller2017Practical`. It learns the distribution of
+incident radiance in the scene while rendering and uses it to sample the directions of the
+path segments, which greatly reduces the noise in scenes where the light reaches most surfaces
+along a few, hard to find paths (e.g. through a narrow opening).
+
+The distribution is stored in a *spatio-directional tree* (SD-tree): a binary tree that
+adaptively subdivides the bounding box of the scene, whose leaves hold quadtrees over the
+sphere of directions. Rendering is always progressive (see the ``progressive`` parameter of
+the sampling integrators): passes of doubling sample counts are rendered one after another,
+each of which records the radiance estimates of its paths into the tree, which then guides
+the next pass. Directions are chosen with probability ``bsdf_sampling_fraction`` by
+sampling the BSDF and otherwise from the tree, and weighted by the combined density of both
+techniques.
+
+When ``adrrs`` is enabled, the learned incident radiance furthermore drives *adjoint-driven
+Russian roulette and splitting* :cite:`Vorba2016Adjoint`: at each vertex, the expected
+contribution of the remainder of the path is compared to that of the path as a whole. Paths
+heading into dark regions are terminated early, while paths that reach bright regions are
+split into several branches, each of which samples its own continuation. Where no estimate is
+available yet (e.g. during the first pass), the usual Russian roulette is used instead.
+
+.. note:: This integrator is only available in scalar variants and does not handle
+   participating media.
+
+ */
+
+template <typename Float, typename Spectrum>
+class GuidedPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_progressive)
+    MTS_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    using SDTree       = mitsuba::SDTree<ScalarFloat>;
+    using DTreeWrapper = typename SDTree::DTreeWrapper;
+
+    GuidedPathIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float>)
+            Throw("The guided_path integrator is only supported in scalar variants!");
+
+        m_bsdf_sampling_fraction = props.float_("bsdf_sampling_fraction", .5f);
+        m_spatial_threshold      = props.float_("spatial_threshold", 12000.f);
+        m_directional_threshold  = props.float_("directional_threshold", .01f);
+        m_adrrs                  = props.bool_("adrrs", false);
+        m_max_split              = props.int_("max_split", 8);
+
+        if (m_bsdf_sampling_fraction < 0.f || m_bsdf_sampling_fraction > 1.f)
+            Throw("\"bsdf_sampling_fraction\" must be in [0, 1]!");
+        if (m_max_split < 1)
+            Throw("\"max_split\" must be at least 1!");
+
+        // The guiding distribution is learned from one pass to the next
+        m_progressive = true;
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        m_sdtree = std::make_unique<SDTree>(scene->bbox());
+        return Base::render(scene, sensor);
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (!is_array_v<Float>) {
+            Spectrum result(0.f);
+
+            /* Guided vertices of all branches of the path, whose radiance is
+               recorded at the end. Branches created by splitting share the
+               vertices before the split. */
+            Vertex vertices[MaxVertices];
+            size_t vertex_count = 0;
+
+            // Add a contribution to the incident radiance of a vertex and its predecessors
+            auto add_radiance = [&](int index, const Spectrum &value) {
+                UnpolarizedSpectrum v = depolarize(value);
+                for (; index >= 0; index = vertices[index].parent)
+                    vertices[index].radiance += select(vertices[index].throughput > 0.f,
+                                                       v / vertices[index].throughput, 0.f);
+            };
+
+            // Branches created by splitting that remain to be traced
+            Branch branches[MaxBranches];
+            size_t branch_count = 0;
+
+            // ---------------------- First intersection ----------------------
+
+            Branch b;
+            b.ray = ray_;
+            b.si = scene->ray_intersect(b.ray, active);
+            b.emitter = b.si.emitter(scene);
+            b.active = active;
+            Mask valid_ray = b.si.is_valid();
+
+            while (true) {
+                // Short-hands for the state of the current branch
+                RayDifferential3f &ray = b.ray;
+                SurfaceInteraction3f &si = b.si;
+                EmitterPtr &emitter = b.emitter;
+                Spectrum &throughput = b.throughput;
+                Float &eta = b.eta;
+                Float &emission_weight = b.emission_weight;
+                Mask &active = b.active;
+
+                for (int &depth = b.depth;; ++depth) {
+                    // Branches resume right after the vertex at which they were split
+                    if (b.resume) {
+                        b.resume = false;
+                    } else {
+                        // -------------- Intersection with emitters --------------
+
+                        if (emitter != nullptr) {
+                            Spectrum emitted = emitter->eval(si, active);
+                            Spectrum contrib = emission_weight * throughput * emitted;
+                            result += contrib;
+
+                            /* The emission is an unweighted estimate of the radiance
+                               incident at the vertex that sampled this direction */
+                            if (b.vertex >= 0 && vertices[b.vertex].depth == depth - 1) {
+                                vertices[b.vertex].radiance += depolarize(emitted);
+                                add_radiance(vertices[b.vertex].parent, contrib);
+                            } else {
+                                add_radiance(b.vertex, contrib);
+                            }
+                        }
+
+                        active &= si.is_valid();
+                        MTS_STATS(stats_record(StatsHistogram::PathDepth, UInt32(depth), active));
+
+                        if (m_adrrs && b.reference > 0.f && b.expected > 0.f) {
+                            /* Adjoint-driven Russian roulette and splitting: keep the
+                               expected contribution of the path, which is estimated
+                               using the learned incident radiance, within a window
+                               around that of the path as a whole */
+                            Float ratio = b.expected / b.reference;
+                            if (ratio < AdrrsWindowMin) {
+                                Mask rr_continue = sampler->next_1d(active) < ratio;
+                                MTS_STATS(stats_count(StatsCounter::RussianRoulette, active && !rr_continue));
+                                active &= rr_continue;
+                                throughput /= ratio;
+                            } else if (ratio > AdrrsWindowMax && active &&
+                                       (uint32_t) depth < (uint32_t) m_max_depth) {
+                                // Split into 'ratio' branches on average
+                                Float split = min(ratio, min((Float) m_max_split,
+                                                             Float(MaxBranches - branch_count + 1)));
+                                size_t count = (size_t) split;
+                                if (sampler->next_1d(active) < split - count)
+                                    count++;
+
+                                throughput /= split;
+                                b.expected = 0.f;
+                                for (size_t i = 1; i < count; ++i) {
+                                    branches[branch_count] = b;
+                                    branches[branch_count++].resume = true;
+                                }
+                            }
+                        } else if (depth > m_rr_depth) {
+                            // Russian roulette, see the 'path' integrator
+                            Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
+                            Mask rr_continue = sampler->next_1d(active) < q;
+                            MTS_STATS(stats_count(StatsCounter::RussianRoulette, active && !rr_continue));
+                            active &= rr_continue;
+                            throughput *= rcp(q);
+                        }
+
+                        if ((uint32_t) depth >= (uint32_t) m_max_depth || !active)
+                            break;
+                    }
+
+                    BSDFContext ctx;
+                    BSDFPtr bsdf = si.bsdf(ray);
+
+                    // Only guide directions at vertices with non-delta components
+                    DTreeWrapper *dtree = nullptr;
+                    if (m_sdtree && has_flag(bsdf->flags(), BSDFFlags::Smooth))
+                        dtree = m_sdtree->dtree(si.p);
+                    Float bsdf_fraction = dtree ? m_bsdf_sampling_fraction : 1.f;
+
+                    // ------------------- Emitter sampling -------------------
+
+                    Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                    if (active_e) {
+                        auto [ds, emitter_val] = scene->sample_emitter_direction(
+                            si, sampler->next_2d(active_e), true, active_e);
+                        active_e &= neq(ds.pdf, 0.f);
+
+                        /* Query the BSDF for that emitter-sampled direction and
+                           determine the density of sampling that same direction
+                           using BSDF or guided sampling */
+                        Vector3f wo = si.to_local(ds.d);
+                        auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                        Float pdf = bsdf_pdf;
+                        if (dtree)
+                            pdf = bsdf_fraction * bsdf_pdf + (1.f - bsdf_fraction) * dtree->pdf(ds.d);
+
+                        Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, pdf));
+                        if (active_e) {
+                            Spectrum contrib = mis * throughput * bsdf_val * emitter_val;
+                            result += contrib;
+                            add_radiance(b.vertex, contrib);
+                        }
+                    }
+
+                    // ---------------- BSDF or guided sampling ----------------
+
+                    BSDFSample3f bs;
+                    Spectrum bsdf_weight;
+
+                    if (sampler->next_1d(active) < bsdf_fraction) {
+                        std::tie(bs, bsdf_weight) = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                                 sampler->next_2d(active), active);
+
+                        /* One-sample MIS: weight non-delta components by the
+                           combined density of both techniques */
+                        if (has_flag(bs.sampled_type, BSDFFlags::Delta)) {
+                            bsdf_weight /= bsdf_fraction;
+                        } else if (dtree) {
+                            Float pdf = bsdf_fraction * bs.pdf +
+                                        (1.f - bsdf_fraction) * dtree->pdf(si.to_world(bs.wo));
+                            bsdf_weight *= select(pdf > 0.f, bs.pdf / pdf, 0.f);
+                            bs.pdf = pdf;
+                        }
+                        bsdf_weight = si.to_world_mueller(bsdf_weight, -bs.wo, si.wi);
+                    } else {
+                        Vector3f wo_world = dtree->sample(sampler->next_2d(active));
+                        bs = BSDFSample3f(si.to_local(wo_world));
+
+                        auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, bs.wo, active);
+                        bs.pdf = bsdf_fraction * bsdf_pdf +
+                                 (1.f - bsdf_fraction) * dtree->pdf(wo_world);
+                        bs.sampled_type = +BSDFFlags::Smooth;
+
+                        bsdf_weight = select(bs.pdf > 0.f, bsdf_val / bs.pdf, 0.f);
+                        bsdf_weight = si.to_world_mueller(bsdf_weight, -bs.wo, si.wi);
+                    }
+
+                    throughput = throughput * bsdf_weight;
+                    active &= any(neq(depolarize(throughput), 0.f));
+                    if (!active)
+                        break;
+
+                    eta *= bs.eta;
+
+                    // Remember guided vertices to record their incident radiance
+                    if (dtree && !has_flag(bs.sampled_type, BSDFFlags::Delta) &&
+                        vertex_count < MaxVertices) {
+                        Vertex &v = vertices[vertex_count];
+                        v.dtree      = dtree;
+                        v.wo         = si.to_world(bs.wo);
+                        v.pdf        = bs.pdf;
+                        v.throughput = depolarize(throughput);
+                        v.radiance   = 0.f;
+                        v.depth      = depth;
+                        v.parent     = b.vertex;
+                        b.vertex     = (int) vertex_count++;
+                    }
+
+                    // Expected contribution of the remainder of the path
+                    b.expected = 0.f;
+                    if (m_adrrs && dtree && !has_flag(bs.sampled_type, BSDFFlags::Delta)) {
+                        b.expected = hmean(depolarize(throughput)) *
+                                     dtree->radiance(si.to_world(bs.wo));
+                        if (!(b.reference > 0.f))
+                            b.reference = b.expected;
+                    }
+
+                    // Intersect the sampled ray against the scene geometry
+                    ray = si.spawn_ray(si.to_world(bs.wo));
+                    SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+
+                    /* Determine probability of having sampled that same
+                       direction using emitter sampling. */
+                    emitter = si_bsdf.emitter(scene, active);
+                    DirectionSample3f ds(si_bsdf, si);
+                    ds.object = emitter;
+
+                    if (emitter != nullptr) {
+                        Float emitter_pdf =
+                            select(!has_flag(bs.sampled_type, BSDFFlags::Delta),
+                                   scene->pdf_emitter_direction(si, ds),
+                                   0.f);
+
+                        emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                    }
+
+                    si = std::move(si_bsdf);
+                }
+
+                if (branch_count == 0)
+                    break;
+                b = branches[--branch_count];
+            }
+
+            // Record the incident radiance estimates into the SD-tree
+            for (size_t i = 0; i < vertex_count; ++i) {
+                const Vertex &v = vertices[i];
+                Float value = hmean(v.radiance) / v.pdf;
+                if (v.pdf > 0.f && std::isfinite(value) && value >= 0.f)
+                    v.dtree->record(v.wo, value);
+            }
+
+            return { result, valid_ray };
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray_);
+            return { 0.f, false };
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("GuidedPathIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  bsdf_sampling_fraction = %f,\n"
+            "  spatial_threshold = %f,\n"
+            "  directional_threshold = %f,\n"
+            "  adrrs = %s,\n"
+            "  max_split = %i\n"
+            "]", m_max_depth, m_rr_depth, m_bsdf_sampling_fraction,
+            m_spatial_threshold, m_directional_threshold,
+            m_adrrs ? "true" : "false", m_max_split);
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    void pass_finished(const Scene * /* scene */, size_t pass,
+                       size_t pass_sample_count) override {
+        if (!m_sdtree)
+            return;
+
+        m_sdtree->refine(m_spatial_threshold * std::sqrt((ScalarFloat) pass_sample_count),
+                         m_directional_threshold, MaxDirectionalDepth);
+
+        Log(Debug, "Path guiding: pass %i, SD-tree has %i spatial leaves and %i directional nodes.",
+            pass, m_sdtree->leaf_count(), m_sdtree->directional_node_count());
+    }
+
+private:
+    /// Path vertex whose incident radiance is recorded into the SD-tree
+    struct Vertex {
+        DTreeWrapper *dtree;
+        ScalarVector3f wo;
+        ScalarFloat pdf;
+        UnpolarizedSpectrum throughput;
+        UnpolarizedSpectrum radiance;
+        int depth;
+        /// Index of the preceding guided vertex of the path, or -1
+        int parent;
+    };
+
+    /// State of a path (branch) at a vertex
+    struct Branch {
+        RayDifferential3f ray;
+        SurfaceInteraction3f si;
+        EmitterPtr emitter = nullptr;
+        Spectrum throughput = Spectrum(1.f);
+        Float eta = 1.f;
+        Float emission_weight = 1.f;
+        Mask active = true;
+        int depth = 1;
+        /// Index of the last guided vertex of the branch, or -1
+        int vertex = -1;
+        /// Expected contribution of the branch and of the whole path (ADRRS)
+        Float expected = 0.f, reference = 0.f;
+        /// Was the branch split off at its current vertex?
+        bool resume = false;
+    };
+
+    static constexpr size_t MaxVertices = 64;
+    static constexpr size_t MaxBranches = 16;
+    static constexpr size_t MaxDirectionalDepth = 20;
+
+    std::unique_ptr<SDTree> m_sdtree;
+    ScalarFloat m_bsdf_sampling_fraction;
+    ScalarFloat m_spatial_threshold;
+    ScalarFloat m_directional_threshold;
+    bool m_adrrs;
+    int m_max_split;
+
+    /// Bounds of the weight window for a window size of 5 (Vorba and Křivánek 2016)
+    static constexpr ScalarFloat AdrrsWindowMin = 2.f / 6.f;
+    static constexpr ScalarFloat AdrrsWindowMax = 5.f * AdrrsWindowMin;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(GuidedPathIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(GuidedPathIntegrator, "Guided path tracer integrator");
+NAMESPACE_END(mitsuba)
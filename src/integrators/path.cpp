@@ -2,6 +2,7 @@
 #include <enoki/stl.h>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/integrator.h>
@@ -30,6 +31,10 @@ Path tracer (:monosp:`path`)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - emitter_candidates
+   - |int|
+   - Number of candidate emitter samples drawn at each vertex, out of which a single one is
+     selected by *resampled importance sampling* for the shadow ray (see below). (Default: 1)
 
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
@@ -63,6 +68,13 @@ sampling to combine BSDF and emitter samples. The main difference in comparison
 to the former plugin is that it considers light paths of arbitrary length to compute
 both direct and indirect illumination.
 
+In scenes with many emitters, most shadow rays are wasted on emitters that contribute little
+to the shaded point. When ``emitter_candidates`` is larger than one, several candidate
+directions are drawn at each vertex without testing their visibility, and a single one of them
+is selected proportionally to its unshadowed contribution (*resampled importance sampling*
+:cite:`Talbot2005Importance`). Only the selected candidate is tested for visibility, which
+reduces the noise per shadow ray at the cost of additional BSDF and emitter evaluations.
+
 .. _sec-path-strictnormals:
 
 .. Commented out for now
@@ -92,10 +104,14 @@ both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, sample_emitter_direction_ris)
     MTS_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
 
-    PathIntegrator(const Properties &props) : Base(props) { }
+    PathIntegrator(const Properties &props) : Base(props) {
+        m_emitter_candidates = props.size_("emitter_candidates", 1);
+        if (m_emitter_candidates == 0)
+            Throw("\"emitter_candidates\" must be positive!");
+    }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
@@ -129,6 +145,7 @@ public:
                 result[active] += emission_weight * throughput * emitter->eval(si, active);
 
             active &= si.is_valid();
+            MTS_STATS(stats_record(StatsHistogram::PathDepth, UInt32(depth), active));
 
             /* Russian roulette: try to keep path weights equal to one,
                while accounting for the solid angle compression at refractive
@@ -136,7 +153,9 @@ public:
                getting stuck (e.g. due to total internal reflection) */
             if (depth > m_rr_depth) {
                 Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
-                active &= sampler->next_1d(active) < q;
+                Mask rr_continue = sampler->next_1d(active) < q;
+                MTS_STATS(stats_count(StatsCounter::RussianRoulette, active && !rr_continue));
+                active &= rr_continue;
                 throughput *= rcp(q);
             }
 
@@ -155,18 +174,16 @@ public:
             Mask active_e = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
 
             if (likely(any_or<true>(active_e))) {
-                auto [ds, emitter_val] = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
+                auto [ds, emitter_val] = sample_emitter_direction_ris(
+                    scene, si, bsdf, ctx, sampler, m_emitter_candidates, active_e);
                 active_e &= neq(ds.pdf, 0.f);
 
-                // Query the BSDF for that emitter-sampled direction
+                /* Query the BSDF for that emitter-sampled direction and determine
+                   the density of sampling that same direction using BSDF sampling */
                 Vector3f wo = si.to_local(ds.d);
-                Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
+                auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
                 bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
-                // Determine density of sampling that same direction using BSDF sampling
-                Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-
                 Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
                 result[active_e] += mis * throughput * bsdf_val * emitter_val;
             }
@@ -216,8 +233,9 @@ public:
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %i,\n"
-            "  rr_depth = %i\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %i,\n"
+            "  emitter_candidates = %i\n"
+            "]", m_max_depth, m_rr_depth, m_emitter_candidates);
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -227,6 +245,9 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+private:
+    /// Number of candidates of the resampled emitter sampling
+    size_t m_emitter_candidates;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(PathIntegrator, MonteCarloIntegrator)
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/simd.h>
+#include <mitsuba/core/vector.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+#include <algorithm>
+#include <vector>
+
+/// @file Photon map with fixed-radius queries for photon mapping integrators.
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Photon map based on a hashed uniform grid
+ *
+ * The grid has a cell size of twice the query radius, hence the sphere
+ * around any query position overlaps at most 2x2x2 cells. Cells are hashed
+ * into a table with about as many buckets as there are photons. The photons
+ * are sorted by bucket (in parallel), and their positions are stored as a
+ * structure of arrays so that a query can compare packets of photons against
+ * the query radius using SIMD instructions.
+ *
+ * \tparam Power
+ *    Type of the (unpolarized) power carried by a photon
+ */
+template <typename Float, typename Power> class PhotonMap {
+public:
+    using Point3f  = Point<Float, 3>;
+    using Vector3f = Vector<Float, 3>;
+    using Point3i  = Point<int32_t, 3>;
+
+    static constexpr size_t PacketSize = Packet<Float>::Size;
+    using FloatP = Packet<Float, PacketSize>;
+
+    struct Photon {
+        /// Position of the photon
+        Point3f p;
+        /// Direction towards the previous vertex of the photon path
+        Vector3f d;
+        /// Power carried by the photon
+        Power power;
+    };
+
+    /// Build a photon map for queries within \c radius
+    PhotonMap(const std::vector<Photon> &photons, Float radius)
+        : m_radius(radius), m_inv_cell_size(.5f / radius) {
+        size_t count = photons.size(), table_size = 1;
+        while (table_size < count)
+            table_size *= 2;
+        m_table_mask = (uint32_t) table_size - 1;
+
+        // Sort the photons by bucket
+        std::vector<std::pair<uint32_t, uint32_t>> keys(count);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, count, GrainSize),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    keys[i] = { hash(cell(photons[i].p)), (uint32_t) i };
+            }
+        );
+        tbb::parallel_sort(keys.begin(), keys.end());
+
+        /* Reorder the photons accordingly. The position arrays are padded
+           with a packet of photons at infinity, so that queries can load
+           full packets at the end of the last bucket. */
+        for (size_t k = 0; k < 3; ++k)
+            m_position[k].resize(count + PacketSize, math::Infinity<Float>);
+        m_direction.resize(count);
+        m_power.resize(count);
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, count, GrainSize),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    const Photon &photon = photons[keys[i].second];
+                    for (size_t k = 0; k < 3; ++k)
+                        m_position[k][i] = photon.p[k];
+                    m_direction[i] = photon.d;
+                    m_power[i] = photon.power;
+                }
+            }
+        );
+
+        // Index of the first photon of each bucket
+        m_bucket_start.resize(table_size + 1);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, table_size + 1, GrainSize),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t h = range.begin(); h != range.end(); ++h)
+                    m_bucket_start[h] = (uint32_t) (std::lower_bound(
+                        keys.begin(), keys.end(), std::make_pair((uint32_t) h, 0u)) - keys.begin());
+            }
+        );
+    }
+
+    /**
+     * \brief Invoke <tt>func(d, power)</tt> for each photon within the
+     * query radius of \c p
+     */
+    template <typename Func> void lookup(const Point3f &p, Func func) const {
+        // Cell containing 'p' and the neighbors closest to it along each axis
+        Point3f q = p * m_inv_cell_size;
+        Point3i base(floor(q)), offset = select(q - floor(q) < .5f, Point3i(-1), Point3i(1));
+
+        uint32_t visited[8];
+        size_t visited_count = 0;
+
+        Float radius_2 = sqr(m_radius);
+        FloatP px(p.x()), py(p.y()), pz(p.z());
+
+        for (int i = 0; i < 8; ++i) {
+            Point3i c = base + Point3i(i & 1, (i >> 1) & 1, i >> 2) * offset;
+            uint32_t h = hash(c);
+
+            // Neighboring cells may collide in the same bucket
+            if (std::find(visited, visited + visited_count, h) != visited + visited_count)
+                continue;
+            visited[visited_count++] = h;
+
+            uint32_t start = m_bucket_start[h], end = m_bucket_start[h + 1];
+            for (uint32_t j = start; j < end; j += PacketSize) {
+                FloatP dx = load_unaligned<FloatP>(m_position[0].data() + j) - px,
+                       dy = load_unaligned<FloatP>(m_position[1].data() + j) - py,
+                       dz = load_unaligned<FloatP>(m_position[2].data() + j) - pz;
+                FloatP dist_2 = dx * dx + dy * dy + dz * dz;
+
+                if (likely(none(dist_2 <= radius_2)))
+                    continue;
+
+                uint32_t n = std::min((uint32_t) PacketSize, end - j);
+                for (uint32_t k = 0; k < n; ++k) {
+                    if (dist_2.coeff(k) <= radius_2)
+                        func(m_direction[j + k], m_power[j + k]);
+                }
+            }
+        }
+    }
+
+    /// Number of stored photons
+    size_t size() const { return m_direction.size(); }
+
+    /// Radius of the queries
+    Float radius() const { return m_radius; }
+
+private:
+    Point3i cell(const Point3f &p) const { return Point3i(floor(p * m_inv_cell_size)); }
+
+    uint32_t hash(const Point3i &c) const {
+        return (((uint32_t) c.x() * 73856093u) ^ ((uint32_t) c.y() * 19349663u) ^
+                ((uint32_t) c.z() * 83492791u)) & m_table_mask;
+    }
+
+private:
+    static constexpr size_t GrainSize = 4096;
+
+    Float m_radius;
+    Float m_inv_cell_size;
+    uint32_t m_table_mask;
+    std::vector<Float> m_position[3];
+    std::vector<Vector3f> m_direction;
+    std::vector<Power> m_power;
+    std::vector<uint32_t> m_bucket_start;
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,447 @@
+#include <enoki/stl.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/sensor.h>
+#include "photonmap.h"
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-photonmapper:
+
+Photon mapper (:monosp:`photonmapper`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). This limit applies to the photon paths as well. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - photon_count
+   - |int|
+   - Number of photons emitted per photon map, i.e. per pass in progressive mode.
+     (Default: 250000)
+ * - radius
+   - |float|
+   - Radius of the density estimation. The default value of zero selects
+     0.5% of the diagonal of the scene's bounding box. (Default: 0)
+ * - alpha
+   - |float|
+   - Fraction of the photons that are kept from one pass to the next in progressive
+     mode, which controls how fast the radius shrinks. (Default: 0.7)
+ * - caustics_only
+   - |bool|
+   - Only use the photon map to render caustics and rely on path tracing for all other light
+     transport (see below). (Default: |false|)
+
+This integrator implements photon mapping :cite:`Jensen1996Global`, which handles the
+*caustics* due to light focused by specular surfaces (e.g. the bottom of a pool or the shadow of
+a glass) much more efficiently than path tracing. In a first step, photons are emitted from the
+light sources (in parallel) and traced through the scene. Whenever a photon hits a non-specular
+surface after at least one bounce, it is stored in a photon map. The radiance leaving a camera
+path vertex is then estimated from the density of the photons within a fixed radius.
+
+By default, camera paths are traced through specular surfaces until they reach a non-specular
+surface, where direct illumination is computed using emitter sampling and the remaining
+(indirect) illumination is estimated using the photon map.
+
+When ``caustics_only`` is enabled, the integrator behaves like the :ref:`path tracer
+<integrator-path>`, except that only photons that were specularly reflected or refracted on all
+of their previous bounces are stored. Their density estimate is added at every non-specular
+vertex of the camera paths, while the corresponding paths (a non-specular vertex, followed by
+specular bounces up to an emitter) are ignored by the path tracer. This is generally the best
+combination for scenes with caustics.
+
+Photon mapping is a biased but consistent method: the image is blurred within the density
+estimation radius. When rendering in ``progressive`` mode (see the sampling integrators), a new
+photon map is traced after every pass, with a radius that shrinks according to the progressive
+photon mapping scheme of Knaus and Zwicker :cite:`Knaus2011Progressive`, so that the image
+converges to the correct solution.
+
+.. note:: This integrator is only available in scalar RGB and monochrome variants and does not
+   handle participating media.
+
+ */
+
+template <typename Float, typename Spectrum>
+class PhotonMapIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_progressive)
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    using PhotonMap = mitsuba::PhotonMap<ScalarFloat, UnpolarizedSpectrum>;
+    using Photon    = typename PhotonMap::Photon;
+
+    PhotonMapIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_array_v<Float> || is_spectral_v<Spectrum>)
+            Throw("The photonmapper integrator is only supported in scalar RGB and "
+                  "monochrome variants!");
+
+        m_photon_count  = props.size_("photon_count", 250000);
+        m_radius        = props.float_("radius", 0.f);
+        m_alpha         = props.float_("alpha", .7f);
+        m_caustics_only = props.bool_("caustics_only", false);
+
+        if (m_photon_count == 0)
+            Throw("\"photon_count\" must be positive!");
+        if (m_radius < 0.f)
+            Throw("\"radius\" must be positive!");
+        if (m_alpha <= 0.f || m_alpha > 1.f)
+            Throw("\"alpha\" must be in (0, 1]!");
+
+        /* Photons are traced with an independent sampler, since the sensor's
+           sampler may generate patterns that are tied to its sample count
+           and to the dimensions consumed by camera paths */
+        m_photon_sampler =
+            PluginManager::instance()->create_object<Sampler>(Properties("independent"));
+    }
+
+    bool render(Scene *scene, Sensor *sensor) override {
+        if (scene->emitters().empty()) {
+            m_photon_map.reset();
+        } else {
+            m_query_radius = m_radius;
+            if (m_query_radius == 0.f)
+                m_query_radius = 5e-3f * norm(scene->bbox().extents());
+            if (!(m_query_radius > 0.f))
+                m_query_radius = 1.f;
+            trace_photons(scene, 0);
+        }
+        return Base::render(scene, sensor);
+    }
+
+    std::pair<Spectrum, Mask> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum>) {
+            RayDifferential3f ray = ray_;
+
+            // MIS weight for intersected emitters (set by prev. iteration)
+            Float emission_weight(1.f);
+
+            Spectrum throughput(1.f), result(0.f);
+
+            /* Whether a non-delta BSDF component was sampled along the path,
+               and whether only delta components were sampled since then */
+            bool smooth_vertex = false, delta_since_smooth = false;
+
+            // ---------------------- First intersection ----------------------
+
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            Mask valid_ray = si.is_valid();
+            EmitterPtr emitter = si.emitter(scene);
+
+            for (int depth = 1;; ++depth) {
+
+                // ---------------- Intersection with emitters ----------------
+
+                /* In caustics mode, paths from a non-specular vertex through
+                   specular surfaces to an emitter are handled by the photons */
+                if (emitter != nullptr && !(m_caustics_only && delta_since_smooth))
+                    result += emission_weight * throughput * emitter->eval(si, active);
+
+                active &= si.is_valid();
+                MTS_STATS(stats_record(StatsHistogram::PathDepth, UInt32(depth), active));
+
+                // Russian roulette, see the 'path' integrator
+                if (depth > m_rr_depth) {
+                    Float q = min(hmax(depolarize(throughput)), .95f);
+                    Mask rr_continue = sampler->next_1d(active) < q;
+                    MTS_STATS(stats_count(StatsCounter::RussianRoulette, active && !rr_continue));
+                    active &= rr_continue;
+                    throughput *= rcp(q);
+                }
+
+                if ((uint32_t) depth >= (uint32_t) m_max_depth || !active)
+                    break;
+
+                BSDFContext ctx;
+                BSDFPtr bsdf = si.bsdf(ray);
+                bool smooth = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                // ------------------- Photon density estimate ------------------
+
+                if (smooth && m_photon_map)
+                    result += throughput * density_estimate(ctx, si, bsdf);
+
+                // --------------------- Emitter sampling ---------------------
+
+                if (smooth) {
+                    auto [ds, emitter_val] = scene->sample_emitter_direction(
+                        si, sampler->next_2d(active), true, active);
+
+                    if (ds.pdf != 0.f) {
+                        Vector3f wo = si.to_local(ds.d);
+                        auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active);
+                        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+                        /* Without 'caustics_only', non-delta components are
+                           never sampled: the photon map accounts for them */
+                        Float mis = (ds.delta || !m_caustics_only)
+                                        ? 1.f : mis_weight(ds.pdf, bsdf_pdf);
+                        result += mis * throughput * bsdf_val * emitter_val;
+                    }
+                }
+
+                // ----------------------- BSDF sampling ----------------------
+
+                if (!m_caustics_only) {
+                    // Only continue the path through the delta components
+                    if (!has_flag(bsdf->flags(), BSDFFlags::Delta))
+                        break;
+                    ctx.type_mask = +BSDFFlags::Delta;
+                }
+
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                   sampler->next_2d(active), active);
+                bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
+
+                throughput = throughput * bsdf_val;
+                active &= any(neq(depolarize(throughput), 0.f));
+                if (!active)
+                    break;
+
+                if (has_flag(bs.sampled_type, BSDFFlags::Delta)) {
+                    delta_since_smooth = smooth_vertex;
+                } else {
+                    smooth_vertex = true;
+                    delta_since_smooth = false;
+                }
+
+                // Intersect the BSDF ray against the scene geometry
+                ray = si.spawn_ray(si.to_world(bs.wo));
+                SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
+
+                /* Determine probability of having sampled that same
+                   direction using emitter sampling. */
+                emitter = si_bsdf.emitter(scene, active);
+                DirectionSample3f ds(si_bsdf, si);
+                ds.object = emitter;
+
+                if (emitter != nullptr) {
+                    Float emitter_pdf =
+                        select(!has_flag(bs.sampled_type, BSDFFlags::Delta),
+                               scene->pdf_emitter_direction(si, ds),
+                               0.f);
+
+                    emission_weight = mis_weight(bs.pdf, emitter_pdf);
+                }
+
+                si = std::move(si_bsdf);
+            }
+
+            return { result, valid_ray };
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(ray_);
+            return { 0.f, false };
+        }
+    }
+
+    std::string to_string() const override {
+        return tfm::format("PhotonMapIntegrator[\n"
+            "  max_depth = %i,\n"
+            "  rr_depth = %i,\n"
+            "  photon_count = %i,\n"
+            "  radius = %f,\n"
+            "  alpha = %f,\n"
+            "  caustics_only = %s\n"
+            "]", m_max_depth, m_rr_depth, m_photon_count, m_radius,
+            m_alpha, m_caustics_only ? "true" : "false");
+    }
+
+    Float mis_weight(Float pdf_a, Float pdf_b) const {
+        pdf_a *= pdf_a;
+        pdf_b *= pdf_b;
+        return select(pdf_a > 0.f, pdf_a / (pdf_a + pdf_b), 0.f);
+    }
+
+    MTS_DECLARE_CLASS()
+
+protected:
+    void pass_finished(const Scene *scene, size_t pass,
+                       size_t /* pass_sample_count */) override {
+        if (!m_photon_map)
+            return;
+
+        // Shrink the radius as in probabilistic progressive photon mapping
+        m_query_radius *= std::sqrt((pass + 1 + m_alpha) / (pass + 2));
+        trace_photons(scene, pass + 1);
+    }
+
+    /// Radiance leaving \c si towards \c si.wi estimated from the photon map
+    Spectrum density_estimate(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                              const BSDF *bsdf) const {
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum>) {
+            UnpolarizedSpectrum value(0.f);
+            m_photon_map->lookup(si.p, [&](const ScalarVector3f &d,
+                                           const UnpolarizedSpectrum &power) {
+                // The BSDF includes the cosine factor, which the flux already accounts for
+                Vector3f wo = si.to_local(d);
+                Float cos_theta = abs(Frame3f::cos_theta(wo));
+                if (cos_theta > 0.f)
+                    value += depolarize(bsdf->eval(ctx, si, wo)) * power / cos_theta;
+            });
+
+            Float scale = rcp(math::Pi<Float> * sqr(m_photon_map->radius()) *
+                              (ScalarFloat) m_photon_count);
+            return unpolarized<Spectrum>(value * scale);
+        } else {
+            ENOKI_MARK_USED(ctx);
+            ENOKI_MARK_USED(si);
+            ENOKI_MARK_USED(bsdf);
+            return 0.f;
+        }
+    }
+
+    /**
+     * \brief Emit \ref m_photon_count photons from the emitters of \c scene
+     * (in parallel) and build a new photon map from the stored photons
+     */
+    void trace_photons(const Scene *scene, size_t pass) {
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum>) {
+            Timer timer;
+            size_t unit_count = (m_photon_count + PhotonsPerUnit - 1) / PhotonsPerUnit;
+            std::vector<std::vector<Photon>> photons(unit_count);
+
+            ThreadEnvironment env;
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, unit_count, 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = m_photon_sampler->clone();
+                    for (size_t i = range.begin(); i != range.end(); ++i) {
+                        sampler->seed(PhotonSeedTag | (pass * unit_count + i));
+                        size_t count = std::min(PhotonsPerUnit, m_photon_count - i * PhotonsPerUnit);
+                        for (size_t j = 0; j < count; ++j)
+                            trace_photon(scene, sampler, photons[i]);
+                    }
+                }
+            );
+
+            std::vector<Photon> merged;
+            size_t stored = 0;
+            for (const auto &p : photons)
+                stored += p.size();
+            merged.reserve(stored);
+            for (auto &p : photons) {
+                merged.insert(merged.end(), p.begin(), p.end());
+                std::vector<Photon>().swap(p);
+            }
+
+            m_photon_map = std::make_unique<PhotonMap>(merged, m_query_radius);
+
+            Log(Debug, "Traced %i photons (%i stored, radius %f) in %s.", m_photon_count,
+                stored, m_query_radius, util::time_string(timer.value()));
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(pass);
+        }
+    }
+
+    /// Trace a single photon path and append its stored photons to \c photons
+    void trace_photon(const Scene *scene, Sampler *sampler,
+                      std::vector<Photon> &photons) const {
+        if constexpr (!is_array_v<Float> && !is_spectral_v<Spectrum>) {
+            // Pick an emitter uniformly
+            const auto &emitters = scene->emitters();
+            Float u = sampler->next_1d();
+            size_t index = std::min((size_t) (u * emitters.size()), emitters.size() - 1);
+            const Emitter *emitter = emitters[index].get();
+
+            auto [ray, weight] = emitter->sample_ray(0.f, sampler->next_1d(),
+                                                     sampler->next_2d(),
+                                                     sampler->next_2d());
+            UnpolarizedSpectrum power = depolarize(weight) * (ScalarFloat) emitters.size();
+
+            // Photons are transported with adjoint BSDFs
+            BSDFContext ctx(TransportMode::Importance);
+
+            for (int depth = 1; (uint32_t) depth <= (uint32_t) m_max_depth; ++depth) {
+                SurfaceInteraction3f si = scene->ray_intersect(ray);
+                if (!si.is_valid())
+                    break;
+
+                BSDFPtr bsdf = si.bsdf();
+                bool smooth = has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+                // Direct illumination is computed using emitter sampling
+                if (smooth && depth > 1)
+                    photons.push_back({ si.p, -ray.d, power });
+
+                // Caustic photons are only specularly reflected or refracted
+                if (m_caustics_only) {
+                    if (!has_flag(bsdf->flags(), BSDFFlags::Delta))
+                        break;
+                    ctx.type_mask = +BSDFFlags::Delta;
+                }
+
+                auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(),
+                                                   sampler->next_2d());
+                UnpolarizedSpectrum new_power = power * depolarize(bsdf_val);
+                if (all(eq(new_power, 0.f)))
+                    break;
+
+                // Russian roulette: keep the photon power about constant
+                if (depth > m_rr_depth) {
+                    Float q = min(hmax(new_power) / hmax(power), .95f);
+                    if (!(sampler->next_1d() < q))
+                        break;
+                    new_power /= q;
+                }
+
+                power = new_power;
+                ray = si.spawn_ray(si.to_world(bs.wo));
+            }
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(photons);
+        }
+    }
+
+private:
+    /// Number of photons traced by each parallel work unit
+    static constexpr size_t PhotonsPerUnit = 4096;
+
+    /**
+     * Tag of the photon sampler seeds. The camera pass seeds image blocks
+     * with <tt>pass * block_count + block_id</tt>, hence untagged work unit
+     * indices would reuse the random numbers of camera paths.
+     */
+    static constexpr uint64_t PhotonSeedTag = 1ull << 63;
+
+    size_t m_photon_count;
+    ScalarFloat m_radius;
+    ScalarFloat m_alpha;
+    bool m_caustics_only;
+
+    ScalarFloat m_query_radius = 0.f;
+    ref<Sampler> m_photon_sampler;
+    std::unique_ptr<PhotonMap> m_photon_map;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(PhotonMapIntegrator, MonteCarloIntegrator)
+MTS_EXPORT_PLUGIN(PhotonMapIntegrator, "Photon mapping integrator");
+NAMESPACE_END(mitsuba)
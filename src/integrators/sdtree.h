@@ -0,0 +1,390 @@
+#pragma once
+
+#include <mitsuba/core/atomic.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/vector.h>
+#include <atomic>
+#include <vector>
+
+/// @file Spatio-directional trees (SD-trees) for path guiding.
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Map a direction onto the unit square
+ *
+ * Uses cylindrical coordinates (cos(theta), phi), which preserve areas: the
+ * uniform density on the sphere maps to the uniform density on the square.
+ */
+template <typename Float>
+Point<Float, 2> dir_to_canonical(const Vector<Float, 3> &d) {
+    Float cos_theta = clamp(d.z(), Float(-1), Float(1)),
+          phi       = std::atan2(d.y(), d.x());
+    if (phi < 0.f)
+        phi += 2.f * math::Pi<Float>;
+    return { clamp((cos_theta + 1.f) * .5f, Float(0), math::OneMinusEpsilon<Float>),
+             clamp(phi * math::InvTwoPi<Float>, Float(0), math::OneMinusEpsilon<Float>) };
+}
+
+/// Inverse of \ref dir_to_canonical()
+template <typename Float>
+Vector<Float, 3> canonical_to_dir(const Point<Float, 2> &p) {
+    Float cos_theta = 2.f * p.x() - 1.f,
+          sin_theta = safe_sqrt(1.f - sqr(cos_theta));
+    auto [sin_phi, cos_phi] = sincos(2.f * math::Pi<Float> * p.y());
+    return { sin_theta * cos_phi, sin_theta * sin_phi, cos_theta };
+}
+
+/**
+ * \brief Quadtree over the directions of the unit sphere (D-tree)
+ *
+ * Each node stores the energy that was recorded in its four quadrants of
+ * the cylindrical parameterization of \ref dir_to_canonical(). Recording is
+ * lock-free and may happen concurrently with sampling, as long as the
+ * structure of the tree does not change.
+ */
+template <typename Float> class DTree {
+public:
+    using Point2f  = Point<Float, 2>;
+    using Vector3f = Vector<Float, 3>;
+
+    struct Node {
+        /// Energy recorded in each quadrant
+        AtomicFloat<Float> sum[4];
+        /// Node index of each quadrant's subtree, zero for leaves
+        uint32_t child[4] = { 0, 0, 0, 0 };
+
+        Node() = default;
+        Node(const Node &node) { *this = node; }
+
+        Node &operator=(const Node &node) {
+            for (size_t i = 0; i < 4; ++i) {
+                sum[i] = (Float) node.sum[i];
+                child[i] = node.child[i];
+            }
+            return *this;
+        }
+
+        bool leaf(size_t i) const { return child[i] == 0; }
+
+        Float total() const {
+            return (Float) sum[0] + (Float) sum[1] + (Float) sum[2] + (Float) sum[3];
+        }
+
+        /// Return the quadrant containing \c p and map \c p into it
+        static size_t quadrant(Point2f &p) {
+            size_t index = 0;
+            for (size_t k = 0; k < 2; ++k) {
+                if (p[k] >= .5f) {
+                    index |= size_t(1) << k;
+                    p[k] -= .5f;
+                }
+                p[k] *= 2.f;
+            }
+            return index;
+        }
+    };
+
+    DTree() : m_nodes(1) { }
+
+    /// Total recorded energy
+    Float total() const { return m_nodes[0].total(); }
+
+    /// Number of nodes
+    size_t node_count() const { return m_nodes.size(); }
+
+    /// Scale the recorded energy by \c factor (not thread-safe)
+    void scale(Float factor) {
+        for (Node &node : m_nodes)
+            for (size_t i = 0; i < 4; ++i)
+                node.sum[i] = (Float) node.sum[i] * factor;
+    }
+
+    /// Atomically add \c value to all nodes containing direction \c d
+    void record(const Vector3f &d, Float value) {
+        Point2f p = dir_to_canonical(d);
+        Node *node = &m_nodes[0];
+        while (true) {
+            size_t i = Node::quadrant(p);
+            node->sum[i] += value;
+            if (node->leaf(i))
+                break;
+            node = &m_nodes[node->child[i]];
+        }
+    }
+
+    /// Density of \ref sample() with respect to solid angle
+    Float pdf(const Vector3f &d) const {
+        if (!(total() > 0.f))
+            return math::InvFourPi<Float>;
+
+        Point2f p = dir_to_canonical(d);
+        const Node *node = &m_nodes[0];
+        Float result = math::InvFourPi<Float>;
+        while (true) {
+            size_t i = Node::quadrant(p);
+            Float node_total = node->total();
+            if (!(node_total > 0.f))
+                return 0.f;
+            result *= 4.f * (Float) node->sum[i] / node_total;
+            if (node->leaf(i))
+                break;
+            node = &m_nodes[node->child[i]];
+        }
+        return result;
+    }
+
+    /// Sample a direction proportionally to the recorded energy
+    Vector3f sample(Point2f u) const {
+        if (!(total() > 0.f))
+            return canonical_to_dir(u);
+
+        const Node *node = &m_nodes[0];
+        Point2f origin(0.f);
+        Float size = 1.f;
+
+        while (true) {
+            // Choose the horizontal half, then the quadrant within it
+            Float s[4];
+            for (size_t i = 0; i < 4; ++i)
+                s[i] = (Float) node->sum[i];
+
+            Float left = s[0] + s[2], right = s[1] + s[3];
+            size_t index = 0;
+            Float p_left = left / (left + right);
+            if (u.x() < p_left) {
+                u.x() /= p_left;
+            } else {
+                u.x() = (u.x() - p_left) / (1.f - p_left);
+                index |= 1;
+            }
+
+            Float p_bottom = s[index] / (s[index] + s[index | 2]);
+            if (u.y() < p_bottom) {
+                u.y() /= p_bottom;
+            } else {
+                u.y() = (u.y() - p_bottom) / (1.f - p_bottom);
+                index |= 2;
+            }
+            u = min(u, math::OneMinusEpsilon<Float>);
+
+            size *= .5f;
+            origin += Point2f(Float(index & 1), Float(index >> 1)) * size;
+
+            if (node->leaf(index))
+                break;
+            node = &m_nodes[node->child[index]];
+        }
+
+        return canonical_to_dir(origin + u * size);
+    }
+
+    /**
+     * \brief Return a tree with the same energy distribution as \c tree
+     * that is subdivided where the energy exceeds \c threshold times the
+     * total, and that holds no energy
+     */
+    static DTree refine(const DTree &tree, Float threshold, size_t max_depth) {
+        DTree result;
+        Float total = tree.total();
+        if (total > 0.f)
+            result.refine_node(tree, 0, 1.f, 0, 1, total, threshold, max_depth);
+        return result;
+    }
+
+private:
+    /**
+     * Create the children of the node \c dst of this tree that contain more
+     * than \c threshold of the energy. \c src is the matching node of the
+     * source tree, or -1 when it is a leaf there, in which case its energy
+     * \c fraction is assumed to be uniformly distributed.
+     */
+    void refine_node(const DTree &tree, int src, Float fraction, uint32_t dst,
+                     size_t depth, Float total, Float threshold, size_t max_depth) {
+        for (size_t i = 0; i < 4; ++i) {
+            int child_src = -1;
+            Float child_fraction = .25f * fraction;
+            if (src >= 0) {
+                const Node &node = tree.m_nodes[src];
+                child_fraction = (Float) node.sum[i] / total;
+                if (!node.leaf(i))
+                    child_src = (int) node.child[i];
+            }
+
+            if (depth < max_depth && child_fraction > threshold) {
+                uint32_t child = (uint32_t) m_nodes.size();
+                m_nodes.emplace_back();
+                m_nodes[dst].child[i] = child;
+                refine_node(tree, child_src, child_fraction, child, depth + 1,
+                            total, threshold, max_depth);
+            }
+        }
+    }
+
+private:
+    std::vector<Node> m_nodes;
+};
+
+/**
+ * \brief Spatio-directional tree in the style of "Practical Path Guiding for
+ * Efficient Light-Transport Simulation" by Müller et al. (2017)
+ *
+ * A binary tree subdivides the bounding box of the scene by alternately
+ * halving its axes. Each leaf holds two directional quadtrees: one to
+ * sample from, which is learned in the previous iteration and read-only,
+ * and one in which the radiance of the current iteration is recorded.
+ *
+ * During an iteration, the structure of both trees is fixed, so that
+ * lookups, sampling and (atomic) recording do not need any locks. \ref
+ * refine() must be called in between iterations, when no other thread
+ * accesses the tree.
+ */
+template <typename Float> class SDTree {
+public:
+    using Point2f        = Point<Float, 2>;
+    using Point3f        = Point<Float, 3>;
+    using Vector3f       = Vector<Float, 3>;
+    using BoundingBox3f  = BoundingBox<Point3f>;
+
+    /// Guiding distributions of a spatial leaf
+    struct DTreeWrapper {
+        DTree<Float> sampling, building;
+        std::atomic<uint64_t> sample_count { 0 };
+        /// Number of samples that were recorded into \c sampling
+        Float sampling_count = 0.f;
+
+        DTreeWrapper() = default;
+        DTreeWrapper(const DTreeWrapper &w)
+            : sampling(w.sampling), building(w.building),
+              sample_count(w.sample_count.load()),
+              sampling_count(w.sampling_count) { }
+
+        /// Sample a direction from the distribution learned so far
+        Vector3f sample(const Point2f &u) const { return sampling.sample(u); }
+
+        /// Density of \ref sample() with respect to solid angle
+        Float pdf(const Vector3f &d) const { return sampling.pdf(d); }
+
+        /**
+         * \brief Estimate of the incident radiance from direction \c d,
+         * based on the distribution learned so far (zero if unknown)
+         */
+        Float radiance(const Vector3f &d) const {
+            if (!(sampling_count > 0.f))
+                return 0.f;
+            return sampling.pdf(d) * sampling.total() / sampling_count;
+        }
+
+        /// Record an estimate of the incident radiance from direction \c d
+        void record(const Vector3f &d, Float value) {
+            building.record(d, value);
+            sample_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    SDTree(const BoundingBox3f &bbox) : m_nodes(1), m_wrappers(1) {
+        // Use a cube so that the spatial subdivision yields well-shaped cells
+        Vector3f extents = bbox.valid() ? bbox.extents() : Vector3f(1.f);
+        Float size = hmax(extents) * (1.f + math::Epsilon<Float>);
+        m_bbox = BoundingBox3f(bbox.valid() ? bbox.min : Point3f(0.f));
+        m_bbox.max = m_bbox.min + Vector3f(size > 0.f ? size : Float(1));
+        m_nodes[0].wrapper = 0;
+    }
+
+    /// Return the guiding distributions of the spatial leaf containing \c p
+    DTreeWrapper *dtree(const Point3f &p) {
+        Point3f q = clamp((p - m_bbox.min) / m_bbox.extents(), 0.f, 1.f);
+        uint32_t index = 0;
+        while (!m_nodes[index].leaf()) {
+            const SNode &node = m_nodes[index];
+            Float &x = q[node.axis];
+            if (x < .5f) {
+                index = node.child[0];
+                x *= 2.f;
+            } else {
+                index = node.child[1];
+                x = (x - .5f) * 2.f;
+            }
+        }
+        return &m_wrappers[m_nodes[index].wrapper];
+    }
+
+    /**
+     * \brief Prepare the tree for the next iteration
+     *
+     * Spatial leaves with more than \c spatial_threshold recorded samples
+     * are split (the children inherit the recorded data). Then, the recorded
+     * distribution of each leaf becomes its sampling distribution, and a
+     * refined, empty tree is created for recording.
+     */
+    void refine(Float spatial_threshold, Float directional_threshold,
+                size_t max_directional_depth) {
+        for (size_t i = 0; i < m_nodes.size(); ++i) {
+            if (!m_nodes[i].leaf())
+                continue;
+            DTreeWrapper &wrapper = m_wrappers[m_nodes[i].wrapper];
+            uint64_t count = wrapper.sample_count.load();
+            if ((Float) count <= spatial_threshold || m_nodes.size() + 2 > MaxNodes)
+                continue;
+
+            /* Split the leaf, its children are visited later on by this loop.
+               Each one inherits half of the recorded samples and energy. */
+            uint32_t wrapper_index = m_nodes[i].wrapper;
+            wrapper.sample_count = count / 2;
+            wrapper.building.scale(.5f);
+            m_wrappers.push_back(m_wrappers[wrapper_index]);
+
+            SNode left, right;
+            left.axis = right.axis = (m_nodes[i].axis + 1) % 3;
+            left.wrapper = wrapper_index;
+            right.wrapper = (uint32_t) m_wrappers.size() - 1;
+
+            m_nodes[i].child[0] = (uint32_t) m_nodes.size();
+            m_nodes[i].child[1] = (uint32_t) m_nodes.size() + 1;
+            m_nodes.push_back(left);
+            m_nodes.push_back(right);
+        }
+
+        for (DTreeWrapper &wrapper : m_wrappers) {
+            wrapper.sampling = wrapper.building;
+            wrapper.sampling_count = (Float) wrapper.sample_count.load();
+            wrapper.building = DTree<Float>::refine(wrapper.building, directional_threshold,
+                                                    max_directional_depth);
+            wrapper.sample_count = 0;
+        }
+    }
+
+    /// Number of spatial leaves
+    size_t leaf_count() const { return m_wrappers.size(); }
+
+    /// Total number of directional nodes of the sampling distributions
+    size_t directional_node_count() const {
+        size_t count = 0;
+        for (const DTreeWrapper &wrapper : m_wrappers)
+            count += wrapper.sampling.node_count();
+        return count;
+    }
+
+private:
+    /// Node of the spatial binary tree
+    struct SNode {
+        /// Indices of the two children, zero for leaves
+        uint32_t child[2] = { 0, 0 };
+        /// Split axis of the node
+        uint32_t axis = 0;
+        /// Index of the guiding distributions of a leaf
+        uint32_t wrapper = 0;
+
+        bool leaf() const { return child[0] == 0; }
+    };
+
+    /// Upper bound on the number of spatial nodes
+    static constexpr size_t MaxNodes = size_t(1) << 24;
+
+    BoundingBox3f m_bbox;
+    std::vector<SNode> m_nodes;
+    std::vector<DTreeWrapper> m_wrappers;
+};
+
+NAMESPACE_END(mitsuba)
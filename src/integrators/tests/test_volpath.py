@@ -0,0 +1,113 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def fog_scene(integrator, medium):
+    """A point light above a cube of fog that contains a diffuse floor"""
+    from mitsuba.core.xml import load_string
+
+    return load_string("""<scene version='2.0.0'>
+        <integrator type="volpath">
+            <integer name="max_depth" value="8"/>
+            {integrator}
+        </integrator>
+        <sensor type="perspective">
+            <transform name="to_world">
+                <lookat origin="0.5, -1.5, 0.8" target="0.5, 0.5, 0.4" up="0, 0, 1"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="24"/>
+                <integer name="height" value="24"/>
+            </film>
+            <sampler type="independent">
+                <integer name="sample_count" value="256"/>
+            </sampler>
+        </sensor>
+        <emitter type="point">
+            <point name="position" x="0.5" y="0.5" z="1.3"/>
+            <rgb name="intensity" value="2"/>
+        </emitter>
+        <!-- The fog fills the unit cube, which is also the extent of constant volumes -->
+        <shape type="cube">
+            <transform name="to_world">
+                <scale value="0.5"/>
+                <translate x="0.5" y="0.5" z="0.5"/>
+            </transform>
+            <bsdf type="null"/>
+            {medium}
+        </shape>
+        <shape type="rectangle">
+            <transform name="to_world">
+                <scale value="0.45"/>
+                <translate x="0.5" y="0.5" z="0.05"/>
+            </transform>
+            <bsdf type="diffuse"/>
+            <ref name="exterior" id="fog"/>
+        </shape>
+    </scene>""".format(integrator=integrator, medium=medium))
+
+
+def homogeneous_fog(extra=""):
+    return """<medium type="homogeneous" name="interior" id="fog">
+        <rgb name="albedo" value="0.8"/>
+        <rgb name="sigma_t" value="1.5"/>
+        <boolean name="has_spectral_extinction" value="false"/>
+        {}
+    </medium>""".format(extra)
+
+
+def render_mean(scene):
+    from mitsuba.core import Bitmap, Struct
+
+    sensor = scene.sensors()[0]
+    assert scene.integrator().render(scene, sensor) is True
+    converted = sensor.film().bitmap(raw=True).convert(
+        Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+    return np.mean(np.array(converted, copy=False), axis=(0, 1))
+
+
+def test01_equiangular(variant_scalar_rgb):
+    # Equiangular sampling only reduces the variance of next event estimation
+    means = [render_mean(fog_scene("""<boolean name="equiangular" value="%s"/>""" % v,
+                                   homogeneous_fog()))
+             for v in ['false', 'true']]
+    assert np.all(means[0][:3] > 0)
+    assert ek.allclose(means[0], means[1], rtol=5e-2)
+
+
+def test02_homogeneous_transmittance(variant_scalar_rgb):
+    # Shadow rays evaluate the transmittance of homogeneous media in closed
+    # form, while they track collisions in heterogeneous media. A constant
+    # heterogeneous medium must produce the same image on average.
+    mean_homogeneous = render_mean(fog_scene("", homogeneous_fog()))
+    mean_heterogeneous = render_mean(fog_scene("", """
+        <medium type="heterogeneous" name="interior" id="fog">
+            <rgb name="albedo" value="0.8"/>
+            <rgb name="sigma_t" value="1.5"/>
+            <boolean name="has_spectral_extinction" value="false"/>
+        </medium>"""))
+    assert np.all(mean_homogeneous[:3] > 0)
+    assert ek.allclose(mean_homogeneous, mean_heterogeneous, rtol=5e-2)
+
+
+def check_spectral_mis():
+    # Chromatic extinction: each channel (or wavelength) has its own free-flight distribution
+    medium = """<medium type="homogeneous" name="interior" id="fog">
+        <rgb name="albedo" value="0.9"/>
+        <rgb name="sigma_t" value="0.3, 1.0, 3.0"/>
+    </medium>"""
+    means = [render_mean(fog_scene("""<boolean name="use_spectral_mis" value="%s"/>""" % v,
+                                   medium))
+             for v in ['false', 'true']]
+    assert np.all(means[0][:3] > 0)
+    assert ek.allclose(means[0], means[1], rtol=5e-2)
+
+
+def test03_spectral_mis_rgb(variant_scalar_rgb):
+    check_spectral_mis()
+
+
+def test04_spectral_mis_spectral(variant_scalar_spectral):
+    check_spectral_mis()
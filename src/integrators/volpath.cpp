@@ -21,6 +21,8 @@ public:
                      Medium, MediumPtr, PhaseFunctionContext)
 
     VolumetricPathIntegrator(const Properties &props) : Base(props) {
+        m_equiangular = props.bool_("equiangular", false);
+        m_use_spectral_mis = props.bool_("use_spectral_mis", true);
     }
 
     MTS_INLINE
@@ -54,6 +56,8 @@ public:
         Float eta(1.f);
 
         Spectrum throughput(1.f), result(0.f);
+        // Ratios of the path pdfs of all channels to that of the hero channel
+        UnpolarizedSpectrum spectral_ratio(1.f);
         MediumPtr medium = initial_medium;
         MediumInteraction3f mi;
 
@@ -100,19 +104,39 @@ public:
                 not_spectral = !is_spectral && active_medium;
             }
 
+            // Distribution of equiangular sampling along the current ray segment
+            Equiangular equiangular;
+            equiangular.active = false;
+
             if (any_or<true>(active_medium)) {
+                /* Equiangular sampling requires the full ray segment and a
+                   closed form transmittance, i.e. a homogeneous medium with a
+                   spectrally constant extinction */
+                Mask act_equiangular = false;
+                if (m_equiangular)
+                    act_equiangular = not_spectral && medium->is_homogeneous() &&
+                                      medium->use_emitter_sampling() &&
+                                      (depth + 1 < (uint32_t) m_max_depth);
+
                 mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
+                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid() &&
+                                 !act_equiangular) = mi.t;
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
                     masked(si, intersect) = scene->ray_intersect(ray, intersect);
                 needs_intersection &= !active_medium;
 
+                if (any_or<true>(act_equiangular))
+                    equiangular = sample_equiangular(scene, sampler, ray, mi, si, medium, channel,
+                                                     throughput, spectral_ratio, result, act_equiangular);
+
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
                 if (any_or<true>(is_spectral)) {
                     auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
                     Float tr_pdf = index_spectrum(free_flight_pdf, channel);
                     masked(throughput, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+                    if (m_use_spectral_mis)
+                        masked(spectral_ratio, is_spectral && tr_pdf > 0.f) *= free_flight_pdf / tr_pdf;
                 }
 
                 escaped_medium = active_medium && !mi.is_valid();
@@ -124,10 +148,13 @@ public:
                 act_null_scatter |= null_scatter && active_medium;
                 act_medium_scatter |= !act_null_scatter && active_medium;
 
-                if (any_or<true>(is_spectral && act_null_scatter))
-                    masked(throughput, is_spectral && act_null_scatter) *=
-                        mi.sigma_n * index_spectrum(mi.combined_extinction, channel) /
-                        index_spectrum(mi.sigma_n, channel);
+                if (any_or<true>(is_spectral && act_null_scatter)) {
+                    UnpolarizedSpectrum weight = mi.sigma_n * index_spectrum(mi.combined_extinction, channel) /
+                                                 index_spectrum(mi.sigma_n, channel);
+                    masked(throughput, is_spectral && act_null_scatter) *= weight;
+                    if (m_use_spectral_mis)
+                        masked(spectral_ratio, is_spectral && act_null_scatter) *= weight / mi.combined_extinction;
+                }
 
                 masked(depth, act_medium_scatter) += 1;
             }
@@ -143,9 +170,14 @@ public:
             }
 
             if (any_or<true>(act_medium_scatter)) {
-                if (any_or<true>(is_spectral))
-                    masked(throughput, is_spectral && act_medium_scatter) *=
-                        mi.sigma_s * index_spectrum(mi.combined_extinction, channel) / index_spectrum(mi.sigma_t, channel);
+                if (any_or<true>(is_spectral)) {
+                    Float weight = index_spectrum(mi.combined_extinction, channel) /
+                                   index_spectrum(mi.sigma_t, channel);
+                    masked(throughput, is_spectral && act_medium_scatter) *= mi.sigma_s * weight;
+                    if (m_use_spectral_mis)
+                        masked(spectral_ratio, is_spectral && act_medium_scatter) *=
+                            mi.sigma_t * weight / mi.combined_extinction;
+                }
                 if (any_or<true>(not_spectral))
                     masked(throughput, not_spectral && act_medium_scatter) *= mi.sigma_s / mi.sigma_t;
 
@@ -160,9 +192,16 @@ public:
 
                 Mask active_e = act_medium_scatter && sample_emitters;
                 if (any_or<true>(active_e)) {
-                    auto [emitted, ds] = sample_emitter(mi, true, scene, sampler, medium, channel, active_e);
+                    auto [emitted, ds] = sample_emitter(mi, true, scene, sampler, medium, channel,
+                                                        spectral_ratio, active_e);
                     Float phase_val = phase->eval(phase_ctx, mi, ds.d, active_e);
-                    masked(result, active_e) += throughput * phase_val * emitted;
+
+                    // MIS with equiangular sampling of the same ray segment
+                    Float weight(1.f);
+                    if (any_or<true>(equiangular.active))
+                        masked(weight, equiangular.active) =
+                            mis_weight(free_flight_pdf(mi, mi.t, channel), equiangular.pdf(mi.t));
+                    masked(result, active_e) += throughput * phase_val * weight * emitted;
                 }
 
                 // ------------------ Phase function sampling -----------------
@@ -187,7 +226,8 @@ public:
                     active_surface && specular_chain && neq(emitter, nullptr);
                 if (any_or<true>(use_emitter_contribution))
                     masked(result, use_emitter_contribution) +=
-                        throughput * emitter->eval(si, use_emitter_contribution);
+                        throughput * spectral_mis_weight(spectral_ratio) *
+                        emitter->eval(si, use_emitter_contribution);
             }
             active_surface &= si.is_valid();
             if (any_or<true>(active_surface)) {
@@ -197,16 +237,15 @@ public:
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
 
                 if (likely(any_or<true>(active_e))) {
-                    auto [emitted, ds] = sample_emitter(si, false, scene, sampler, medium, channel, active_e);
-
-                    // Query the BSDF for that emitter-sampled direction
-                    Vector3f wo       = si.to_local(ds.d);
-                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active_e);
-                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+                    auto [emitted, ds] = sample_emitter(si, false, scene, sampler, medium, channel,
+                                                        spectral_ratio, active_e);
 
-                    // Determine probability of having sampled that same
+                    // Query the BSDF for that emitter-sampled direction and
+                    // determine probability of having sampled that same
                     // direction using BSDF sampling.
-                    Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
+                    Vector3f wo = si.to_local(ds.d);
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+                    bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
                     result[active_e] += throughput * bsdf_val * mis_weight(ds.pdf, select(ds.delta, 0.f, bsdf_pdf)) * emitted;
                 }
 
@@ -240,8 +279,8 @@ public:
                     masked(si_new, intersect2) = scene->ray_intersect(ray, intersect2);
                 needs_intersection &= !intersect2;
 
-                auto [emitted, emitter_pdf] = evaluate_direct_light(si, scene, sampler,
-                                                                    medium, ray, si_new, channel, add_emitter);
+                auto [emitted, emitter_pdf] = evaluate_direct_light(si, scene, sampler, medium, ray, si_new,
+                                                                    channel, spectral_ratio, add_emitter);
                 result += select(add_emitter && neq(emitter_pdf, 0),
                                 mis_weight(bs.pdf, emitter_pdf) * throughput * emitted, 0.0f);
 
@@ -256,10 +295,15 @@ public:
     }
 
 
-    /// Samples an emitter in the scene and evaluates it's attenuated contribution
+    /**
+     * Samples an emitter in the scene and evaluates it's attenuated contribution.
+     * The result includes the spectral MIS weight of the path, whose ratios of
+     * channel pdfs up to the reference interaction are given by \c spectral_ratio.
+     */
     std::tuple<Spectrum, DirectionSample3f>
     sample_emitter(const Interaction3f &ref_interaction, Mask is_medium_interaction, const Scene *scene,
-                          Sampler *sampler, MediumPtr medium, UInt32 channel, Mask active) const {
+                   Sampler *sampler, MediumPtr medium, UInt32 channel,
+                   UnpolarizedSpectrum spectral_ratio, Mask active) const {
         using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
         Spectrum transmittance(1.0f);
 
@@ -290,7 +334,6 @@ public:
 
             if (any_or<true>(active_medium)) {
                 auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = min(mi.t, remaining_dist);
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
                     masked(si, intersect) = scene->ray_intersect(ray, intersect);
@@ -298,14 +341,26 @@ public:
                 masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
                 needs_intersection &= !active_medium;
 
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
-                Mask not_spectral = !is_spectral && active_medium;
+                /* Homogeneous media have no null collisions, hence tracking
+                   would only yield a binary estimate of their transmittance.
+                   Evaluate it in closed form up to the next surface instead. */
+                Mask homogeneous = active_medium && medium->is_homogeneous();
+                if (any_or<true>(homogeneous)) {
+                    Float t = min(remaining_dist, si.t) - mi.mint;
+                    masked(transmittance, homogeneous) *= exp(-t * mi.combined_extinction);
+                    masked(mi.t, homogeneous) = math::Infinity<Float>;
+                }
+
+                Mask is_spectral = medium->has_spectral_extinction() && active_medium && !homogeneous;
+                Mask not_spectral = !is_spectral && active_medium && !homogeneous;
                 if (any_or<true>(is_spectral)) {
                     Float t      = min(remaining_dist, min(mi.t, si.t)) - mi.mint;
                     UnpolarizedSpectrum tr  = exp(-t * mi.combined_extinction);
                     UnpolarizedSpectrum free_flight_pdf = select(si.t < mi.t || mi.t > remaining_dist, tr, tr * mi.combined_extinction);
                     Float tr_pdf = index_spectrum(free_flight_pdf, channel);
                     masked(transmittance, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+                    if (m_use_spectral_mis)
+                        masked(spectral_ratio, is_spectral && tr_pdf > 0.f) *= free_flight_pdf / tr_pdf;
                 }
 
                 // Handle exceeding the maximum distance by medium sampling
@@ -361,15 +416,15 @@ public:
                 masked(medium, has_medium_trans) = si.target_medium(ray.d);
             }
         }
-        return { emitter_val * transmittance, ds };
+        return { emitter_val * transmittance * spectral_mis_weight(spectral_ratio), ds };
     }
 
 
     std::pair<Spectrum, Float>
     evaluate_direct_light(const Interaction3f &ref_interaction, const Scene *scene,
                           Sampler *sampler, MediumPtr medium, Ray3f ray,
-                          const SurfaceInteraction3f &si_ray,
-                          UInt32 channel, Mask active) const {
+                          const SurfaceInteraction3f &si_ray, UInt32 channel,
+                          UnpolarizedSpectrum spectral_ratio, Mask active) const {
         using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
 
         Spectrum emitter_val(0.0f);
@@ -400,6 +455,8 @@ public:
                     auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
                     Float tr_pdf = index_spectrum(free_flight_pdf, channel);
                     masked(transmittance, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
+                    if (m_use_spectral_mis)
+                        masked(spectral_ratio, is_spectral && tr_pdf > 0.f) *= free_flight_pdf / tr_pdf;
                 }
 
                 needs_intersection &= !active_medium;
@@ -459,19 +516,114 @@ public:
                 masked(medium, has_medium_trans) = si.target_medium(ray.d);
             }
         }
-        return { transmittance * emitter_val, emitter_pdf };
+        return { transmittance * emitter_val * spectral_mis_weight(spectral_ratio), emitter_pdf };
     }
 
 
     //! @}
     // =============================================================
 
+    /// Parameters of the equiangular distance distribution along a ray segment
+    struct Equiangular {
+        /// Ray distance of the point closest to the center, and distance to it
+        Float delta, dist;
+        /// Angles subtended by the start and end of the segment
+        Float theta_a, theta_b;
+        /// Extent of the segment along the ray
+        Float t0, t1;
+        Mask active;
+
+        Float pdf(const Float &t) const {
+            return select(active && t >= t0 && t <= t1,
+                          dist / ((theta_b - theta_a) * (sqr(dist) + sqr(t - delta))), 0.f);
+        }
+    };
+
+    /**
+     * One-sample balance heuristic weight over the channels that could have
+     * driven the distance sampling decisions of a path ("hero wavelength"
+     * MIS, Wilkie et al. 2014), given the ratios of their path pdfs to that
+     * of the channel that was actually used.
+     */
+    Float spectral_mis_weight(const UnpolarizedSpectrum &spectral_ratio) const {
+        if (!m_use_spectral_mis)
+            return 1.f;
+        return rcp(hmean(spectral_ratio));
+    }
+
+    /// Density of sampling a real collision at distance \c t in a homogeneous medium
+    Float free_flight_pdf(const MediumInteraction3f &mi, const Float &t, const UInt32 &channel) const {
+        Float sigma_t = index_spectrum(mi.combined_extinction, channel);
+        return sigma_t * exp(-sigma_t * (t - mi.mint));
+    }
+
+    /**
+     * Next event estimation at a distance sampled along the current ray
+     * segment proportionally to the inverse squared distance to a point on an
+     * emitter ("equiangular sampling", Kulla and Fajardo 2012). Its
+     * contribution is combined with the free-flight sampled scattering
+     * events using MIS. Returns the distance distribution for the MIS
+     * weights of the latter.
+     */
+    Equiangular sample_equiangular(const Scene *scene, Sampler *sampler, const Ray3f &ray,
+                                   const MediumInteraction3f &mi, const SurfaceInteraction3f &si,
+                                   MediumPtr medium, UInt32 channel, const Spectrum &throughput,
+                                   const UnpolarizedSpectrum &spectral_ratio, Spectrum &result,
+                                   Mask active) const {
+        Equiangular eq;
+
+        // Center the distribution at a point on a sampled emitter
+        Interaction3f it = zero<Interaction3f>();
+        it.p           = ray(mi.mint);
+        it.time        = ray.time;
+        it.wavelengths = ray.wavelengths;
+        DirectionSample3f ds_center =
+            scene->sample_emitter_direction(it, sampler->next_2d(active), false, active).first;
+        active &= neq(ds_center.pdf, 0.f);
+
+        eq.t0      = mi.mint;
+        eq.t1      = si.t;
+        eq.delta   = dot(ds_center.p - ray.o, ray.d);
+        eq.dist    = norm(ds_center.p - ray(eq.delta));
+        eq.theta_a = atan2(eq.t0 - eq.delta, eq.dist);
+        eq.theta_b = atan2(eq.t1 - eq.delta, eq.dist);
+        active &= eq.dist > 0.f && eq.theta_b > eq.theta_a;
+        eq.active = active;
+
+        Float theta = eq.theta_a + (eq.theta_b - eq.theta_a) * sampler->next_1d(active);
+        Float t     = clamp(eq.delta + eq.dist * tan(theta), eq.t0, eq.t1);
+        Float pdf   = eq.pdf(t);
+
+        MediumInteraction3f mi_eq = mi;
+        mi_eq.t = t;
+        mi_eq.p = ray(t);
+        std::tie(mi_eq.sigma_s, mi_eq.sigma_n, mi_eq.sigma_t) =
+            medium->get_scattering_coefficients(mi_eq, active);
+        UnpolarizedSpectrum tr = exp(-(t - mi.mint) * mi_eq.sigma_t);
+
+        // Scatter at the sampled distance towards a sampled emitter
+        PhaseFunctionContext phase_ctx(sampler);
+        auto phase = mi_eq.medium->phase_function();
+        auto [emitted, ds] = sample_emitter(mi_eq, true, scene, sampler, medium, channel,
+                                            spectral_ratio, active);
+        Float phase_val = phase->eval(phase_ctx, mi_eq, ds.d, active);
+
+        Float weight = select(active && pdf > 0.f,
+                              mis_weight(pdf, free_flight_pdf(mi, t, channel)) / pdf, 0.f);
+        masked(result, active) += throughput * tr * mi_eq.sigma_s * phase_val * weight * emitted;
+
+        return eq;
+    }
+
     std::string to_string() const override {
         return tfm::format("VolumetricSimplePathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  equiangular = %s,\n"
+                           "  use_spectral_mis = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_equiangular ? "true" : "false",
+                           m_use_spectral_mis ? "true" : "false");
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -481,6 +633,11 @@ public:
     };
 
     MTS_DECLARE_CLASS()
+private:
+    /// Use equiangular sampling for emitters in homogeneous media
+    bool m_equiangular;
+    /// Combine the distance sampling decisions of all channels using MIS
+    bool m_use_spectral_mis;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(VolumetricPathIntegrator, MonteCarloIntegrator);
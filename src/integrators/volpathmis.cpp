@@ -284,8 +284,7 @@ public:
                 if (likely(any_or<true>(active_e))) {
                     auto [p_over_f_nee_end, p_over_f_end, emitted, ds] = sample_emitter(si, false, scene, sampler, medium, p_over_f, channel, active_e);
                     Vector3f wo_local       = si.to_local(ds.d);
-                    Spectrum bsdf_val = bsdf->eval(ctx, si, wo_local, active_e);
-                    Float bsdf_pdf =  bsdf->pdf(ctx, si, wo_local, active_e);
+                    auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo_local, active_e);
                     update_weights(p_over_f_nee_end, 1.0f, depolarize(bsdf_val), channel, active_e);
                     update_weights(p_over_f_end, select(ds.delta, 0.f, bsdf_pdf), depolarize(bsdf_val), channel, active_e);
                     masked(result, active_e) += mis_weight(p_over_f_nee_end, p_over_f_end) * emitted;
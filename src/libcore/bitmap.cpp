@@ -7,6 +7,7 @@
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
 #include <tbb/tbb.h>
+#include <mutex>
 #include <unordered_map>
 
 /* libpng */
@@ -36,6 +37,8 @@ extern "C" {
 #include <ImfStandardAttributes.h>
 #include <ImfRgbaYca.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
+#include <ImfTileDescription.h>
 #include <ImfChannelList.h>
 #include <ImfStringAttribute.h>
 #include <ImfIntAttribute.h>
@@ -916,9 +919,23 @@ private:
     ref<Stream> m_stream;
 };
 
-void Bitmap::read_openexr(Stream *stream) {
+/// Initialize OpenEXR's thread pool, which is used to (de-)compress scanlines and tiles
+static void exr_init_thread_pool() {
     if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+        Imf::setGlobalThreadCount(util::core_count());
+}
+
+static Imf::PixelType exr_pixel_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Float32: return Imf::FLOAT;
+        case Struct::Type::Float16: return Imf::HALF;
+        case Struct::Type::UInt32: return Imf::UINT;
+        default: Throw("Unexpected field type!");
+    }
+}
+
+void Bitmap::read_openexr(Stream *stream) {
+    exr_init_thread_pool();
 
     EXRIStream istr(stream);
     Imf::InputFile file(istr);
@@ -1278,21 +1295,24 @@ void Bitmap::read_openexr(Stream *stream) {
     }
 }
 
-void Bitmap::write_openexr(Stream *stream, int quality) const {
-    if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
-
-    PixelFormat pixel_format = m_pixel_format;
+/// Create an OpenEXR header (including the channel list) for the given image layout
+static Imf::Header exr_header(const Bitmap::Vector2u &size, Bitmap::PixelFormat pixel_format,
+                              const Struct *struct_, const Properties &metadata_,
+                              int quality) {
+    using Float    = Bitmap::Float;
+    using Vector3f = Bitmap::Vector3f;
+    using Point3f  = Bitmap::Point3f;
+    using Matrix4f = Bitmap::Matrix4f;
 
-    Properties metadata(m_metadata);
+    Properties metadata(metadata_);
     if (!metadata.has_property("generatedBy"))
         metadata.set_string("generatedBy", "Mitsuba version " MTS_VERSION);
 
     std::vector<std::string> keys = metadata.property_names();
 
     Imf::Header header(
-        (int) m_size.x(),  // width
-        (int) m_size.y(),  // height,
+        (int) size.x(),    // width
+        (int) size.y(),    // height,
         1.f,               // pixelAspectRatio
         Imath::V2f(0, 0),  // screenWindowCenter,
         1.f,               // screenWindowWidth
@@ -1355,7 +1375,8 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
         }
     }
 
-    if (pixel_format == PixelFormat::XYZ || pixel_format == PixelFormat::XYZA) {
+    if (pixel_format == Bitmap::PixelFormat::XYZ ||
+        pixel_format == Bitmap::PixelFormat::XYZA) {
         Imf::addChromaticities(header, Imf::Chromaticities(
             Imath::V2f(1.f, 0.f),
             Imath::V2f(0.f, 1.f),
@@ -1363,25 +1384,28 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
             Imath::V2f(1.f / 3.f, 1.f / 3.f)));
     }
 
+    Imf::ChannelList &channels = header.channels();
+    for (auto field : *struct_)
+        channels.insert(field.name, Imf::Channel(exr_pixel_type(field.type)));
+
+    return header;
+}
+
+void Bitmap::write_openexr(Stream *stream, int quality) const {
+    exr_init_thread_pool();
+
+    Imf::Header header = exr_header(m_size, m_pixel_format, m_struct,
+                                    m_metadata, quality);
+
     size_t pixel_stride = m_struct->size(),
            row_stride = pixel_stride * m_size.x();
 
-    Imf::ChannelList &channels = header.channels();
     Imf::FrameBuffer framebuffer;
     const uint8_t *ptr = uint8_data();
-    for (auto field : *m_struct) {
-        Imf::PixelType comp_type;
-        switch (field.type) {
-            case Struct::Type::Float32: comp_type = Imf::FLOAT; break;
-            case Struct::Type::Float16: comp_type = Imf::HALF; break;
-            case Struct::Type::UInt32: comp_type = Imf::UINT; break;
-            default: Throw("Unexpected field type!");
-        }
-
-        Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
-        channels.insert(field.name, Imf::Channel(comp_type));
-        framebuffer.insert(field.name, slice);
-    }
+    for (auto field : *m_struct)
+        framebuffer.insert(field.name,
+            Imf::Slice(exr_pixel_type(field.type), (char *) (ptr + field.offset),
+                       pixel_stride, row_stride));
 
     EXROStream ostr(stream);
     Imf::OutputFile file(ostr, header);
@@ -1389,6 +1413,125 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
     file.writePixels((int) m_size.y());
 }
 
+// -----------------------------------------------------------------------------
+//   Tiled OpenEXR output
+// -----------------------------------------------------------------------------
+
+struct TiledEXRWriter::TiledEXRWriterPrivate {
+    ref<FileStream> stream;
+    std::unique_ptr<EXROStream> ostream;
+    std::unique_ptr<Imf::TiledOutputFile> file;
+    ref<const Struct> struct_;
+    size_t tiles_written = 0;
+    std::mutex mutex;
+};
+
+TiledEXRWriter::TiledEXRWriter(const fs::path &path, const Vector2u &size,
+                               const Vector2u &tile_size, const Bitmap *prototype,
+                               int quality)
+    : d(new TiledEXRWriterPrivate()), m_path(path), m_size(size),
+      m_tile_size(tile_size) {
+    if (any(eq(tile_size, 0u)) || any(eq(size, 0u)))
+        Throw("TiledEXRWriter: image and tile size must be nonzero!");
+
+    exr_init_thread_pool();
+
+    Imf::Header header = exr_header(size, prototype->pixel_format(), prototype->struct_(),
+                                    prototype->metadata(), quality);
+    header.setTileDescription(
+        Imf::TileDescription(tile_size.x(), tile_size.y(), Imf::ONE_LEVEL));
+
+    // Permit writing tiles in arbitrary order
+    header.lineOrder() = Imf::RANDOM_Y;
+
+    Log(Debug, "Writing tiled OpenEXR file \"%s\" (%ix%i, %ix%i tiles, %s, %s) ..",
+        path.string(), size.x(), size.y(), tile_size.x(), tile_size.y(),
+        prototype->pixel_format(), prototype->component_format());
+
+    d->struct_ = prototype->struct_();
+    d->stream = new FileStream(path, FileStream::ETruncReadWrite);
+    d->ostream.reset(new EXROStream(d->stream));
+    d->file.reset(new Imf::TiledOutputFile(*d->ostream, header));
+}
+
+TiledEXRWriter::~TiledEXRWriter() {
+    try {
+        close();
+    } catch (const std::exception &e) {
+        Log(Warn, "TiledEXRWriter: could not finalize \"%s\": %s", m_path, e.what());
+    }
+}
+
+void TiledEXRWriter::write(const Point2u &offset, const Bitmap *bitmap) {
+    if (*bitmap->struct_() != *d->struct_)
+        Throw("TiledEXRWriter::write(): the bitmap has an incompatible pixel layout!");
+
+    Vector2u end = offset + bitmap->size();
+    if (any(neq(offset % m_tile_size, 0u)) || any(end > m_size) ||
+        any(neq(end % m_tile_size, 0u) & neq(end, m_size)))
+        Throw("TiledEXRWriter::write(): region (offset=%s, size=%s) is not "
+              "aligned to the tile grid!", offset, bitmap->size());
+
+    size_t pixel_stride = d->struct_->size(),
+           row_stride = pixel_stride * bitmap->width();
+
+    // OpenEXR addresses pixels using absolute coordinates
+    const uint8_t *ptr = bitmap->uint8_data() - offset.x() * pixel_stride -
+                         offset.y() * row_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (auto field : *d->struct_)
+        framebuffer.insert(field.name,
+            Imf::Slice(exr_pixel_type(field.type), (char *) (ptr + field.offset),
+                       pixel_stride, row_stride));
+
+    Vector2u tile_start = offset / m_tile_size,
+             tile_end   = (end - 1u) / m_tile_size;
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (!d->file)
+        Throw("TiledEXRWriter::write(): the file was already closed!");
+
+    d->file->setFrameBuffer(framebuffer);
+    d->file->writeTiles((int) tile_start.x(), (int) tile_end.x(),
+                        (int) tile_start.y(), (int) tile_end.y());
+    d->tiles_written += hprod(tile_end - tile_start + 1u);
+}
+
+void TiledEXRWriter::close() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (!d->file)
+        return;
+
+    if (d->tiles_written < tile_count())
+        Log(Warn, "TiledEXRWriter: closing \"%s\" with only %i/%i tiles written!",
+            m_path, d->tiles_written, tile_count());
+
+    d->file.reset();
+    d->ostream.reset();
+    d->stream->close();
+}
+
+size_t TiledEXRWriter::tiles_written() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->tiles_written;
+}
+
+size_t TiledEXRWriter::tile_count() const {
+    return hprod((m_size + m_tile_size - 1u) / m_tile_size);
+}
+
+std::string TiledEXRWriter::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledEXRWriter[" << std::endl
+        << "  path = \"" << m_path << "\"," << std::endl
+        << "  size = " << m_size << "," << std::endl
+        << "  tile_size = " << m_tile_size << "," << std::endl
+        << "  tiles_written = " << tiles_written() << "/" << tile_count() << std::endl
+        << "]";
+    return oss.str();
+}
+
 // -----------------------------------------------------------------------------
 //   JPEG bitmap I/O
 // -----------------------------------------------------------------------------
@@ -2494,5 +2637,6 @@ void Bitmap::static_shutdown() {
 }
 
 MTS_IMPLEMENT_CLASS(Bitmap, Object)
+MTS_IMPLEMENT_CLASS(TiledEXRWriter, Object)
 
 NAMESPACE_END(mitsuba)
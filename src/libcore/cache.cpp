@@ -0,0 +1,270 @@
+#include <mitsuba/core/cache.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#if defined(__WINDOWS__)
+#  include <windows.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+ref<AssetCache> AssetCache::m_instance;
+
+/// Modification time and size of a file, used to detect stale cache entries
+struct FileStamp {
+    int64_t mtime = 0;
+    int64_t size = -1;
+
+    bool operator==(const FileStamp &s) const { return mtime == s.mtime && size == s.size; }
+    bool operator!=(const FileStamp &s) const { return !operator==(s); }
+};
+
+static FileStamp file_stamp(const fs::path &path) {
+    FileStamp stamp;
+#if defined(__WINDOWS__)
+    struct _stati64 sb;
+    if (_wstati64(path.native().c_str(), &sb) != 0)
+        return stamp;
+    stamp.mtime = (int64_t) sb.st_mtime * 1000000000ll;
+#else
+    struct stat sb;
+    if (stat(path.native().c_str(), &sb) != 0)
+        return stamp;
+#  if defined(__OSX__)
+    stamp.mtime = (int64_t) sb.st_mtimespec.tv_sec * 1000000000ll + sb.st_mtimespec.tv_nsec;
+#  else
+    stamp.mtime = (int64_t) sb.st_mtim.tv_sec * 1000000000ll + sb.st_mtim.tv_nsec;
+#  endif
+#endif
+    stamp.size = (int64_t) sb.st_size;
+    return stamp;
+}
+
+struct AssetCache::AssetCachePrivate {
+    struct Entry {
+        std::string path;
+        std::string key;
+        FileStamp stamp;
+        ref<Object> object;
+        size_t size;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    /// Entries sorted from most to least recently used
+    EntryList entries;
+    std::unordered_map<std::string, EntryList::iterator> index;
+    mutable std::mutex mutex;
+
+    bool enabled = true;
+    size_t memory_limit = size_t(4) * 1024 * 1024 * 1024;
+    size_t memory_usage = 0;
+    size_t hit_count = 0;
+    size_t miss_count = 0;
+
+    static std::string id(const std::string &path, const std::string &key) {
+        return path + '\n' + key;
+    }
+
+    void erase(EntryList::iterator it) {
+        memory_usage -= it->size;
+        index.erase(id(it->path, it->key));
+        entries.erase(it);
+    }
+
+    /// Evict least recently used entries until the memory limit is respected
+    void evict() {
+        while (memory_usage > memory_limit && !entries.empty()) {
+            auto it = std::prev(entries.end());
+            Log(Debug, "Evicting \"%s\" (%s) from the asset cache",
+                it->path, util::mem_string(it->size));
+            erase(it);
+        }
+    }
+
+    /// Look up an entry and move it to the front. Requires the lock to be held.
+    ref<Object> find(const std::string &path, const std::string &key,
+                     const FileStamp &stamp) {
+        auto it = index.find(id(path, key));
+        if (it == index.end())
+            return nullptr;
+
+        if (it->second->stamp != stamp) {
+            // The file was modified since it was cached
+            erase(it->second);
+            return nullptr;
+        }
+
+        entries.splice(entries.begin(), entries, it->second);
+        return entries.front().object;
+    }
+
+    /// Insert an entry (replacing any existing one). Requires the lock to be held.
+    void put(const std::string &path, const std::string &key,
+             const FileStamp &stamp, Object *object, size_t size) {
+        auto it = index.find(id(path, key));
+        if (it != index.end())
+            erase(it->second);
+
+        if (size > memory_limit) {
+            Log(Debug, "Not caching \"%s\": size (%s) exceeds the memory limit",
+                path, util::mem_string(size));
+            return;
+        }
+
+        entries.push_front(Entry{ path, key, stamp, object, size });
+        index[id(path, key)] = entries.begin();
+        memory_usage += size;
+        evict();
+    }
+};
+
+AssetCache::AssetCache() : d(new AssetCachePrivate()) { }
+
+AssetCache::~AssetCache() { }
+
+ref<Object> AssetCache::get(const fs::path &path, const std::string &key,
+                            const Loader &loader) {
+    /* Bypass the cache (and its statistics) entirely when it is disabled,
+       without invoking the loader while holding the lock */
+    if (!enabled()) {
+        size_t size = 0;
+        return loader(size);
+    }
+
+    FileStamp stamp = file_stamp(path);
+    std::string path_str = path.string();
+
+    /* critical section */ {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        if (d->enabled && stamp.size >= 0) {
+            ref<Object> result = d->find(path_str, key, stamp);
+            if (result) {
+                d->hit_count++;
+                Log(Debug, "Using cached copy of \"%s\"", path.filename());
+                return result;
+            }
+        }
+        d->miss_count++;
+    }
+
+    /* Decode the asset without holding the lock. Concurrent misses on the
+       same asset may decode it twice, in which case the last one wins. */
+    size_t size = 0;
+    ref<Object> result = loader(size);
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (d->enabled && stamp.size >= 0 && result)
+        d->put(path_str, key, stamp, result, size);
+    return result;
+}
+
+ref<Object> AssetCache::find(const fs::path &path, const std::string &key) {
+    FileStamp stamp = file_stamp(path);
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (!d->enabled || stamp.size < 0)
+        return nullptr;
+    return d->find(path.string(), key, stamp);
+}
+
+void AssetCache::put(const fs::path &path, const std::string &key,
+                     Object *object, size_t size) {
+    FileStamp stamp = file_stamp(path);
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (d->enabled && stamp.size >= 0)
+        d->put(path.string(), key, stamp, object, size);
+}
+
+void AssetCache::set_enabled(bool enabled) {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->enabled = enabled;
+    if (!enabled) {
+        d->entries.clear();
+        d->index.clear();
+        d->memory_usage = 0;
+    }
+}
+
+bool AssetCache::enabled() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->enabled;
+}
+
+void AssetCache::set_memory_limit(size_t limit) {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->memory_limit = limit;
+    d->evict();
+}
+
+size_t AssetCache::memory_limit() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->memory_limit;
+}
+
+size_t AssetCache::memory_usage() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->memory_usage;
+}
+
+size_t AssetCache::entry_count() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->entries.size();
+}
+
+size_t AssetCache::hit_count() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->hit_count;
+}
+
+size_t AssetCache::miss_count() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->miss_count;
+}
+
+std::vector<std::tuple<std::string, std::string, size_t>> AssetCache::entries() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    std::vector<std::tuple<std::string, std::string, size_t>> result;
+    result.reserve(d->entries.size());
+    for (const auto &entry : d->entries)
+        result.emplace_back(entry.path, entry.key, entry.size);
+    return result;
+}
+
+void AssetCache::clear() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->entries.clear();
+    d->index.clear();
+    d->memory_usage = 0;
+}
+
+std::string AssetCache::to_string() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    std::ostringstream oss;
+    oss << "AssetCache[" << std::endl
+        << "  enabled = " << d->enabled << "," << std::endl
+        << "  entries = " << d->entries.size() << "," << std::endl
+        << "  memory_usage = " << util::mem_string(d->memory_usage) << "," << std::endl
+        << "  memory_limit = " << util::mem_string(d->memory_limit) << "," << std::endl
+        << "  hit_count = " << d->hit_count << "," << std::endl
+        << "  miss_count = " << d->miss_count << std::endl
+        << "]";
+    return oss.str();
+}
+
+void AssetCache::static_initialization() {
+    m_instance = new AssetCache();
+}
+
+void AssetCache::static_shutdown() {
+    m_instance = nullptr;
+}
+
+MTS_IMPLEMENT_CLASS(AssetCache, Object)
+
+NAMESPACE_END(mitsuba)
@@ -8,21 +8,254 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Number of call sites tracked by the rate limiter
+#define MTS_LOG_SITE_COUNT 1024
+
+/// A log message or progress update waiting to be passed to the appenders
+struct LogEntry {
+    LogLevel level = Info;
+    /// Formatted message (or formatted progress string)
+    std::string text;
+
+    /* Progress updates only */
+    bool is_progress = false;
+    float progress = 0.f;
+    std::string name, eta;
+    const void *ptr = nullptr;
+
+    void dispatch(const std::vector<ref<Appender>> &appenders) const {
+        for (auto entry : appenders) {
+            if (is_progress)
+                entry->log_progress(progress, name, text, eta, ptr);
+            else
+                entry->append(level, text);
+        }
+    }
+};
+
+/**
+ * Bounded multi-producer queue of log entries (following Dmitry Vyukov's
+ * design). Producers claim a cell by advancing the tail with a CAS and
+ * publish it by updating its sequence number, hence they never block.
+ * Cells are consumed by a single thread at a time (the one holding the
+ * logger's append mutex).
+ */
+struct LogQueue {
+    struct Cell {
+        std::atomic<size_t> seq;
+        LogEntry entry;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> tail { 0 };
+    alignas(64) size_t head = 0;
+
+    LogQueue(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity)
+            size *= 2;
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /// Append an entry. Returns \c false if the queue is full.
+    bool push(LogEntry &&entry) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[pos & mask];
+            size_t seq = cell.seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.entry = std::move(entry);
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Remove the oldest published entry (single consumer only)
+    bool pop(LogEntry &entry) {
+        Cell &cell = cells[head & mask];
+        if (cell.seq.load(std::memory_order_acquire) != head + 1)
+            return false;
+        entry = std::move(cell.entry);
+        cell.entry = LogEntry();
+        cell.seq.store(head + mask + 1, std::memory_order_release);
+        head++;
+        return true;
+    }
+};
+
+/// Per call site state of the rate limiter
+struct LogSite {
+    std::atomic<uint64_t> key { 0 };
+    std::atomic<uint64_t> window { 0 };
+    std::atomic<uint32_t> count { 0 };
+    std::atomic<uint32_t> suppressed { 0 };
+};
+
 struct Logger::LoggerPrivate {
+    /**
+     * Protects the list of appenders and the formatter. It is never held
+     * while calling the appenders, since these may be Python objects that
+     * need the GIL, while a thread holding the GIL may be about to modify
+     * the list of appenders.
+     */
     std::mutex mutex;
+    /// Serializes calls to the appenders and consumption of the queue
+    std::mutex append_mutex;
     LogLevel error_level = Error;
     std::vector<ref<Appender>> appenders;
     ref<Formatter> formatter;
+
+    /* Asynchronous mode */
+    std::unique_ptr<LogQueue> queue;
+    std::atomic<bool> async { false };
+    std::thread drain_thread;
+    std::mutex drain_mutex;
+    std::condition_variable drain_cv;
+    bool drain_stop = false;
+    std::atomic<size_t> dropped { 0 };
+    size_t dropped_reported = 0;
+
+    /* Rate limiting */
+    std::atomic<uint32_t> rate_limit { 0 };
+    std::atomic<uint64_t> rate_interval { 1000 };
+    std::atomic<size_t> suppressed { 0 };
+    LogSite sites[MTS_LOG_SITE_COUNT];
+
+    /// Return a copy of the current list of appenders
+    std::vector<ref<Appender>> appenders_snapshot() {
+        std::lock_guard<std::mutex> guard(mutex);
+        return appenders;
+    }
+
+    /// Pass all pending messages to the appenders. Requires \c append_mutex to be held.
+    void drain() {
+        if (!queue)
+            return;
+        std::vector<ref<Appender>> targets = appenders_snapshot();
+        LogEntry entry;
+        while (queue->pop(entry))
+            entry.dispatch(targets);
+
+        size_t dropped_now = dropped.load(std::memory_order_relaxed);
+        if (dropped_now != dropped_reported) {
+            entry = LogEntry();
+            entry.level = Warn;
+            entry.text = tfm::format("Log queue overflow: %i messages were dropped!",
+                                     dropped_now - dropped_reported);
+            dropped_reported = dropped_now;
+            entry.dispatch(targets);
+        }
+    }
+
+    /// Queue an entry (asynchronous mode) or pass it to the appenders right away
+    void submit(LogEntry &&entry) {
+        if (async.load(std::memory_order_relaxed)) {
+            /* Progress updates are superseded by later ones, hence there is
+               no need to report them when they don't fit */
+            bool is_progress = entry.is_progress;
+            if (!queue->push(std::move(entry)) && !is_progress)
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::vector<ref<Appender>> targets = appenders_snapshot();
+        std::lock_guard<std::mutex> guard(append_mutex);
+        entry.dispatch(targets);
+    }
+
+    void drain_loop() {
+        std::unique_lock<std::mutex> drain_guard(drain_mutex);
+        while (!drain_stop) {
+            drain_guard.unlock();
+            /* critical section */ {
+                std::lock_guard<std::mutex> guard(append_mutex);
+                try {
+                    drain();
+                } catch (const std::exception &e) {
+                    std::cerr << "Caught an exception in a log appender: "
+                              << e.what() << std::endl;
+                }
+            }
+            drain_guard.lock();
+            drain_cv.wait_for(drain_guard, std::chrono::milliseconds(5));
+        }
+    }
+
+    /**
+     * Apply the rate limit to a message from the given call site. Returns
+     * \c false if the message should be discarded, otherwise stores the
+     * number of messages that were discarded since the last one.
+     */
+    bool admit(const char *file, int line, uint32_t &suppressed_before) {
+        uint32_t limit = rate_limit.load(std::memory_order_relaxed);
+        suppressed_before = 0;
+        if (limit == 0 || !file)
+            return true;
+
+        // FNV-1a hash of the file name and line number (never zero)
+        uint64_t key = 14695981039346656037ull;
+        for (const char *c = file; *c; ++c)
+            key = (key ^ (uint8_t) *c) * 1099511628211ull;
+        key = ((key ^ (uint64_t) line) * 1099511628211ull) | 1;
+
+        LogSite *site = nullptr;
+        for (size_t i = 0; i < 8; ++i) {
+            LogSite &s = sites[(key + i) % MTS_LOG_SITE_COUNT];
+            uint64_t k = s.key.load(std::memory_order_relaxed);
+            if (k == 0 && s.key.compare_exchange_strong(k, key, std::memory_order_relaxed))
+                k = key;
+            if (k == key) {
+                site = &s;
+                break;
+            }
+        }
+        if (!site)
+            return true; // Table is full, don't limit
+
+        uint64_t now = (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count(),
+                 window = now / std::max(rate_interval.load(std::memory_order_relaxed), (uint64_t) 1),
+                 prev = site->window.load(std::memory_order_relaxed);
+
+        if (prev != window && site->window.compare_exchange_strong(prev, window, std::memory_order_relaxed))
+            site->count.store(0, std::memory_order_relaxed);
+
+        if (site->count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+            site->suppressed.fetch_add(1, std::memory_order_relaxed);
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        suppressed_before = site->suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
 };
 
 Logger::Logger(LogLevel log_level)
     : m_log_level(log_level), d(new LoggerPrivate()) { }
 
-Logger::~Logger() { }
+Logger::~Logger() {
+    set_async(false);
+}
 
 void Logger::set_formatter(Formatter *formatter) {
     std::lock_guard<std::mutex> guard(d->mutex);
@@ -51,6 +284,63 @@ LogLevel Logger::error_level() const {
     return d->error_level;
 }
 
+void Logger::set_async(bool async, size_t capacity) {
+    if (d->drain_thread.joinable()) {
+        /* critical section */ {
+            std::lock_guard<std::mutex> guard(d->drain_mutex);
+            d->drain_stop = true;
+        }
+        d->drain_cv.notify_one();
+        d->drain_thread.join();
+    }
+
+    std::lock_guard<std::mutex> guard(d->append_mutex);
+    d->async = false;
+    d->drain();
+
+    if (async) {
+        /* The queue is never released while the logger is alive, since other
+           threads may still be about to push into it */
+        if (!d->queue)
+            d->queue.reset(new LogQueue(std::max(capacity, (size_t) 2)));
+        d->drain_stop = false;
+        d->drain_thread = std::thread([this]() { d->drain_loop(); });
+        d->async = true;
+    }
+}
+
+bool Logger::is_async() const {
+    return d->async;
+}
+
+void Logger::flush(bool wait) {
+    if (!d->async.load(std::memory_order_relaxed))
+        return;
+    std::unique_lock<std::mutex> guard(d->append_mutex, std::defer_lock);
+    if (wait)
+        guard.lock();
+    else if (!guard.try_lock())
+        return;
+    d->drain();
+}
+
+void Logger::set_rate_limit(size_t count, float interval) {
+    d->rate_interval = (uint64_t) std::max(interval * 1000.f, 1.f);
+    d->rate_limit = (uint32_t) count;
+}
+
+size_t Logger::rate_limit() const {
+    return d->rate_limit;
+}
+
+size_t Logger::suppressed_count() const {
+    return d->suppressed;
+}
+
+size_t Logger::dropped_count() const {
+    return d->dropped;
+}
+
 #undef Throw
 
 void Logger::log(LogLevel level, const Class *class_, const char *file,
@@ -66,19 +356,31 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
         abort();
     }
 
+    uint32_t suppressed_before;
+    if (!d->admit(file, line, suppressed_before))
+        return;
+
     std::string text = d->formatter->format(level, class_,
         Thread::thread(), file, line, msg);
+    if (suppressed_before > 0)
+        text += tfm::format(" (%i similar messages were suppressed)", suppressed_before);
 
-    std::lock_guard<std::mutex> guard(d->mutex);
-    for (auto entry : d->appenders)
-        entry->append(level, text);
+    LogEntry entry;
+    entry.level = level;
+    entry.text = std::move(text);
+    d->submit(std::move(entry));
 }
 
 void Logger::log_progress(float progress, const std::string &name,
     const std::string &formatted, const std::string &eta, const void *ptr) {
-    std::lock_guard<std::mutex> guard(d->mutex);
-    for (auto entry : d->appenders)
-        entry->log_progress(progress, name, formatted, eta, ptr);
+    LogEntry entry;
+    entry.is_progress = true;
+    entry.progress = progress;
+    entry.name = name;
+    entry.text = formatted;
+    entry.eta = eta;
+    entry.ptr = ptr;
+    d->submit(std::move(entry));
 }
 
 void Logger::add_appender(Appender *appender) {
@@ -93,12 +395,15 @@ void Logger::remove_appender(Appender *appender) {
 }
 
 std::string Logger::read_log() {
-    std::lock_guard<std::mutex> guard(d->mutex);
-    for (auto appender: d->appenders) {
-        if (appender->class_()->derives_from(MTS_CLASS(StreamAppender))) {
-            auto sa = static_cast<StreamAppender *>(appender.get());
-            if (sa->logs_to_file())
-                return sa->read_log();
+    flush();
+    /* critical section */ {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        for (auto appender: d->appenders) {
+            if (appender->class_()->derives_from(MTS_CLASS(StreamAppender))) {
+                auto sa = static_cast<StreamAppender *>(appender.get());
+                if (sa->logs_to_file())
+                    return sa->read_log();
+            }
         }
     }
     Log(Error, "No stream appender with a file attachment could be found");
@@ -125,6 +430,9 @@ void Logger::static_initialization() {
 }
 
 void Logger::static_shutdown() {
+    Logger *logger = Thread::thread()->logger();
+    if (logger)
+        logger->set_async(false);
     Thread::thread()->set_logger(nullptr);
 }
 
@@ -149,6 +457,12 @@ void Throw(LogLevel level, const Class *theClass, const char *file,
     util::trap_debugger();
     #endif
 
+    /* Emit pending asynchronous messages before the exception, waiting for
+       the drain thread if it is currently invoking the appenders */
+    Logger *logger = Thread::thread()->logger();
+    if (logger)
+        logger->flush();
+
     DefaultFormatter formatter;
     formatter.set_has_date(false);
     formatter.set_has_log_level(false);
@@ -0,0 +1,279 @@
+#include <mitsuba/core/numa.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <tbb/task_scheduler_observer.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#if defined(__LINUX__)
+#  include <sched.h>
+#  include <unistd.h>
+#elif defined(__WINDOWS__)
+#  include <windows.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+NAMESPACE_BEGIN(numa)
+
+struct Topology {
+    std::vector<std::vector<int>> nodes;
+    std::vector<int> cpu_to_node;
+};
+
+#if defined(__LINUX__)
+/// Parse a list of the form "0-3,8,10-11" as used by sysfs
+static std::vector<int> parse_list(const std::string &str) {
+    std::vector<int> result;
+    for (const std::string &item : string::tokenize(str, ",\n ")) {
+        auto range = string::tokenize(item, "-");
+        if (range.empty())
+            continue;
+        int first = std::stoi(range[0]),
+            last = range.size() > 1 ? std::stoi(range[1]) : first;
+        for (int i = first; i <= last; ++i)
+            result.push_back(i);
+    }
+    return result;
+}
+
+static std::string read_sysfs(const std::string &path) {
+    std::ifstream is(path);
+    std::string line;
+    if (is.good())
+        std::getline(is, line);
+    return line;
+}
+#endif
+
+static Topology detect_topology() {
+    Topology topo;
+
+#if defined(__LINUX__)
+    // Processors that this process may use
+    int cpu_count = std::max((int) sysconf(_SC_NPROCESSORS_CONF), 1);
+    std::vector<bool> allowed(cpu_count, true);
+    size_t size = CPU_ALLOC_SIZE(cpu_count);
+    cpu_set_t *cpuset = CPU_ALLOC(cpu_count);
+    if (cpuset) {
+        CPU_ZERO_S(size, cpuset);
+        if (sched_getaffinity(0, size, cpuset) == 0) {
+            for (int i = 0; i < cpu_count; ++i)
+                allowed[i] = CPU_ISSET_S(i, size, cpuset);
+        }
+        CPU_FREE(cpuset);
+    }
+
+    try {
+        for (int node : parse_list(read_sysfs("/sys/devices/system/node/online"))) {
+            std::vector<int> cpus;
+            for (int cpu : parse_list(read_sysfs(tfm::format(
+                     "/sys/devices/system/node/node%i/cpulist", node)))) {
+                if (cpu < cpu_count && allowed[cpu])
+                    cpus.push_back(cpu);
+            }
+            if (!cpus.empty())
+                topo.nodes.push_back(cpus);
+        }
+    } catch (const std::exception &) {
+        topo.nodes.clear();
+    }
+
+    if (topo.nodes.empty()) {
+        std::vector<int> cpus;
+        for (int i = 0; i < cpu_count; ++i)
+            if (allowed[i])
+                cpus.push_back(i);
+        topo.nodes.push_back(cpus);
+    }
+#elif defined(__WINDOWS__)
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest)) {
+        for (ULONG node = 0; node <= highest; ++node) {
+            ULONGLONG mask = 0;
+            if (!GetNumaNodeProcessorMask((UCHAR) node, &mask))
+                continue;
+            std::vector<int> cpus;
+            for (int i = 0; i < 64; ++i)
+                if (mask & (1ull << i))
+                    cpus.push_back(i);
+            if (!cpus.empty())
+                topo.nodes.push_back(cpus);
+        }
+    }
+#endif
+
+    if (topo.nodes.empty()) {
+        std::vector<int> cpus;
+        for (int i = 0; i < util::core_count(); ++i)
+            cpus.push_back(i);
+        topo.nodes.push_back(cpus);
+    }
+
+    int max_cpu = 0;
+    for (const auto &cpus : topo.nodes)
+        for (int cpu : cpus)
+            max_cpu = std::max(max_cpu, cpu);
+    topo.cpu_to_node.resize(max_cpu + 1, 0);
+    for (size_t i = 0; i < topo.nodes.size(); ++i)
+        for (int cpu : topo.nodes[i])
+            topo.cpu_to_node[cpu] = (int) i;
+
+    return topo;
+}
+
+static const Topology &topology() {
+    static Topology topo = detect_topology();
+    return topo;
+}
+
+static std::atomic<bool> numa_enabled { true };
+
+size_t node_count() {
+    return topology().nodes.size();
+}
+
+const std::vector<int> &node_cpus(size_t node) {
+    const Topology &topo = topology();
+    if (node >= topo.nodes.size())
+        Throw("numa::node_cpus(): node index %i is out of bounds!", node);
+    return topo.nodes[node];
+}
+
+size_t current_node() {
+    const Topology &topo = topology();
+    int cpu = -1;
+#if defined(__LINUX__)
+    cpu = sched_getcpu();
+#elif defined(__WINDOWS__)
+    cpu = (int) GetCurrentProcessorNumber();
+#endif
+    if (cpu < 0 || cpu >= (int) topo.cpu_to_node.size())
+        return 0;
+    return (size_t) topo.cpu_to_node[cpu];
+}
+
+void set_enabled(bool enabled) {
+    numa_enabled = enabled;
+}
+
+bool enabled() {
+    return numa_enabled && node_count() > 1;
+}
+
+size_t node_thread_count(size_t node) {
+    const Topology &topo = topology();
+    size_t nodes = topo.nodes.size(), total_cpus = 0;
+    for (const auto &cpus : topo.nodes)
+        total_cpus += cpus.size();
+    size_t total = std::max(__global_thread_count, nodes);
+
+    // Proportional allocation, the remainder is assigned to the first nodes
+    std::vector<size_t> counts(nodes);
+    size_t assigned = 0;
+    for (size_t i = 0; i < nodes; ++i) {
+        counts[i] = std::max((size_t) 1, total * topo.nodes[i].size() / total_cpus);
+        assigned += counts[i];
+    }
+    for (size_t i = 0; assigned < total; i = (i + 1) % nodes, ++assigned)
+        counts[i]++;
+
+    return counts[std::min(node, nodes - 1)];
+}
+
+/// Pins workers to a node while they execute tasks of the node's arena
+class NodeObserver : public tbb::task_scheduler_observer {
+public:
+    NodeObserver(tbb::task_arena &arena, int node)
+        : tbb::task_scheduler_observer(arena), m_node(node) {
+        observe(true);
+    }
+
+    ~NodeObserver() { observe(false); }
+
+    void on_scheduler_entry(bool is_worker) override {
+        Thread *thread = Thread::thread();
+        if (is_worker && thread)
+            thread->set_numa_node(m_node);
+    }
+
+    void on_scheduler_exit(bool is_worker) override {
+        Thread *thread = Thread::thread();
+        if (is_worker && thread)
+            thread->set_numa_node(-1);
+    }
+
+private:
+    int m_node;
+};
+
+struct NodeArena {
+    std::unique_ptr<tbb::task_arena> arena;
+    std::unique_ptr<NodeObserver> observer;
+    size_t thread_count = 0;
+};
+
+static std::mutex arena_mutex;
+static std::vector<NodeArena> arenas;
+
+void parallel_for_nodes(const std::function<void(size_t)> &func) {
+    if (!enabled()) {
+        func(0);
+        return;
+    }
+
+    size_t nodes = node_count();
+    std::lock_guard<std::mutex> guard(arena_mutex);
+    if (arenas.size() != nodes)
+        arenas.resize(nodes);
+
+    for (size_t i = 0; i < nodes; ++i) {
+        NodeArena &na = arenas[i];
+        size_t thread_count = node_thread_count(i);
+        if (na.arena && na.thread_count == thread_count)
+            continue;
+        na.observer.reset();
+        na.arena.reset(new tbb::task_arena((int) thread_count));
+        na.arena->initialize();
+        na.observer.reset(new NodeObserver(*na.arena, (int) i));
+        na.thread_count = thread_count;
+        Log(Debug, "NUMA node %i: %i threads on %i processors", i, thread_count,
+            node_cpus(i).size());
+    }
+
+    std::vector<tbb::task_group> groups(nodes);
+    for (size_t i = 0; i < nodes; ++i)
+        arenas[i].arena->execute([&, i]() { groups[i].run([&, i]() { func(i); }); });
+
+    std::exception_ptr exception;
+    for (size_t i = 0; i < nodes; ++i) {
+        try {
+            arenas[i].arena->execute([&, i]() { groups[i].wait(); });
+        } catch (...) {
+            if (!exception)
+                exception = std::current_exception();
+        }
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void static_shutdown() {
+    std::lock_guard<std::mutex> guard(arena_mutex);
+    for (NodeArena &na : arenas) {
+        na.observer.reset();
+        if (na.arena)
+            na.arena->terminate();
+        na.arena.reset();
+    }
+    arenas.clear();
+}
+
+NAMESPACE_END(numa)
+NAMESPACE_END(mitsuba)
@@ -4,6 +4,9 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/timeline.h>
 #include <mutex>
 #include <unordered_map>
 
@@ -106,6 +109,7 @@ struct PluginManager::PluginManagerPrivate {
 
         if (fs::exists(resolved)) {
             Log(Info, "Loading plugin \"%s\" ..", filename.string());
+            ScopedTimelineEvent timeline_event("plugin", name);
             Plugin *plugin = new Plugin(resolved);
             // New classes must be registered within the class hierarchy
             Class::static_initialization();
@@ -136,8 +140,11 @@ void PluginManager::register_python_plugin(const std::string &plugin_name) {
 
 ref<Object> PluginManager::create_object(const Properties &props, const Class *class_) {
     Assert(class_ != nullptr);
-    if (class_->name() == "Scene")
-       return class_->construct(props);
+    if (class_->name() == "Scene") {
+        ref<Object> scene = class_->construct(props);
+        Profiler::register_object(scene.get(), "scene");
+        return scene;
+    }
 
     const Class *plugin_class;
 
@@ -163,6 +170,12 @@ ref<Object> PluginManager::create_object(const Properties &props, const Class *c
               oc->name(), oc->variant());
     }
 
+    // Label used to attribute profiler samples to this plugin instance
+    std::string label = props.plugin_name();
+    if (!props.id().empty() && !string::starts_with(props.id(), "_unnamed_"))
+        label += ":" + props.id();
+    Profiler::register_object(object.get(), label);
+
    return object;
 }
 
@@ -1,4 +1,5 @@
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
 
@@ -7,32 +8,102 @@
 #include <signal.h>
 #include <stdio.h>
 #include <tbb/tbb.h>
+#include <algorithm>
 #include <array>
 #include <map>
+#include <mutex>
+#include <new>
+#include <set>
+#include <sstream>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
-static thread_local uint64_t profiler_flags_storage = 0;
-uint64_t *profiler_flags() { return &profiler_flags_storage; }
+static thread_local ProfilerStack profiler_stack_storage;
+ProfilerStack *profiler_stack() { return &profiler_stack_storage; }
+
+/// Sampling interval of the profiler in microseconds (100 Hz)
+static constexpr uint64_t profiler_interval_us = 1000000 / 100;
 
 struct ProfilerSample {
-    uint64_t flags = (uint64_t) -1;
+    bool used = false;
+    uint64_t flags = 0;
+    uint32_t depth = 0;
+    ProfilerFrame frames[MTS_PROFILE_MAX_DEPTH] { };
     uint64_t count = 0;
 };
 
 static std::array<ProfilerSample, MTS_PROFILE_HASH_SIZE> profiler_samples;
+static std::atomic<bool> profiler_recording { false };
+static std::atomic<uint64_t> profiler_dropped { 0 };
+static bool profiler_handler_installed = false;
+
+/* The label storage is intentionally leaked, since objects may still be
+   destroyed (and unregistered) during static destruction */
+static std::mutex &profiler_labels_mutex() {
+    static std::mutex *mutex = new std::mutex();
+    return *mutex;
+}
+
+static std::unordered_map<uint32_t, std::string> &profiler_labels() {
+    static auto *labels = new std::unordered_map<uint32_t, std::string>();
+    return *labels;
+}
+
+/// Counter used to generate the IDs of labeled instances (requires the lock)
+static uint32_t profiler_id_counter = 0;
+
+/// Lock-free list of IDs of destroyed instances, whose labels are discarded by \ref Profiler::reset()
+struct ProfilerDeadLabel {
+    uint32_t id;
+    ProfilerDeadLabel *next;
+};
 
+static std::atomic<ProfilerDeadLabel *> profiler_dead_labels { nullptr };
+
+static uint64_t profiler_hash(uint64_t flags, uint32_t depth,
+                              const ProfilerFrame *frames) {
+    // FNV-1a style hash over the phase bitmask and all stack frames
+    uint64_t hash = 0xcbf29ce484222325ull ^ flags;
+    for (uint32_t i = 0; i < depth; ++i) {
+        hash = (hash ^ (uint64_t) frames[i].phase) * 0x100000001b3ull;
+        hash = (hash ^ (uint64_t) frames[i].object) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static bool profiler_match(const ProfilerSample &sample, uint64_t flags,
+                           uint32_t depth, const ProfilerFrame *frames) {
+    if (sample.flags != flags || sample.depth != depth)
+        return false;
+    for (uint32_t i = 0; i < depth; ++i) {
+        if (sample.frames[i].phase != frames[i].phase ||
+            sample.frames[i].object != frames[i].object)
+            return false;
+    }
+    return true;
+}
+
+/* Note: this function runs in a signal handler and must not allocate memory,
+   acquire locks or call into the logger. */
 static void profiler_callback(int, siginfo_t *, void *) {
-    uint64_t flags = *profiler_flags();
+    if (!profiler_recording.load(std::memory_order_relaxed))
+        return;
+
+    const ProfilerStack *stack = profiler_stack();
+    uint32_t depth = std::min(stack->depth, (uint32_t) MTS_PROFILE_MAX_DEPTH);
+    std::atomic_signal_fence(std::memory_order_acquire);
+    uint64_t flags = stack->flags;
+    const ProfilerFrame *frames = stack->frames;
 
     uint64_t bucket_id =
-        std::hash<uint64_t>{}(flags) % (profiler_samples.size() - 1);
+        profiler_hash(flags, depth, frames) % profiler_samples.size();
 
     // Hash table with linear probing
     size_t tries = 0;
     while (tries < profiler_samples.size()) {
         ProfilerSample &bucket = profiler_samples[bucket_id];
-        if (bucket.flags == (uint64_t) -1 || bucket.flags == flags)
+        if (!bucket.used || profiler_match(bucket, flags, depth, frames))
             break;
         if (++bucket_id == profiler_samples.size())
             bucket_id = 0;
@@ -40,49 +111,253 @@ static void profiler_callback(int, siginfo_t *, void *) {
     }
 
     if (tries == profiler_samples.size()) {
-        Log(Warn, "Profiler hash table filled up -- you may need to increase "
-                  "MTS_PROFILE_HASH_SIZE.");
+        profiler_dropped++;
         return;
     }
 
     ProfilerSample &bucket = profiler_samples[bucket_id];
-    bucket.flags = flags;
+    if (!bucket.used) {
+        bucket.flags = flags;
+        bucket.depth = depth;
+        for (uint32_t i = 0; i < depth; ++i)
+            bucket.frames[i] = frames[i];
+        bucket.used = true;
+    }
     bucket.count++;
 }
 
+static void profiler_set_timer(long interval_us) {
+    itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = interval_us;
+    timer.it_value = timer.it_interval;
+
+    if (setitimer(ITIMER_PROF, &timer, nullptr))
+        Throw("Profiler: failure in setitimer(): %s", strerror(errno));
+}
+
 void Profiler::static_initialization() {
-    if (!util::detect_debugger()) {
-        (void) profiler_flags();
+    start();
+}
 
+void Profiler::static_shutdown() {
+    stop();
+}
+
+void Profiler::start() {
+    if (util::detect_debugger())
+        return;
+
+    (void) profiler_stack();
+
+    if (!profiler_handler_installed) {
         struct sigaction sa;
         memset(&sa, 0, sizeof(sa));
         sa.sa_sigaction = profiler_callback;
         sa.sa_flags = SA_RESTART | SA_SIGINFO;
         sigemptyset(&sa.sa_mask);
         if (sigaction(SIGPROF, &sa, nullptr))
-            Throw("profiler_start(): failure in sigaction(): %s", strerror(errno));
+            Throw("Profiler: failure in sigaction(): %s", strerror(errno));
+        profiler_handler_installed = true;
+    }
+
+    profiler_recording = true;
+    profiler_set_timer((long) profiler_interval_us);
+}
 
-        itimerval timer;
-        timer.it_interval.tv_sec = 0;
-        timer.it_interval.tv_usec = 1000000 / 100; // 100 Hz sampling
-        timer.it_value = timer.it_interval;
+void Profiler::stop() {
+    profiler_recording = false;
+    if (profiler_handler_installed)
+        profiler_set_timer(0);
+}
+
+bool Profiler::running() {
+    return profiler_recording;
+}
 
-        if (setitimer(ITIMER_PROF, &timer, nullptr))
-            Throw("profiler_start(): failure in setitimer(): %s", strerror(errno));
+void Profiler::reset() {
+    bool recording = profiler_recording.exchange(false);
+    for (auto &sample : profiler_samples)
+        sample = ProfilerSample();
+    profiler_dropped = 0;
+
+    // The labels of destroyed instances are no longer referenced
+    std::lock_guard<std::mutex> guard(profiler_labels_mutex());
+    auto &labels = profiler_labels();
+    ProfilerDeadLabel *node =
+        profiler_dead_labels.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        ProfilerDeadLabel *next = node->next;
+        labels.erase(node->id);
+        delete node;
+        node = next;
     }
+    profiler_recording = recording;
 }
 
-void Profiler::static_shutdown() {
-    if (util::detect_debugger())
+void Profiler::register_object(const Object *object, const std::string &label) {
+    std::lock_guard<std::mutex> guard(profiler_labels_mutex());
+    if (object->m_profiler_id == 0) {
+        // IDs are never reused, 0 denotes instances without a label
+        if (++profiler_id_counter == 0)
+            ++profiler_id_counter;
+        object->m_profiler_id = profiler_id_counter;
+    }
+    profiler_labels()[object->m_profiler_id] = label;
+}
+
+void Profiler::unregister_object(const Object *object) {
+    ProfilerDeadLabel *node = new (std::nothrow) ProfilerDeadLabel{
+        object->m_profiler_id,
+        profiler_dead_labels.load(std::memory_order_relaxed) };
+    if (!node)
         return;
+    while (!profiler_dead_labels.compare_exchange_weak(
+        node->next, node, std::memory_order_release, std::memory_order_relaxed)) { }
+}
 
-    itimerval timer;
-    timer.it_interval.tv_sec = 0;
-    timer.it_interval.tv_usec = 0;
-    timer.it_value = timer.it_interval;
+/// Sample record with resolved plugin labels
+struct ProfilerRecord {
+    uint64_t flags;
+    std::vector<std::pair<ProfilerPhase, std::string>> frames;
+    uint64_t count;
+};
 
-    if (setitimer(ITIMER_PROF, &timer, nullptr))
-        Throw("profiler_stop(): failure in setitimer(): %s", strerror(errno));
+/// Copy the sample table and resolve the labels of all plugin instances
+static std::vector<ProfilerRecord> profiler_records() {
+    std::vector<ProfilerRecord> records;
+    std::lock_guard<std::mutex> guard(profiler_labels_mutex());
+    const auto &labels = profiler_labels();
+
+    for (const auto &sample : profiler_samples) {
+        if (!sample.used || sample.count == 0)
+            continue;
+        ProfilerRecord record { sample.flags, { }, sample.count };
+        for (uint32_t i = 0; i < sample.depth; ++i) {
+            // The instance itself may no longer exist at this point
+            auto it = labels.find(sample.frames[i].object);
+            record.frames.emplace_back(sample.frames[i].phase,
+                                       it != labels.end() ? it->second : std::string());
+        }
+        records.push_back(std::move(record));
+    }
+
+    std::sort(records.begin(), records.end(),
+              [](const auto &a, const auto &b) { return a.count > b.count; });
+    return records;
+}
+
+static std::string profiler_frame_name(const std::pair<ProfilerPhase, std::string> &frame) {
+    std::string name = profiler_phase_id[int(frame.first)];
+    if (!frame.second.empty())
+        name += " [" + frame.second + "]";
+    return name;
+}
+
+ProfilerSampleList Profiler::samples() {
+    ProfilerSampleList result;
+    for (const auto &record : profiler_records()) {
+        std::vector<std::pair<std::string, std::string>> frames;
+        for (const auto &frame : record.frames)
+            frames.emplace_back(profiler_phase_id[int(frame.first)], frame.second);
+        result.emplace_back(std::move(frames), (size_t) record.count);
+    }
+    return result;
+}
+
+void Profiler::write_flamegraph(const fs::path &path) {
+    // Merge stacks of distinct instances that share the same label
+    std::map<std::string, uint64_t> stacks;
+    for (const auto &record : profiler_records()) {
+        std::string stack;
+        for (const auto &frame : record.frames) {
+            std::string name = profiler_frame_name(frame);
+            std::replace(name.begin(), name.end(), ';', ',');
+            if (!stack.empty())
+                stack += ";";
+            stack += name;
+        }
+        if (stack.empty())
+            stack = "Idle";
+        stacks[stack] += record.count;
+    }
+
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    for (const auto &kv : stacks)
+        fs->write_line(kv.first + " " + std::to_string(kv.second));
+    fs->close();
+    Log(Info, "Profiler: wrote %i stacks to \"%s\"", stacks.size(), path.string());
+}
+
+struct ProfilerNode {
+    std::string name;
+    uint64_t count = 0;
+    std::vector<ProfilerNode> children;
+
+    ProfilerNode &child(const std::string &child_name) {
+        for (auto &c : children) {
+            if (c.name == child_name)
+                return c;
+        }
+        children.push_back(ProfilerNode{ child_name, 0, { } });
+        return children.back();
+    }
+};
+
+static std::string json_escape(const std::string &str) {
+    std::string result;
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        if ((unsigned char) c < 0x20)
+            continue;
+        result += c;
+    }
+    return result;
+}
+
+static void write_trace_events(std::ostringstream &oss, ProfilerNode &node,
+                               uint64_t start, bool &first) {
+    if (!first)
+        oss << "," << std::endl;
+    first = false;
+    oss << "  { \"name\": \"" << json_escape(node.name) << "\", \"cat\": \"mitsuba\", "
+        << "\"ph\": \"X\", \"pid\": 0, \"tid\": 0, "
+        << "\"ts\": " << start * profiler_interval_us << ", "
+        << "\"dur\": " << node.count * profiler_interval_us << ", "
+        << "\"args\": { \"samples\": " << node.count << " } }";
+
+    std::sort(node.children.begin(), node.children.end(),
+              [](const auto &a, const auto &b) { return a.count > b.count; });
+    for (auto &child : node.children) {
+        write_trace_events(oss, child, start, first);
+        start += child.count;
+    }
+}
+
+void Profiler::write_chrome_trace(const fs::path &path) {
+    ProfilerNode root { "Profile", 0, { } };
+    for (const auto &record : profiler_records()) {
+        root.count += record.count;
+        ProfilerNode *node = &root;
+        if (record.frames.empty())
+            node->child("Idle").count += record.count;
+        for (const auto &frame : record.frames) {
+            node = &node->child(profiler_frame_name(frame));
+            node->count += record.count;
+        }
+    }
+
+    std::ostringstream oss;
+    oss << "{ \"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+    bool first = true;
+    write_trace_events(oss, root, 0, first);
+    oss << std::endl << "] }";
+
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    fs->write_line(oss.str());
+    fs->close();
+    Log(Info, "Profiler: wrote Chrome trace to \"%s\"", path.string());
 }
 
 void Profiler::print_report() {
@@ -91,16 +366,24 @@ void Profiler::print_report() {
     uint64_t event_count_total = 0,
              buckets_used = 0;
 
-    SampleMap leaf_results, hierarchical_results;
+    SampleMap leaf_results, hierarchical_results, plugin_results;
 
     size_t prefix_length = 0;
     size_t max_indent = 0;
 
-    for (auto const &sample: profiler_samples) {
-        if (sample.count == 0)
-            continue;
+    std::vector<ProfilerRecord> records = profiler_records();
+    for (auto const &sample: records) {
         uint64_t sample_flags = sample.flags;
 
+        // Attribute each sample once to every plugin instance on the stack
+        std::set<std::string> plugins;
+        for (const auto &frame : sample.frames) {
+            if (!frame.second.empty())
+                plugins.insert(profiler_frame_name(frame));
+        }
+        for (const auto &name : plugins)
+            plugin_results[name] += sample.count;
+
         event_count_total += sample.count;
         buckets_used++;
 
@@ -132,6 +415,14 @@ void Profiler::print_report() {
     Log(Info, "Recorded %i samples, used %i/%i hash table entries.",
         event_count_total, buckets_used, profiler_samples.size());
 
+    if (profiler_dropped > 0)
+        Log(Warn, "Dropped %i samples because the profiler hash table filled "
+                  "up -- you may need to increase MTS_PROFILE_HASH_SIZE.",
+            (uint64_t) profiler_dropped);
+
+    if (event_count_total == 0)
+        return;
+
     if (event_count_total < 250)
         Log(Warn, "Collected very few samples -- perform a longer "
                   "rendering to obtain more reliable profile data.");
@@ -172,6 +463,27 @@ void Profiler::print_report() {
             std::string(prefix_length - kv.first.length() - 4, ' '),
             kv.second / float(event_count_total) * 100.f);
     }
+
+    if (plugin_results.empty())
+        return;
+
+    std::vector<std::pair<std::string, uint64_t>> plugin_results_sorted(
+        plugin_results.begin(), plugin_results.end());
+    std::sort(
+        plugin_results_sorted.begin(), plugin_results_sorted.end(),
+        [](auto a, auto b) { return a.second > b.second; });
+
+    size_t plugin_prefix_length = 0;
+    for (const auto &kv : plugin_results_sorted)
+        plugin_prefix_length = std::max(plugin_prefix_length, kv.first.length());
+    plugin_prefix_length += 8;
+
+    Log(Info, "\U000023F1  Profile (per plugin, inclusive):");
+    for (auto kv : plugin_results_sorted) {
+        Log(Info, "    %s%s%.2f%%", kv.first,
+            std::string(plugin_prefix_length - kv.first.length() - 4, ' '),
+            kv.second / float(event_count_total) * 100.f);
+    }
 }
 
 MTS_IMPLEMENT_CLASS(Profiler, Object)
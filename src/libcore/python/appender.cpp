@@ -21,7 +21,7 @@ public:
         PYBIND11_OVERLOAD_PURE(
             void,          // Return value
             Appender,      // Parent class
-            append,        // Function
+            log_progress,  // Function
             progress, name, formatted, eta, ptr // Arguments
         );
     }
@@ -205,3 +205,21 @@ MTS_PY_EXPORT(Bitmap) {
             return py::object(result);
         });
 }
+
+MTS_PY_EXPORT(TiledEXRWriter) {
+    using Float = typename TiledEXRWriter::Float;
+    MTS_IMPORT_CORE_TYPES()
+
+    MTS_PY_CLASS(TiledEXRWriter, Object)
+        .def(py::init<const fs::path &, const Vector2u &, const Vector2u &,
+                      const Bitmap *, int>(),
+             "path"_a, "size"_a, "tile_size"_a, "prototype"_a, "quality"_a = -1,
+             D(TiledEXRWriter, TiledEXRWriter))
+        .def("write", &TiledEXRWriter::write, "offset"_a, "bitmap"_a,
+             D(TiledEXRWriter, write), py::call_guard<py::gil_scoped_release>())
+        .def_method(TiledEXRWriter, close)
+        .def_method(TiledEXRWriter, size)
+        .def_method(TiledEXRWriter, tile_size)
+        .def_method(TiledEXRWriter, tiles_written)
+        .def_method(TiledEXRWriter, tile_count);
+}
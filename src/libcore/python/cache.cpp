@@ -0,0 +1,17 @@
+#include <mitsuba/core/cache.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(AssetCache) {
+    MTS_PY_CLASS(AssetCache, Object)
+        .def_static_method(AssetCache, instance, py::return_value_policy::reference)
+        .def_method(AssetCache, set_enabled, "enabled"_a)
+        .def_method(AssetCache, enabled)
+        .def_method(AssetCache, set_memory_limit, "limit"_a)
+        .def_method(AssetCache, memory_limit)
+        .def_method(AssetCache, memory_usage)
+        .def_method(AssetCache, entry_count)
+        .def_method(AssetCache, hit_count)
+        .def_method(AssetCache, miss_count)
+        .def_method(AssetCache, entries)
+        .def_method(AssetCache, clear);
+}
@@ -1,5 +1,6 @@
 #include <mitsuba/python/python.h>
 #include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/stream.h>
 #include <pybind11/numpy.h>
 #include <enoki/stl.h>
 
@@ -7,9 +8,11 @@ template <typename Warp> auto bind_warp(py::module &m,
         const char *name,
         const char *doc,
         const char *doc_constructor,
+        const char *doc_constructor_stream,
         const char *doc_sample,
         const char *doc_invert,
-        const char *doc_eval) {
+        const char *doc_eval,
+        const char *doc_write) {
     using Float                = typename Warp::Float;
     using ScalarFloat          = scalar_t<Float>;
     using NumPyArray           = py::array_t<ScalarFloat, py::array::c_style | py::array::forcecast>;
@@ -55,6 +58,9 @@ template <typename Warp> auto bind_warp(py::module &m,
                  "normalize"_a = true, "build_hierarchy"_a = true,
                  doc_constructor);
 
+    warp.def(py::init<Stream *>(), "stream"_a, doc_constructor_stream)
+        .def("write", &Warp::write, "stream"_a, doc_write);
+
     warp.def("sample",
              vectorize([](const Warp *w, const Vector2f &sample,
                           const Array<Float, Warp::Dimension> &param,
@@ -85,9 +91,11 @@ template <typename Warp> void bind_warp_hierarchical(py::module &m, const char *
     bind_warp<Warp>(m, name,
         D(Hierarchical2D),
         D(Hierarchical2D, Hierarchical2D, 2),
+        D(Hierarchical2D, Hierarchical2D, 3),
         D(Hierarchical2D, sample),
         D(Hierarchical2D, invert),
-        D(Hierarchical2D, eval)
+        D(Hierarchical2D, eval),
+        D(Hierarchical2D, write)
     );
 }
 
@@ -95,9 +103,11 @@ template <typename Warp> void bind_warp_marginal(py::module &m, const char *name
     bind_warp<Warp>(m, name,
         D(Marginal2D),
         D(Marginal2D, Marginal2D, 2),
+        D(Marginal2D, Marginal2D, 3),
         D(Marginal2D, sample),
         D(Marginal2D, invert),
-        D(Marginal2D, eval)
+        D(Marginal2D, eval),
+        D(Marginal2D, write)
     );
 }
 
@@ -17,21 +17,35 @@ static void PyLog(LogLevel level, const std::string &msg) {
     if (!name.empty() && name[0] != '<')
         fmt.insert(2, "()");
 
+    std::string text = tfm::format(fmt.c_str(), name.c_str(), msg.c_str());
+
+    /* Release the GIL, since errors flush the asynchronous log queue, which
+       may involve calling Python appenders on another thread */
+    py::gil_scoped_release release;
     Thread::thread()->logger()->log(
         level, nullptr /* class_ */,
-        filename.c_str(), lineno,
-        tfm::format(fmt.c_str(), name.c_str(), msg.c_str()));
+        filename.c_str(), lineno, text);
 }
 
 MTS_PY_EXPORT(Logger) {
     MTS_PY_CLASS(Logger, Object)
         .def(py::init<LogLevel>(), D(Logger, Logger))
         .def_method(Logger, log_progress, "progress"_a, "name"_a,
-            "formatted"_a, "eta"_a, "ptr"_a = py::none())
+            "formatted"_a, "eta"_a, "ptr"_a = py::none(),
+            py::call_guard<py::gil_scoped_release>())
         .def_method(Logger, set_log_level)
         .def_method(Logger, log_level)
         .def_method(Logger, set_error_level)
         .def_method(Logger, error_level)
+        .def_method(Logger, set_async, "async"_a, "capacity"_a = 8192,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, is_async)
+        .def_method(Logger, flush, "wait"_a = true,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, set_rate_limit, "count"_a, "interval"_a = 1.f)
+        .def_method(Logger, rate_limit)
+        .def_method(Logger, suppressed_count)
+        .def_method(Logger, dropped_count)
         .def_method(Logger, add_appender, py::keep_alive<1, 2>())
         .def_method(Logger, remove_appender)
         .def_method(Logger, clear_appenders)
@@ -39,7 +53,7 @@ MTS_PY_EXPORT(Logger) {
         .def("appender", (Appender * (Logger::*)(size_t)) &Logger::appender, D(Logger, appender))
         .def("formatter", (Formatter * (Logger::*)()) &Logger::formatter, D(Logger, formatter))
         .def_method(Logger, set_formatter, py::keep_alive<1, 2>())
-        .def_method(Logger, read_log);
+        .def_method(Logger, read_log, py::call_guard<py::gil_scoped_release>());
 
     m.def("Log", &PyLog, "level"_a, "msg"_a);
 }
@@ -1,7 +1,9 @@
 #include <tbb/tbb.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/python/python.h>
@@ -13,8 +15,10 @@ MTS_PY_DECLARE(Object);
 MTS_PY_DECLARE(Cast);
 MTS_PY_DECLARE(Struct);
 MTS_PY_DECLARE(Appender);
+MTS_PY_DECLARE(AssetCache);
 MTS_PY_DECLARE(ArgParser);
 MTS_PY_DECLARE(Bitmap);
+MTS_PY_DECLARE(TiledEXRWriter);
 MTS_PY_DECLARE(Formatter);
 MTS_PY_DECLARE(FileResolver);
 MTS_PY_DECLARE(Logger);
@@ -23,10 +27,14 @@ MTS_PY_DECLARE(Stream);
 MTS_PY_DECLARE(DummyStream);
 MTS_PY_DECLARE(FileStream);
 MTS_PY_DECLARE(MemoryStream);
+MTS_PY_DECLARE(SocketStream);
 MTS_PY_DECLARE(ZStream);
 MTS_PY_DECLARE(ProgressReporter);
+MTS_PY_DECLARE(Profiler);
 MTS_PY_DECLARE(rfilter);
+MTS_PY_DECLARE(Statistics);
 MTS_PY_DECLARE(Thread);
+MTS_PY_DECLARE(Timeline);
 MTS_PY_DECLARE(util);
 
 PYBIND11_MODULE(core_ext, m) {
@@ -65,6 +73,7 @@ PYBIND11_MODULE(core_ext, m) {
     Thread::static_initialization();
     Logger::static_initialization();
     Bitmap::static_initialization();
+    AssetCache::static_initialization();
 
     // Append the mitsuba directory to the FileResolver search path list
     ref<FileResolver> fr = Thread::thread()->file_resolver();
@@ -105,10 +114,12 @@ PYBIND11_MODULE(core_ext, m) {
     MTS_PY_IMPORT(Cast);
     MTS_PY_IMPORT(Struct);
     MTS_PY_IMPORT(Appender);
+    MTS_PY_IMPORT(AssetCache);
     MTS_PY_IMPORT(ArgParser);
     MTS_PY_IMPORT(rfilter);
     MTS_PY_IMPORT(Stream);
     MTS_PY_IMPORT(Bitmap);
+    MTS_PY_IMPORT(TiledEXRWriter);
     MTS_PY_IMPORT(Formatter);
     MTS_PY_IMPORT(FileResolver);
     MTS_PY_IMPORT(Logger);
@@ -116,9 +127,13 @@ PYBIND11_MODULE(core_ext, m) {
     MTS_PY_IMPORT(DummyStream);
     MTS_PY_IMPORT(FileStream);
     MTS_PY_IMPORT(MemoryStream);
+    MTS_PY_IMPORT(SocketStream);
     MTS_PY_IMPORT(ZStream);
     MTS_PY_IMPORT(ProgressReporter);
+    MTS_PY_IMPORT(Statistics);
+    MTS_PY_IMPORT(Profiler);
     MTS_PY_IMPORT(Thread);
+    MTS_PY_IMPORT(Timeline);
     MTS_PY_IMPORT(util);
 
     /* Register a cleanup callback function that is invoked when
@@ -127,6 +142,8 @@ PYBIND11_MODULE(core_ext, m) {
         [scheduler_holder](py::handle weakref) {
             delete scheduler_holder;
 
+            Profiler::static_shutdown();
+            AssetCache::static_shutdown();
             Bitmap::static_shutdown();
             Logger::static_shutdown();
             Thread::static_shutdown();
@@ -0,0 +1,18 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(Profiler) {
+#if defined(MTS_ENABLE_PROFILER)
+    MTS_PY_CLASS(Profiler, Object)
+#else
+    py::class_<Profiler>(m, "Profiler", D(Profiler))
+#endif
+        .def_static_method(Profiler, start)
+        .def_static_method(Profiler, stop)
+        .def_static_method(Profiler, running)
+        .def_static_method(Profiler, reset)
+        .def_static_method(Profiler, print_report)
+        .def_static_method(Profiler, samples)
+        .def_static_method(Profiler, write_flamegraph, "path"_a)
+        .def_static_method(Profiler, write_chrome_trace, "path"_a);
+}
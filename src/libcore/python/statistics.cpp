@@ -0,0 +1,29 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(Statistics) {
+    py::enum_<StatsCounter>(m, "StatsCounter", D(StatsCounter))
+        .value("CameraRays", StatsCounter::CameraRays, D(StatsCounter, CameraRays))
+        .value("IntersectionRays", StatsCounter::IntersectionRays, D(StatsCounter, IntersectionRays))
+        .value("ShadowRays", StatsCounter::ShadowRays, D(StatsCounter, ShadowRays))
+        .value("KDTreeInnerNodes", StatsCounter::KDTreeInnerNodes, D(StatsCounter, KDTreeInnerNodes))
+        .value("KDTreeLeafNodes", StatsCounter::KDTreeLeafNodes, D(StatsCounter, KDTreeLeafNodes))
+        .value("PrimitiveTests", StatsCounter::PrimitiveTests, D(StatsCounter, PrimitiveTests))
+        .value("RussianRoulette", StatsCounter::RussianRoulette, D(StatsCounter, RussianRoulette));
+
+    py::enum_<StatsHistogram>(m, "StatsHistogram", D(StatsHistogram))
+        .value("PathDepth", StatsHistogram::PathDepth, D(StatsHistogram, PathDepth))
+        .value("PrimitiveTestsPerRay", StatsHistogram::PrimitiveTestsPerRay,
+               D(StatsHistogram, PrimitiveTestsPerRay));
+
+    py::class_<Statistics>(m, "Statistics", D(Statistics))
+        .def_static_method(Statistics, enabled)
+        .def_static_method(Statistics, reset)
+        .def_static_method(Statistics, merge)
+        .def_static_method(Statistics, counter, "counter"_a)
+        .def_static_method(Statistics, histogram, "histogram"_a)
+        .def_static_method(Statistics, elapsed)
+        .def_static_method(Statistics, report)
+        .def_static_method(Statistics, to_json)
+        .def_static_method(Statistics, write_json, "path"_a);
+}
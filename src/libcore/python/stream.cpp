@@ -2,6 +2,7 @@
 #include <mitsuba/core/dstream.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/sstream.h>
 #include <mitsuba/core/zstream.h>
 
 #include <mitsuba/core/filesystem.h>
@@ -97,6 +98,27 @@ MTS_PY_EXPORT(MemoryStream) {
         .def_method(MemoryStream, owns_buffer);
 }
 
+MTS_PY_EXPORT(SocketStream) {
+    MTS_PY_CLASS(SocketStream, Stream)
+        .def(py::init<const std::string &, int>(), D(SocketStream, SocketStream),
+            "host"_a, "port"_a)
+        .def_method(SocketStream, peer)
+        .def_method(SocketStream, set_timeout, "timeout"_a)
+        .def("poll", &SocketStream::poll, "timeout"_a,
+             py::call_guard<py::gil_scoped_release>(), D(SocketStream, poll))
+        .def_method(SocketStream, received_bytes)
+        .def_method(SocketStream, sent_bytes);
+
+    MTS_PY_CLASS(ServerSocket, Object)
+        .def(py::init<int, const std::string &>(), D(ServerSocket, ServerSocket),
+            "port"_a = 0, "address"_a = "")
+        .def_method(ServerSocket, port)
+        .def("accept", &ServerSocket::accept, "timeout"_a = -1.f,
+             py::call_guard<py::gil_scoped_release>(), D(ServerSocket, accept))
+        .def_method(ServerSocket, close)
+        .def_method(ServerSocket, is_closed);
+}
+
 MTS_PY_EXPORT(ZStream) {
     auto c = MTS_PY_CLASS(ZStream, Stream);
 
@@ -0,0 +1,28 @@
+#include <mitsuba/core/timeline.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(Timeline) {
+    py::class_<TimelineEvent>(m, "TimelineEvent", D(TimelineEvent))
+        .def_readonly("category", &TimelineEvent::category, D(TimelineEvent, category))
+        .def_readonly("name", &TimelineEvent::name, D(TimelineEvent, name))
+        .def_readonly("thread", &TimelineEvent::thread, D(TimelineEvent, thread))
+        .def_readonly("start", &TimelineEvent::start, D(TimelineEvent, start))
+        .def_readonly("duration", &TimelineEvent::duration, D(TimelineEvent, duration))
+        .def_readonly("rss_start", &TimelineEvent::rss_start, D(TimelineEvent, rss_start))
+        .def_readonly("rss_end", &TimelineEvent::rss_end, D(TimelineEvent, rss_end))
+        .def_readonly("peak_rss", &TimelineEvent::peak_rss, D(TimelineEvent, peak_rss))
+        .def("__repr__", [](const TimelineEvent &e) {
+            return tfm::format("TimelineEvent[category=\"%s\", name=\"%s\", duration=%f]",
+                               e.category, e.name, e.duration);
+        });
+
+    py::class_<Timeline>(m, "Timeline", D(Timeline))
+        .def_static_method(Timeline, set_enabled, "enabled"_a)
+        .def_static_method(Timeline, enabled)
+        .def_static_method(Timeline, reset)
+        .def_static_method(Timeline, time)
+        .def_static_method(Timeline, add, "category"_a, "name"_a, "start"_a, "rss_start"_a)
+        .def_static_method(Timeline, events)
+        .def_static_method(Timeline, to_json)
+        .def_static_method(Timeline, write_json, "path"_a);
+}
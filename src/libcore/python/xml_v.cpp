@@ -10,7 +10,8 @@ MTS_PY_EXPORT(xml) {
 
     m.def(
         "load_file",
-        [](const std::string &name, bool update_scene, py::kwargs kwargs) {
+        [](const std::string &name, bool update_scene, bool deferred,
+           const std::string &write_compiled, py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -22,13 +23,15 @@ MTS_PY_EXPORT(xml) {
             py::gil_scoped_release release;
             return cast_object(
                 xml::load_file(
-                    name, mitsuba::detail::get_variant<Float, Spectrum>(), param, update_scene));
+                    name, mitsuba::detail::get_variant<Float, Spectrum>(), param,
+                    update_scene, deferred, write_compiled));
         },
-        "path"_a, "update_scene"_a = false, D(xml, load_file));
+        "path"_a, "update_scene"_a = false, "deferred"_a = false,
+        "write_compiled"_a = "", D(xml, load_file));
 
     m.def(
         "load_string",
-        [](const std::string &name, py::kwargs kwargs) {
+        [](const std::string &name, bool deferred, py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -39,7 +42,8 @@ MTS_PY_EXPORT(xml) {
             }
             py::gil_scoped_release release;
             return cast_object(
-                xml::load_string(name, mitsuba::detail::get_variant<Float, Spectrum>(), param));
+                xml::load_string(name, mitsuba::detail::get_variant<Float, Spectrum>(),
+                                 param, deferred));
         },
-        "string"_a, D(xml, load_string));
+        "string"_a, "deferred"_a = false, D(xml, load_string));
 }
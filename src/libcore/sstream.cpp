@@ -0,0 +1,351 @@
+#include <mitsuba/core/sstream.h>
+#include <cmath>
+#include <cstring>
+
+#if defined(__WINDOWS__)
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <errno.h>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <poll.h>
+#  include <sys/socket.h>
+#  include <sys/time.h>
+#  include <sys/types.h>
+#  include <unistd.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+#if defined(__WINDOWS__)
+using socket_t = SOCKET;
+#else
+using socket_t = int;
+#endif
+
+static std::string socket_error() {
+#if defined(__WINDOWS__)
+    return tfm::format("error code %i", WSAGetLastError());
+#else
+    return strerror(errno);
+#endif
+}
+
+static void socket_init() {
+#if defined(__WINDOWS__)
+    static bool initialized = []() {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            Throw("Could not initialize Winsock!");
+        return true;
+    }();
+    ENOKI_MARK_USED(initialized);
+#endif
+}
+
+static void close_socket(intptr_t socket) {
+#if defined(__WINDOWS__)
+    closesocket((socket_t) socket);
+#else
+    ::close((socket_t) socket);
+#endif
+}
+
+/// Convert a socket address into a "host:port" string
+static std::string address_string(const sockaddr *addr, socklen_t addr_len) {
+    char host[NI_MAXHOST], service[NI_MAXSERV];
+    if (getnameinfo(addr, addr_len, host, sizeof(host), service, sizeof(service),
+                    NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+        return "<unknown>";
+    return tfm::format("%s:%s", host, service);
+}
+
+/**
+ * Wait until a socket becomes readable. Returns \c false when the timeout
+ * (in seconds, negative: wait indefinitely) expired.
+ */
+static bool wait_readable(intptr_t socket, float timeout) {
+    /* Use poll() rather than select(), whose descriptor sets cannot hold
+       sockets beyond FD_SETSIZE. A closed or failed connection also counts
+       as readable, the subsequent read reports the error. */
+    pollfd fd;
+    fd.fd = (socket_t) socket;
+    fd.events = POLLIN;
+    int timeout_ms = timeout < 0.f ? -1 : (int) std::ceil(timeout * 1000.f);
+
+    while (true) {
+        fd.revents = 0;
+#if defined(__WINDOWS__)
+        int rv = WSAPoll(&fd, 1, timeout_ms);
+#else
+        int rv = poll(&fd, 1, timeout_ms);
+#endif
+        if (rv < 0) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("poll(): %s", socket_error());
+        }
+        return rv > 0;
+    }
+}
+
+/// Disable Nagle's algorithm and enable keep-alive messages to detect dead peers
+static void configure_socket(intptr_t socket) {
+    int flag = 1;
+    setsockopt((socket_t) socket, IPPROTO_TCP, TCP_NODELAY, (const char *) &flag, sizeof(flag));
+    setsockopt((socket_t) socket, SOL_SOCKET, SO_KEEPALIVE, (const char *) &flag, sizeof(flag));
+#if defined(__OSX__)
+    setsockopt((socket_t) socket, SOL_SOCKET, SO_NOSIGPIPE, (const char *) &flag, sizeof(flag));
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+SocketStream::SocketStream(const std::string &host, int port)
+    : m_socket(-1), m_received(0), m_sent(0) {
+    socket_init();
+    set_byte_order(ENetworkByteOrder);
+
+    addrinfo hints, *result = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int rv = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+    if (rv != 0)
+        Throw("Could not resolve \"%s\": %s", host, gai_strerror(rv));
+
+    std::string error;
+    for (addrinfo *ai = result; ai != nullptr; ai = ai->ai_next) {
+        socket_t s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if ((intptr_t) s == -1) {
+            error = socket_error();
+            continue;
+        }
+        if (::connect(s, ai->ai_addr, (socklen_t) ai->ai_addrlen) != 0) {
+            error = socket_error();
+            close_socket((intptr_t) s);
+            continue;
+        }
+        m_socket = (intptr_t) s;
+        m_peer = address_string(ai->ai_addr, (socklen_t) ai->ai_addrlen);
+        break;
+    }
+    freeaddrinfo(result);
+
+    if (m_socket == -1)
+        Throw("Could not connect to %s:%i: %s", host, port, error);
+    configure_socket(m_socket);
+}
+
+SocketStream::SocketStream(intptr_t socket, const std::string &peer)
+    : m_socket(socket), m_peer(peer), m_received(0), m_sent(0) {
+    set_byte_order(ENetworkByteOrder);
+    configure_socket(m_socket);
+}
+
+SocketStream::~SocketStream() {
+    close();
+}
+
+void SocketStream::close() {
+    if (m_socket == -1)
+        return;
+    close_socket(m_socket);
+    m_socket = -1;
+}
+
+void SocketStream::set_timeout(float timeout) {
+    if (is_closed())
+        Throw("Attempted to configure a closed socket stream: %s", to_string());
+#if defined(__WINDOWS__)
+    DWORD value = (DWORD) (timeout * 1000.f);
+#else
+    timeval value;
+    value.tv_sec = (time_t) timeout;
+    value.tv_usec = (suseconds_t) ((timeout - (float) value.tv_sec) * 1e6f);
+#endif
+    if (setsockopt((socket_t) m_socket, SOL_SOCKET, SO_RCVTIMEO,
+                   (const char *) &value, sizeof(value)) != 0)
+        Throw("Could not set the socket timeout: %s", socket_error());
+}
+
+bool SocketStream::poll(float timeout) {
+    if (is_closed())
+        Throw("Attempted to poll a closed socket stream: %s", to_string());
+    return wait_readable(m_socket, timeout);
+}
+
+void SocketStream::read(void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to read from a closed socket stream: %s", to_string());
+
+    char *ptr = (char *) p;
+    while (size > 0) {
+        int chunk = (int) std::min(size, (size_t) (1 << 30));
+        auto n = ::recv((socket_t) m_socket, ptr, chunk, 0);
+        if (n == 0)
+            Throw("Connection to %s was closed by the peer (%i more bytes "
+                  "required)", m_peer, size);
+        if (n < 0) {
+#if defined(__WINDOWS__)
+            if (WSAGetLastError() == WSAETIMEDOUT)
+#else
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+#endif
+                Throw("Read from %s timed out", m_peer);
+            Throw("Could not read from %s: %s", m_peer, socket_error());
+        }
+        ptr += n;
+        size -= (size_t) n;
+        m_received += (size_t) n;
+    }
+}
+
+void SocketStream::write(const void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to write to a closed socket stream: %s", to_string());
+
+#if defined(__LINUX__)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+
+    const char *ptr = (const char *) p;
+    while (size > 0) {
+        int chunk = (int) std::min(size, (size_t) (1 << 30));
+        auto n = ::send((socket_t) m_socket, ptr, chunk, flags);
+        if (n < 0) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("Could not write to %s: %s", m_peer, socket_error());
+        }
+        ptr += n;
+        size -= (size_t) n;
+        m_sent += (size_t) n;
+    }
+}
+
+std::string SocketStream::to_string() const {
+    std::ostringstream oss;
+
+    oss << class_()->name() << "[" << std::endl;
+    if (is_closed()) {
+        oss << "  closed" << std::endl;
+    } else {
+        oss << "  peer = \"" << m_peer << "\"," << std::endl
+            << "  host_byte_order = " << host_byte_order() << "," << std::endl
+            << "  byte_order = " << byte_order() << "," << std::endl
+            << "  received = " << m_received << "," << std::endl
+            << "  sent = " << m_sent << std::endl;
+    }
+
+    oss << "]";
+
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
+
+ServerSocket::ServerSocket(int port, const std::string &address)
+    : m_socket(-1), m_port(port) {
+    socket_init();
+
+    addrinfo hints, *result = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    int rv = getaddrinfo(address.empty() ? nullptr : address.c_str(),
+                         std::to_string(port).c_str(), &hints, &result);
+    if (rv != 0)
+        Throw("Could not resolve \"%s\": %s", address, gai_strerror(rv));
+
+    std::string error;
+    for (addrinfo *ai = result; ai != nullptr; ai = ai->ai_next) {
+        socket_t s = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if ((intptr_t) s == -1) {
+            error = socket_error();
+            continue;
+        }
+        int flag = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *) &flag, sizeof(flag));
+        if (::bind(s, ai->ai_addr, (socklen_t) ai->ai_addrlen) != 0 ||
+            ::listen(s, SOMAXCONN) != 0) {
+            error = socket_error();
+            close_socket((intptr_t) s);
+            continue;
+        }
+        m_socket = (intptr_t) s;
+        break;
+    }
+    freeaddrinfo(result);
+
+    if (m_socket == -1)
+        Throw("Could not listen on port %i: %s", port, error);
+
+    sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname((socket_t) m_socket, (sockaddr *) &addr, &addr_len) == 0) {
+        if (addr.ss_family == AF_INET)
+            m_port = ntohs(((sockaddr_in *) &addr)->sin_port);
+        else if (addr.ss_family == AF_INET6)
+            m_port = ntohs(((sockaddr_in6 *) &addr)->sin6_port);
+    }
+}
+
+ServerSocket::~ServerSocket() {
+    close();
+}
+
+void ServerSocket::close() {
+    if (m_socket == -1)
+        return;
+    close_socket(m_socket);
+    m_socket = -1;
+}
+
+ref<SocketStream> ServerSocket::accept(float timeout) {
+    if (is_closed())
+        Throw("Attempted to accept a connection on a closed server socket!");
+
+    while (true) {
+        if (timeout >= 0.f && !wait_readable(m_socket, timeout))
+            return nullptr;
+
+        sockaddr_storage addr;
+        socklen_t addr_len = sizeof(addr);
+        socket_t s = ::accept((socket_t) m_socket, (sockaddr *) &addr, &addr_len);
+        if ((intptr_t) s == -1) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+#endif
+            Throw("Could not accept a connection: %s", socket_error());
+        }
+
+        return new SocketStream((intptr_t) s,
+                                address_string((sockaddr *) &addr, addr_len));
+    }
+}
+
+std::string ServerSocket::to_string() const {
+    std::ostringstream oss;
+    oss << "ServerSocket[port=" << m_port << (is_closed() ? ", closed" : "") << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(SocketStream, Stream)
+MTS_IMPLEMENT_CLASS(ServerSocket, Object)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,228 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Merged statistics of all threads
+struct StatsTotals {
+    uint64_t counters[int(StatsCounter::StatsCounterCount)] { };
+    uint64_t histograms[int(StatsHistogram::StatsHistogramCount)]
+                       [MTS_STATS_HISTOGRAM_BINS] { };
+    float elapsed = 0.f;
+};
+
+static std::mutex stats_mutex;
+static StatsTotals stats_merged;
+static Timer stats_timer;
+
+#if defined(MTS_ENABLE_STATISTICS)
+/// Counters of threads that have already terminated
+static StatsTotals stats_retired;
+static std::unordered_set<StatsThreadData *> stats_threads;
+
+static void stats_clear(StatsThreadData *data) {
+    for (auto &c : data->counters)
+        c.store(0, std::memory_order_relaxed);
+    for (auto &h : data->histograms)
+        for (auto &b : h)
+            b.store(0, std::memory_order_relaxed);
+}
+
+static void stats_accumulate(StatsTotals &totals, const StatsThreadData *data) {
+    for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i)
+        totals.counters[i] += data->counters[i].load(std::memory_order_relaxed);
+    for (int i = 0; i < int(StatsHistogram::StatsHistogramCount); ++i)
+        for (int j = 0; j < MTS_STATS_HISTOGRAM_BINS; ++j)
+            totals.histograms[i][j] += data->histograms[i][j].load(std::memory_order_relaxed);
+}
+
+/// Registers the counters of a thread so that they can be merged later on
+struct StatsThreadSlot {
+    StatsThreadData data;
+
+    StatsThreadSlot() {
+        stats_clear(&data);
+        std::lock_guard<std::mutex> guard(stats_mutex);
+        stats_threads.insert(&data);
+    }
+
+    ~StatsThreadSlot() {
+        std::lock_guard<std::mutex> guard(stats_mutex);
+        stats_accumulate(stats_retired, &data);
+        stats_threads.erase(&data);
+    }
+};
+
+static thread_local StatsThreadSlot stats_thread_slot;
+StatsThreadData *stats_thread_data() { return &stats_thread_slot.data; }
+#endif
+
+bool Statistics::enabled() {
+#if defined(MTS_ENABLE_STATISTICS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Statistics::reset() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+#if defined(MTS_ENABLE_STATISTICS)
+    for (StatsThreadData *data : stats_threads)
+        stats_clear(data);
+    stats_retired = StatsTotals();
+#endif
+    stats_merged = StatsTotals();
+    stats_timer.reset();
+}
+
+void Statistics::merge() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    StatsTotals totals;
+#if defined(MTS_ENABLE_STATISTICS)
+    totals = stats_retired;
+    for (const StatsThreadData *data : stats_threads)
+        stats_accumulate(totals, data);
+#endif
+    totals.elapsed = stats_timer.value() / 1000.f;
+    stats_merged = totals;
+}
+
+uint64_t Statistics::counter(StatsCounter counter) {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    return stats_merged.counters[int(counter)];
+}
+
+std::vector<uint64_t> Statistics::histogram(StatsHistogram histogram) {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    const uint64_t *bins = stats_merged.histograms[int(histogram)];
+    return std::vector<uint64_t>(bins, bins + MTS_STATS_HISTOGRAM_BINS);
+}
+
+float Statistics::elapsed() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    return stats_merged.elapsed;
+}
+
+/// Human-readable label of a histogram bin
+static std::string stats_bin_label(int histogram, int bin) {
+    std::string label;
+    if (!stats_histogram_log2[histogram] || bin < 2)
+        label = std::to_string(bin);
+    else
+        label = std::to_string(1ull << (bin - 1)) + "-" + std::to_string((1ull << bin) - 1);
+    if (bin == MTS_STATS_HISTOGRAM_BINS - 1)
+        label += "+";
+    return label;
+}
+
+/// Mean of a histogram (using the lower bound of logarithmic bins)
+static double stats_histogram_mean(int histogram, const uint64_t *bins) {
+    double sum = 0.0, weight = 0.0;
+    for (int j = 0; j < MTS_STATS_HISTOGRAM_BINS; ++j) {
+        double value = (stats_histogram_log2[histogram] && j > 0) ? double(1ull << (j - 1)) : double(j);
+        sum += value * bins[j];
+        weight += bins[j];
+    }
+    return weight > 0 ? sum / weight : 0.0;
+}
+
+std::string Statistics::report() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    const StatsTotals &t = stats_merged;
+    std::ostringstream oss;
+
+    oss << "Render statistics (" << util::time_string(t.elapsed * 1000.f, true) << "):" << std::endl;
+
+    for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i) {
+        oss << "    " << stats_counter_id[i] << ": " << t.counters[i];
+        if (t.elapsed > 0.f && t.counters[i] > 0 && i <= int(StatsCounter::ShadowRays))
+            oss << " (" << tfm::format("%.2f", t.counters[i] / t.elapsed * 1e-6f) << " M/sec)";
+        oss << std::endl;
+    }
+
+    uint64_t rays = t.counters[int(StatsCounter::IntersectionRays)] +
+                    t.counters[int(StatsCounter::ShadowRays)];
+    if (rays > 0) {
+        oss << "    Average per traced ray: "
+            << tfm::format("%.2f inner nodes, %.2f leaves, %.2f primitive tests",
+                           t.counters[int(StatsCounter::KDTreeInnerNodes)] / double(rays),
+                           t.counters[int(StatsCounter::KDTreeLeafNodes)] / double(rays),
+                           t.counters[int(StatsCounter::PrimitiveTests)] / double(rays))
+            << std::endl;
+    }
+
+    uint64_t camera_rays = t.counters[int(StatsCounter::CameraRays)];
+    for (int i = 0; i < int(StatsHistogram::StatsHistogramCount); ++i) {
+        const uint64_t *bins = t.histograms[i];
+        int last = -1;
+        for (int j = 0; j < MTS_STATS_HISTOGRAM_BINS; ++j)
+            if (bins[j] > 0)
+                last = j;
+        if (last < 0)
+            continue;
+
+        if (i == int(StatsHistogram::PathDepth)) {
+            // Every lane that reaches a given depth contributes one vertex
+            uint64_t vertices = 0;
+            for (int j = 0; j <= last; ++j)
+                vertices += bins[j];
+            oss << "    " << stats_histogram_id[i] << " (average: "
+                << tfm::format("%.2f", camera_rays > 0 ? vertices / double(camera_rays) : 0.0)
+                << " vertices per path):" << std::endl;
+        } else {
+            oss << "    " << stats_histogram_id[i] << " (average: "
+                << tfm::format("%.2f", stats_histogram_mean(i, bins)) << "):" << std::endl;
+        }
+
+        for (int j = 0; j <= last; ++j)
+            oss << "        " << stats_bin_label(i, j) << ": " << bins[j] << std::endl;
+    }
+
+    std::string result = oss.str();
+    result.pop_back();
+    return result;
+}
+
+std::string Statistics::to_json() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    const StatsTotals &t = stats_merged;
+    std::ostringstream oss;
+
+    oss << "{" << std::endl
+        << "  \"enabled\": " << (enabled() ? "true" : "false") << "," << std::endl
+        << "  \"elapsed\": " << t.elapsed << "," << std::endl
+        << "  \"counters\": {" << std::endl;
+    for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i) {
+        oss << "    \"" << stats_counter_id[i] << "\": " << t.counters[i]
+            << (i + 1 < int(StatsCounter::StatsCounterCount) ? "," : "") << std::endl;
+    }
+    oss << "  }," << std::endl
+        << "  \"histograms\": {" << std::endl;
+    for (int i = 0; i < int(StatsHistogram::StatsHistogramCount); ++i) {
+        oss << "    \"" << stats_histogram_id[i] << "\": { \"log2\": "
+            << (stats_histogram_log2[i] ? "true" : "false") << ", \"bins\": [";
+        for (int j = 0; j < MTS_STATS_HISTOGRAM_BINS; ++j)
+            oss << (j > 0 ? ", " : "") << t.histograms[i][j];
+        oss << "] }" << (i + 1 < int(StatsHistogram::StatsHistogramCount) ? "," : "")
+            << std::endl;
+    }
+    oss << "  }" << std::endl
+        << "}";
+    return oss.str();
+}
+
+void Statistics::write_json(const fs::path &path) {
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    fs->write_line(to_json());
+    fs->close();
+    Log(Info, "Statistics: wrote \"%s\"", path.string());
+}
+
+NAMESPACE_END(mitsuba)
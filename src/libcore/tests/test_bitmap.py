@@ -7,7 +7,7 @@ import enoki as ek
 
 mitsuba.set_variant('scalar_rgb')
 
-from mitsuba.core import Bitmap, Struct, ReconstructionFilter, float_dtype, FilterBoundaryCondition
+from mitsuba.core import Bitmap, Struct, ReconstructionFilter, float_dtype, FilterBoundaryCondition, TiledEXRWriter
 
 def find_resource(fname):
     path = os.path.dirname(os.path.realpath(__file__))
@@ -76,6 +76,37 @@ def test_read_write_complex_exr(tmpdir):
     assert str(b3) != str(b1)
 
 
+def test_tiled_exr_writer(tmpdir):
+    # Tests writing an OpenEXR file tile by tile, in arbitrary order
+    data = np.arange(10*7*3, dtype=np.float32).reshape((7, 10, 3))
+    tmp_file = os.path.join(str(tmpdir), "tiled.exr")
+
+    def tile(x, y):
+        return Bitmap(np.array(data[y:y+4, x:x+4, :]), Bitmap.PixelFormat.RGB)
+
+    writer = TiledEXRWriter(tmp_file, [10, 7], [4, 4], tile(0, 0))
+    assert writer.tile_count() == 6
+    for (x, y) in [(8, 4), (0, 0), (4, 4), (8, 0), (0, 4), (4, 0)]:
+        writer.write([x, y], tile(x, y))
+    assert writer.tiles_written() == 6
+
+    # Regions must be aligned to the tile grid
+    with pytest.raises(RuntimeError):
+        writer.write([2, 0], tile(2, 0))
+
+    writer.close()
+
+    b = Bitmap(tmp_file)
+    assert b.size() == [10, 7]
+    assert np.allclose(np.array(b), data)
+
+    # Whole images can be written in one go (compressing tiles in parallel)
+    writer = TiledEXRWriter(tmp_file, [10, 7], [4, 4], tile(0, 0))
+    writer.write([0, 0], Bitmap(data, Bitmap.PixelFormat.RGB))
+    writer.close()
+    assert np.allclose(np.array(Bitmap(tmp_file)), data)
+
+
 def test_convert_rgb_y(tmpdir):
     # Tests RGBA(float64) -> Y (float32) conversion
     b1 = Bitmap(Bitmap.PixelFormat.RGBA, Struct.Type.Float64, [3, 1])
@@ -168,3 +168,40 @@ def test04_chi2(variant_packet_rgb, warp, attempt):
         assert chi2.run(
             test_count=11 * len(all_warps)
         )
+
+
+@pytest.mark.parametrize("warp", all_warps)
+def test05_serialization(variant_scalar_rgb, warp):
+    # Check that a reloaded warp produces the same mapping as the original
+    from mitsuba.core import MemoryStream
+
+    cls = getattr(mitsuba.core, warp)
+    ndim = int(warp[-1]) + 2
+    np.random.seed(all_warps.index(warp))
+
+    shape = np.random.randint(2, 8, ndim)
+    param_res = [
+        sorted(np.random.rand(s)) for s in shape[:-2]
+    ]
+    values = np.random.rand(*shape) * 10
+    instance = cls(values, param_res)
+
+    stream = MemoryStream()
+    instance.write(stream)
+    stream.seek(0)
+    instance_2 = cls(stream)
+    assert str(instance_2) == str(instance)
+
+    for j in range(10):
+        p_i = np.random.rand(2)
+        param = [np.random.rand() for i in range(ndim - 2)]
+        assert ek.allclose(instance.sample(p_i, param=param),
+                           instance_2.sample(p_i, param=param))
+        assert ek.allclose(instance.eval(p_i, param=param),
+                           instance_2.eval(p_i, param=param))
+
+    # Loading data of a different type should fail
+    stream.seek(0)
+    other = all_warps[(all_warps.index(warp) + 4) % len(all_warps)]
+    with pytest.raises(RuntimeError):
+        getattr(mitsuba.core, other)(stream)
@@ -152,5 +152,6 @@ def test12_truncate_and_file_size():
     open(str(p), 'a').close()
     assert fs.resize_file(p, 42)
     assert fs.file_size(p) == 42
+    assert fs.last_write_time(p) > 0
     assert fs.remove(p)
     assert not fs.exists(p)
@@ -41,3 +41,132 @@ def test01_custom(variant_scalar_rgb):
         for app in appenders:
             logger.add_appender(app)
         logger.set_formatter(formatter)
+
+
+def test02_async_rate_limit(variant_scalar_rgb):
+    from mitsuba.core import Thread, Appender, Log, LogLevel
+
+    messages = []
+
+    class MyAppender(Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+    logger = Thread.thread().logger()
+    appenders = []
+    while logger.appender_count() > 0:
+        app = logger.appender(0)
+        appenders.append(app)
+        logger.remove_appender(app)
+
+    try:
+        logger.add_appender(MyAppender())
+        logger.set_async(True)
+        assert logger.is_async()
+        logger.set_rate_limit(3, 1000)
+
+        for i in range(10):
+            Log(LogLevel.Info, "Message %i" % i)
+        logger.flush()
+
+        # Only the first three messages from this call site pass
+        assert len(messages) == 3
+        assert messages[0].endswith('Message 0')
+        assert messages[2].endswith('Message 2')
+        assert logger.suppressed_count() >= 7
+        assert logger.dropped_count() == 0
+
+        # Errors are never rate limited
+        with pytest.raises(RuntimeError, match='Fatal'):
+            Log(LogLevel.Error, "Fatal")
+    finally:
+        logger.set_rate_limit(0)
+        logger.set_async(False)
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
+
+
+def test03_async_appenders_and_progress(variant_scalar_rgb):
+    from mitsuba.core import Thread, Appender, Log, LogLevel
+
+    events = []
+
+    class MyAppender(Appender):
+        def append(self, level, text):
+            events.append(text.split(': ')[-1])
+
+        def log_progress(self, progress, name, formatted, eta, ptr):
+            events.append('progress %s %.1f' % (name, progress))
+
+    logger = Thread.thread().logger()
+    appenders = []
+    while logger.appender_count() > 0:
+        app = logger.appender(0)
+        appenders.append(app)
+        logger.remove_appender(app)
+
+    try:
+        logger.add_appender(MyAppender())
+        logger.set_async(True)
+
+        # Progress updates are queued along with the messages
+        Log(LogLevel.Info, "Before")
+        logger.log_progress(0.5, "job", "[===   ]", "1s")
+        Log(LogLevel.Info, "After")
+
+        # Modifying the appenders while the drain thread invokes the Python
+        # appender (which needs the GIL held by this thread) must not deadlock
+        for i in range(200):
+            Log(LogLevel.Info, "Message %i" % i)
+            other = MyAppender()
+            logger.add_appender(other)
+            logger.remove_appender(other)
+        logger.flush()
+
+        assert events[:3] == ['Before', 'progress job 0.5', 'After']
+        messages = [e for e in events[3:] if e.startswith('Message')]
+        assert messages[:5] == ['Message %i' % i for i in range(5)]
+        assert messages[-1] == 'Message 199'
+    finally:
+        logger.set_async(False)
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
+
+
+def test04_async_flush_on_error(variant_scalar_rgb):
+    from mitsuba.core import Thread, Appender, Log, LogLevel
+    import time
+
+    messages = []
+
+    class SlowAppender(Appender):
+        def append(self, level, text):
+            # Keep the drain thread busy while further messages are queued
+            time.sleep(1e-3)
+            messages.append(text.split(': ')[-1])
+
+    logger = Thread.thread().logger()
+    appenders = []
+    while logger.appender_count() > 0:
+        app = logger.appender(0)
+        appenders.append(app)
+        logger.remove_appender(app)
+
+    try:
+        logger.add_appender(SlowAppender())
+        logger.set_async(True)
+
+        for i in range(50):
+            Log(LogLevel.Info, "Message %i" % i)
+
+        # All queued messages are appended (in order) before the error is raised
+        with pytest.raises(RuntimeError, match='Fatal'):
+            Log(LogLevel.Error, "Fatal")
+        assert messages == ['Message %i' % i for i in range(50)]
+    finally:
+        logger.set_async(False)
+        logger.clear_appenders()
+        for app in appenders:
+            logger.add_appender(app)
@@ -0,0 +1,79 @@
+import json
+import os
+import time
+import pytest
+
+import mitsuba
+mitsuba.set_variant('scalar_rgb')
+from mitsuba.core import Profiler
+from mitsuba.core.xml import load_string
+
+
+def render_scene():
+    scene = load_string("""
+        <scene version="2.0.0">
+            <integrator type="path"/>
+            <sensor type="perspective">
+                <film type="hdrfilm">
+                    <integer name="width" value="16"/>
+                    <integer name="height" value="16"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="16"/>
+                </sampler>
+            </sensor>
+            <emitter type="constant"/>
+            <bsdf type="diffuse" id="mat"/>
+            <shape type="sphere">
+                <ref id="mat"/>
+            </shape>
+        </scene>
+    """)
+    scene.integrator().render(scene, scene.sensors()[0])
+
+
+def test01_attribution(tmpdir):
+    Profiler.reset()
+    Profiler.start()
+    samples = []
+    deadline = time.time() + 10
+    while time.time() < deadline:
+        render_scene()
+        samples = Profiler.samples()
+        if any(label == 'diffuse:mat' for stack, _ in samples
+               for _, label in stack):
+            break
+    Profiler.stop()
+
+    if len(samples) == 0:
+        pytest.skip("Profiler is disabled or did not collect any samples")
+
+    assert not Profiler.running()
+    assert any(label == 'diffuse:mat' for stack, _ in samples
+               for _, label in stack)
+    assert all(count > 0 for _, count in samples)
+
+    # Worker threads inherit the frames of the thread that launched them, so
+    # BSDF samples are nested within the integrator instance
+    assert any(stack[0][1] == 'path' and
+               any(label == 'diffuse:mat' for _, label in stack)
+               for stack, _ in samples if len(stack) > 0)
+
+    folded = os.path.join(str(tmpdir), 'profile.folded')
+    Profiler.write_flamegraph(folded)
+    with open(folded) as f:
+        lines = f.read().splitlines()
+    assert len(lines) > 0
+    assert sum(int(l.rsplit(' ', 1)[1]) for l in lines) == \
+        sum(count for _, count in samples)
+    assert any('BSDF' in l and '[diffuse:mat]' in l for l in lines)
+
+    trace = os.path.join(str(tmpdir), 'profile.json')
+    Profiler.write_chrome_trace(trace)
+    with open(trace) as f:
+        events = json.load(f)['traceEvents']
+    assert events[0]['name'] == 'Profile'
+    assert all(e['ph'] == 'X' for e in events)
+
+    Profiler.reset()
+    assert len(Profiler.samples()) == 0
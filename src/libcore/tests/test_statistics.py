@@ -0,0 +1,53 @@
+import json
+import pytest
+
+import mitsuba
+mitsuba.set_variant('scalar_rgb')
+from mitsuba.core import Statistics, StatsCounter, StatsHistogram
+from mitsuba.core.xml import load_string
+
+
+def test01_json_layout():
+    Statistics.reset()
+    Statistics.merge()
+    data = json.loads(Statistics.to_json())
+    assert data['enabled'] == Statistics.enabled()
+    assert data['counters']['Camera rays'] == 0
+    assert len(data['histograms']['Path depth']['bins']) == \
+        len(Statistics.histogram(StatsHistogram.PathDepth))
+
+
+def test02_render_counters():
+    if not Statistics.enabled():
+        pytest.skip("Render statistics are disabled")
+
+    scene = load_string("""
+        <scene version="2.0.0">
+            <integrator type="path">
+                <integer name="rr_depth" value="1"/>
+            </integrator>
+            <sensor type="perspective">
+                <film type="hdrfilm">
+                    <integer name="width" value="8"/>
+                    <integer name="height" value="8"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="4"/>
+                </sampler>
+            </sensor>
+            <emitter type="constant"/>
+            <shape type="sphere"/>
+        </scene>
+    """)
+    scene.integrator().render(scene, scene.sensors()[0])
+
+    assert Statistics.counter(StatsCounter.CameraRays) == 8 * 8 * 4
+    assert Statistics.counter(StatsCounter.IntersectionRays) >= 8 * 8 * 4
+    assert Statistics.counter(StatsCounter.KDTreeLeafNodes) > 0
+    assert Statistics.counter(StatsCounter.PrimitiveTests) > 0
+
+    # Every camera ray contributes one vertex at depth 1 if it hits the sphere
+    depth = Statistics.histogram(StatsHistogram.PathDepth)
+    assert 0 < depth[1] <= 8 * 8 * 4
+    assert all(depth[i] >= depth[i + 1] for i in range(1, len(depth) - 1))
+    assert 'Camera rays' in Statistics.report()
@@ -5,7 +5,8 @@ import mitsuba
 
 mitsuba.set_variant('scalar_rgb')
 
-from mitsuba.core import Stream, DummyStream, FileStream, MemoryStream, ZStream
+from mitsuba.core import Stream, DummyStream, FileStream, MemoryStream, ZStream, \
+    SocketStream, ServerSocket
 from mitsuba.python.test.util import tmpfile, make_tmpfile
 
 parameters = [
@@ -38,7 +39,7 @@ def write_contents(stream):
 
 
 def check_contents(stream):
-    if type(stream) is not ZStream:
+    if type(stream) not in [ZStream, SocketStream]:
         stream.seek(0)
     for v in contents:
         if type(v) is str:
@@ -283,3 +284,169 @@ def test08_fstream(rw, tmpfile):
     else:
         with pytest.raises(RuntimeError):
             FileStream(new_name)
+
+
+def test09_socket_stream():
+    server = ServerSocket(0, '127.0.0.1')
+    assert server.port() > 0
+    # No pending connection
+    assert server.accept(0.0) is None
+
+    client = SocketStream('127.0.0.1', server.port())
+    connection = server.accept(5.0)
+    assert connection is not None
+    assert connection.byte_order() == Stream.ENetworkByteOrder
+
+    write_contents(client)
+    check_contents(connection)
+    assert connection.received_bytes() == client.sent_bytes()
+
+    # Reading past the end of a closed connection fails
+    client.close()
+    with pytest.raises(RuntimeError):
+        connection.read_int32()
+    connection.close()
+    server.close()
+    assert server.is_closed()
+
+
+def distributed_scene(tmpdir):
+    path = str(tmpdir.join('scene.xml'))
+    with open(path, 'w') as f:
+        f.write("""<scene version='2.0.0'>
+            <integrator type="path">
+                <integer name="max_depth" value="4"/>
+                <integer name="block_size" value="16"/>
+            </integrator>
+            <sensor type="perspective">
+                <transform name="to_world">
+                    <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+                </transform>
+                <film type="hdrfilm">
+                    <integer name="width" value="64"/>
+                    <integer name="height" value="64"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="256"/>
+                </sampler>
+            </sensor>
+            <emitter type="constant"/>
+            <shape type="sphere"/>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <scale value="3"/>
+                    <translate z="-1"/>
+                </transform>
+            </shape>
+        </scene>""")
+    return path
+
+
+class Process:
+    """Runs the mitsuba executable and collects its output in the background"""
+
+    def __init__(self, *args):
+        import subprocess
+        import threading
+
+        self.lines = []
+        self.process = subprocess.Popen(['mitsuba', '-m', 'scalar_rgb'] + list(args),
+                                        stdout=subprocess.PIPE,
+                                        stderr=subprocess.STDOUT,
+                                        universal_newlines=True)
+
+        def collect():
+            for line in self.process.stdout:
+                self.lines.append(line)
+        self.thread = threading.Thread(target=collect, daemon=True)
+        self.thread.start()
+
+    def wait_for(self, text, timeout=60):
+        import time
+        start = time.time()
+        while not any(text in line for line in self.lines):
+            if self.process.poll() is not None or time.time() - start > timeout:
+                raise Exception('"%s" was not logged:\n%s' % (text, self.output()))
+            time.sleep(0.05)
+
+    def wait(self, timeout=120):
+        code = self.process.wait(timeout)
+        self.thread.join()
+        return code
+
+    def output(self):
+        return ''.join(self.lines)
+
+
+def free_port():
+    server = ServerSocket(0, '127.0.0.1')
+    port = server.port()
+    server.close()
+    return port
+
+
+def test10_distributed_render(tmpdir):
+    import shutil
+    import time
+    import numpy as np
+    from mitsuba.core import Bitmap
+
+    if shutil.which('mitsuba') is None:
+        pytest.skip("mitsuba executable not found")
+
+    scene = distributed_scene(tmpdir)
+    port = free_port()
+    master = Process('-L', str(port), scene, '-o', str(tmpdir.join('master.exr')))
+    workers = []
+    try:
+        master.wait_for('Distributing')
+        workers = [Process('-t', '2', '-C', '127.0.0.1:%i' % port) for i in range(3)]
+
+        # Kill a worker while the job is in progress: its blocks are re-rendered by others
+        workers[0].wait_for('connecting to the master')
+        time.sleep(0.5)
+        workers[0].process.kill()
+
+        assert master.wait() == 0, master.output()
+        for worker in workers[1:]:
+            assert worker.wait() == 0, worker.output()
+    finally:
+        for p in [master] + workers:
+            if p.process.poll() is None:
+                p.process.kill()
+
+    local = Process(scene, '-o', str(tmpdir.join('local.exr')))
+    assert local.wait() == 0, local.output()
+
+    # Blocks are seeded by their identifier, hence the images match
+    image_master = np.array(Bitmap(str(tmpdir.join('master.exr'))))
+    image_local = np.array(Bitmap(str(tmpdir.join('local.exr'))))
+    assert image_master.shape == (64, 64, 3)
+    assert np.mean(image_local) > 0
+    assert np.allclose(image_master, image_local, rtol=1e-4, atol=1e-5)
+
+
+def test11_distributed_render_worker_error(tmpdir):
+    import shutil
+
+    if shutil.which('mitsuba') is None:
+        pytest.skip("mitsuba executable not found")
+
+    # The workers can't load the scene, which the master loaded before
+    scene = distributed_scene(tmpdir)
+    port = free_port()
+    master = Process('-L', str(port), scene, '-o', str(tmpdir.join('master.exr')))
+    workers = []
+    try:
+        master.wait_for('Distributing')
+        os.remove(scene)
+        workers = [Process('-t', '2', '-C', '127.0.0.1:%i' % port) for i in range(2)]
+
+        # The master gives up instead of waiting for workers forever
+        assert master.wait(60) != 0
+        assert 'aborting the job' in master.output()
+        assert 'scene.xml' in master.output()
+    finally:
+        for p in [master] + workers:
+            if p.process.poll() is None:
+                p.process.kill()
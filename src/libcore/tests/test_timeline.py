@@ -0,0 +1,72 @@
+import json
+import pytest
+
+import mitsuba
+
+
+def test01_add_events(variant_scalar_rgb):
+    from mitsuba.core import Timeline, util
+
+    Timeline.set_enabled(True)
+    try:
+        Timeline.reset()
+        start = Timeline.time()
+        rss = util.current_rss()
+        Timeline.add("custom", "my \"event\"", start, rss)
+
+        events = Timeline.events()
+        assert len(events) == 1
+        assert events[0].category == "custom"
+        assert events[0].name == "my \"event\""
+        assert events[0].duration >= 0
+        assert events[0].peak_rss >= events[0].rss_end > 0
+
+        data = json.loads(Timeline.to_json())
+        assert data['peak_rss'] >= data['rss'] > 0
+        assert data['phases']['custom']['count'] == 1
+        assert data['events'][0]['name'] == "my \"event\""
+    finally:
+        Timeline.set_enabled(False)
+
+    # Events are ignored while the timeline is disabled
+    Timeline.reset()
+    Timeline.add("custom", "ignored", Timeline.time(), 0)
+    assert len(Timeline.events()) == 0
+
+
+def test02_render_phases(variant_scalar_rgb):
+    from mitsuba.core import Timeline
+    from mitsuba.core.xml import load_string
+
+    Timeline.set_enabled(True)
+    try:
+        Timeline.reset()
+        scene = load_string("""
+            <scene version="2.0.0">
+                <integrator type="direct">
+                    <integer name="samples_per_pass" value="2"/>
+                </integrator>
+                <sensor type="perspective">
+                    <film type="hdrfilm">
+                        <integer name="width" value="16"/>
+                        <integer name="height" value="16"/>
+                    </film>
+                    <sampler type="independent">
+                        <integer name="sample_count" value="4"/>
+                    </sampler>
+                </sensor>
+                <shape type="sphere"/>
+                <emitter type="constant"/>
+            </scene>
+        """)
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        events = Timeline.events()
+    finally:
+        Timeline.set_enabled(False)
+
+    categories = [e.category for e in events]
+    for c in ["load", "accel", "render"]:
+        assert c in categories
+    assert categories.count("pass") == 2
+    assert any(e.category == "load" and e.name.startswith("sphere") for e in events)
@@ -1,3 +1,4 @@
+import os
 import enoki as ek
 import pytest
 import mitsuba
@@ -297,3 +298,57 @@ def test20_upgrade_tree(variant_scalar_rgb):
                                <float name="intIOR" value="1.33"/>
                            </bsdf>
                        </scene>""")
+
+
+def test21_deferred_instantiation(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    scene_str = """<scene version="2.0.0">
+                       <bsdf type="diffuse" id="used"/>
+                       <bsdf type="diffuse" id="unused">
+                           <float name="not_a_property" value="1"/>
+                       </bsdf>
+                       <shape type="sphere">
+                           <ref id="used"/>
+                       </shape>
+                   </scene>"""
+
+    # Eager loading instantiates the faulty (but unused) BSDF
+    with pytest.raises(Exception) as e:
+        xml.load_string(scene_str)
+    e.match('unreferenced property')
+
+    # Deferred loading skips it
+    scene = xml.load_string(scene_str, deferred=True)
+    assert len(scene.shapes()) == 1
+
+
+def test22_compiled_scene(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import xml
+
+    scene_file = os.path.join(str(tmpdir), "scene.xml")
+    compiled_file = os.path.join(str(tmpdir), "scene.mtsc")
+    with open(scene_file, "w") as f:
+        f.write("""<scene version="2.0.0">
+                       <bsdf type="diffuse" id="mat">
+                           <rgb name="reflectance" value="$r, 0.5, 0.25"/>
+                       </bsdf>
+                       <shape type="sphere">
+                           <transform name="to_world">
+                               <translate x="1" y="2" z="3"/>
+                           </transform>
+                           <ref id="mat"/>
+                       </shape>
+                   </scene>""")
+
+    scene = xml.load_file(scene_file, write_compiled=compiled_file, r=0.75)
+    assert os.path.exists(compiled_file)
+
+    scene2 = xml.load_file(compiled_file)
+    assert len(scene2.shapes()) == 1
+    assert scene.bbox() == scene2.bbox()
+
+    # Compiled scenes are specific to the parameter values
+    with pytest.raises(Exception) as e:
+        xml.load_file(compiled_file, r=0.5)
+    e.match('different parameter values')
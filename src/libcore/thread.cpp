@@ -1,10 +1,12 @@
 #include <mitsuba/core/thread.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/numa.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/profiler.h>
 #include <tbb/task_scheduler_observer.h>
+#include <algorithm>
 #include <condition_variable>
 #include <thread>
 #include <sstream>
@@ -93,6 +95,7 @@ struct Thread::ThreadPrivate {
     bool tbb_thread = false;
     bool critical = false;
     int core_affinity = -1;
+    int numa_node = -1;
     Thread::EPriority priority;
     ref<Logger> logger;
     ref<Thread> parent;
@@ -169,6 +172,10 @@ int Thread::core_affinity() const {
     return d->core_affinity;
 }
 
+int Thread::numa_node() const {
+    return d->numa_node;
+}
+
 uint32_t Thread::thread_id() {
 #if defined(__WINDOWS__)
     return this_thread_id;
@@ -244,100 +251,146 @@ bool Thread::set_priority(EPriority priority) {
     return true;
 }
 
-void Thread::set_core_affinity(int core_id) {
-    d->core_affinity = core_id;
-    if (!d->running)
-        return;
-
-#if defined(__OSX__)
-    /* CPU affinity not supported on OSX */
-#elif defined(__LINUX__)
-    int core_count = sysconf(_SC_NPROCESSORS_CONF),
-        logical_core_count = core_count;
-
-    size_t size = 0;
-    cpu_set_t *cpuset = nullptr;
-    int retval = 0;
+#if defined(__LINUX__)
+/// Return the logical processors that a thread may currently run on
+static std::vector<int> native_affinity(std::thread::native_handle_type handle,
+                                        const char *caller) {
+    int cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    std::vector<int> cpus;
 
     /* The kernel may expect a larger cpu_set_t than would be warranted by the
        physical core count. Keep querying with increasingly larger buffers if
        the pthread_getaffinity_np operation fails */
-    for (int i = 0; i<10; ++i) {
-        size = CPU_ALLOC_SIZE(logical_core_count);
-        cpuset = CPU_ALLOC(logical_core_count);
+    for (int i = 0; i < 10; ++i) {
+        size_t size = CPU_ALLOC_SIZE(cpu_count);
+        cpu_set_t *cpuset = CPU_ALLOC(cpu_count);
         if (!cpuset) {
-            Log(Warn, "Thread::set_core_affinity(): could not allocate cpu_set_t");
-            return;
+            Log(Warn, "%s: could not allocate cpu_set_t", caller);
+            return cpus;
         }
 
         CPU_ZERO_S(size, cpuset);
-
-        int retval = pthread_getaffinity_np(d->native_handle, size, cpuset);
-        if (retval == 0)
-            break;
-
-        /* Something went wrong -- release memory */
+        int retval = pthread_getaffinity_np(handle, size, cpuset);
+        if (retval == 0) {
+            for (int j = 0; j < cpu_count; ++j) {
+                if (CPU_ISSET_S(j, size, cpuset))
+                    cpus.push_back(j);
+            }
+        }
         CPU_FREE(cpuset);
 
         if (retval == EINVAL) {
             /* Retry with a larger cpuset */
-            logical_core_count *= 2;
+            cpu_count *= 2;
         } else {
+            if (retval)
+                Log(Warn, "%s: pthread_getaffinity_np(): could not read thread "
+                    "affinity map: %s", caller, strerror(retval));
             break;
         }
     }
+    return cpus;
+}
+#endif
+
+/// Restrict a thread to the given set of logical processors
+static bool set_native_affinity(std::thread::native_handle_type handle,
+                                const std::vector<int> &cpus,
+                                const char *caller) {
+#if defined(__LINUX__)
+    int cpu_count = (int) sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu : cpus)
+        cpu_count = std::max(cpu_count, cpu + 1);
+
+    size_t size = CPU_ALLOC_SIZE(cpu_count);
+    cpu_set_t *cpuset = CPU_ALLOC(cpu_count);
+    if (!cpuset) {
+        Log(Warn, "%s: could not allocate cpu_set_t", caller);
+        return false;
+    }
+    CPU_ZERO_S(size, cpuset);
+    for (int cpu : cpus)
+        CPU_SET_S(cpu, size, cpuset);
 
+    int retval = pthread_setaffinity_np(handle, size, cpuset);
+    CPU_FREE(cpuset);
     if (retval) {
-        Log(Warn, "Thread::set_core_affinity(): pthread_getaffinity_np(): could "
-            "not read thread affinity map: %s", strerror(retval));
-        return;
+        Log(Warn, "%s: pthread_setaffinity_np: failed: %s", caller,
+            strerror(retval));
+        return false;
     }
-
-    int actual_core_id = -1, available = 0;
-    for (int i=0; i<logical_core_count; ++i) {
-        if (!CPU_ISSET_S(i, size, cpuset))
-            continue;
-        if (available++ == core_id) {
-            actual_core_id = i;
-            break;
-        }
+    return true;
+#elif defined(__WINDOWS__)
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus)
+        if (cpu < (int) (sizeof(DWORD_PTR) * 8))
+            mask |= (DWORD_PTR) 1 << cpu;
+    if (!SetThreadAffinityMask(handle, mask)) {
+        Log(Warn, "%s: SetThreadAffinityMask : failed", caller);
+        return false;
     }
+    return true;
+#else
+    /* CPU affinity not supported on OSX */
+    (void) handle; (void) cpus; (void) caller;
+    return false;
+#endif
+}
 
-    if (actual_core_id == -1) {
-        Log(Warn, "Thread::set_core_affinity(): out of bounds: %i/%i cores "
-                   "available, requested #%i!",
-            available, core_count, core_id);
-        CPU_FREE(cpuset);
+void Thread::set_core_affinity(int core_id) {
+    d->core_affinity = core_id;
+    if (!d->running)
         return;
-    }
 
-    CPU_ZERO_S(size, cpuset);
-    CPU_SET_S(actual_core_id, size, cpuset);
+#if defined(__OSX__)
+    /* CPU affinity not supported on OSX */
+#elif defined(__LINUX__)
+    /* Select the requested core among those that the thread may currently
+       run on (e.g. as restricted by taskset) */
+    std::vector<int> available =
+        native_affinity(d->native_handle, "Thread::set_core_affinity()");
+    if (available.empty())
+        return;
 
-    retval = pthread_setaffinity_np(d->native_handle, size, cpuset);
-    if (retval) {
-        Log(Warn,
-            "Thread::set_core_affinity(): pthread_setaffinity_np: failed: %s",
-            strerror(retval));
-        CPU_FREE(cpuset);
+    if (core_id < 0 || core_id >= (int) available.size()) {
+        Log(Warn, "Thread::set_core_affinity(): out of bounds: %i/%i cores "
+                   "available, requested #%i!",
+            available.size(), sysconf(_SC_NPROCESSORS_CONF), core_id);
         return;
     }
 
-    CPU_FREE(cpuset);
+    set_native_affinity(d->native_handle, { available[core_id] },
+                        "Thread::set_core_affinity()");
 #elif defined(__WINDOWS__)
     int core_count = util::core_count();
-    const HANDLE handle = d->native_handle;
-
-    DWORD_PTR mask;
+    std::vector<int> cpus;
+    if (core_id != -1 && core_id < core_count) {
+        cpus.push_back(core_id);
+    } else {
+        for (int i = 0; i < core_count; ++i)
+            cpus.push_back(i);
+    }
+    set_native_affinity(d->native_handle, cpus, "Thread::set_core_affinity()");
+#endif
+}
 
-    if (core_id != -1 && core_id < core_count)
-        mask = (DWORD_PTR) 1 << core_id;
-    else
-        mask = (1 << core_count) - 1;
+void Thread::set_numa_node(int node) {
+    if (d->numa_node == node)
+        return;
+    d->numa_node = node;
+    if (!d->running)
+        return;
 
-    if (!SetThreadAffinityMask(handle, mask))
-        Log(Warn, "Thread::set_core_affinity(): SetThreadAffinityMask : failed");
-#endif
+    std::vector<int> cpus;
+    if (node >= 0) {
+        cpus = numa::node_cpus((size_t) node);
+    } else {
+        for (size_t i = 0; i < numa::node_count(); ++i) {
+            const std::vector<int> &node_cpus = numa::node_cpus(i);
+            cpus.insert(cpus.end(), node_cpus.begin(), node_cpus.end());
+        }
+    }
+    set_native_affinity(d->native_handle, cpus, "Thread::set_numa_node()");
 }
 
 void Thread::start() {
@@ -395,6 +448,12 @@ void Thread::dispatch() {
     if (d->core_affinity != -1)
         set_core_affinity(d->core_affinity);
 
+    if (d->numa_node != -1) {
+        int node = d->numa_node;
+        d->numa_node = -1;
+        set_numa_node(node);
+    }
+
     try {
         run();
     } catch (std::exception &e) {
@@ -537,6 +596,7 @@ void Thread::static_initialization() {
 }
 
 void Thread::static_shutdown() {
+    numa::static_shutdown();
     observer->wait();
     observer.reset();
     thread()->d->running = false;
@@ -556,7 +616,7 @@ ThreadEnvironment::ThreadEnvironment() {
     m_logger = thread->logger();
     m_file_resolver = thread->file_resolver();
 #if defined(MTS_ENABLE_PROFILER)
-    m_profiler_flags = *profiler_flags();
+    m_profiler_stack = *profiler_stack();
 #endif
 }
 
@@ -568,9 +628,9 @@ ScopedSetThreadEnvironment::ScopedSetThreadEnvironment(ThreadEnvironment &env) {
     thread->set_logger(env.m_logger);
     thread->set_file_resolver(env.m_file_resolver);
 #if defined(MTS_ENABLE_PROFILER)
-    uint64_t *profiler_flags = mitsuba::profiler_flags();
-    m_profiler_flags = *profiler_flags;
-    *profiler_flags = env.m_profiler_flags;
+    ProfilerStack *stack = profiler_stack();
+    m_profiler_stack = *stack;
+    profiler_assign_stack(stack, env.m_profiler_stack);
 #endif
 }
 
@@ -579,7 +639,7 @@ ScopedSetThreadEnvironment::~ScopedSetThreadEnvironment() {
     thread->set_logger(m_logger);
     thread->set_file_resolver(m_file_resolver);
 #if defined(MTS_ENABLE_PROFILER)
-    *profiler_flags() = m_profiler_flags;
+    profiler_assign_stack(profiler_stack(), m_profiler_stack);
 #endif
 }
 
@@ -0,0 +1,152 @@
+#include <mitsuba/core/timeline.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+NAMESPACE_BEGIN(mitsuba)
+
+using TimelineClock = std::chrono::steady_clock;
+
+static std::atomic<bool> timeline_enabled { false };
+static std::mutex timeline_mutex;
+static std::vector<TimelineEvent> timeline_events;
+static std::atomic<TimelineClock::rep> timeline_origin {
+    TimelineClock::now().time_since_epoch().count()
+};
+
+void Timeline::set_enabled(bool enabled) {
+    timeline_enabled = enabled;
+}
+
+bool Timeline::enabled() {
+    return timeline_enabled;
+}
+
+void Timeline::reset() {
+    std::lock_guard<std::mutex> guard(timeline_mutex);
+    timeline_events.clear();
+    timeline_origin = TimelineClock::now().time_since_epoch().count();
+}
+
+double Timeline::time() {
+    TimelineClock::duration elapsed =
+        TimelineClock::now().time_since_epoch() - TimelineClock::duration(timeline_origin.load());
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+void Timeline::add(const std::string &category, const std::string &name,
+                   double start, size_t rss_start) {
+    if (!timeline_enabled)
+        return;
+    Thread *thread = Thread::thread();
+    TimelineEvent event { category, name, thread ? thread->name() : std::string(),
+                          start, time() - start, rss_start, util::current_rss(),
+                          util::peak_rss() };
+    std::lock_guard<std::mutex> guard(timeline_mutex);
+    timeline_events.push_back(std::move(event));
+}
+
+std::vector<TimelineEvent> Timeline::events() {
+    std::lock_guard<std::mutex> guard(timeline_mutex);
+    return timeline_events;
+}
+
+static std::string json_escape(const std::string &str) {
+    std::string result;
+    result.reserve(str.size() + 2);
+    result += '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if ((unsigned char) c < 0x20)
+                    result += tfm::format("\\u%04x", (int) c);
+                else
+                    result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+std::string Timeline::to_json() {
+    std::vector<TimelineEvent> events = Timeline::events();
+
+    struct Summary {
+        size_t count = 0;
+        double duration = 0.0;
+        int64_t rss_delta = 0;
+    };
+    std::map<std::string, Summary> summary;
+    for (const TimelineEvent &e : events) {
+        Summary &s = summary[e.category];
+        s.count++;
+        s.duration += e.duration;
+        s.rss_delta += (int64_t) e.rss_end - (int64_t) e.rss_start;
+    }
+
+    std::ostringstream oss;
+    oss << "{" << std::endl
+        << "  \"duration\": " << time() << "," << std::endl
+        << "  \"rss\": " << util::current_rss() << "," << std::endl
+        << "  \"peak_rss\": " << util::peak_rss() << "," << std::endl
+        << "  \"phases\": {" << std::endl;
+    size_t i = 0;
+    for (const auto &kv : summary) {
+        oss << "    " << json_escape(kv.first) << ": { \"count\": " << kv.second.count
+            << ", \"duration\": " << kv.second.duration
+            << ", \"rss_delta\": " << kv.second.rss_delta << " }"
+            << (++i < summary.size() ? "," : "") << std::endl;
+    }
+    oss << "  }," << std::endl
+        << "  \"events\": [" << std::endl;
+    for (size_t j = 0; j < events.size(); ++j) {
+        const TimelineEvent &e = events[j];
+        oss << "    { \"category\": " << json_escape(e.category)
+            << ", \"name\": " << json_escape(e.name)
+            << ", \"thread\": " << json_escape(e.thread)
+            << ", \"start\": " << e.start
+            << ", \"duration\": " << e.duration
+            << ", \"rss_start\": " << e.rss_start
+            << ", \"rss_end\": " << e.rss_end
+            << ", \"peak_rss\": " << e.peak_rss << " }"
+            << (j + 1 < events.size() ? "," : "") << std::endl;
+    }
+    oss << "  ]" << std::endl
+        << "}";
+    return oss.str();
+}
+
+void Timeline::write_json(const fs::path &path) {
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    fs->write_line(to_json());
+    fs->close();
+    Log(Info, "Timeline: wrote \"%s\"", path.string());
+}
+
+ScopedTimelineEvent::ScopedTimelineEvent(const std::string &category,
+                                         const std::string &name)
+    : m_active(Timeline::enabled()) {
+    if (!m_active)
+        return;
+    m_category = category;
+    m_name = name;
+    m_rss_start = util::current_rss();
+    m_start = Timeline::time();
+}
+
+ScopedTimelineEvent::~ScopedTimelineEvent() {
+    if (m_active)
+        Timeline::add(m_category, m_name, m_start, m_rss_start);
+}
+
+NAMESPACE_END(mitsuba)
@@ -12,13 +12,18 @@
 #  include <unistd.h>
 #  include <limits.h>
 #  include <sys/ioctl.h>
+#  include <sys/resource.h>
+#  include <cstdio>
 #elif defined(__OSX__)
 #  include <sys/sysctl.h>
+#  include <sys/resource.h>
+#  include <mach/mach.h>
 #  include <mach-o/dyld.h>
 #  include <unistd.h>
 #  include <sys/ioctl.h>
 #elif defined(__WINDOWS__)
 #  include <windows.h>
+#  include <psapi.h>
 #endif
 
 NAMESPACE_BEGIN(mitsuba)
@@ -118,6 +123,49 @@ done:
 #endif
 }
 
+size_t current_rss() {
+#if defined(__LINUX__)
+    long pages = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    if (fscanf(f, "%*s %ld", &pages) != 1)
+        pages = 0;
+    fclose(f);
+    return (size_t) pages * (size_t) sysconf(_SC_PAGESIZE);
+#elif defined(__OSX__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return (size_t) info.resident_size;
+#elif defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS info;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+        return 0;
+    return (size_t) info.WorkingSetSize;
+#endif
+}
+
+size_t peak_rss() {
+#if defined(__WINDOWS__)
+    PROCESS_MEMORY_COUNTERS info;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info)))
+        return 0;
+    return (size_t) info.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#  if defined(__OSX__)
+    return (size_t) usage.ru_maxrss; // bytes
+#  else
+    return (size_t) usage.ru_maxrss * 1024; // kilobytes
+#  endif
+#endif
+}
+
 bool detect_debugger() {
 #if defined(__LINUX__)
     char exePath[PATH_MAX];
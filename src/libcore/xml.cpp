@@ -1,21 +1,31 @@
 #include <cctype>
+#include <cstring>
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <mitsuba/core/class.h>
 #include <mitsuba/core/config.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timeline.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
 #include <pugixml.hpp>
@@ -255,6 +265,14 @@ bool check_cuda() {
 }
 
 
+/// Description of an object created while parsing (e.g. an inline <rgb> texture)
+struct XMLInlineObject {
+    Properties props;
+    const Class *class_ = nullptr;
+    std::vector<Float> wavelengths, values;
+    bool expand = false;
+};
+
 struct XMLParseContext {
     std::unordered_map<std::string, XMLObject> instances;
     Transform4f transform;
@@ -262,6 +280,10 @@ struct XMLParseContext {
     bool parallelize;
     ColorMode color_mode;
 
+    /// Keep track of objects created while parsing (needed to compile the scene)
+    bool record_inline_objects = false;
+    std::unordered_map<const Object *, XMLInlineObject> inline_objects;
+
     XMLParseContext(const std::string &variant) : variant(variant) {
         color_mode = MTS_INVOKE_VARIANT(variant, variant_to_color_mode);
 
@@ -273,6 +295,38 @@ struct XMLParseContext {
     std::string variant;
 };
 
+/**
+ * \brief Create a texture while parsing (e.g. for an <rgb> or <spectrum> tag)
+ *
+ * Non-empty \c wavelengths and \c values arrays are passed to the plugin as
+ * pointers. When \c expand is set, the object is replaced by its expansion.
+ */
+static ref<Object> create_inline_texture(XMLParseContext &ctx, const Properties &props,
+                                         const std::vector<Float> &wavelengths = {},
+                                         const std::vector<Float> &values = {},
+                                         bool expand = false) {
+    const Class *class_ = Class::for_name("Texture", ctx.variant);
+    Properties props2(props);
+    if (!wavelengths.empty())
+        props2.set_pointer("wavelengths", wavelengths.data());
+    if (!values.empty())
+        props2.set_pointer("values", values.data());
+
+    ref<Object> obj = PluginManager::instance()->create_object(props2, class_);
+    if (expand) {
+        auto expanded = obj->expand();
+        Assert(expanded.size() <= 1);
+        if (!expanded.empty())
+            obj = expanded[0];
+    }
+
+    if (ctx.record_inline_objects)
+        ctx.inline_objects[obj.get()] =
+            XMLInlineObject{ props, class_, wavelengths, values, expand };
+
+    return obj;
+}
+
 /// Helper function to check if attributes are fully specified
 static void check_attributes(XMLSource &src, const pugi::xml_node &node,
                              std::set<std::string> &&attrs, bool expect_all = true) {
@@ -778,8 +832,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         if (!within_emitter && is_ior)
                             props2.set_bool("unbounded", true);
 
-                        ref<Object> obj = PluginManager::instance()->create_object(
-                            props2, Class::for_name("Texture", ctx.variant));
+                        ref<Object> obj = create_inline_texture(ctx, props2);
                         props.set_object(node.attribute("name").value(), obj);
                     } else {
                         props.set_color("color", col);
@@ -814,12 +867,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                             props2.set_float("value", value);
                         }
 
-                        ref<Object> obj = PluginManager::instance()->create_object(
-                            props2, Class::for_name("Texture", ctx.variant));
-                        auto expanded = obj->expand();
-                        Assert(expanded.size() <= 1);
-                        if (!expanded.empty())
-                            obj = expanded[0];
+                        ref<Object> obj = create_inline_texture(ctx, props2, {}, {}, true);
                         props.set_object(node.attribute("name").value(), obj);
                     } else {
                         /* Parse wavelength:value pairs, either inlined or from an external file.
@@ -881,19 +929,18 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                             props2.set_long("size", wavelengths.size());
                             props2.set_float("lambda_min", wavelengths.front());
                             props2.set_float("lambda_max", wavelengths.back());
-                            props2.set_pointer("values", values.data());
                         } else {
                             props2.set_plugin_name("irregular");
                             props2.set_long("size", wavelengths.size());
-                            props2.set_pointer("wavelengths", wavelengths.data());
-                            props2.set_pointer("values", values.data());
                         }
 
-                        ref<Object> obj = PluginManager::instance()->create_object(
-                            props2, Class::for_name("Texture", ctx.variant));
-
-                        // In non-spectral mode, pre-integrate against the CIE matching curves
-                        if (ctx.color_mode != ColorMode::Spectral) {
+                        ref<Object> obj;
+                        if (ctx.color_mode == ColorMode::Spectral) {
+                            obj = create_inline_texture(ctx, props2,
+                                                        is_regular ? std::vector<Float>() : wavelengths,
+                                                        values);
+                        } else {
+                            // In non-spectral mode, pre-integrate against the CIE matching curves
 
                             /// Spectral IOR values are unbounded and require special handling
                             std::string name = node.attribute("name").value();
@@ -914,8 +961,7 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                                     props3.set_bool("unbounded", true);
                             }
 
-                            obj = PluginManager::instance()->create_object(
-                                props3, Class::for_name("Texture", ctx.variant));
+                            obj = create_inline_texture(ctx, props3);
                         }
 
                         props.set_object(node.attribute("name").value(), obj);
@@ -1028,6 +1074,18 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
     return std::make_pair("", "");
 }
 
+/// Descriptive name of an object for the timeline, e.g. 'ply "bunny" (bunny.ply)'
+static std::string timeline_name(const Properties &props) {
+    if (!Timeline::enabled())
+        return std::string();
+    std::string name = props.plugin_name();
+    if (!props.id().empty() && props.id()[0] != '_')
+        name += " \"" + props.id() + "\"";
+    if (props.has_property("filename"))
+        name += " (" + props.as_string("filename") + ")";
+    return name;
+}
+
 static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id) {
     auto it = ctx.instances.find(id);
     if (it == ctx.instances.end())
@@ -1094,6 +1152,7 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
         functor(range);
 
     try {
+        ScopedTimelineEvent timeline_event("load", timeline_name(props));
         inst.object = PluginManager::instance()->create_object(props, inst.class_);
     } catch (const std::exception &e) {
         Throw("Error while loading \"%s\" (near %s): could not instantiate "
@@ -1125,10 +1184,466 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
     return inst.object;
 }
 
+/// Follow <alias> chains to the id of the object that is actually instantiated
+static std::string resolve_alias(XMLParseContext &ctx, std::string id) {
+    for (size_t i = 0; i <= ctx.instances.size(); ++i) {
+        auto it = ctx.instances.find(id);
+        if (it == ctx.instances.end())
+            Throw("reference to unknown object \"%s\"!", id);
+        if (it->second.alias.empty())
+            return id;
+        id = it->second.alias;
+    }
+    Throw("cyclic alias involving object \"%s\"!", id);
+}
+
+/**
+ * \brief Deferred instantiation of the object graph rooted at \c root_id
+ *
+ * In contrast to \ref instantiate_node(), which creates objects eagerly
+ * while recursing through the graph, this function first builds the
+ * dependency graph of all reachable objects. Top-level objects with a
+ * user-specified ID that the scene does not consume directly (e.g. BSDFs or
+ * textures in a shared material library) are skipped unless another
+ * instantiated object references them. The remaining objects are created in
+ * topologically sorted waves, each of which is processed in parallel.
+ */
+static ref<Object> instantiate_deferred(XMLParseContext &ctx, const std::string &root_id) {
+    Timer timer;
+    std::string root = resolve_alias(ctx, root_id);
+    XMLObject &root_inst = ctx.instances[root];
+
+    // Object types that the scene consumes directly, even if unreferenced
+    auto consumed_by_scene = [](const XMLObject &inst) {
+        const std::string &name = inst.class_->name();
+        return name == "Shape" || name == "Emitter" || name == "Sensor" || name == "Integrator";
+    };
+
+    std::unordered_map<std::string, std::vector<std::string>> deps;
+    std::vector<std::string> stack;
+    size_t skipped = 0;
+
+    // Determine which direct children of the root must be instantiated
+    bool is_scene = root_inst.class_->name() == "Scene";
+    std::vector<std::pair<std::string, std::string>> candidates;
+    deps[root];
+    for (auto &kv : root_inst.props.named_references()) {
+        std::string id = resolve_alias(ctx, kv.second);
+        const XMLObject &inst = ctx.instances[id];
+        if (!is_scene || string::starts_with(id, "_unnamed_") || consumed_by_scene(inst))
+            stack.push_back(id);
+        else
+            candidates.emplace_back(kv.first, id);
+        deps[root].push_back(id);
+    }
+
+    // Collect all objects reachable from the ones that are instantiated anyways
+    while (!stack.empty()) {
+        std::string id = stack.back();
+        stack.pop_back();
+        if (deps.find(id) != deps.end())
+            continue;
+        auto &list = deps[id];
+        for (auto &kv : ctx.instances[id].props.named_references()) {
+            std::string dep = resolve_alias(ctx, kv.second);
+            list.push_back(dep);
+            stack.push_back(dep);
+        }
+    }
+
+    // Skip library objects that nothing else refers to
+    for (auto &[name, id] : candidates) {
+        if (deps.find(id) != deps.end())
+            continue;
+        Log(Debug, "Skipping unreferenced object \"%s\"", id);
+        root_inst.props.remove_property(name);
+        auto &root_deps = deps[root];
+        root_deps.erase(std::remove(root_deps.begin(), root_deps.end(), id),
+                        root_deps.end());
+        skipped++;
+    }
+
+    // Instantiate the remaining objects in topologically sorted waves
+    std::unordered_set<std::string> done;
+    std::vector<std::pair<size_t, std::string>> load_times;
+    std::mutex load_times_mutex;
+    ThreadEnvironment env;
+    size_t wave_count = 0;
+
+    while (done.size() < deps.size()) {
+        std::vector<std::string> wave;
+        for (auto &[id, list] : deps) {
+            if (done.find(id) != done.end())
+                continue;
+            bool ready = true;
+            for (auto &dep : list)
+                ready &= done.find(dep) != done.end();
+            if (ready)
+                wave.push_back(id);
+        }
+
+        if (wave.empty())
+            Throw("Error while loading \"%s\": the scene contains a cyclic "
+                  "reference!", root_inst.src_id);
+
+        auto functor = [&](const tbb::blocked_range<uint32_t> &range) {
+            ScopedSetThreadEnvironment set_env(env);
+            for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                Timer obj_timer;
+                auto instantiate = [&]() { instantiate_node(ctx, wave[i]); };
+
+                // Isolate from parent tasks to prevent deadlocks (see instantiate_node)
+                if (ctx.parallelize)
+                    tbb::this_task_arena::isolate(instantiate);
+                else
+                    instantiate();
+
+                size_t time = obj_timer.value();
+                std::lock_guard<std::mutex> guard(load_times_mutex);
+                load_times.emplace_back(time, wave[i]);
+            }
+        };
+
+        tbb::blocked_range<uint32_t> range(0u, (uint32_t) wave.size(), 1);
+        if (ctx.parallelize)
+            tbb::parallel_for(range, functor);
+        else
+            functor(range);
+
+        done.insert(wave.begin(), wave.end());
+        wave_count++;
+    }
+
+    // Report the most expensive objects
+    std::sort(load_times.begin(), load_times.end(),
+              [](const auto &a, const auto &b) { return a.first > b.first; });
+    for (size_t i = 0; i < std::min(load_times.size(), (size_t) 10); ++i) {
+        const XMLObject &inst = ctx.instances[load_times[i].second];
+        Log(Debug, "  %s \"%s\" (%s): %s", string::to_lower(inst.class_->name()),
+            load_times[i].second, inst.props.plugin_name(),
+            util::time_string(load_times[i].first));
+    }
+
+    Log(Info, "Instantiated %i objects in %i waves (%i unreferenced objects skipped, took %s)",
+        done.size(), wave_count, skipped, util::time_string(timer.value()));
+
+    return instantiate_node(ctx, root);
+}
+
+// Compiled scene format ("MTSC" followed by a format version number)
+static const char compiled_scene_magic[4] = { 'M', 'T', 'S', 'C' };
+static const uint32_t compiled_scene_version = 1;
+
+/// Check whether a file contains a compiled scene
+static bool is_compiled_scene(const fs::path &filename) {
+    std::ifstream is(filename.native(), std::ios::binary);
+    char magic[4];
+    return (bool) is.read(magic, 4) &&
+           memcmp(magic, compiled_scene_magic, 4) == 0;
+}
+
+/// Turn a file reference into an absolute path (if it can be resolved)
+static std::string resolve_filename(const std::string &filename) {
+    fs::path path = Thread::thread()->file_resolver()->resolve(filename);
+    if (!fs::exists(path))
+        return filename;
+    return fs::absolute(path).string();
+}
+
+static void write_properties(Stream *stream, const Properties &props_,
+                             const std::unordered_map<const Object *, uint32_t> &inline_index) {
+    // Work on a copy, the getters below would mark the properties as queried
+    Properties props(props_);
+    std::vector<std::string> names = props.property_names();
+
+    stream->write(props.plugin_name());
+    stream->write(props.id());
+    stream->write((uint32_t) names.size());
+
+    for (const std::string &name : names) {
+        Properties::Type type = props.type(name);
+        stream->write(name);
+        stream->write((uint8_t) type);
+
+        switch (type) {
+            case Properties::Type::Bool:
+                stream->write(props.bool_(name));
+                break;
+
+            case Properties::Type::Long:
+                stream->write(props.long_(name));
+                break;
+
+            case Properties::Type::Float:
+                stream->write(props.float_(name));
+                break;
+
+            case Properties::Type::Point3f: {
+                    Point3f p = props.point3f(name);
+                    stream->write_array(&p.x(), 3);
+                }
+                break;
+
+            case Properties::Type::Vector3f: {
+                    Vector3f v = props.vector3f(name);
+                    stream->write_array(&v.x(), 3);
+                }
+                break;
+
+            case Properties::Type::Color: {
+                    Color3f c = props.color(name);
+                    stream->write_array(&c.x(), 3);
+                }
+                break;
+
+            case Properties::Type::Transform: {
+                    const Matrix4f &m = props.transform(name).matrix;
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < 4; ++j)
+                            stream->write(m(i, j));
+                }
+                break;
+
+            case Properties::Type::String: {
+                    std::string value = props.string(name);
+                    if (name == "filename")
+                        value = resolve_filename(value);
+                    stream->write(value);
+                }
+                break;
+
+            case Properties::Type::NamedReference:
+                stream->write((const std::string &) props.named_reference(name));
+                break;
+
+            case Properties::Type::Object: {
+                    auto it = inline_index.find(props.object(name).get());
+                    if (it == inline_index.end())
+                        Throw("Cannot compile property \"%s\" of plugin \"%s\": "
+                              "unsupported object", name, props.plugin_name());
+                    stream->write(it->second);
+                }
+                break;
+
+            default:
+                Throw("Cannot compile property \"%s\" of plugin \"%s\": "
+                      "unsupported type", name, props.plugin_name());
+        }
+    }
+}
+
+static Properties read_properties(Stream *stream, const std::vector<ref<Object>> &inline_objects) {
+    std::string plugin_name, id;
+    uint32_t count;
+    stream->read(plugin_name);
+    stream->read(id);
+    stream->read(count);
+
+    Properties props(plugin_name);
+    props.set_id(id);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        std::string name;
+        uint8_t type;
+        stream->read(name);
+        stream->read(type);
+
+        switch ((Properties::Type) type) {
+            case Properties::Type::Bool: {
+                    bool value;
+                    stream->read(value);
+                    props.set_bool(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Long: {
+                    int64_t value;
+                    stream->read(value);
+                    props.set_long(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Float: {
+                    Float value;
+                    stream->read(value);
+                    props.set_float(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Point3f: {
+                    Point3f p;
+                    stream->read_array(&p.x(), 3);
+                    props.set_point3f(name, p, false);
+                }
+                break;
+
+            case Properties::Type::Vector3f: {
+                    Vector3f v;
+                    stream->read_array(&v.x(), 3);
+                    props.set_vector3f(name, v, false);
+                }
+                break;
+
+            case Properties::Type::Color: {
+                    Color3f c;
+                    stream->read_array(&c.x(), 3);
+                    props.set_color(name, c, false);
+                }
+                break;
+
+            case Properties::Type::Transform: {
+                    Matrix4f m;
+                    for (size_t j = 0; j < 4; ++j)
+                        for (size_t k = 0; k < 4; ++k)
+                            stream->read(m(j, k));
+                    props.set_transform(name, Transform4f(m), false);
+                }
+                break;
+
+            case Properties::Type::String: {
+                    std::string value;
+                    stream->read(value);
+                    props.set_string(name, value, false);
+                }
+                break;
+
+            case Properties::Type::NamedReference: {
+                    std::string value;
+                    stream->read(value);
+                    props.set_named_reference(name, value, false);
+                }
+                break;
+
+            case Properties::Type::Object: {
+                    uint32_t index;
+                    stream->read(index);
+                    if (index >= inline_objects.size())
+                        Throw("Invalid object index %i", index);
+                    props.set_object(name, inline_objects[index], false);
+                }
+                break;
+
+            default:
+                Throw("Invalid property type %i", (int) type);
+        }
+    }
+
+    return props;
+}
+
+/**
+ * \brief Serialize the parsed (but not yet instantiated) object graph
+ *
+ * The compiled representation stores all objects with fully resolved
+ * properties, including objects that were created while parsing (e.g.
+ * textures for <rgb> tags) and absolute paths for resolvable "filename"
+ * properties. It is specific to the variant and parameter values.
+ */
+static void write_compiled(Stream *stream, XMLParseContext &ctx, const std::string &root_id,
+                           const ParameterList &param) {
+    stream->write(compiled_scene_magic, 4);
+    stream->write(compiled_scene_version);
+    stream->write(ctx.variant);
+    stream->write(param);
+    stream->write(root_id);
+
+    std::unordered_map<const Object *, uint32_t> inline_index;
+    stream->write((uint32_t) ctx.inline_objects.size());
+    for (auto &[obj, inline_obj] : ctx.inline_objects) {
+        inline_index[obj] = (uint32_t) inline_index.size();
+        stream->write(inline_obj.class_->name());
+        write_properties(stream, inline_obj.props, {});
+        stream->write(inline_obj.wavelengths);
+        stream->write(inline_obj.values);
+        stream->write(inline_obj.expand);
+    }
+
+    stream->write((uint32_t) ctx.instances.size());
+    for (auto &[id, inst] : ctx.instances) {
+        stream->write(id);
+        stream->write(inst.class_ ? inst.class_->name() : std::string());
+        stream->write(inst.src_id);
+        stream->write(inst.alias);
+        stream->write((uint64_t) inst.location);
+        write_properties(stream, inst.props, inline_index);
+    }
+}
+
+/// Reconstruct the parse context from a compiled scene. Returns the root ID.
+static std::string read_compiled(Stream *stream, XMLParseContext &ctx, const std::string &src_id,
+                                 const ParameterList &param) {
+    char magic[4];
+    uint32_t version;
+    std::string variant, root_id;
+    ParameterList compiled_param;
+
+    stream->read(magic, 4);
+    stream->read(version);
+    if (memcmp(magic, compiled_scene_magic, 4) != 0 || version != compiled_scene_version)
+        Throw("\"%s\": unsupported compiled scene format (version %i, expected %i)",
+              src_id, version, compiled_scene_version);
+
+    stream->read(variant);
+    if (variant != ctx.variant)
+        Throw("\"%s\": the scene was compiled for variant \"%s\" and cannot be "
+              "loaded using variant \"%s\"", src_id, variant, ctx.variant);
+
+    stream->read(compiled_param);
+    if (!param.empty() && param != compiled_param)
+        Throw("\"%s\": the scene was compiled using different parameter values",
+              src_id);
+    stream->read(root_id);
+
+    uint32_t inline_count;
+    stream->read(inline_count);
+    std::vector<ref<Object>> inline_objects;
+    inline_objects.reserve(inline_count);
+    for (uint32_t i = 0; i < inline_count; ++i) {
+        std::string class_name;
+        stream->read(class_name);
+        Properties props = read_properties(stream, {});
+        std::vector<Float> wavelengths, values;
+        bool expand;
+        stream->read(wavelengths);
+        stream->read(values);
+        stream->read(expand);
+        if (class_name != "Texture")
+            Throw("\"%s\": invalid inline object of type \"%s\"", src_id, class_name);
+        inline_objects.push_back(
+            create_inline_texture(ctx, props, wavelengths, values, expand));
+    }
+
+    auto offset = [](ptrdiff_t) { return std::string("compiled scene"); };
+
+    uint32_t instance_count;
+    stream->read(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i) {
+        std::string id, class_name;
+        uint64_t location;
+        stream->read(id);
+        stream->read(class_name);
+
+        XMLObject &inst = ctx.instances[id];
+        stream->read(inst.src_id);
+        stream->read(inst.alias);
+        stream->read(location);
+        inst.props = read_properties(stream, inline_objects);
+        inst.location = (size_t) location;
+        inst.offset = offset;
+        if (!class_name.empty())
+            inst.class_ = Class::for_name(class_name, ctx.variant);
+    }
+
+    if (ctx.instances.find(root_id) == ctx.instances.end())
+        Throw("\"%s\": invalid compiled scene (missing root object)", src_id);
+
+    return root_id;
+}
+
 NAMESPACE_END(detail)
 
 ref<Object> load_string(const std::string &string, const std::string &variant,
-                        ParameterList param) {
+                        ParameterList param, bool deferred) {
     ScopedPhase sp(ProfilerPhase::InitScene);
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_buffer(string.c_str(), string.length(),
@@ -1149,16 +1664,38 @@ ref<Object> load_string(const std::string &string, const std::string &variant,
     size_t arg_counter; // Unused
     auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
                                       param, arg_counter, 0).second;
+    if (deferred)
+        return detail::instantiate_deferred(ctx, scene_id);
     return detail::instantiate_node(ctx, scene_id);
 }
 
 ref<Object> load_file(const fs::path &filename_, const std::string &variant,
-                      ParameterList param, bool write_update) {
+                      ParameterList param, bool write_update, bool deferred,
+                      const fs::path &write_compiled) {
     ScopedPhase sp(ProfilerPhase::InitScene);
     fs::path filename = filename_;
     if (!fs::exists(filename))
         Throw("\"%s\": file does not exist!", filename);
 
+    if (detail::is_compiled_scene(filename)) {
+        Log(Info, "Loading compiled scene \"%s\" ..", filename);
+        Log(Info, "Using variant \"%s\"", variant);
+
+        detail::XMLParseContext ctx(variant);
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename);
+        ref<MemoryStream> stream = new MemoryStream(mmap->data(), mmap->size());
+        std::string scene_id;
+        try {
+            scene_id = detail::read_compiled(stream, ctx, filename.string(), param);
+        } catch (const EOFException &) {
+            Throw("\"%s\": compiled scene is truncated!", filename);
+        }
+
+        if (deferred)
+            return detail::instantiate_deferred(ctx, scene_id);
+        return detail::instantiate_node(ctx, scene_id);
+    }
+
     Log(Info, "Loading XML file \"%s\" ..", filename);
     Log(Info, "Using variant \"%s\"", variant);
 
@@ -1179,6 +1716,8 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
     pugi::xml_node root = doc.document_element();
 
     detail::XMLParseContext ctx(variant);
+    ctx.record_inline_objects = !write_compiled.empty();
+    ParameterList param_orig = param;
     Properties prop;
     size_t arg_counter = 0; // Unused
     auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
@@ -1208,7 +1747,36 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
         filename = backup;
     }
 
-    return detail::instantiate_node(ctx, scene_id);
+    if (write_compiled.empty()) {
+        if (deferred)
+            return detail::instantiate_deferred(ctx, scene_id);
+        return detail::instantiate_node(ctx, scene_id);
+    }
+
+    /* Serialize the object graph before instantiation modifies it, but only
+       keep the compiled scene if all objects could be created successfully */
+    fs::path temp = write_compiled;
+    temp.replace_extension(".tmp");
+    ref<Object> result;
+    try {
+        ref<FileStream> stream = new FileStream(temp, FileStream::ETruncReadWrite);
+        detail::write_compiled(stream, ctx, scene_id, param_orig);
+        stream->close();
+
+        result = deferred ? detail::instantiate_deferred(ctx, scene_id)
+                          : detail::instantiate_node(ctx, scene_id);
+    } catch (...) {
+        fs::remove(temp);
+        throw;
+    }
+
+    if (fs::exists(write_compiled))
+        fs::remove(write_compiled);
+    if (!fs::rename(temp, write_compiled))
+        Throw("Unable to rename file \"%s\" to \"%s\"!", temp, write_compiled);
+    Log(Info, "Wrote compiled scene to \"%s\"", write_compiled);
+
+    return result;
 }
 
 NAMESPACE_END(xml)
@@ -0,0 +1,164 @@
+#include <mitsuba/render/blockscheduler.h>
+#include <mitsuba/core/logger.h>
+#include <algorithm>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Blocks below this size (in pixels) are never split
+static constexpr int min_split_size = 8;
+
+/// Compute the offset and size of sub-block \c sub (1..4) of a block
+template <typename Vector2i>
+static std::pair<Vector2i, Vector2i> sub_block(const Vector2i &offset,
+                                               const Vector2i &size, size_t sub) {
+    if (sub == 0)
+        return { offset, size };
+    Vector2i half = (size + 1) / 2;
+    bool right = ((sub - 1) & 1) != 0, bottom = ((sub - 1) & 2) != 0;
+    return {
+        offset + Vector2i(right ? half.x() : 0, bottom ? half.y() : 0),
+        Vector2i(right ? size.x() - half.x() : half.x(),
+                 bottom ? size.y() - half.y() : half.y())
+    };
+}
+
+BlockScheduler::BlockScheduler(Vector2i size, Vector2i offset, size_t block_size,
+                               size_t passes, size_t worker_count)
+    : m_block_size(block_size), m_passes(std::max(passes, (size_t) 1)),
+      m_worker_count(std::max(worker_count, (size_t) 1)),
+      m_size(size), m_offset(offset) {
+
+    m_blocks = Vector2i(ceil(Vector2f(m_size) / m_block_size));
+    m_block_count = hprod(m_blocks);
+    m_cost.resize(m_block_count, -1.f);
+
+    // Use the spiral order when no cost estimates are available
+    ref<Spiral> spiral = new Spiral(m_size, Vector2i(0), m_block_size, 1);
+    m_order.reserve(m_block_count);
+    while (true) {
+        auto [block_offset, block_size_, block_id] = spiral->next_block();
+        ENOKI_MARK_USED(block_id);
+        if (hprod(block_size_) == 0)
+            break;
+        Vector2i pos = block_offset / (int) m_block_size;
+        m_order.push_back((uint32_t) (pos.x() + pos.y() * m_blocks.x()));
+    }
+
+    reset();
+}
+
+std::pair<BlockScheduler::Vector2i, BlockScheduler::Vector2i>
+BlockScheduler::block(size_t index) const {
+    if (index >= m_block_count)
+        Throw("BlockScheduler::block(): index %i is out of bounds!", index);
+    Vector2i pos((int) (index % m_blocks.x()), (int) (index / m_blocks.x())),
+             offset = pos * (int) m_block_size,
+             size = min((int) m_block_size, m_size - offset);
+    return { offset + m_offset, size };
+}
+
+void BlockScheduler::set_cost(size_t index, float cost) {
+    if (index >= m_block_count)
+        Throw("BlockScheduler::set_cost(): index %i is out of bounds!", index);
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+    m_cost[index] = cost;
+}
+
+float BlockScheduler::cost(size_t index) const {
+    if (index >= m_block_count)
+        Throw("BlockScheduler::cost(): index %i is out of bounds!", index);
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+    return m_cost[index];
+}
+
+void BlockScheduler::record_cost(size_t block_id, float cost) {
+    size_t sub   = block_id % 5,
+           index = (block_id / 5) % m_block_count;
+
+    // Extrapolate the cost of a sub-block to the whole block
+    auto [offset, size] = block(index);
+    Vector2i piece = sub_block(offset, size, sub).second;
+    if (hprod(piece) == 0)
+        return;
+    cost *= hprod(size) / (float) hprod(piece);
+
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+    m_cost[index] = cost;
+}
+
+void BlockScheduler::reset() {
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+    m_items.clear();
+    m_next_item = 0;
+    m_pass_count = 0;
+}
+
+void BlockScheduler::build_pass(size_t pass) {
+    m_items.clear();
+    m_next_item = 0;
+
+    float max_cost = -1.f;
+    for (float c : m_cost)
+        max_cost = std::max(max_cost, c);
+
+    auto make_id = [&](size_t index, size_t sub) {
+        return (pass * m_block_count + index) * 5 + sub;
+    };
+
+    if (max_cost < 0.f) {
+        for (uint32_t index : m_order) {
+            auto [offset, size] = block(index);
+            m_items.push_back({ offset, size, make_id(index, 0), 0.f });
+        }
+        return;
+    }
+
+    // Blocks without an estimate are assumed to be expensive
+    auto block_cost = [&](size_t index) {
+        return m_cost[index] < 0.f ? max_cost : m_cost[index];
+    };
+
+    double total_cost = 0.0;
+    for (size_t i = 0; i < m_block_count; ++i)
+        total_cost += block_cost(i);
+
+    /* Split blocks that would take a considerable fraction of the time that
+       each worker spends on the pass */
+    float threshold = (float) (total_cost / (2 * m_worker_count));
+
+    for (uint32_t index : m_order) {
+        auto [offset, size] = block(index);
+        float c = block_cost(index);
+        if (m_worker_count > 1 && c > threshold && all(size >= min_split_size)) {
+            for (size_t sub = 1; sub <= 4; ++sub) {
+                auto [sub_offset, sub_size] = sub_block(offset, size, sub);
+                m_items.push_back({ sub_offset, sub_size, make_id(index, sub),
+                                    c * hprod(sub_size) / (float) hprod(size) });
+            }
+        } else {
+            m_items.push_back({ offset, size, make_id(index, 0), c });
+        }
+    }
+
+    // Most expensive first, ties are resolved using the spiral order
+    std::stable_sort(m_items.begin(), m_items.end(),
+                     [](const Item &a, const Item &b) { return a.cost > b.cost; });
+}
+
+std::tuple<BlockScheduler::Vector2i, BlockScheduler::Vector2i, size_t>
+BlockScheduler::next_block() {
+    std::lock_guard<tbb::spin_mutex> lock(m_mutex);
+
+    while (m_next_item == m_items.size()) {
+        if (m_pass_count == m_passes)
+            return { Vector2i(0), Vector2i(0), (size_t) -1 };
+        build_pass(m_pass_count++);
+    }
+
+    const Item &item = m_items[m_next_item++];
+    return { item.offset, item.size, item.id };
+}
+
+MTS_IMPLEMENT_CLASS(BlockScheduler, Object)
+NAMESPACE_END(mitsuba)
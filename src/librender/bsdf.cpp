@@ -8,6 +8,14 @@ MTS_VARIANT BSDF<Float, Spectrum>::BSDF(const Properties &props)
 
 MTS_VARIANT BSDF<Float, Spectrum>::~BSDF() { }
 
+MTS_VARIANT std::pair<Spectrum, Float>
+BSDF<Float, Spectrum>::eval_pdf(const BSDFContext &ctx,
+                                const SurfaceInteraction3f &si,
+                                const Vector3f &wo,
+                                Mask active) const {
+    return { eval(ctx, si, wo, active), pdf(ctx, si, wo, active) };
+}
+
 MTS_VARIANT Spectrum BSDF<Float, Spectrum>::eval_null_transmission(
     const SurfaceInteraction3f & /* si */, Mask /* active */) const {
     return 0.f;
@@ -0,0 +1,247 @@
+#include <mitsuba/render/denoiser.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timeline.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <cmath>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// B3 spline kernel of the à-trous wavelet transform
+static const float atrous_kernel[5] = { 1.f / 16.f, 1.f / 4.f, 3.f / 8.f, 1.f / 4.f, 1.f / 16.f };
+
+/// Albedo values below this threshold are not demodulated
+static const float albedo_epsilon = 1e-3f;
+
+static float luminance(const float *rgb) {
+    return .2126f * rgb[0] + .7152f * rgb[1] + .0722f * rgb[2];
+}
+
+/// Check that a bitmap can be used as input of the denoiser and return its data
+static const float *input_data(const Bitmap *bitmap, const Bitmap *color,
+                               size_t channels, const char *name) {
+    if (!bitmap)
+        return nullptr;
+    if (bitmap->component_format() != Struct::Type::Float32)
+        Throw("Denoiser::denoise(): the %s image must have a float32 component format!", name);
+    if (bitmap->size() != color->size())
+        Throw("Denoiser::denoise(): the %s image must have the same size as the "
+              "color image!", name);
+    if (bitmap->channel_count() < channels)
+        Throw("Denoiser::denoise(): the %s image must have at least %i channels!",
+              name, channels);
+    return (const float *) bitmap->data();
+}
+
+/// Process the rows of an image in parallel
+template <typename Func> static void for_each_row(int height, Func func) {
+    ThreadEnvironment env;
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, height),
+        [&](const tbb::blocked_range<int> &range) {
+            ScopedSetThreadEnvironment set_env(env);
+            for (int y = range.begin(); y != range.end(); ++y)
+                func(y);
+        }
+    );
+}
+
+Denoiser::Denoiser(size_t iterations, float sigma_color, float sigma_normal,
+                   float sigma_albedo)
+    : m_iterations(iterations), m_sigma_color(sigma_color),
+      m_sigma_normal(sigma_normal), m_sigma_albedo(sigma_albedo) {
+    if (m_sigma_color <= 0.f || m_sigma_normal < 0.f || m_sigma_albedo <= 0.f)
+        Throw("Denoiser: the edge-stopping parameters must be positive!");
+}
+
+ref<Bitmap> Denoiser::denoise(const Bitmap *color_, const Bitmap *albedo_,
+                              const Bitmap *normal_, const Bitmap *variance_) const {
+    ScopedTimelineEvent timeline_event("denoise", class_()->name());
+
+    const float *color    = input_data(color_, color_, 3, "color"),
+                *albedo   = input_data(albedo_, color_, 3, "albedo"),
+                *normal   = input_data(normal_, color_, 3, "normal"),
+                *variance = input_data(variance_, color_, 1, "variance");
+
+    int width = (int) color_->width(), height = (int) color_->height();
+    size_t pixel_count = color_->pixel_count(),
+           color_stride  = color_->channel_count(),
+           albedo_stride = albedo ? albedo_->channel_count() : 0,
+           normal_stride = normal ? normal_->channel_count() : 0,
+           var_stride    = variance ? variance_->channel_count() : 0;
+
+    /* Planar working copies: demodulated color (3 channels), modulation
+       factor (3), unit normals (3), albedo luminance and variance */
+    std::vector<float> c(pixel_count * 3), c2(pixel_count * 3),
+                       modulation(pixel_count * 3, 1.f), n(pixel_count * 3, 0.f),
+                       a(pixel_count, 0.f), var(pixel_count), var2(pixel_count),
+                       var_blur(pixel_count);
+
+    for_each_row(height, [&](int y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = (size_t) y * width + x;
+            const float *rgb = color + i * color_stride;
+
+            float lum_scale = 1.f;
+            if (albedo) {
+                const float *alb = albedo + i * albedo_stride;
+                for (int k = 0; k < 3; ++k)
+                    modulation[3 * i + k] = alb[k] > albedo_epsilon ? alb[k] : 1.f;
+                a[i] = luminance(alb);
+                lum_scale = luminance(&modulation[3 * i]);
+            }
+            for (int k = 0; k < 3; ++k) {
+                float value = rgb[k] / modulation[3 * i + k];
+                c[3 * i + k] = std::isfinite(value) ? value : 0.f;
+            }
+
+            if (normal) {
+                const float *nrm = normal + i * normal_stride;
+                float length = std::sqrt(nrm[0] * nrm[0] + nrm[1] * nrm[1] + nrm[2] * nrm[2]);
+                if (length > 0.f)
+                    for (int k = 0; k < 3; ++k)
+                        n[3 * i + k] = nrm[k] / length;
+            }
+
+            // The variance is demodulated along with the color
+            if (variance)
+                var[i] = std::max(variance[i * var_stride], 0.f) / (lum_scale * lum_scale);
+        }
+    });
+
+    // Without a variance estimate, use the variance of the 3x3 neighborhood
+    if (!variance) {
+        for_each_row(height, [&](int y) {
+            for (int x = 0; x < width; ++x) {
+                float sum = 0.f, sum2 = 0.f;
+                int count = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int qx = x + dx, qy = y + dy;
+                        if (qx < 0 || qy < 0 || qx >= width || qy >= height)
+                            continue;
+                        float l = luminance(&c[3 * ((size_t) qy * width + qx)]);
+                        sum += l;
+                        sum2 += l * l;
+                        count++;
+                    }
+                }
+                float mean = sum / count;
+                var[(size_t) y * width + x] = std::max(sum2 / count - mean * mean, 0.f);
+            }
+        });
+    }
+
+    for (size_t it = 0; it < m_iterations; ++it) {
+        int step = 1 << it;
+
+        // Blur the variance to make the edge-stopping function more robust
+        for_each_row(height, [&](int y) {
+            for (int x = 0; x < width; ++x) {
+                float sum = 0.f, weight_sum = 0.f;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int qx = x + dx, qy = y + dy;
+                        if (qx < 0 || qy < 0 || qx >= width || qy >= height)
+                            continue;
+                        float weight = atrous_kernel[dx + 2] * atrous_kernel[dy + 2];
+                        sum += weight * var[(size_t) qy * width + qx];
+                        weight_sum += weight;
+                    }
+                }
+                var_blur[(size_t) y * width + x] = sum / weight_sum;
+            }
+        });
+
+        for_each_row(height, [&](int y) {
+            for (int x = 0; x < width; ++x) {
+                size_t p = (size_t) y * width + x;
+                const float *c_p = &c[3 * p], *n_p = &n[3 * p];
+                float l_p = luminance(c_p),
+                      inv_sigma_l = 1.f / (m_sigma_color * std::sqrt(var_blur[p]) + 1e-6f);
+                bool has_normal_p = normal && (n_p[0] != 0.f || n_p[1] != 0.f || n_p[2] != 0.f);
+
+                float sum[3] = { 0.f, 0.f, 0.f }, sum_var = 0.f, weight_sum = 0.f;
+                for (int ky = 0; ky < 5; ++ky) {
+                    int qy = y + (ky - 2) * step;
+                    if (qy < 0 || qy >= height)
+                        continue;
+                    for (int kx = 0; kx < 5; ++kx) {
+                        int qx = x + (kx - 2) * step;
+                        if (qx < 0 || qx >= width)
+                            continue;
+                        size_t q = (size_t) qy * width + qx;
+                        const float *c_q = &c[3 * q];
+
+                        float weight = atrous_kernel[kx] * atrous_kernel[ky];
+                        if (q != p) {
+                            float exponent = std::abs(l_p - luminance(c_q)) * inv_sigma_l;
+
+                            if (albedo) {
+                                float da = (a[p] - a[q]) / m_sigma_albedo;
+                                exponent += da * da;
+                            }
+
+                            if (normal) {
+                                const float *n_q = &n[3 * q];
+                                bool has_normal_q = n_q[0] != 0.f || n_q[1] != 0.f || n_q[2] != 0.f;
+                                if (has_normal_p != has_normal_q)
+                                    continue;
+                                if (has_normal_p) {
+                                    float cos_theta = n_p[0] * n_q[0] + n_p[1] * n_q[1] +
+                                                      n_p[2] * n_q[2];
+                                    if (cos_theta <= 0.f)
+                                        continue;
+                                    weight *= std::pow(cos_theta, m_sigma_normal);
+                                }
+                            }
+
+                            weight *= std::exp(-exponent);
+                        }
+
+                        for (int k = 0; k < 3; ++k)
+                            sum[k] += weight * c_q[k];
+                        sum_var += weight * weight * var[q];
+                        weight_sum += weight;
+                    }
+                }
+
+                float inv_weight_sum = 1.f / weight_sum;
+                for (int k = 0; k < 3; ++k)
+                    c2[3 * p + k] = sum[k] * inv_weight_sum;
+                var2[p] = sum_var * inv_weight_sum * inv_weight_sum;
+            }
+        });
+
+        c.swap(c2);
+        var.swap(var2);
+    }
+
+    ref<Bitmap> result = new Bitmap(Bitmap::PixelFormat::RGB, Struct::Type::Float32,
+                                    color_->size());
+    float *output = (float *) result->data();
+    for_each_row(height, [&](int y) {
+        for (int x = 0; x < width; ++x) {
+            size_t i = (size_t) y * width + x;
+            for (int k = 0; k < 3; ++k)
+                output[3 * i + k] = c[3 * i + k] * modulation[3 * i + k];
+        }
+    });
+
+    return result;
+}
+
+std::string Denoiser::to_string() const {
+    std::ostringstream oss;
+    oss << "Denoiser[" << std::endl
+        << "  iterations = " << m_iterations << "," << std::endl
+        << "  sigma_color = " << m_sigma_color << "," << std::endl
+        << "  sigma_normal = " << m_sigma_normal << "," << std::endl
+        << "  sigma_albedo = " << m_sigma_albedo << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(Denoiser, Object)
+NAMESPACE_END(mitsuba)
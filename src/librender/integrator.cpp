@@ -1,13 +1,19 @@
+#include <chrono>
 #include <thread>
 #include <mutex>
 
 #include <enoki/morton.h>
+#include <mitsuba/core/numa.h>
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/timeline.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
+#include <mitsuba/render/blockscheduler.h>
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/sampler.h>
@@ -19,10 +25,15 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Return the (high resolution) time in seconds that has passed since \c start
+static float seconds_since(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
+
 // -----------------------------------------------------------------------------
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
-    : Base(props) {
+    : Base(props), m_stop(false) {
     m_block_size = (uint32_t) props.size_("block_size", MTS_BLOCK_SIZE);
     uint32_t block_size = math::round_to_power_of_two(m_block_size);
     if (block_size != m_block_size) {
@@ -36,6 +47,19 @@ MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Proper
 
     /// Disable direct visibility of emitters if needed
     m_hide_emitters = props.bool_("hide_emitters", false);
+
+    std::string schedule = props.string("block_schedule", "spiral");
+    if (schedule != "spiral" && schedule != "cost")
+        Throw("Invalid block schedule \"%s\", must be one of: \"spiral\" or \"cost\"",
+              schedule);
+    m_cost_schedule = schedule == "cost";
+
+    m_progressive = props.bool_("progressive", false);
+    m_preview = props.bool_("preview", false);
+    if (m_progressive && is_cuda_array_v<Float>) {
+        Log(Warn, "Progressive rendering is not supported in GPU mode, disabling..");
+        m_progressive = false;
+    }
 }
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
@@ -48,21 +72,91 @@ MTS_VARIANT std::vector<std::string> SamplingIntegrator<Float, Spectrum>::aov_na
     return { };
 }
 
-MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Sensor *sensor) {
-    ScopedPhase sp(ProfilerPhase::Render);
-    m_stop = false;
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::pass_finished(const Scene * /* scene */,
+                                                                    size_t /* pass */,
+                                                                    size_t /* pass_sample_count */) { }
+
+MTS_VARIANT std::pair<typename SamplingIntegrator<Float, Spectrum>::DirectionSample3f, Spectrum>
+SamplingIntegrator<Float, Spectrum>::sample_emitter_direction_ris(const Scene *scene,
+                                                                  const SurfaceInteraction3f &si,
+                                                                  const BSDFPtr &bsdf,
+                                                                  const BSDFContext &ctx,
+                                                                  Sampler *sampler,
+                                                                  size_t candidate_count,
+                                                                  Mask active) const {
+    if (candidate_count <= 1)
+        return scene->sample_emitter_direction(si, sampler->next_2d(active), true, active);
+
+    DirectionSample3f ds = zero<DirectionSample3f>();
+    Spectrum emitter_val(0.f);
+    Float weight_sum(0.f), weight(0.f);
+
+    /* Weighted reservoir sampling: the i-th candidate replaces the current
+       one with probability w_i / (w_1 + ... + w_i), where the resampling
+       weight w_i is the unshadowed contribution divided by the density */
+    for (size_t i = 0; i < candidate_count; ++i) {
+        auto [ds_i, emitter_val_i] =
+            scene->sample_emitter_direction(si, sampler->next_2d(active), false, active);
+        Mask active_i = active && neq(ds_i.pdf, 0.f);
+
+        Spectrum bsdf_val = bsdf->eval(ctx, si, si.to_local(ds_i.d), active_i);
+        Float w = select(active_i, hmean(depolarize(bsdf_val) * depolarize(emitter_val_i)), 0.f);
+
+        weight_sum += w;
+        Mask replace = active_i && w > 0.f && sampler->next_1d(active) * weight_sum < w;
+        masked(ds, replace) = ds_i;
+        masked(emitter_val, replace) = emitter_val_i;
+        masked(weight, replace) = w;
+    }
 
-    ref<Film> film = sensor->film();
-    ScalarVector2i film_size = film->crop_size();
+    /* The selected sample has the contribution weight (w_1 + ... + w_M) /
+       (M * target), where the target function is 'w' times the density */
+    active &= weight > 0.f;
+    emitter_val *= select(active, weight_sum / ((ScalarFloat) candidate_count * weight), 0.f);
 
-    size_t total_spp        = sensor->sampler()->sample_count();
-    size_t samples_per_pass = (m_samples_per_pass == (size_t) -1)
+    // Trace a single shadow ray towards the selected candidate
+    if (any_or<true>(active)) {
+        Ray3f ray(si.p, ds.d, math::RayEpsilon<Float> * (1.f + hmax(abs(si.p))),
+                  ds.dist * (1.f - math::ShadowEpsilon<Float>), si.time, si.wavelengths);
+        emitter_val[scene->ray_test(ray, active)] = 0.f;
+    }
+    masked(ds.pdf, !active) = 0.f;
+
+    return { ds, emitter_val };
+}
+
+MTS_VARIANT size_t
+SamplingIntegrator<Float, Spectrum>::samples_per_pass(size_t total_spp) const {
+    size_t samples_per_pass = (m_samples_per_pass == (uint32_t) -1)
                                ? total_spp : std::min((size_t) m_samples_per_pass, total_spp);
     if ((total_spp % samples_per_pass) != 0)
         Throw("sample_count (%d) must be a multiple of samples_per_pass (%d).",
               total_spp, samples_per_pass);
+    return samples_per_pass;
+}
+
+MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Sensor *sensor) {
+    ScopedPhase sp(ProfilerPhase::Render, this);
+    m_stop = false;
+
+    ref<Film> film = sensor->film();
+    ScalarVector2i film_size = film->crop_size();
 
-    size_t n_passes = ceil(total_spp / (ScalarFloat) samples_per_pass);
+    size_t total_spp = sensor->sampler()->sample_count();
+    size_t samples_per_pass, n_passes;
+    if (m_progressive) {
+        // The sample count of each pass doubles, starting at 'samples_per_pass'
+        samples_per_pass = (m_samples_per_pass == (uint32_t) -1)
+            ? 1 : std::min((size_t) m_samples_per_pass, total_spp);
+        n_passes = 0;
+        for (size_t spp = 0, pass_spp = samples_per_pass; spp < total_spp; pass_spp *= 2) {
+            spp += std::min(pass_spp, total_spp - spp);
+            n_passes++;
+        }
+    } else {
+        samples_per_pass = this->samples_per_pass(total_spp);
+        n_passes = ceil(total_spp / (ScalarFloat) samples_per_pass);
+    }
 
     std::vector<std::string> channels = aov_names();
     bool has_aovs = !channels.empty();
@@ -71,11 +165,15 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
     for (size_t i = 0; i < 5; ++i)
         channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
     film->prepare(channels);
+    film->set_pass_count(n_passes);
+    Statistics::reset();
+    ScopedTimelineEvent timeline_event("render", class_()->name());
 
     if constexpr (!is_cuda_array_v<Float>) {
         /// Render on the CPU using a spiral pattern
         size_t n_threads = __global_thread_count;
-        Log(Info, "Starting render job (%ix%i, %i sample%s,%s %i thread%s)",
+        Log(Info, "Starting %srender job (%ix%i, %i sample%s,%s %i thread%s)",
+            m_progressive ? "progressive " : "",
             film_size.x(), film_size.y(),
             total_spp, total_spp == 1 ? "" : "s",
             n_passes > 1 ? tfm::format(" %d passes,", n_passes) : "",
@@ -84,51 +182,225 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
         if (m_timeout > 0.f)
             Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
 
-        Spiral spiral(film, m_block_size, n_passes);
+        /* On NUMA systems, each node renders a horizontal band of the image
+           using its own spiral and workers pinned to the node, and then helps
+           with the bands of the other nodes. */
+        std::vector<ref<Spiral>> spirals;
+        std::vector<ref<BlockScheduler>> schedulers;
+        std::vector<size_t> seed_offsets;
+        size_t block_rows = (film_size.y() + m_block_size - 1) / m_block_size,
+               n_bands = numa::enabled() ? std::min(numa::node_count(), block_rows) : 1,
+               row = 0, total_blocks = 0,
+           // Each progressive pass renders the whole image using its own spirals
+           band_passes = m_progressive ? 1 : n_passes;
+        for (size_t i = 0; i < n_bands; ++i) {
+            // Proportional to the node's thread count, at least one row per band
+            size_t rows = (i + 1 == n_bands)
+                ? block_rows - row
+                : std::min(std::max((size_t) 1, block_rows * numa::node_thread_count(i) / n_threads),
+                           block_rows - row - (n_bands - i - 1));
+            ScalarVector2i offset(0, (int) (row * m_block_size)),
+                           size(film_size.x(),
+                                std::min((int) ((row + rows) * m_block_size), film_size.y()) - offset.y());
+            offset += ScalarVector2i(film->crop_offset());
+            seed_offsets.push_back(total_blocks);
+            if (m_cost_schedule) {
+                schedulers.push_back(new BlockScheduler(
+                    size, offset, m_block_size, band_passes,
+                    n_bands > 1 ? numa::node_thread_count(i) : n_threads));
+                total_blocks += schedulers.back()->id_count();
+            } else {
+                spirals.push_back(new Spiral(size, offset, m_block_size, band_passes));
+                total_blocks += spirals.back()->block_count() * band_passes;
+            }
+            row += rows;
+        }
+
+        /* Progress is tracked in pixels (weighted by their sample count in
+           progressive mode) since the scheduler may split blocks */
+        size_t pixels_per_pass = hprod(film_size),
+               total_pixels = pixels_per_pass * n_passes,
+               total_work = pixels_per_pass * total_spp;
+
+        auto next_block = [&](size_t index) {
+            return m_cost_schedule ? schedulers[index]->next_block()
+                                   : spirals[index]->next_block();
+        };
+
+        if (m_cost_schedule)
+            estimate_block_costs(scene, sensor, schedulers, channels.size(),
+                                 has_aovs, samples_per_pass);
 
         ThreadEnvironment env;
         ref<ProgressReporter> progress = new ProgressReporter("Rendering");
         std::mutex mutex;
+        size_t pixels_done = 0, passes_done = 0, work_done = 0;
+
+        /* In progressive mode, the blocks of a pass are accumulated separately
+           and only merged into the film once the pass is complete */
+        ref<ImageBlock> pass_block;
+        std::mutex pass_mutex;
+        size_t pass_spp = samples_per_pass, seed_offset = 0;
+        if (m_progressive) {
+            pass_block = new ImageBlock(film_size, channels.size());
+            pass_block->set_offset(film->crop_offset());
+        }
 
-        // Total number of blocks to be handled, including multiple passes.
-        size_t total_blocks = spiral.block_count() * n_passes,
-               blocks_done = 0;
+        /* Passes overlap slightly since the blocks are processed in parallel,
+           the timeline records the intervals between their completion */
+        double pass_start = Timeline::time();
+        size_t pass_rss = util::current_rss();
 
-        m_render_timer.reset();
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, total_blocks, 1),
-            [&](const tbb::blocked_range<size_t> &range) {
-                ScopedSetThreadEnvironment set_env(env);
-                ref<Sampler> sampler = sensor->sampler()->clone();
-                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
-                                                       film->reconstruction_filter(),
-                                                       !has_aovs);
-                scoped_flush_denormals flush_denormals(true);
-                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+        // Render blocks until all spirals are exhausted, starting with the given band
+        auto render_blocks = [&](size_t band) {
+            ScopedSetThreadEnvironment set_env(env);
+            ref<Sampler> sampler = sensor->sampler()->clone();
+            ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                   film->reconstruction_filter(),
+                                                   !has_aovs);
+            scoped_flush_denormals flush_denormals(true);
+            std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+
+            for (size_t k = 0; k < n_bands; ++k) {
+                size_t index = (band + k) % n_bands;
 
                 // For each block
-                for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size, block_id] = spiral.next_block();
-                    Assert(hprod(size) != 0);
+                while (!should_stop()) {
+                    auto [offset, size, block_id] = next_block(index);
+                    if (hprod(size) == 0)
+                        break;
                     block->set_size(size);
                     block->set_offset(offset);
 
                     // Ensure that the sample generation is fully deterministic
-                    sampler->seed(block_id);
+                    sampler->seed(seed_offset + seed_offsets[index] + block_id);
 
+                    auto block_start = std::chrono::steady_clock::now();
                     render_block(scene, sensor, sampler, block,
-                                 aovs.get(), samples_per_pass);
+                                 aovs.get(), pass_spp);
 
-                    film->put(block);
+                    // Refine the cost estimate used to order the next pass
+                    if (m_cost_schedule && !should_stop())
+                        schedulers[index]->record_cost(block_id, seconds_since(block_start));
+
+                    if (m_progressive) {
+                        std::lock_guard<std::mutex> lock(pass_mutex);
+                        pass_block->put(block);
+                    } else {
+                        film->put(block);
+                    }
 
                     /* Critical section: update progress bar */ {
                         std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (ScalarFloat) total_blocks);
+                        pixels_done += hprod(size);
+                        work_done += hprod(size) * pass_spp;
+                        progress->update(work_done / (ScalarFloat) total_work);
+
+                        if (Timeline::enabled() && !m_progressive &&
+                            pixels_done / pixels_per_pass > passes_done) {
+                            passes_done = pixels_done / pixels_per_pass;
+                            Timeline::add("pass", tfm::format("pass %i", passes_done),
+                                          pass_start, pass_rss);
+                            pass_start = Timeline::time();
+                            pass_rss = util::current_rss();
+                        }
                     }
                 }
             }
-        );
+        };
+
+        // Launch one block loop per worker thread
+        auto launch = [&](size_t band, size_t worker_count) {
+            tbb::parallel_for(
+                tbb::blocked_range<size_t>(0, worker_count, 1),
+                [&](const tbb::blocked_range<size_t> &range) {
+                    for (auto i = range.begin(); i != range.end(); ++i)
+                        render_blocks(band);
+                },
+                tbb::simple_partitioner()
+            );
+        };
+
+        auto run = [&]() {
+            if (n_bands > 1)
+                numa::parallel_for_nodes([&](size_t node) {
+                    launch(node % n_bands, numa::node_thread_count(node));
+                });
+            else
+                launch(0, n_threads);
+        };
+
+        m_render_timer.reset();
+        if (!m_progressive) {
+            run();
+        } else {
+            /* Developing a streaming film finalizes its output file, hence
+               the remaining passes would be lost */
+            bool preview = m_preview;
+            if (preview && film->streams_output()) {
+                Log(Warn, "Previews are not supported by films that stream their "
+                          "output, disabling..");
+                preview = false;
+            }
+
+            size_t spp_done = 0, pass = 0, target_spp = samples_per_pass;
+            while (spp_done < total_spp && !m_stop) {
+                pass_spp = std::min(target_spp, total_spp - spp_done);
+
+                /* Only start passes that are expected to finish before the
+                   timeout, based on the time per sample of the previous ones */
+                if (m_timeout > 0.f && spp_done > 0) {
+                    float elapsed = m_render_timer.value() / 1000.f,
+                          time_per_sample = elapsed / spp_done;
+                    size_t remaining = (size_t) std::max(
+                        (m_timeout - elapsed) / time_per_sample, 0.f);
+                    if (remaining == 0)
+                        break;
+                    pass_spp = std::min(pass_spp, remaining);
+                }
+
+                for (auto &spiral : spirals)
+                    spiral->reset();
+                for (auto &scheduler : schedulers)
+                    scheduler->reset();
+                pass_block->clear();
+                seed_offset = pass * total_blocks;
+
+                pass_start = Timeline::time();
+                pass_rss = util::current_rss();
+                run();
+
+                /* Discard an interrupted pass so that the image stays uniformly
+                   converged, unless nothing else has been rendered yet */
+                bool complete = !should_stop();
+                if (complete || spp_done == 0)
+                    film->put(pass_block);
+                if (!complete) {
+                    if (spp_done == 0)
+                        Log(Warn, "The first rendering pass did not finish before the "
+                                  "timeout, the image is incomplete.");
+                    break;
+                }
+
+                pass_finished(scene, pass, pass_spp);
+                spp_done += pass_spp;
+                pass++;
+                target_spp *= 2;
+                Timeline::add("pass", tfm::format("pass %i (%i spp)", pass, pass_spp),
+                              pass_start, pass_rss);
+                Log(Debug, "Pass %i finished: %i/%i samples per pixel (%s)", pass,
+                    spp_done, total_spp, util::time_string(m_render_timer.value(), true));
+
+                if (preview && spp_done < total_spp) {
+                    ScopedTimelineEvent preview_event("preview", class_()->name());
+                    film->develop();
+                }
+            }
+
+            if (spp_done < total_spp && !m_stop)
+                Log(Info, "Timeout reached after %i of %i samples per pixel.",
+                    spp_done, total_spp);
+        }
     } else {
         ref<Sampler> sampler = sensor->sampler();
 
@@ -160,6 +432,11 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
         Log(Info, "Rendering finished. (took %s)",
             util::time_string(m_render_timer.value(), true));
 
+    // Sum up the per-thread statistics counters
+    Statistics::merge();
+    if (Statistics::enabled())
+        Log(Info, "%s", Statistics::report());
+
     return !m_stop;
 }
 
@@ -209,6 +486,70 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
     }
 }
 
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::estimate_block_costs(
+    const Scene *scene, Sensor *sensor, const std::vector<ref<BlockScheduler>> &schedulers,
+    size_t channel_count, bool has_aovs, size_t sample_count) const {
+    if constexpr (!is_cuda_array_v<Float>) {
+        ScopedTimelineEvent timeline_event("prepass", class_()->name());
+
+        // Number of probed pixels along each axis of a block
+        const int probe_count = 4;
+
+        std::vector<std::pair<size_t, size_t>> blocks;
+        for (size_t i = 0; i < schedulers.size(); ++i)
+            for (size_t j = 0; j < schedulers[i]->block_count(); ++j)
+                blocks.emplace_back(i, j);
+
+        const Film *film = sensor->film();
+        ThreadEnvironment env;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, blocks.size(), 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                ref<ImageBlock> block = new ImageBlock(m_block_size, channel_count,
+                                                       film->reconstruction_filter(),
+                                                       !has_aovs);
+                scoped_flush_denormals flush_denormals(true);
+                std::unique_ptr<Float[]> aovs(new Float[channel_count]);
+                ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
+
+                for (auto i = range.begin(); i != range.end() && !m_stop; ++i) {
+                    auto [s, index] = blocks[i];
+                    auto [offset, size] = schedulers[s]->block(index);
+                    block->set_size(size);
+                    block->set_offset(offset);
+                    block->clear();
+                    sampler->seed(i);
+
+                    // Render one sample at the center of each cell of a coarse grid
+                    ScalarVector2i probes = min(size, probe_count);
+                    auto start = std::chrono::steady_clock::now();
+                    for (int y = 0; y < probes.y(); ++y) {
+                        for (int x = 0; x < probes.x(); ++x) {
+                            ScalarVector2i pos =
+                                offset + ((2 * ScalarVector2i(x, y) + 1) * size) / (2 * probes);
+                            render_sample(scene, sensor, sampler, block, aovs.get(),
+                                          Vector2f(ScalarVector2f(pos)), diff_scale_factor);
+                        }
+                    }
+
+                    schedulers[s]->set_cost(index, seconds_since(start) * hprod(size) *
+                                                       sample_count / (float) hprod(probes));
+                }
+            }
+        );
+    } else {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(schedulers);
+        ENOKI_MARK_USED(channel_count);
+        ENOKI_MARK_USED(has_aovs);
+        ENOKI_MARK_USED(sample_count);
+        Throw("Not implemented for CUDA arrays.");
+    }
+}
+
 MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
     const Scene *scene, const Sensor *sensor, Sampler *sampler, ImageBlock *block,
     Float *aovs, const Vector2f &pos, ScalarFloat diff_scale_factor, Mask active) const {
@@ -230,6 +571,7 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
 
     auto [ray, ray_weight] = sensor->sample_ray_differential(
         time, wavelength_sample, adjusted_position, aperture_sample);
+    MTS_STATS(stats_count(StatsCounter::CameraRays, active));
 
     ray.scale_differential(diff_scale_factor);
 
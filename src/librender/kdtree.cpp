@@ -1,6 +1,7 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/properties.h>
+#include <algorithm>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -44,6 +45,14 @@ MTS_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.int_("kd_exact_primitive_threshold"));
 
+    /* kd-tree traversal: Precompute the vertex data of the triangles in each
+       leaf and intersect them in SIMD-sized blocks (scalar variants only) */
+    m_triangle_blocks_enabled = props.bool_("kd_triangle_blocks", true);
+
+    /* kd-tree traversal: Same for the spherical primitives of shapes (e.g.
+       particles), which are intersected after the triangles */
+    m_sphere_blocks_enabled = props.bool_("kd_sphere_blocks", true);
+
     m_primitive_map.push_back(0);
 }
 
@@ -53,14 +62,120 @@ MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
         primitive_count());
 
     Base::build();
+    build_leaf_blocks();
 
     Log(Info, "Finished. (%s of storage, took %s)",
         util::mem_string(m_index_count * sizeof(Index) +
-                        m_node_count * sizeof(KDNode)),
+                        m_node_count * sizeof(KDNode) +
+                        m_triangle_blocks.size() * sizeof(TriangleBlock) +
+                        m_sphere_blocks.size() * sizeof(SphereBlock) +
+                        m_leaf_blocks.size() * sizeof(LeafBlocks)),
         util::time_string(timer.value())
     );
 }
 
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build_leaf_blocks() {
+    m_triangle_blocks.clear();
+    m_sphere_blocks.clear();
+    m_leaf_blocks.clear();
+
+    if constexpr (!is_array_v<Float>) {
+        auto is_triangle = [&](Index prim_index) {
+            return m_triangle_blocks_enabled &&
+                   m_shapes[find_shape(prim_index)]->is_mesh();
+        };
+
+        auto is_sphere = [&](Index prim_index) {
+            if (!m_sphere_blocks_enabled)
+                return false;
+            const Shape *shape = m_shapes[find_shape(prim_index)];
+            return !shape->is_mesh() && !shape->primitive_sphere(prim_index).empty();
+        };
+
+        bool has_blocks = false;
+        for (Size i = 0; i < primitive_count() && !has_blocks; ++i)
+            has_blocks = is_triangle(i) || is_sphere(i);
+        if (!has_blocks)
+            return;
+
+        m_leaf_blocks.resize(m_index_count, LeafBlocks{ 0, 0, 0, 0 });
+
+        for (Size i = 0; i < m_node_count; ++i) {
+            const KDNode &node = m_nodes[i];
+            if (!node.leaf() || node.primitive_count() == 0)
+                continue;
+
+            Index *begin = m_indices.get() + node.primitive_offset(),
+                  *end   = begin + node.primitive_count();
+
+            // Move the mesh triangles and then the spheres to the front of the leaf
+            Index *split_tri = std::stable_partition(begin, end, is_triangle),
+                  *split_sph = std::stable_partition(split_tri, end, is_sphere);
+
+            LeafBlocks &leaf = m_leaf_blocks[node.primitive_offset()];
+            leaf.triangle_block_offset = Index(m_triangle_blocks.size());
+            leaf.triangle_count        = Index(split_tri - begin);
+            leaf.sphere_block_offset   = Index(m_sphere_blocks.size());
+            leaf.sphere_count          = Index(split_sph - split_tri);
+
+            for (Index *it = begin; it < split_tri; it += TriangleBlockSize) {
+                TriangleBlock block;
+                memset(&block, 0, sizeof(TriangleBlock));
+
+                for (size_t k = 0; k < TriangleBlockSize && it + k < split_tri; ++k) {
+                    Index prim_index = it[k],
+                          shape_index = find_shape(prim_index);
+                    const Mesh *mesh = (const Mesh *) m_shapes[shape_index].get();
+
+                    auto fi = mesh->face_indices(prim_index);
+                    ScalarPoint3f p0 = mesh->vertex_position(fi[0]),
+                                  p1 = mesh->vertex_position(fi[1]),
+                                  p2 = mesh->vertex_position(fi[2]);
+                    ScalarVector3f e1 = p1 - p0, e2 = p2 - p0;
+
+                    for (size_t j = 0; j < 3; ++j) {
+                        block.p0.coeff(j).coeff(k) = p0[j];
+                        block.e1.coeff(j).coeff(k) = e1[j];
+                        block.e2.coeff(j).coeff(k) = e2[j];
+                    }
+                    block.shape_index[k] = shape_index;
+                    block.prim_index[k]  = prim_index;
+                }
+
+                m_triangle_blocks.push_back(block);
+            }
+
+            for (Index *it = split_tri; it < split_sph; it += SphereBlockSize) {
+                SphereBlock block;
+                memset(&block, 0, sizeof(SphereBlock));
+                block.center = SphereVector(std::numeric_limits<ScalarFloat>::quiet_NaN());
+
+                for (size_t k = 0; k < SphereBlockSize && it + k < split_sph; ++k) {
+                    Index prim_index = it[k],
+                          shape_index = find_shape(prim_index);
+
+                    ScalarBoundingSphere3f sphere =
+                        m_shapes[shape_index]->primitive_sphere(prim_index);
+
+                    for (size_t j = 0; j < 3; ++j)
+                        block.center.coeff(j).coeff(k) = sphere.center[j];
+                    block.radius.coeff(k) = sphere.radius;
+                    block.shape_index[k]  = shape_index;
+                    block.prim_index[k]   = prim_index;
+                }
+
+                m_sphere_blocks.push_back(block);
+            }
+        }
+
+        Log(Debug, "Precomputed %i triangle blocks and %i sphere blocks of size %i (%s)",
+            m_triangle_blocks.size(), m_sphere_blocks.size(), TriangleBlockSize,
+            util::mem_string(m_triangle_blocks.size() * sizeof(TriangleBlock) +
+                             m_sphere_blocks.size() * sizeof(SphereBlock) +
+                             m_leaf_blocks.size() * sizeof(LeafBlocks)));
+    }
+}
+
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
     m_primitive_map.push_back(m_primitive_map.back() +
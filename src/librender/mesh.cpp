@@ -1,3 +1,4 @@
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
@@ -8,6 +9,7 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
 #include "blender_types.h"
+#include <iomanip>
 #include <mutex>
 
 #if defined(MTS_ENABLE_EMBREE)
@@ -486,6 +488,116 @@ MTS_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
         m_bbox.expand(vertex_position(i));
 }
 
+/// Decoded mesh geometry, shared between meshes via the \ref AssetCache
+class MeshData : public Object {
+public:
+    MeshData(const std::string &name, Struct *vertex_struct, Struct *face_struct,
+             const uint8_t *vertices, size_t vertex_count, size_t vertex_size,
+             const uint8_t *faces, size_t face_count, size_t face_size)
+        : name(name), vertex_struct(vertex_struct), face_struct(face_struct),
+          vertex_count(vertex_count), face_count(face_count),
+          vertex_size(vertex_size), face_size(face_size),
+          vertices(new uint8_t[(vertex_count + 1) * vertex_size]),
+          faces(new uint8_t[(face_count + 1) * face_size]) {
+        memcpy(this->vertices.get(), vertices, (vertex_count + 1) * vertex_size);
+        memcpy(this->faces.get(), faces, (face_count + 1) * face_size);
+    }
+
+    size_t size() const {
+        return (vertex_count + 1) * vertex_size + (face_count + 1) * face_size;
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~MeshData() = default;
+
+public:
+    std::string name;
+    ref<Struct> vertex_struct;
+    ref<Struct> face_struct;
+    size_t vertex_count, face_count;
+    size_t vertex_size, face_size;
+    std::unique_ptr<uint8_t[]> vertices;
+    std::unique_ptr<uint8_t[]> faces;
+};
+
+MTS_IMPLEMENT_CLASS(MeshData, Object)
+
+/// Build an asset cache key that accounts for all properties baked into the geometry
+template <typename Float, typename Spectrum, typename Transform>
+static std::string mesh_cache_key(const std::string &key, const Transform &to_world,
+                                  bool disable_vertex_normals) {
+    /* Encode the exact bits of the transformation, printing it in decimal
+       notation would round away small differences */
+    std::ostringstream oss;
+    oss << std::hex << std::setfill('0');
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            auto value = to_world.matrix(i, j);
+            uint8_t bytes[sizeof(value)];
+            memcpy(bytes, &value, sizeof(value));
+            for (uint8_t byte : bytes)
+                oss << std::setw(2) << (uint32_t) byte;
+        }
+    }
+
+    return tfm::format("%s:%s:face_normals=%i:to_world=%s",
+                       detail::get_variant<Float, Spectrum>(), key,
+                       disable_vertex_normals, oss.str());
+}
+
+MTS_VARIANT bool Mesh<Float, Spectrum>::load_cached(const fs::path &path,
+                                                    const std::string &key) {
+    AssetCache *cache = AssetCache::instance();
+    if (!cache)
+        return false;
+
+    ref<MeshData> data = static_cast<MeshData *>(cache->find(path,
+        mesh_cache_key<Float, Spectrum>(key, m_to_world, m_disable_vertex_normals)).get());
+    if (!data)
+        return false;
+
+    m_vertex_struct = data->vertex_struct;
+    m_face_struct   = data->face_struct;
+    m_vertex_count  = (ScalarSize) data->vertex_count;
+    m_face_count    = (ScalarSize) data->face_count;
+    m_vertex_size   = (ScalarSize) data->vertex_size;
+    m_face_size     = (ScalarSize) data->face_size;
+
+    if (m_vertex_struct->has_field("nx"))
+        m_normal_offset = (ScalarIndex) m_vertex_struct->offset("nx");
+    if (m_vertex_struct->has_field("u"))
+        m_texcoord_offset = (ScalarIndex) m_vertex_struct->offset("u");
+    if (m_vertex_struct->has_field("r"))
+        m_color_offset = (ScalarIndex) m_vertex_struct->offset("r");
+
+    m_vertices = VertexHolder(new uint8_t[(data->vertex_count + 1) * data->vertex_size]);
+    m_faces    = FaceHolder(new uint8_t[(data->face_count + 1) * data->face_size]);
+    memcpy(m_vertices.get(), data->vertices.get(), (data->vertex_count + 1) * data->vertex_size);
+    memcpy(m_faces.get(), data->faces.get(), (data->face_count + 1) * data->face_size);
+
+    if (!data->name.empty())
+        m_name = data->name;
+    recompute_bbox();
+
+    Log(Debug, "\"%s\": using cached copy (%i faces, %i vertices)",
+        m_name, m_face_count, m_vertex_count);
+    return true;
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::store_cached(const fs::path &path,
+                                                     const std::string &key) const {
+    AssetCache *cache = AssetCache::instance();
+    if (!cache || !m_vertices || !m_faces)
+        return;
+
+    ref<MeshData> data = new MeshData(m_name, m_vertex_struct, m_face_struct,
+                                      m_vertices.get(), m_vertex_count, m_vertex_size,
+                                      m_faces.get(), m_face_count, m_face_size);
+    cache->put(path, mesh_cache_key<Float, Spectrum>(key, m_to_world, m_disable_vertex_normals),
+               data, data->size());
+}
+
 MTS_VARIANT void Mesh<Float, Spectrum>::area_distr_build() {
     if (m_face_count == 0)
         Throw("Cannot create sampling table for an empty mesh: %s", to_string());
@@ -0,0 +1,19 @@
+#include <mitsuba/render/blockscheduler.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(BlockScheduler) {
+    using Vector2i = typename BlockScheduler::Vector2i;
+    MTS_PY_CLASS(BlockScheduler, Object)
+        .def(py::init<Vector2i, Vector2i, size_t, size_t, size_t>(),
+            "size"_a, "offset"_a, "block_size"_a = MTS_BLOCK_SIZE, "passes"_a = 1,
+            "worker_count"_a = 1, D(BlockScheduler, BlockScheduler))
+        .def_method(BlockScheduler, max_block_size)
+        .def_method(BlockScheduler, block_count)
+        .def_method(BlockScheduler, id_count)
+        .def_method(BlockScheduler, block, "index"_a)
+        .def_method(BlockScheduler, set_cost, "index"_a, "cost"_a)
+        .def_method(BlockScheduler, cost, "index"_a)
+        .def_method(BlockScheduler, record_cost, "block_id"_a, "cost"_a)
+        .def_method(BlockScheduler, reset)
+        .def_method(BlockScheduler, next_block);
+}
@@ -0,0 +1,13 @@
+#include <mitsuba/render/denoiser.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(Denoiser) {
+    MTS_PY_CLASS(Denoiser, Object)
+        .def(py::init<size_t, float, float, float>(),
+            "iterations"_a = 5, "sigma_color"_a = 4.f, "sigma_normal"_a = 128.f,
+            "sigma_albedo"_a = .1f, D(Denoiser, Denoiser))
+        .def("denoise", &Denoiser::denoise, "color"_a, "albedo"_a = nullptr,
+            "normal"_a = nullptr, "variance"_a = nullptr,
+            py::call_guard<py::gil_scoped_release>(), D(Denoiser, denoise))
+        .def_method(Denoiser, iterations);
+}
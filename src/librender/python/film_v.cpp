@@ -11,6 +11,8 @@ MTS_PY_EXPORT(Film) {
     MTS_PY_IMPORT_TYPES(Film)
     MTS_PY_CLASS(Film, Object)
         .def_method(Film, prepare, "channels"_a)
+        .def_method(Film, set_pass_count, "count"_a)
+        .def_method(Film, streams_output)
         .def_method(Film, put, "block"_a)
         .def_method(Film, set_destination_file, "filename"_a)
         .def("develop", py::overload_cast<>(&Film::develop))
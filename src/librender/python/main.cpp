@@ -1,6 +1,8 @@
 #include <mitsuba/python/python.h>
 
+MTS_PY_DECLARE(BlockScheduler);
 MTS_PY_DECLARE(BSDFContext);
+MTS_PY_DECLARE(Denoiser);
 MTS_PY_DECLARE(EmitterExtras);
 MTS_PY_DECLARE(MicrofacetType);
 MTS_PY_DECLARE(PhaseFunctionExtras);
@@ -10,7 +12,9 @@ PYBIND11_MODULE(render_ext, m) {
     // Temporarily change the module name (for pydoc)
     m.attr("__name__") = "mitsuba.render";
 
+    MTS_PY_IMPORT(BlockScheduler);
     MTS_PY_IMPORT(BSDFContext);
+    MTS_PY_IMPORT(Denoiser);
     MTS_PY_IMPORT(EmitterExtras);
     MTS_PY_IMPORT(MicrofacetType);
     MTS_PY_IMPORT(PhaseFunctionExtras);
@@ -36,6 +36,8 @@ MTS_PY_EXPORT(Shape) {
             &Shape::bbox, py::const_), D(Shape, bbox, 2), "index"_a)
         .def("bbox", py::overload_cast<ScalarUInt32, const ScalarBoundingBox3f &>(
             &Shape::bbox, py::const_), D(Shape, bbox, 3), "index"_a, "clip"_a)
+        .def("primitive_sphere", &Shape::primitive_sphere, "index"_a,
+            D(Shape, primitive_sphere))
         .def_method(Shape, surface_area)
         .def_method(Shape, id)
         .def_method(Shape, is_mesh)
@@ -1,5 +1,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/timeline.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/scene.h>
@@ -88,10 +90,18 @@ MTS_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
             create_object<Integrator>(Properties("path"));
     }
 
-    if constexpr (is_cuda_array_v<Float>)
-        accel_init_gpu(props);
-    else
-        accel_init_cpu(props);
+    /* Build the acceleration data structure */ {
+#if defined(MTS_ENABLE_EMBREE)
+        const char *accel_name = is_cuda_array_v<Float> ? "optix" : "embree";
+#else
+        const char *accel_name = is_cuda_array_v<Float> ? "optix" : "kdtree";
+#endif
+        ScopedTimelineEvent timeline_event("accel", accel_name);
+        if constexpr (is_cuda_array_v<Float>)
+            accel_init_gpu(props);
+        else
+            accel_init_cpu(props);
+    }
 
     // Create emitters' shapes (environment luminaires)
     for (Emitter *emitter: m_emitters)
@@ -108,6 +118,7 @@ MTS_VARIANT Scene<Float, Spectrum>::~Scene() {
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+    MTS_STATS(stats_count(StatsCounter::IntersectionRays, active));
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_intersect_gpu(ray, active);
@@ -131,6 +142,7 @@ Scene<Float, Spectrum>::ray_intersect_naive(const Ray3f &ray, Mask active) const
 MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
+    MTS_STATS(stats_count(StatsCounter::ShadowRays, active));
 
     if constexpr (is_cuda_array_v<Float>)
         return ray_test_gpu(ray, active);
@@ -272,6 +272,18 @@ MTS_VARIANT typename Shape<Float, Spectrum>::Mask Shape<Float, Spectrum>::ray_te
     return ray_intersect(ray, unused).first;
 }
 
+MTS_VARIANT std::pair<typename Shape<Float, Spectrum>::Mask, Float>
+Shape<Float, Spectrum>::ray_intersect_primitive(ScalarIndex /*index*/, const Ray3f &ray,
+                                                Float *cache, Mask active) const {
+    return ray_intersect(ray, cache, active);
+}
+
+MTS_VARIANT typename Shape<Float, Spectrum>::Mask
+Shape<Float, Spectrum>::ray_test_primitive(ScalarIndex /*index*/, const Ray3f &ray,
+                                           Mask active) const {
+    return ray_test(ray, active);
+}
+
 MTS_VARIANT void Shape<Float, Spectrum>::fill_surface_interaction(const Ray3f & /*ray*/,
                                                                   const Float * /*cache*/,
                                                                   SurfaceInteraction3f & /*si*/,
@@ -317,6 +329,11 @@ Shape<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip)
     return result;
 }
 
+MTS_VARIANT typename Shape<Float, Spectrum>::ScalarBoundingSphere3f
+Shape<Float, Spectrum>::primitive_sphere(ScalarIndex) const {
+    return ScalarBoundingSphere3f();
+}
+
 MTS_VARIANT typename Shape<Float, Spectrum>::ScalarSize
 Shape<Float, Spectrum>::primitive_count() const {
     return 1;
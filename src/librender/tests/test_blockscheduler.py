@@ -0,0 +1,94 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def extract_blocks(scheduler, max_blocks = 1000):
+    blocks = []
+    b = scheduler.next_block()
+
+    while np.prod(b[1]) > 0:
+        blocks.append(b)
+        b = scheduler.next_block()
+
+        assert len(blocks) <= max_blocks,\
+               "Too many blocks produced, implementation is probably wrong."
+    return blocks
+
+
+def test01_spiral_order(variant_scalar_rgb):
+    from mitsuba.render import BlockScheduler, Spiral
+
+    # Without cost estimates, the blocks are generated in spiral order
+    s = BlockScheduler([318, 322], [5, 7], passes=2)
+    spiral = Spiral([318, 322], [5, 7], passes=2)
+    assert s.block_count() == 110
+
+    blocks, expected = extract_blocks(s), extract_blocks(spiral)
+    assert len(blocks) == len(expected)
+    for b, e in zip(blocks, expected):
+        assert ek.all(b[0] == e[0]) and ek.all(b[1] == e[1])
+
+    ids = [b[2] for b in blocks]
+    assert len(set(ids)) == len(ids)
+    assert max(ids) < s.id_count()
+
+
+def test02_cost_order(variant_scalar_rgb):
+    from mitsuba.render import BlockScheduler
+
+    s = BlockScheduler([128, 64], [0, 0], block_size=32, worker_count=1)
+    assert s.block_count() == 8
+    for i in range(s.block_count()):
+        s.set_cost(i, float(i))
+    assert s.cost(3) == 3.0
+
+    # Most expensive first
+    blocks = extract_blocks(s)
+    assert len(blocks) == 8
+    for i, b in enumerate(blocks):
+        offset, size = s.block(7 - i)
+        assert ek.all(b[0] == offset) and ek.all(b[1] == size)
+
+
+def test03_split(variant_scalar_rgb):
+    from mitsuba.render import BlockScheduler
+
+    s = BlockScheduler([64, 64], [10, 20], block_size=32, worker_count=4)
+    for i in range(s.block_count()):
+        s.set_cost(i, 1.0)
+    s.set_cost(2, 100.0)
+
+    # The expensive block is split into four quadrants that are processed first
+    blocks = extract_blocks(s)
+    assert len(blocks) == 7
+    offset, size = s.block(2)
+    area = 0
+    for b in blocks[:4]:
+        assert ek.all(b[0] >= offset) and ek.all(b[0] + b[1] <= offset + size)
+        area += np.prod(b[1])
+    assert area == np.prod(size)
+
+    ids = [b[2] for b in blocks]
+    assert len(set(ids)) == len(ids)
+
+    # The measured time of a sub-block is extrapolated to the whole block
+    s.record_cost(blocks[0][2], 0.5)
+    assert ek.allclose(s.cost(2), 2.0)
+
+
+def test04_record_cost(variant_scalar_rgb):
+    from mitsuba.render import BlockScheduler
+
+    # Costs measured during a pass determine the order of the next pass
+    s = BlockScheduler([64, 32], [0, 0], block_size=32, passes=2)
+    first = s.next_block()
+    second = s.next_block()
+    s.record_cost(first[2], 1.0)
+    s.record_cost(second[2], 2.0)
+
+    blocks = extract_blocks(s)
+    assert len(blocks) == 2
+    assert ek.all(blocks[0][0] == second[0])
+    assert ek.all(blocks[1][0] == first[0])
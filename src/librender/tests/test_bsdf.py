@@ -28,3 +28,41 @@ def test02_bs_construct(variant_scalar_rgb):
     assert ek.allclose(bs.pdf, 0.0)
     assert ek.allclose(bs.eta, 1.0)
     assert bs.sampled_type == 0
+
+
+@pytest.mark.parametrize("bsdf_xml", [
+    '<bsdf type="diffuse"/>',
+    '<bsdf type="plastic"/>',
+    '<bsdf type="roughplastic"><float name="alpha" value="0.2"/></bsdf>',
+    '<bsdf type="roughplastic"><boolean name="sample_visible" value="false"/></bsdf>',
+    '<bsdf type="roughconductor"><float name="alpha" value="0.2"/></bsdf>',
+    '<bsdf type="roughdielectric"><float name="alpha" value="0.3"/></bsdf>',
+    '<bsdf type="roughdielectric"><boolean name="sample_visible" value="false"/></bsdf>',
+    '<bsdf type="conductor"/>',
+    '<bsdf type="blendbsdf"><float name="weight" value="0.3"/>'
+    '<bsdf type="diffuse"/><bsdf type="roughconductor"/></bsdf>',
+    '<bsdf type="mask"><float name="opacity" value="0.4"/><bsdf type="diffuse"/></bsdf>',
+    '<bsdf type="twosided"><bsdf type="roughplastic"/></bsdf>',
+])
+def test03_eval_pdf(variant_scalar_rgb, bsdf_xml):
+    from mitsuba.core import Frame3f, warp
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import BSDFContext, SurfaceInteraction3f
+
+    bsdf = load_string(bsdf_xml.replace('<bsdf ', '<bsdf version="2.0.0" ', 1))
+
+    si = SurfaceInteraction3f()
+    si.p = [0, 0, 0]
+    si.n = [0, 0, 1]
+    si.sh_frame = Frame3f(si.n)
+    si.wavelengths = []
+    ctx = BSDFContext()
+
+    # The fused query must match separate calls to eval() and pdf()
+    for i in range(8):
+        si.wi = warp.square_to_uniform_sphere([(i + 0.5) / 8, 0.3])
+        for j in range(16):
+            wo = warp.square_to_uniform_sphere([(j + 0.5) / 16, (3 * j % 16 + 0.5) / 16])
+            value, pdf = bsdf.eval_pdf(ctx, si, wo)
+            assert ek.allclose(value, bsdf.eval(ctx, si, wo), rtol=1e-4, atol=1e-6)
+            assert ek.allclose(pdf, bsdf.pdf(ctx, si, wo), rtol=1e-4, atol=1e-6)
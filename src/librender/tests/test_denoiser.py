@@ -0,0 +1,56 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def make_bitmap(array):
+    from mitsuba.core import Bitmap
+    return Bitmap(np.ascontiguousarray(array, dtype=np.float32))
+
+
+def test01_construct(variant_scalar_rgb):
+    from mitsuba.render import Denoiser
+
+    d = Denoiser(iterations=3)
+    assert d.iterations() == 3
+
+    with pytest.raises(RuntimeError):
+        Denoiser(sigma_color=0)
+
+
+def test02_reduce_noise(variant_scalar_rgb):
+    from mitsuba.render import Denoiser
+
+    np.random.seed(1234)
+    noisy = 0.5 + 0.1 * np.random.normal(size=(48, 64, 3))
+    result = np.array(Denoiser().denoise(make_bitmap(noisy)), copy=False)
+
+    assert result.shape == (48, 64, 3)
+    assert np.std(result) < 0.25 * np.std(noisy)
+    assert ek.allclose(np.mean(result), 0.5, atol=1e-2)
+
+
+def test03_preserve_edges(variant_scalar_rgb):
+    from mitsuba.render import Denoiser
+
+    # Two surfaces with different normals and albedos meet in the middle
+    np.random.seed(1234)
+    albedo = np.full((32, 32, 3), 0.2)
+    albedo[:, 16:] = 0.8
+    normal = np.zeros((32, 32, 3))
+    normal[:, :16, 2] = 1
+    normal[:, 16:, 0] = 1
+    noisy = albedo * (1 + 0.1 * np.random.normal(size=(32, 32, 3)))
+    variance = np.full((32, 32, 1), 0.01 * 0.5 ** 2)
+
+    result = np.array(Denoiser().denoise(make_bitmap(noisy), make_bitmap(albedo),
+                                         make_bitmap(normal), make_bitmap(variance)),
+                      copy=False)
+
+    assert ek.allclose(result[:, :16], 0.2, atol=0.02)
+    assert ek.allclose(result[:, 16:], 0.8, atol=0.08)
+
+    # Mismatched resolutions are rejected
+    with pytest.raises(RuntimeError):
+        Denoiser().denoise(make_bitmap(noisy), make_bitmap(albedo[:16]))
@@ -38,7 +38,37 @@ def _save(film, int_name, suffix=''):
     scene_i += 1
 
 
-def check_scene(int_name, scene_name, is_empty=False):
+def capture_log(func):
+    """Run ``func()`` and return all messages (including debug output) that
+    were logged in the meantime."""
+    from mitsuba.core import Thread, Appender, LogLevel
+
+    messages = []
+
+    class MyAppender(Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+        def log_progress(self, progress, name, formatted, eta, ptr):
+            pass
+
+    logger = Thread.thread().logger()
+    log_level = logger.log_level()
+    appender = MyAppender()
+    logger.add_appender(appender)
+    logger.set_log_level(LogLevel.Debug)
+    try:
+        func()
+    finally:
+        logger.set_log_level(log_level)
+        logger.remove_appender(appender)
+    return messages
+
+
+def check_scene(int_name, scene_name, is_empty=False, xml=""):
+    """Render a test scene with the given integrator (configured by the
+    optional XML parameters) and compare the average of each channel against
+    the reference. Returns the rendered RGBA image."""
     from mitsuba.core.xml import load_string
     from mitsuba.core import Bitmap, Struct
 
@@ -46,7 +76,7 @@ def check_scene(int_name, scene_name, is_empty=False):
 
     print("variant_name:", variant_name)
 
-    integrator = make_integrator(int_name, "")
+    integrator = make_integrator(int_name, xml)
     scene = SCENES[scene_name]['factory']()
     integrator_type = {
         'direct': 'direct',
@@ -65,14 +95,14 @@ def check_scene(int_name, scene_name, is_empty=False):
         _save(film, int_name, suffix='_' + variant_name)
 
     converted = film.bitmap(raw=True).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
-    values = np.array(converted, copy=False)
+    values = np.array(converted, copy=True)
     means = np.mean(values, axis=(0, 1))
     # Very noisy images, so we add a tolerance
     assert ek.allclose(means, avg, rtol=5e-2), \
         "Mismatch: {} integrator, {} scene, {}".format(
             int_name, scene_name, variant_name)
 
-    return np.array(film.bitmap(raw=False), copy=True)
+    return values
 
 
 @pytest.mark.parametrize(*integrators)
@@ -148,6 +178,230 @@ def test06_render_timeout(variants_cpu_rgb, int_name):
     assert ek.allclose(timeout, effective, atol=0.5)
 
 
+@pytest.mark.parametrize(*integrators)
+def test07_render_progressive(variants_cpu_rgb, int_name):
+    from mitsuba.core import Timeline
+
+    # Passes of 2, 4, 8, ... spp accumulate to the same average as a single pass
+    Timeline.set_enabled(True)
+    try:
+        Timeline.reset()
+        check_scene(int_name, 'teapot', xml="""
+            <boolean name="progressive" value="true"/>
+            <integer name="samples_per_pass" value="2"/>
+        """)
+        passes = [e.name for e in Timeline.events() if e.category == 'pass']
+    finally:
+        Timeline.set_enabled(False)
+        Timeline.reset()
+
+    # The pass size doubles until the 32 samples per pixel are exhausted
+    assert passes == ['pass 1 (2 spp)', 'pass 2 (4 spp)', 'pass 3 (8 spp)',
+                      'pass 4 (16 spp)', 'pass 5 (2 spp)']
+
+
+@pytest.mark.parametrize(*integrators)
+def test08_render_progressive_timeout(variants_cpu_rgb, int_name):
+    from timeit import timeit
+
+    if mitsuba.core.DEBUG:
+        pytest.skip("Timeout is unreliable in debug mode.")
+
+    timeout = 0.5
+    integrator = make_integrator(int_name, """
+        <boolean name="progressive" value="true"/>
+        <float name="timeout" value="{}"/>
+    """.format(timeout))
+    scene = SCENES['teapot']['factory'](spp=100000)
+    sensor = scene.sensors()[0]
+
+    def wrapped():
+        assert integrator.render(scene, sensor) is True
+
+    effective = timeit(wrapped, number=1)
+    assert ek.allclose(timeout, effective, atol=0.5)
+
+    # Only complete passes are kept: every pixel received samples
+    weights = np.array(sensor.film().bitmap(raw=True), copy=False)[:, :, 4]
+    assert np.all(weights > 0)
+
+
+def test09_render_guided_path(variant_scalar_rgb):
+    import re
+
+    # Guided sampling is unbiased: the image matches the path tracer on average
+    messages = capture_log(lambda: check_scene('guided_path', 'box', xml="""
+        <float name="spatial_threshold" value="100"/>
+    """))
+
+    # The SD-tree was refined beyond its root based on the recorded radiance
+    leaves = [int(m.group(1)) for m in
+              (re.search(r'SD-tree has (\d+) spatial leaves', text) for text in messages)
+              if m is not None]
+    assert len(leaves) > 0
+    assert leaves[-1] > 1
+
+
+@pytest.mark.parametrize('caustics_only', [False, True])
+def test10_render_photonmapper(variant_scalar_rgb, caustics_only):
+    # The density estimate blurs the image, but preserves its average
+    image = check_scene('photonmapper', 'box', xml="""
+        <boolean name="caustics_only" value="{}"/>
+    """.format('true' if caustics_only else 'false'))
+
+    # Indirect illumination accounts for most of the brightness of the box.
+    # Without 'caustics_only', camera paths end at the first diffuse surface
+    # and the photon map provides all of it.
+    direct = np.array(SCENES['box']['direct'])
+    assert np.all(np.mean(image, axis=(0, 1))[:3] > 2 * direct[:3])
+
+
+@pytest.mark.parametrize('int_name', ['direct', 'path'])
+def test11_render_emitter_candidates(variants_cpu_rgb, int_name):
+    from mitsuba.core import Bitmap, Struct
+
+    # Resampled emitter sampling is unbiased
+    image = check_scene(int_name, 'box', xml="""
+        <integer name="emitter_candidates" value="4"/>
+    """)
+    if int_name != 'direct':
+        return
+
+    # .. and reduces the error of direct illumination at equal sample counts
+    scene = SCENES['box']['factory'](spp=256)
+    sensor = scene.sensors()[0]
+    assert make_integrator('direct').render(scene, sensor) is True
+    reference = np.array(sensor.film().bitmap(raw=True).convert(
+        Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False), copy=True)
+
+    def error(values):
+        return np.mean((values[:, :, :3] - reference[:, :, :3]) ** 2)
+
+    assert error(image) < error(check_scene('direct', 'box'))
+
+
+def test12_render_aov_albedo_moment(variants_cpu_rgb):
+    from mitsuba.core.xml import load_string
+
+    scene = load_string("""<scene version='2.0.0'>
+        <integrator type="aov">
+            <string name="aovs" value="alb:albedo,mom:moment"/>
+            <integrator type="path" name="image"/>
+        </integrator>
+        <sensor type="perspective">
+            <transform name="to_world">
+                <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="16"/>
+                <integer name="height" value="16"/>
+                <rfilter type="box"/>
+            </film>
+            <sampler type="independent">
+                <integer name="sample_count" value="16"/>
+            </sampler>
+        </sensor>
+        <emitter type="constant"/>
+        <shape type="sphere">
+            <bsdf type="diffuse">
+                <rgb name="reflectance" value="0.2, 0.5, 0.8"/>
+            </bsdf>
+        </shape>
+    </scene>""")
+    sensor = scene.sensors()[0]
+    film = sensor.film()
+    assert scene.integrator().render(scene, sensor) is True
+
+    # Channels: X, Y, Z, A, W, alb.[RGB], mom, image.[RGBA]
+    values = np.array(film.bitmap(raw=True), copy=False)
+    values = values[:, :, :-1] / values[:, :, 4:5]
+    albedo, moment = values[:, :, 5:8], values[:, :, 8]
+
+    # Rays that miss the sphere see the unit background radiance and no BSDF
+    assert ek.allclose(albedo[0, 0], 0)
+    assert ek.allclose(moment[0, 0], 1, rtol=1e-4)
+
+    # The diffuse BSDF's sample weight is its albedo
+    assert ek.allclose(albedo[8, 8], [0.2, 0.5, 0.8], rtol=1e-3)
+
+    # Second moment of the luminance: E[L^2] >= E[L]^2
+    luminance = np.dot(values[:, :, 9:12], [0.212671, 0.715160, 0.072169])
+    assert np.all(moment >= luminance ** 2 * (1 - 1e-3))
+    assert moment[8, 8] < 1
+
+
+def test13_render_photonmapper_caustics(variant_scalar_rgb):
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.core.xml import load_string
+
+    # A glass sphere focuses the light of a spherical emitter onto a diffuse plane
+    def render(integrator):
+        scene = load_string("""<scene version='2.0.0'>
+            {}
+            <sensor type="perspective">
+                <transform name="to_world">
+                    <lookat origin="0, -3, 3" target="0, 0, 0.3" up="0, 0, 1"/>
+                </transform>
+                <film type="hdrfilm">
+                    <integer name="width" value="32"/>
+                    <integer name="height" value="32"/>
+                </film>
+                <sampler type="independent">
+                    <integer name="sample_count" value="512"/>
+                </sampler>
+            </sensor>
+            <shape type="sphere">
+                <point name="center" x="0" y="0" z="5"/>
+                <float name="radius" value="1"/>
+                <emitter type="area">
+                    <rgb name="radiance" value="10"/>
+                </emitter>
+            </shape>
+            <shape type="sphere">
+                <point name="center" x="0" y="0" z="1"/>
+                <float name="radius" value="0.5"/>
+                <bsdf type="dielectric"/>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <scale value="3"/>
+                </transform>
+                <bsdf type="diffuse"/>
+            </shape>
+        </scene>""".format(integrator))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor) is True
+        converted = sensor.film().bitmap(raw=True).convert(
+            Bitmap.PixelFormat.RGBA, Struct.Type.Float32, False)
+        return np.array(converted, copy=True)
+
+    image_pm = render("""<integrator type="photonmapper">
+        <boolean name="caustics_only" value="true"/>
+        <integer name="photon_count" value="1000000"/>
+    </integrator>""")
+    image_path = render("""<integrator type="path"/>""")
+
+    # The caustic is rendered from the photon map instead of by the path
+    # tracer, which preserves the average brightness of the whole image and
+    # of the region around the caustic below the sphere
+    assert ek.allclose(np.mean(image_pm, axis=(0, 1)),
+                       np.mean(image_path, axis=(0, 1)), rtol=5e-2)
+    assert ek.allclose(np.mean(image_pm[12:24, 10:22], axis=(0, 1)),
+                       np.mean(image_path[12:24, 10:22], axis=(0, 1)), rtol=1e-1)
+
+
+def test14_render_guided_path_adrrs(variant_scalar_rgb):
+    # Russian roulette and splitting based on the learned radiance is unbiased
+    images = [check_scene('guided_path', 'box', xml="""
+        <float name="spatial_threshold" value="100"/>
+        <boolean name="adrrs" value="{}"/>
+    """.format(adrrs)) for adrrs in ['false', 'true']]
+
+    # Both renderings use the same seeds and SD-tree refinement criteria, hence
+    # the images can only differ due to paths that were terminated or split
+    assert not np.allclose(images[0], images[1])
+
+
 def make_reference_renders():
     mitsuba.set_variant('scalar_rgb')
     from mitsuba.core import Bitmap, Struct
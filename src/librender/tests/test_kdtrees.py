@@ -131,3 +131,58 @@ def test03_depth_packet_stairs(variant_packet_rgb):
     # TODO: spot-check (here, we only check consistency)
     assert ek.all(res_shadow == res.is_valid())
     compare_results(res_naive, res, atol=1e-6)
+
+
+@pytest.mark.parametrize("triangle_blocks", [True, False])
+def test04_depth_scalar_mixed(variant_scalar_rgb, triangle_blocks):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Leaves contain both mesh triangles and analytic shapes
+    scene = load_string("""
+        <scene version="0.5.0">
+            <boolean name="kd_triangle_blocks" value="{}"/>
+            <shape type="cube">
+                <transform name="to_world">
+                    <scale value="0.5"/>
+                </transform>
+            </shape>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <translate z="-0.2"/>
+                </transform>
+            </shape>
+            <shape type="sphere">
+                <point name="center" x="0.3" y="0.2" z="0.4"/>
+                <float name="radius" value="0.3"/>
+            </shape>
+        </scene>
+    """.format("true" if triangle_blocks else "false"))
+    b = scene.bbox()
+
+    n = 40
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.max[2] + 1]
+            d = [0.1, -0.05, -1]
+            r = Ray3f(o, d, 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+            assert ek.all(res_shadow == res_naive.is_valid())
+            compare_results(res_naive, res, atol=1e-5)
+            if res.is_valid():
+                assert res.shape == res_naive.shape
+                assert res.prim_index == res_naive.prim_index
+                assert ek.allclose(res.uv, res_naive.uv, atol=1e-5)
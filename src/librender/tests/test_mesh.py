@@ -228,3 +228,80 @@ def test06_load_various_features(variant_scalar_rgb, mesh_format, features, face
                 assert ek.allclose(v[3:6], [0.0, 1.0, 0.0])
 
     return fresolver_append_path(test)()
+
+
+@fresolver_append_path
+def test07_ply_asset_cache(variant_scalar_rgb):
+    from mitsuba.core import AssetCache
+    from mitsuba.core.xml import load_string
+
+    cache = AssetCache.instance()
+    cache.clear()
+    hits = cache.hit_count()
+
+    xml = """
+        <shape type="ply" version="2.0.0">
+            <string name="filename" value="data/triangle.ply"/>
+            <transform name="to_world">
+                <translate x="{}"/>
+            </transform>
+        </shape>
+    """
+    shape_1 = load_string(xml.format(0))
+    shape_2 = load_string(xml.format(0))
+    assert cache.hit_count() == hits + 1
+    assert cache.entry_count() == 1
+    assert cache.memory_usage() > 0
+    assert ek.allclose(shape_1.vertices()['y'], shape_2.vertices()['y'])
+    assert ek.allclose(shape_1.vertices()['nx'], shape_2.vertices()['nx'])
+
+    # A different transformation must not reuse the cached geometry
+    shape_3 = load_string(xml.format(1))
+    assert cache.hit_count() == hits + 1
+    assert cache.entry_count() == 2
+    assert ek.allclose(shape_3.vertices()['x'], [1, 1, 1])
+
+    # .. even if it only differs beyond the printed precision
+    shape_4 = load_string(xml.format(1.000001))
+    assert cache.hit_count() == hits + 1
+    assert cache.entry_count() == 3
+    assert ek.allclose(shape_4.vertices()['x'], [1.000001] * 3)
+
+    # Shapes do not share their vertex buffers
+    shape_1.vertices()['y'][0] = 5
+    assert ek.allclose(shape_2.vertices()['y'], [0, 0, 1])
+
+    cache.set_memory_limit(0)
+    assert cache.entry_count() == 0
+    cache.set_memory_limit(4 * 1024 * 1024 * 1024)
+
+
+def test08_asset_cache_disabled(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import AssetCache, Bitmap
+    import numpy as np
+    from mitsuba.core.xml import load_string
+
+    cache = AssetCache.instance()
+    cache.clear()
+    filename = str(tmpdir.join('texture.exr'))
+    Bitmap(np.ones((4, 4, 3), dtype=np.float32)).write(filename)
+
+    xml = """<texture type="bitmap" version="2.0.0">
+        <string name="filename" value="{}"/>
+    </texture>""".format(filename.replace('\\', '/'))
+
+    # Lookups of an enabled cache are recorded
+    misses = cache.miss_count()
+    load_string(xml)
+    assert cache.miss_count() == misses + 1
+    assert cache.entry_count() == 1
+
+    # A disabled cache neither stores entries nor records lookups
+    cache.set_enabled(False)
+    try:
+        load_string(xml)
+        load_string(xml)
+        assert cache.miss_count() == misses + 1
+        assert cache.entry_count() == 0
+    finally:
+        cache.set_enabled(True)
@@ -3,6 +3,7 @@
 #include <mitsuba/core/transform.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/texture.h>
+#include <mitsuba/render/volume_texture.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -96,6 +97,7 @@ Volume<Float, Spectrum>::max() const { NotImplementedError("max"); }
 
 MTS_IMPLEMENT_CLASS_VARIANT(Texture, Object, "texture")
 MTS_IMPLEMENT_CLASS_VARIANT(Volume, Object, "volume")
+MTS_IMPLEMENT_CLASS(VolumeData, Object)
 
 MTS_INSTANTIATE_CLASS(Texture)
 MTS_INSTANTIATE_CLASS(Volume)
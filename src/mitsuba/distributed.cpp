@@ -0,0 +1,768 @@
+#include "distributed.h"
+
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timeline.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/zstream.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/spiral.h>
+#include <atomic>
+#include <deque>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Identifies the distributed rendering protocol ("MTSD")
+static const uint32_t protocol_magic = 0x4D545344;
+static const uint32_t protocol_version = 1;
+
+/// Message types of the distributed rendering protocol
+enum class Message : uint8_t {
+    // Master -> worker
+    Job = 0,
+    Block,
+    JobDone,
+    Shutdown,
+    // Worker -> master
+    Result,
+    Error
+};
+
+/// Number of times that a worker tries to connect to the master (once per second)
+static const int connect_attempts = 30;
+
+/// Interval (in seconds) at which blocked threads check whether the master shuts down
+static const float poll_interval = .5f;
+
+/// Number of errors reported by workers after which the master aborts a job
+static const size_t max_job_errors = 32;
+
+/// Largest (compressed) block payload accepted from a worker, in bytes
+static const uint64_t max_payload_size = 256ull * 1024 * 1024;
+
+static void write_message(Stream *stream, Message message) {
+    stream->write((uint8_t) message);
+}
+
+static Message read_message(Stream *stream) {
+    uint8_t value;
+    stream->read(value);
+    if (value > (uint8_t) Message::Error)
+        Throw("Protocol error: invalid message type %i", (int) value);
+    return (Message) value;
+}
+
+static void write_job(Stream *stream, const DistributedJob &job) {
+    stream->write(job.id);
+    stream->write(job.mode);
+    stream->write(job.scene_file);
+    stream->write((uint32_t) job.params.size());
+    for (const auto &kv : job.params) {
+        stream->write(kv.first);
+        stream->write(kv.second);
+    }
+    stream->write(job.sensor_index);
+    stream->write(job.deferred);
+}
+
+static DistributedJob read_job(Stream *stream) {
+    DistributedJob job;
+    uint32_t param_count;
+    stream->read(job.id);
+    stream->read(job.mode);
+    stream->read(job.scene_file);
+    stream->read(param_count);
+    for (uint32_t i = 0; i < param_count; ++i) {
+        std::string key, value;
+        stream->read(key);
+        stream->read(value);
+        job.params.emplace_back(key, value);
+    }
+    stream->read(job.sensor_index);
+    stream->read(job.deferred);
+    return job;
+}
+
+static void write_block(Stream *stream, const DistributedBlock &block) {
+    stream->write_array(block.offset, 2);
+    stream->write_array(block.size, 2);
+    stream->write(block.id);
+    stream->write(block.sample_count);
+}
+
+static DistributedBlock read_block(Stream *stream) {
+    DistributedBlock block;
+    stream->read_array(block.offset, 2);
+    stream->read_array(block.size, 2);
+    stream->read(block.id);
+    stream->read(block.sample_count);
+    return block;
+}
+
+/// Thread that executes a function (used for the connection handlers)
+class FunctionThread : public Thread {
+public:
+    FunctionThread(const std::string &name, const std::function<void()> &func)
+        : Thread(name), m_func(func) { }
+
+    virtual void run() override { m_func(); }
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~FunctionThread() { }
+
+private:
+    std::function<void()> m_func;
+};
+
+MTS_IMPLEMENT_CLASS(FunctionThread, Thread)
+
+// -----------------------------------------------------------------------------
+
+/// State of the job that is currently processed by the master
+struct JobState {
+    DistributedJob job;
+    std::vector<DistributedBlock> blocks;
+    const RenderMaster::MergeFunction *merge;
+
+    /// Blocks that are not assigned to any connection
+    std::deque<size_t> queue;
+    /// Number of connections that currently render each block
+    std::vector<uint32_t> assigned;
+    /// Whether a result has been received for each block
+    std::vector<bool> done;
+    size_t done_count = 0, merged_count = 0;
+    /// Number of blocks that are currently being merged
+    size_t merging = 0;
+
+    /// Errors reported by workers (e.g. when the scene could not be loaded)
+    size_t error_count = 0;
+    std::string last_error;
+    bool aborted = false;
+
+    ref<ProgressReporter> progress;
+    size_t pixels_merged = 0, total_pixels = 0;
+
+    bool finished() const { return aborted || merged_count == blocks.size(); }
+};
+
+struct RenderMaster::Private {
+    ref<ServerSocket> server;
+    ref<Thread> acceptor;
+    std::vector<ref<Thread>> connections;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::shared_ptr<JobState> job;
+    uint32_t job_counter = 0;
+    size_t connection_count = 0;
+    bool stop = false;
+
+    /// Accept connections until the master shuts down
+    void accept_loop() {
+        size_t index = 0;
+        while (true) {
+            /* Check for shutdown */ {
+                std::lock_guard<std::mutex> guard(mutex);
+                if (stop)
+                    break;
+            }
+            ref<SocketStream> stream;
+            try {
+                stream = server->accept(poll_interval);
+            } catch (const std::exception &e) {
+                Log(Warn, "Could not accept a worker connection: %s", e.what());
+                continue;
+            }
+            if (!stream)
+                continue;
+
+            ref<Thread> thread = new FunctionThread(tfm::format("net%i", index++),
+                                                    [this, stream]() { serve(stream); });
+            std::lock_guard<std::mutex> guard(mutex);
+            connections.push_back(thread);
+            thread->start();
+        }
+    }
+
+    /// Wait for a job that this connection has not processed yet (\c nullptr: shutdown)
+    std::shared_ptr<JobState> wait_job(uint32_t last_id) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&]() {
+            return stop || (job && job->job.id != last_id && !job->finished());
+        });
+        return stop ? nullptr : job;
+    }
+
+    /**
+     * Assign a block to a connection. Blocks until a block is available and
+     * returns \c false once the job is done or the master shuts down.
+     */
+    bool next_block(JobState &state, size_t &index) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (stop || state.aborted || state.done_count == state.blocks.size())
+                return false;
+
+            if (!state.queue.empty()) {
+                index = state.queue.front();
+                state.queue.pop_front();
+                break;
+            }
+
+            /* No unassigned blocks left: duplicate a block that is still in
+               progress so that a slow or stalled worker can't hold up the job */
+            bool found = false;
+            for (size_t i = 0; i < state.blocks.size(); ++i) {
+                if (!state.done[i] && state.assigned[i] == 1) {
+                    index = i;
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                break;
+
+            cv.wait(lock);
+        }
+        state.assigned[index]++;
+        return true;
+    }
+
+    /// Return an unfinished block to the queue (e.g. when a connection was lost)
+    void release(JobState &state, size_t index) {
+        std::lock_guard<std::mutex> guard(mutex);
+        state.assigned[index]--;
+        if (!state.done[index] && state.assigned[index] == 0)
+            state.queue.push_front(index);
+        cv.notify_all();
+    }
+
+    /// Merge the result of a block (duplicates are discarded)
+    void complete(JobState &state, size_t index, std::vector<uint8_t> &payload) {
+        /* Critical section: claim the block */ {
+            std::lock_guard<std::mutex> guard(mutex);
+            state.assigned[index]--;
+            if (state.done[index] || state.aborted)
+                return;
+            state.done[index] = true;
+            state.done_count++;
+            state.merging++;
+            cv.notify_all();
+        }
+
+        try {
+            ref<MemoryStream> ms = new MemoryStream(payload.data(), payload.size());
+            ref<ZStream> zs = new ZStream(ms);
+            zs->set_byte_order(Stream::ENetworkByteOrder);
+            (*state.merge)(state.blocks[index], zs);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(mutex);
+            state.done[index] = false;
+            state.done_count--;
+            state.merging--;
+            if (state.assigned[index] == 0)
+                state.queue.push_front(index);
+            cv.notify_all();
+            throw;
+        }
+
+        std::lock_guard<std::mutex> guard(mutex);
+        const DistributedBlock &block = state.blocks[index];
+        state.merging--;
+        state.merged_count++;
+        state.pixels_merged += (size_t) block.size[0] * (size_t) block.size[1];
+        state.progress->update(state.pixels_merged / (float) state.total_pixels);
+        cv.notify_all();
+    }
+
+    /// Record an error that a worker reported while processing a job
+    void fail(JobState &state, const std::string &error) {
+        std::lock_guard<std::mutex> guard(mutex);
+        state.error_count++;
+        state.last_error = error;
+        cv.notify_all();
+    }
+
+    /// Handle the connection to a single worker thread
+    void serve(ref<SocketStream> stream) {
+        std::string peer = stream->peer();
+        std::shared_ptr<JobState> state;
+        size_t index = (size_t) -1;
+        bool connected = false;
+
+        try {
+            uint32_t magic, version, worker_index;
+            stream->read(magic);
+            stream->read(version);
+            if (magic != protocol_magic || version != protocol_version)
+                Throw("incompatible worker (protocol version %i)", version);
+            stream->read(worker_index);
+
+            /* Critical section: register the connection */ {
+                std::lock_guard<std::mutex> guard(mutex);
+                connection_count++;
+                connected = true;
+            }
+            Log(Info, "Worker %s (thread %i) connected.", peer, worker_index);
+
+            uint32_t last_id = 0;
+            while ((state = wait_job(last_id)) != nullptr) {
+                last_id = state->job.id;
+                write_message(stream, Message::Job);
+                write_job(stream, state->job);
+
+                while (next_block(*state, index)) {
+                    write_message(stream, Message::Block);
+                    write_block(stream, state->blocks[index]);
+
+                    // Wait for the result, but give up when the master shuts down
+                    while (!stream->poll(poll_interval)) {
+                        std::lock_guard<std::mutex> guard(mutex);
+                        if (stop)
+                            Throw("master is shutting down");
+                    }
+
+                    Message message = read_message(stream);
+                    if (message == Message::Error) {
+                        std::string error;
+                        stream->read(error);
+                        fail(*state, error);
+                        Throw("worker reported an error: %s", error);
+                    } else if (message != Message::Result) {
+                        Throw("Protocol error: unexpected message %i", (int) message);
+                    }
+
+                    uint64_t block_id, payload_size;
+                    stream->read(block_id);
+                    stream->read(payload_size);
+                    if (block_id != state->blocks[index].id)
+                        Throw("Protocol error: received block %i, expected %i",
+                              block_id, state->blocks[index].id);
+                    if (payload_size > max_payload_size)
+                        Throw("Protocol error: block payload of %s exceeds the "
+                              "maximum message size (%s)",
+                              util::mem_string((size_t) payload_size),
+                              util::mem_string((size_t) max_payload_size));
+                    std::vector<uint8_t> payload(payload_size);
+                    stream->read(payload.data(), payload.size());
+
+                    size_t completed = index;
+                    index = (size_t) -1;
+                    complete(*state, completed, payload);
+                }
+
+                bool stopped;
+                /* Check for shutdown */ {
+                    std::lock_guard<std::mutex> guard(mutex);
+                    stopped = stop;
+                }
+                if (stopped)
+                    break;
+                write_message(stream, Message::JobDone);
+            }
+            write_message(stream, Message::Shutdown);
+        } catch (const std::exception &e) {
+            Log(Warn, "Lost connection to worker %s: %s", peer, e.what());
+        }
+
+        if (state && index != (size_t) -1)
+            release(*state, index);
+        if (connected) {
+            std::lock_guard<std::mutex> guard(mutex);
+            connection_count--;
+            cv.notify_all();
+        }
+        stream->close();
+    }
+};
+
+RenderMaster::RenderMaster(int port, const std::string &address) : d(new Private()) {
+    d->server = new ServerSocket(port, address);
+    d->acceptor = new FunctionThread("accept", [this]() { d->accept_loop(); });
+    d->acceptor->start();
+    Log(Info, "Distributed rendering: listening for workers on port %i", d->server->port());
+}
+
+RenderMaster::~RenderMaster() {
+    shutdown();
+}
+
+int RenderMaster::port() const {
+    return d->server->port();
+}
+
+size_t RenderMaster::connection_count() const {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    return d->connection_count;
+}
+
+void RenderMaster::render(DistributedJob job, const std::vector<DistributedBlock> &blocks,
+                          const MergeFunction &merge) {
+    auto state = std::make_shared<JobState>();
+    state->blocks = blocks;
+    state->merge = &merge;
+    state->assigned.resize(blocks.size(), 0);
+    state->done.resize(blocks.size(), false);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        state->queue.push_back(i);
+        state->total_pixels += (size_t) blocks[i].size[0] * (size_t) blocks[i].size[1];
+    }
+    state->progress = new ProgressReporter("Rendering");
+
+    std::unique_lock<std::mutex> lock(d->mutex);
+    if (d->stop)
+        Throw("RenderMaster::render(): the master was shut down!");
+    job.id = ++d->job_counter;
+    state->job = job;
+    d->job = state;
+    d->cv.notify_all();
+
+    Log(Info, "Distributing %i blocks of \"%s\" (%i worker thread%s connected)",
+        blocks.size(), job.scene_file, d->connection_count,
+        d->connection_count == 1 ? "" : "s");
+
+    while (!state->finished()) {
+        if (d->stop)
+            Throw("RenderMaster::render(): the master was shut down!");
+
+        /* Give up when too many errors were reported, or when all workers
+           failed without ever producing a result (e.g. because none of them
+           could load the scene) */
+        if (state->error_count >= max_job_errors ||
+            (state->error_count > 0 && state->merged_count == 0 &&
+             d->connection_count == 0)) {
+            state->aborted = true;
+            d->cv.notify_all();
+            // The merge function may not be used anymore once this function returns
+            d->cv.wait(lock, [&]() { return state->merging == 0; });
+            Throw("RenderMaster::render(): aborting the job after %i error%s "
+                  "reported by the workers. The last error was: %s",
+                  state->error_count, state->error_count == 1 ? "" : "s",
+                  state->last_error);
+        }
+
+        if (d->cv.wait_for(lock, std::chrono::seconds(10)) == std::cv_status::timeout &&
+            d->connection_count == 0)
+            Log(Warn, "Waiting for workers to connect on port %i ..", d->server->port());
+    }
+}
+
+void RenderMaster::shutdown() {
+    /* Critical section: notify all threads */ {
+        std::lock_guard<std::mutex> guard(d->mutex);
+        if (d->stop)
+            return;
+        d->stop = true;
+        d->cv.notify_all();
+    }
+
+    d->acceptor->join();
+    for (auto &thread : d->connections)
+        thread->join();
+    d->connections.clear();
+    d->server->close();
+}
+
+MTS_IMPLEMENT_CLASS(RenderMaster, Object)
+
+// -----------------------------------------------------------------------------
+
+/// Number of values stored by an image block (including the border)
+template <typename ImageBlock>
+static size_t block_value_count(const ImageBlock *block) {
+    return block->channel_count() * hprod(block->size() + 2 * block->border_size());
+}
+
+template <typename Float, typename Spectrum>
+bool render_distributed_variant(RenderMaster *master, Object *scene_,
+                                const DistributedJob &job, fs::path filename) {
+    MTS_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, SamplingIntegrator)
+
+    auto *scene = dynamic_cast<Scene *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (job.sensor_index >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    if constexpr (is_cuda_array_v<Float>)
+        Throw("Distributed rendering is not supported in GPU modes!");
+
+    ref<Sensor> sensor = scene->sensors()[job.sensor_index];
+    ref<Film> film = sensor->film();
+    auto *integrator = dynamic_cast<SamplingIntegrator *>(scene->integrator());
+    if (!integrator)
+        Throw("Distributed rendering requires a sampling-based integrator!");
+
+    filename.replace_extension("exr");
+    film->set_destination_file(filename);
+
+    std::vector<std::string> channels = integrator->aov_names();
+    bool has_aovs = !channels.empty();
+    for (size_t i = 0; i < 5; ++i)
+        channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+
+    size_t total_spp        = sensor->sampler()->sample_count(),
+           samples_per_pass = integrator->samples_per_pass(total_spp),
+           n_passes         = total_spp / samples_per_pass;
+
+    film->prepare(channels);
+    film->set_pass_count(n_passes);
+
+    // Same blocks and identifiers (= sampler seeds) as SamplingIntegrator::render()
+    std::vector<DistributedBlock> blocks;
+    ref<Spiral> spiral = new Spiral(film->crop_size(), film->crop_offset(),
+                                    integrator->block_size(), n_passes);
+    while (true) {
+        auto [offset, size, block_id] = spiral->next_block();
+        if (hprod(size) == 0)
+            break;
+        blocks.push_back({ { offset.x(), offset.y() }, { size.x(), size.y() },
+                           (uint64_t) block_id, (uint32_t) samples_per_pass });
+    }
+
+    Log(Info, "Starting distributed render job (%ix%i, %i sample%s,%s %i blocks)",
+        film->crop_size().x(), film->crop_size().y(), total_spp,
+        total_spp == 1 ? "" : "s",
+        n_passes > 1 ? tfm::format(" %d passes,", n_passes) : "", blocks.size());
+
+    auto merge = [&](const DistributedBlock &b, Stream *stream) {
+        ref<ImageBlock> block = new ImageBlock(ScalarVector2i(b.size[0], b.size[1]),
+                                               channels.size(),
+                                               film->reconstruction_filter(),
+                                               !has_aovs);
+        block->set_offset(ScalarPoint2i(b.offset[0], b.offset[1]));
+        stream->read_array(block->data().data(), block_value_count(block.get()));
+        film->put(block);
+    };
+
+    Timer timer;
+    /* Render */ {
+        ScopedTimelineEvent timeline_event("render", "distributed");
+        master->render(job, blocks, merge);
+    }
+    Log(Info, "Rendering finished. (took %s)", util::time_string(timer.value(), true));
+
+    film->develop();
+    return true;
+}
+
+bool render_distributed(RenderMaster *master, Object *scene, const DistributedJob &job,
+                        const fs::path &filename) {
+    return MTS_INVOKE_VARIANT(job.mode, render_distributed_variant, master, scene,
+                              job, filename);
+}
+
+// -----------------------------------------------------------------------------
+
+/// Renders the blocks assigned to one connection of a worker
+class BlockRenderer {
+public:
+    virtual ~BlockRenderer() = default;
+
+    /// Render a block and write its (uncompressed) payload to \c stream
+    virtual void render(const DistributedBlock &block, Stream *stream) = 0;
+};
+
+template <typename Float, typename Spectrum>
+class VariantBlockRenderer : public BlockRenderer {
+public:
+    MTS_IMPORT_TYPES(Scene, Sensor, Sampler, ImageBlock, SamplingIntegrator)
+
+    VariantBlockRenderer(Object *scene, size_t sensor_index) {
+        m_scene = dynamic_cast<Scene *>(scene);
+        if (!m_scene)
+            Throw("Root element of the input file must be a <scene> tag!");
+        if (sensor_index >= m_scene->sensors().size())
+            Throw("Specified sensor index is out of bounds!");
+        m_sensor = m_scene->sensors()[sensor_index];
+        m_integrator = dynamic_cast<SamplingIntegrator *>(m_scene->integrator());
+        if (!m_integrator)
+            Throw("Distributed rendering requires a sampling-based integrator!");
+
+        size_t channel_count = m_integrator->aov_names().size() + 5;
+        m_sampler = m_sensor->sampler()->clone();
+        m_block = new ImageBlock(m_integrator->block_size(), channel_count,
+                                 m_sensor->film()->reconstruction_filter(),
+                                 channel_count == 5);
+        m_aovs.reset(new Float[channel_count]);
+    }
+
+    void render(const DistributedBlock &b, Stream *stream) override {
+        if constexpr (!is_cuda_array_v<Float>) {
+            m_block->set_size(ScalarVector2i(b.size[0], b.size[1]));
+            m_block->set_offset(ScalarPoint2i(b.offset[0], b.offset[1]));
+
+            // Ensure that the sample generation is fully deterministic
+            m_sampler->seed(b.id);
+
+            scoped_flush_denormals flush_denormals(true);
+            m_integrator->render_block(m_scene, m_sensor, m_sampler, m_block,
+                                       m_aovs.get(), b.sample_count);
+            stream->write_array(m_block->data().data(), block_value_count(m_block.get()));
+        } else {
+            ENOKI_MARK_USED(b);
+            ENOKI_MARK_USED(stream);
+            Throw("Distributed rendering is not supported in GPU modes!");
+        }
+    }
+
+private:
+    ref<Scene> m_scene;
+    ref<Sensor> m_sensor;
+    ref<SamplingIntegrator> m_integrator;
+    ref<Sampler> m_sampler;
+    ref<ImageBlock> m_block;
+    std::unique_ptr<Float[]> m_aovs;
+};
+
+template <typename Float, typename Spectrum>
+std::unique_ptr<BlockRenderer> make_block_renderer(Object *scene, size_t sensor_index) {
+    return std::unique_ptr<BlockRenderer>(
+        new VariantBlockRenderer<Float, Spectrum>(scene, sensor_index));
+}
+
+/// State shared by the connections of a worker process
+struct WorkerState {
+    std::mutex mutex;
+    uint32_t job_id = 0;
+    ref<Object> scene;
+    std::string error;
+
+    /// Load the job's scene (once per process) and create a renderer for it
+    std::unique_ptr<BlockRenderer> renderer(const DistributedJob &job) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (job_id != job.id) {
+            job_id = job.id;
+            scene = nullptr;
+            error.clear();
+
+            ref<Thread> thread = Thread::thread();
+            ref<FileResolver> fr = thread->file_resolver();
+            ref<FileResolver> fr2 = new FileResolver(*fr);
+            fs::path scene_dir = fs::path(job.scene_file).parent_path();
+            if (!fr2->contains(scene_dir))
+                fr2->append(scene_dir);
+            thread->set_file_resolver(fr2);
+
+            Log(Info, "Loading scene \"%s\" for job %i ..", job.scene_file, job.id);
+            try {
+                ScopedTimelineEvent timeline_event("scene", job.scene_file);
+                scene = xml::load_file(job.scene_file, job.mode, job.params,
+                                       false, job.deferred);
+            } catch (const std::exception &e) {
+                error = e.what();
+            }
+            thread->set_file_resolver(fr);
+        }
+        if (!scene)
+            Throw("%s", error);
+        return MTS_INVOKE_VARIANT(job.mode, make_block_renderer, scene.get(),
+                                  job.sensor_index);
+    }
+};
+
+/// Serve a single connection to the master. Returns \c true when a job was completed.
+static bool serve_master(const std::string &host, int port, uint32_t index,
+                         WorkerState &state) {
+    ref<SocketStream> stream;
+    for (int attempt = 1; !stream; ++attempt) {
+        try {
+            stream = new SocketStream(host, port);
+        } catch (const std::exception &e) {
+            if (attempt == connect_attempts) {
+                Log(Warn, "%s", e.what());
+                return false;
+            }
+            Thread::sleep(1000);
+        }
+    }
+
+    bool success = false;
+    try {
+        stream->write(protocol_magic);
+        stream->write(protocol_version);
+        stream->write(index);
+
+        std::unique_ptr<BlockRenderer> renderer;
+        while (true) {
+            Message message = read_message(stream);
+            if (message == Message::Job) {
+                DistributedJob job = read_job(stream);
+                try {
+                    renderer = state.renderer(job);
+                } catch (const std::exception &e) {
+                    write_message(stream, Message::Error);
+                    stream->write(std::string(e.what()));
+                    throw;
+                }
+            } else if (message == Message::Block) {
+                DistributedBlock block = read_block(stream);
+                if (!renderer)
+                    Throw("Protocol error: received a block before the job");
+
+                ref<MemoryStream> ms = new MemoryStream();
+                /* Compress the payload */ {
+                    ref<ZStream> zs = new ZStream(ms);
+                    zs->set_byte_order(Stream::ENetworkByteOrder);
+                    try {
+                        renderer->render(block, zs);
+                    } catch (const std::exception &e) {
+                        write_message(stream, Message::Error);
+                        stream->write(std::string(e.what()));
+                        throw;
+                    }
+                    zs->close();
+                }
+
+                write_message(stream, Message::Result);
+                stream->write(block.id);
+                stream->write((uint64_t) ms->size());
+                stream->write(ms->raw_buffer(), ms->size());
+            } else if (message == Message::JobDone) {
+                renderer.reset();
+                success = true;
+            } else if (message == Message::Shutdown) {
+                break;
+            } else {
+                Throw("Protocol error: unexpected message %i", (int) message);
+            }
+        }
+    } catch (const std::exception &e) {
+        Log(Warn, "Connection to the master at %s:%i failed: %s", host, port, e.what());
+    }
+    stream->close();
+    return success;
+}
+
+bool run_worker(const std::string &host, int port, size_t connections) {
+    Log(Info, "Distributed rendering: connecting to the master at %s:%i (%i thread%s)",
+        host, port, connections, connections == 1 ? "" : "s");
+
+    WorkerState state;
+    std::vector<ref<Thread>> threads;
+    std::atomic<bool> success { false };
+    for (size_t i = 0; i < connections; ++i) {
+        threads.push_back(new FunctionThread(
+            tfm::format("wrk%i", i), [&, i]() {
+                if (serve_master(host, port, (uint32_t) i, state))
+                    success = true;
+            }));
+        threads.back()->start();
+    }
+    for (auto &thread : threads)
+        thread->join();
+
+    Log(Info, "Distributed rendering: the master closed the connection.");
+    return success;
+}
+
+NAMESPACE_END(mitsuba)
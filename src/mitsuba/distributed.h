@@ -0,0 +1,116 @@
+#pragma once
+
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/xml.h>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+class ServerSocket;
+class Stream;
+
+/**
+ * \brief Reference to a scene that the master sends to its workers
+ *
+ * The workers load the scene from the same (absolute) path, hence the scene
+ * and its assets must be accessible on all machines, e.g. on a shared file
+ * system or at identical locations.
+ */
+struct DistributedJob {
+    uint32_t id = 0;
+    std::string mode;
+    std::string scene_file;
+    xml::ParameterList params;
+    uint32_t sensor_index = 0;
+    bool deferred = false;
+};
+
+/// An image block that is rendered by a worker
+struct DistributedBlock {
+    int32_t offset[2], size[2];
+    uint64_t id;
+    uint32_t sample_count;
+};
+
+/**
+ * \brief Master of a distributed rendering session
+ *
+ * Listens for worker processes (see \ref run_worker()) and hands out the
+ * image blocks of a job to them. Each worker thread uses its own connection
+ * and renders one block at a time; results are sent back as compressed
+ * image block payloads.
+ *
+ * Lost connections are tolerated: their pending block is handed to another
+ * worker. Once no unassigned blocks remain, idle connections receive
+ * duplicates of blocks that are still in progress, so that a stalled worker
+ * cannot hold up the job. The first result of a block is merged and
+ * duplicates are discarded; since blocks are seeded by their identifier,
+ * all results of a block are identical.
+ */
+class RenderMaster : public Object {
+public:
+    using MergeFunction = std::function<void(const DistributedBlock &, Stream *)>;
+
+    /// Listen for workers on the given port
+    RenderMaster(int port, const std::string &address = "");
+
+    /// Return the port on which the master listens for workers
+    int port() const;
+
+    /// Return the number of currently connected worker threads
+    size_t connection_count() const;
+
+    /**
+     * \brief Render the given blocks using the connected workers
+     *
+     * Blocks until all blocks have been rendered and passed to \c merge,
+     * which receives a stream containing the block's payload and may be
+     * called concurrently. The job's identifier is assigned by this function.
+     *
+     * Throws an exception containing the last error reported by a worker
+     * when too many errors occur, or when all workers failed without ever
+     * producing a result (e.g. because none of them could load the scene).
+     */
+    void render(DistributedJob job, const std::vector<DistributedBlock> &blocks,
+                const MergeFunction &merge);
+
+    /// Disconnect all workers and stop listening for connections
+    void shutdown();
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~RenderMaster();
+
+private:
+    struct Private;
+    std::unique_ptr<Private> d;
+};
+
+/**
+ * \brief Render a scene that was loaded by the master using the connected
+ * workers, and write the developed film to \c filename
+ *
+ * \c scene must be an instance of <tt>Scene<Float, Spectrum></tt> for the
+ * variant given by <tt>job.mode</tt>, and its integrator must be a \ref
+ * SamplingIntegrator.
+ */
+extern bool render_distributed(RenderMaster *master, Object *scene,
+                               const DistributedJob &job,
+                               const fs::path &filename);
+
+/**
+ * \brief Connect to a master and render blocks on its behalf until it shuts
+ * down
+ *
+ * \param connections
+ *     Number of concurrent connections (one per rendering thread)
+ *
+ * \return \c true when at least one job was processed successfully.
+ */
+extern bool run_worker(const std::string &host, int port, size_t connections);
+
+NAMESPACE_END(mitsuba)
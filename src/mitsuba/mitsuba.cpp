@@ -1,12 +1,15 @@
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/timeline.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
@@ -14,6 +17,11 @@
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
 #include <tbb/task_scheduler_init.h>
+#include <condition_variable>
+#include <iostream>
+#include <queue>
+
+#include "distributed.h"
 
 #if !defined(__WINDOWS__)
 #  include <signal.h>
@@ -59,14 +67,61 @@ Options:
         When specified, Mitsuba will update the scene's
         XML description to the latest version.
 
+    -l, --lazy
+        Build the scene's dependency graph before loading it, skip
+        objects with an ID that nothing references (e.g. unused parts
+        of a shared material library), and instantiate the rest in
+        parallel.
+
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
+
+    -b, --batch
+        Batch mode: keep the process alive and read render jobs from
+        standard input (one per line) until EOF is reached. Loaded
+        plugins and the thread pool are reused across jobs. Each line
+        has the form
+
+            [-p <priority>] [-s <index>] [-o <filename>]
+            [-D <key>=<value> ...] <scene XML file>
+
+        Pending jobs with a higher priority are rendered first.
+
+    -P <prefix>, --profile <prefix>
+        Write the sampling profiler's data to "<prefix>.folded"
+        (collapsed stacks for flame graph tools) and "<prefix>.json"
+        (Chrome trace format) after rendering.
+
+    -S <filename>, --stats <filename>
+        Write the render statistics of the last rendering (ray counts,
+        kd-tree traversal costs, path depths) to a JSON file. Requires
+        a build with MTS_ENABLE_STATISTICS.
+
+    -T <filename>, --timeline <filename>
+        Write a timeline of the job (plugin loading, per-object load
+        times, acceleration data structure construction, rendering
+        passes, film development and image output) including the
+        resident memory usage of each phase to a JSON file.
+
+    -L <port>, --listen <port>
+        Distributed rendering: act as the master and hand out the
+        image blocks of each scene to workers that connect to the
+        given port. The scene and its assets must be accessible
+        under the same absolute path on all machines.
+
+    -C <host>:<port>, --connect <host>:<port>
+        Distributed rendering: act as a worker and render blocks on
+        behalf of the master at the given address (one connection
+        per thread) until it shuts down.
 )";
 }
 
 std::function<void(void)> develop_callback;
 std::mutex develop_callback_mutex;
 
+/// Master of a distributed rendering session (-L/--listen)
+ref<RenderMaster> render_master;
+
 template <typename Float, typename Spectrum>
 bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
@@ -100,6 +155,219 @@ bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
     return success;
 }
 
+/// Load a scene description and render it using the requested variant
+static bool render_file(const std::string &scene_file, const std::string &output,
+                        const std::string &mode, size_t sensor_i,
+                        const xml::ParameterList &params, bool update,
+                        bool deferred) {
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+    ref<FileResolver> fr2 = new FileResolver(*fr);
+    thread->set_file_resolver(fr2);
+
+    filesystem::path filename(scene_file);
+
+    // Add the scene file's directory to the search path.
+    fs::path scene_dir = filename.parent_path();
+    if (!fr2->contains(scene_dir))
+        fr2->append(scene_dir);
+
+    if (!output.empty())
+        filename = output;
+
+    bool success = false;
+    try {
+        // Try and parse a scene from the passed file.
+        ref<Object> parsed;
+        /* Load the scene */ {
+            ScopedTimelineEvent timeline_event("scene", scene_file);
+            parsed = xml::load_file(scene_file, mode, params, update, deferred);
+        }
+        if (render_master) {
+            DistributedJob job;
+            job.mode = mode;
+            job.scene_file = fs::absolute(fs::path(scene_file)).string();
+            job.params = params;
+            job.sensor_index = (uint32_t) sensor_i;
+            job.deferred = deferred;
+            success = render_distributed(render_master, parsed.get(), job, filename);
+        } else {
+            success = MTS_INVOKE_VARIANT(mode, render, parsed.get(), sensor_i, filename);
+        }
+    } catch (...) {
+        thread->set_file_resolver(fr);
+        throw;
+    }
+    thread->set_file_resolver(fr);
+    return success;
+}
+
+/// A render job submitted via standard input in batch mode
+struct RenderJob {
+    std::string scene_file;
+    std::string output;
+    size_t sensor_i = 0;
+    int priority = 0;
+    size_t index = 0;
+    xml::ParameterList params;
+
+    /// Ordering used by the job queue: highest priority, then submission order
+    bool operator<(const RenderJob &job) const {
+        if (priority != job.priority)
+            return priority < job.priority;
+        return index > job.index;
+    }
+};
+
+/// Parse a single line of the batch mode job stream
+static RenderJob parse_job(const std::string &line, size_t index) {
+    std::vector<std::string> tokens = string::tokenize(line, " \t");
+    RenderJob job;
+    job.index = index;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string &token = tokens[i];
+        bool has_value = token == "-p" || token == "-s" || token == "-o" || token == "-D";
+        if (has_value && i + 1 == tokens.size())
+            Throw("Missing argument for \"%s\" in job \"%s\"", token, line);
+
+        if (token == "-p") {
+            job.priority = std::stoi(tokens[++i]);
+        } else if (token == "-s") {
+            job.sensor_i = (size_t) std::stoul(tokens[++i]);
+        } else if (token == "-o") {
+            job.output = tokens[++i];
+        } else if (token == "-D") {
+            const std::string &value = tokens[++i];
+            auto sep = value.find('=');
+            if (sep == std::string::npos)
+                Throw("-D: expect key=value pair in job \"%s\"", line);
+            job.params.push_back(std::make_pair(value.substr(0, sep),
+                                                value.substr(sep + 1)));
+        } else if (string::starts_with(token, "-")) {
+            Throw("Argument \"%s\" was not recognized in job \"%s\"", token, line);
+        } else if (job.scene_file.empty()) {
+            job.scene_file = token;
+        } else {
+            Throw("Job \"%s\" specifies more than one scene file", line);
+        }
+    }
+
+    if (job.scene_file.empty())
+        Throw("Job \"%s\" does not specify a scene file", line);
+
+    return job;
+}
+
+/**
+ * \brief Thread-safe priority queue of pending batch mode jobs
+ *
+ * Jobs are produced by a \ref JobReader thread that consumes standard input,
+ * and rendered one after the other by the main thread.
+ */
+class JobQueue {
+public:
+    void push(RenderJob &&job) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_jobs.push(std::move(job));
+        m_cv.notify_one();
+    }
+
+    /// Mark the end of the job stream
+    void close() {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_closed = true;
+        m_cv.notify_all();
+    }
+
+    /// Block until a job is available. Returns \c false once the stream is exhausted.
+    bool pop(RenderJob &job) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return !m_jobs.empty() || m_closed; });
+        if (m_jobs.empty())
+            return false;
+        job = m_jobs.top();
+        m_jobs.pop();
+        return true;
+    }
+
+private:
+    std::priority_queue<RenderJob> m_jobs;
+    std::condition_variable m_cv;
+    std::mutex m_mutex;
+    bool m_closed = false;
+};
+
+/// Reads batch mode render jobs from standard input and submits them to a \ref JobQueue
+class JobReader : public Thread {
+public:
+    JobReader(JobQueue *queue) : Thread("jobs"), m_queue(queue) { }
+
+    virtual void run() override {
+        std::string line;
+        size_t index = 0;
+        while (std::getline(std::cin, line)) {
+            line = string::trim(line);
+            if (line.empty() || line[0] == '#')
+                continue;
+            try {
+                m_queue->push(parse_job(line, index++));
+            } catch (const std::exception &e) {
+                Log(Warn, "Ignoring invalid job: %s", e.what());
+            }
+        }
+        m_queue->close();
+    }
+
+    MTS_DECLARE_CLASS()
+protected:
+    virtual ~JobReader() { }
+
+private:
+    JobQueue *m_queue;
+};
+
+MTS_IMPLEMENT_CLASS(JobReader, Thread)
+
+/**
+ * \brief Batch mode main loop: render jobs from standard input until EOF
+ *
+ * Returns \c true when at least one job rendered successfully.
+ */
+static bool render_batch(const std::string &mode, const xml::ParameterList &params,
+                         bool update, bool deferred) {
+    JobQueue queue;
+    ref<JobReader> reader = new JobReader(&queue);
+    reader->start();
+
+    bool any_success = false;
+    size_t job_count = 0, failed_count = 0;
+    RenderJob job;
+    while (queue.pop(job)) {
+        // Parameters given on the command line apply to every job
+        xml::ParameterList job_params = params;
+        job_params.insert(job_params.end(), job.params.begin(), job.params.end());
+
+        Log(Info, "Batch job %i: rendering \"%s\" (priority %i) ..", job.index,
+            job.scene_file, job.priority);
+        bool success = false;
+        try {
+            success = render_file(job.scene_file, job.output, mode, job.sensor_i,
+                                  job_params, update, deferred);
+        } catch (const std::exception &e) {
+            Log(Warn, "Batch job %i failed: %s", job.index, e.what());
+        }
+        job_count++;
+        if (!success)
+            failed_count++;
+        any_success = any_success || success;
+    }
+
+    reader->join();
+    Log(Info, "Batch mode finished: %i job(s), %i failed.", job_count, failed_count);
+    return any_success;
+}
+
 #if !defined(__WINDOWS__)
 // Handle the hang-up signal and write a partially rendered image to disk
 void hup_signal_handler(int signal) {
@@ -117,6 +385,7 @@ int main(int argc, char *argv[]) {
     Thread::static_initialization();
     Logger::static_initialization();
     Bitmap::static_initialization();
+    AssetCache::static_initialization();
     Profiler::static_initialization();
 
     // Ensure that the mitsuba-render shared library is loaded
@@ -130,10 +399,18 @@ int main(int argc, char *argv[]) {
     auto arg_sensor_i  = parser.add(StringVec{ "-s", "--sensor" }, true);
     auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
     auto arg_update    = parser.add(StringVec{ "-u", "--update" }, false);
+    auto arg_lazy      = parser.add(StringVec{ "-l", "--lazy" }, false);
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_batch     = parser.add(StringVec{ "-b", "--batch" }, false);
+    auto arg_profile   = parser.add(StringVec{ "-P", "--profile" }, true);
+    auto arg_stats     = parser.add(StringVec{ "-S", "--stats" }, true);
+    auto arg_timeline  = parser.add(StringVec{ "-T", "--timeline" }, true);
+    auto arg_listen    = parser.add(StringVec{ "-L", "--listen" }, true);
+    auto arg_connect   = parser.add(StringVec{ "-C", "--connect" }, true);
     auto arg_extra     = parser.add("", true);
     bool print_profile = false;
+    std::string profile_prefix, stats_filename, timeline_filename;
     xml::ParameterList params;
     std::string error_msg;
 
@@ -159,6 +436,12 @@ int main(int argc, char *argv[]) {
                 logger->set_log_level(Debug);
         }
 
+        /* Don't let worker threads wait for each other when logging, and
+           keep repeated warnings (e.g. invalid samples) from flooding the
+           output */
+        Thread::thread()->logger()->set_async(true);
+        Thread::thread()->logger()->set_rate_limit(10);
+
         while (arg_define && *arg_define) {
             std::string value = arg_define->as_string();
             auto sep = value.find('=');
@@ -181,6 +464,20 @@ int main(int argc, char *argv[]) {
             Throw("Thread count must be >= 1!");
         tbb::task_scheduler_init init((int) __global_thread_count);
 
+        if (*arg_profile)
+            profile_prefix = arg_profile->as_string();
+
+        if (*arg_stats) {
+            stats_filename = arg_stats->as_string();
+            if (!Statistics::enabled())
+                Log(Warn, "Render statistics were disabled at compile time "
+                          "(set MTS_ENABLE_STATISTICS in CMake).");
+        }
+        if (*arg_timeline) {
+            timeline_filename = arg_timeline->as_string();
+            Timeline::set_enabled(true);
+        }
+
         // Append the mitsuba directory to the FileResolver search path list
         ref<Thread> thread = Thread::thread();
         ref<FileResolver> fr = thread->file_resolver();
@@ -188,7 +485,7 @@ int main(int argc, char *argv[]) {
         if (!fr->contains(base_path))
             fr->append(base_path);
 
-        if (!*arg_extra || *arg_help) {
+        if ((!*arg_extra && !*arg_batch && !*arg_connect) || *arg_help) {
             help((int) __global_thread_count);
         } else {
             Log(Info, "%s", util::info_build((int) __global_thread_count));
@@ -200,34 +497,58 @@ int main(int argc, char *argv[]) {
 #endif
         }
 
-        while (arg_extra && *arg_extra) {
-            filesystem::path filename(arg_extra->as_string());
-            ref<FileResolver> fr2 = new FileResolver(*fr);
-            thread->set_file_resolver(fr2);
-
-            // Add the scene file's directory to the search path.
-            fs::path scene_dir = filename.parent_path();
-            if (!fr2->contains(scene_dir))
-                fr2->append(scene_dir);
-
-            if (*arg_output)
-                filename = arg_output->as_string();
+        if (*arg_connect && !*arg_help) {
+            if (*arg_extra || *arg_batch || *arg_listen)
+                Throw("-C/--connect: a worker does not accept scene files or "
+                      "other distributed rendering options!");
+            std::string address = arg_connect->as_string();
+            auto sep = address.rfind(':');
+            if (sep == std::string::npos)
+                Throw("-C/--connect: expected a host:port pair!");
+            bool success = run_worker(address.substr(0, sep),
+                                      std::stoi(address.substr(sep + 1)),
+                                      __global_thread_count);
+            print_profile = print_profile || success;
+        }
 
-            // Try and parse a scene from the passed file.
-            ref<Object> parsed =
-                xml::load_file(arg_extra->as_string(), mode, params, *arg_update);
+        if (*arg_listen && !*arg_help)
+            render_master = new RenderMaster(arg_listen->as_int());
 
-            bool success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
-                                              sensor_i, filename);
+        while (arg_extra && *arg_extra) {
+            bool success = render_file(arg_extra->as_string(),
+                                       *arg_output ? arg_output->as_string() : "",
+                                       mode, sensor_i, params, *arg_update, *arg_lazy);
             print_profile = print_profile || success;
             arg_extra = arg_extra->next();
         }
+
+        if (*arg_batch && !*arg_help) {
+            bool success = render_batch(mode, params, *arg_update, *arg_lazy);
+            print_profile = print_profile || success;
+        }
+
+        if (!stats_filename.empty() && print_profile)
+            Statistics::write_json(stats_filename);
     } catch (const std::exception &e) {
         error_msg = std::string("Caught a critical exception: ") + e.what();
     } catch (...) {
         error_msg = std::string("Caught a critical exception of unknown type!");
     }
 
+    if (render_master) {
+        render_master->shutdown();
+        render_master = nullptr;
+    }
+
+    // Also write the timeline of failed jobs (e.g. to diagnose slow or failing asset loads)
+    if (!timeline_filename.empty()) {
+        try {
+            Timeline::write_json(timeline_filename);
+        } catch (const std::exception &e) {
+            std::cerr << "Could not write timeline: " << e.what() << std::endl;
+        }
+    }
+
     if (!error_msg.empty()) {
         /* Strip zero-width spaces from the message (Mitsuba uses these
            to properly format chains of multiple exceptions) */
@@ -256,8 +577,18 @@ int main(int argc, char *argv[]) {
     }
 
     Profiler::static_shutdown();
-    if (print_profile)
+    if (print_profile) {
         Profiler::print_report();
+        if (!profile_prefix.empty()) {
+            try {
+                Profiler::write_flamegraph(profile_prefix + ".folded");
+                Profiler::write_chrome_trace(profile_prefix + ".json");
+            } catch (const std::exception &e) {
+                std::cerr << "Could not write profile: " << e.what() << std::endl;
+            }
+        }
+    }
+    AssetCache::static_shutdown();
     Bitmap::static_shutdown();
     Logger::static_shutdown();
     Thread::static_shutdown();
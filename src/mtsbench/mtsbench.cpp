@@ -0,0 +1,827 @@
+#include <mitsuba/core/appender.h>
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <tbb/task_scheduler_init.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace mitsuba;
+
+static void help() {
+    std::cout << util::info_build((int) __global_thread_count) << std::endl;
+    std::cout << util::info_copyright() << std::endl;
+    std::cout << R"(
+Usage: mtsbench [options]
+
+Runs a suite of performance benchmarks on procedurally generated scenes
+(a large triangle mesh, many area lights, a dense participating medium,
+and texture-heavy shading). The following quantities are measured for
+each requested variant:
+
+  * load/<scene>            Scene loading time, including acceleration
+                            data structure construction (seconds)
+  * kdtree/<scene>          ShapeKDTree::build() (seconds)
+  * rays/<scene>/<op>       Coherent (camera) and incoherent (random)
+                            ray_intersect() and ray_test() throughput
+                            (Mrays/s, single thread)
+  * bsdf/<plugin>/<op>      BSDF::sample() and BSDF::eval() throughput
+                            (Mevals/s, single thread)
+  * render/<scene>/<integ>  End-to-end rendering throughput (Msamples/s)
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -m <variant>, --mode <variant>
+        Variant to benchmark (can be specified multiple times, or set
+        to "all"). Default: )" MTS_DEFAULT_VARIANT R"(
+
+    -t <count>, --threads <count>
+        Render with the specified number of threads.
+
+    -f <text>, --filter <text>
+        Only run benchmarks whose name contains the given text.
+
+    -s <factor>, --scale <factor>
+        Scale the size of all workloads (default: 1).
+
+    -r <count>, --repeat <count>
+        Report the best of several runs (default: 3).
+
+    -o <filename>, --output <filename>
+        Write the results to the given JSON file.
+
+    -b <filename>, --baseline <filename>
+        Compare against the results stored in a previously written
+        JSON file. Returns a nonzero exit code if a regression exceeds
+        the tolerance.
+
+    -e <fraction>, --tolerance <fraction>
+        Relative slowdown that is reported as a regression
+        (default: 0.1).
+
+    -d <directory>, --data <directory>
+        Directory for generated meshes and textures
+        (default: "mtsbench_data").
+)";
+}
+
+// =======================================================================
+//! @{ \name Results and baseline comparison
+// =======================================================================
+
+/// Single benchmark measurement
+struct BenchmarkResult {
+    std::string variant;
+    std::string name;
+    double value;
+    std::string unit;
+    bool higher_is_better;
+};
+
+struct BenchmarkOptions {
+    fs::path data_dir;
+    std::string filter;
+    double scale = 1.0;
+    size_t repeat = 3;
+};
+
+/// Shared state of a benchmark run
+struct BenchmarkContext {
+    BenchmarkOptions options;
+    std::vector<BenchmarkResult> results;
+    std::string variant;
+
+    bool enabled(const std::string &name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    size_t scaled(size_t count) const {
+        return std::max((size_t) 1, (size_t) (count * options.scale));
+    }
+
+    void add(const std::string &name, double value, const std::string &unit,
+             bool higher_is_better) {
+        results.push_back({ variant, name, value, unit, higher_is_better });
+        std::cout << "  " << name << std::string(name.size() < 44 ? 44 - name.size() : 1, ' ')
+                  << tfm::format("%10.4f %s", value, unit) << std::endl;
+    }
+};
+
+using Clock = std::chrono::high_resolution_clock;
+
+/// Run a function several times and return the shortest duration in seconds
+template <typename Func> double time_best(size_t repeat, Func func) {
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < std::max(repeat, (size_t) 1); ++i) {
+        auto start = Clock::now();
+        func();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        best = std::min(best, elapsed);
+    }
+    return best;
+}
+
+static std::string results_to_json(const std::vector<BenchmarkResult> &results) {
+    std::ostringstream oss;
+    oss << "{" << std::endl
+        << "  \"version\": \"" << MTS_VERSION << "\"," << std::endl
+        << "  \"threads\": " << __global_thread_count << "," << std::endl
+        << "  \"results\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        oss << "    { \"variant\": \"" << r.variant << "\", \"name\": \"" << r.name
+            << "\", \"value\": " << tfm::format("%.6g", r.value) << ", \"unit\": \""
+            << r.unit << "\", \"higher_is_better\": "
+            << (r.higher_is_better ? "true" : "false") << " }"
+            << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    oss << "  ]" << std::endl << "}";
+    return oss.str();
+}
+
+/**
+ * Parse the result list of a file written by \ref results_to_json(). This is
+ * not a general JSON parser: it only handles the flat records written above.
+ */
+static std::vector<BenchmarkResult> results_from_json(const std::string &json) {
+    std::vector<BenchmarkResult> results;
+    size_t pos = json.find("\"results\"");
+    if (pos == std::string::npos)
+        Throw("Baseline file does not contain a \"results\" list!");
+
+    while (true) {
+        size_t start = json.find('{', pos), end = json.find('}', start);
+        if (start == std::string::npos || end == std::string::npos)
+            break;
+        std::string record = json.substr(start + 1, end - start - 1);
+        pos = end + 1;
+
+        std::map<std::string, std::string> fields;
+        size_t i = 0;
+        while (true) {
+            size_t k0 = record.find('"', i);
+            if (k0 == std::string::npos)
+                break;
+            size_t k1 = record.find('"', k0 + 1),
+                   colon = record.find(':', k1);
+            if (k1 == std::string::npos || colon == std::string::npos)
+                Throw("Malformed record in baseline file: %s", record);
+            std::string key = record.substr(k0 + 1, k1 - k0 - 1), value;
+            size_t v0 = record.find_first_not_of(" \t\r\n", colon + 1);
+            if (v0 != std::string::npos && record[v0] == '"') {
+                size_t v1 = record.find('"', v0 + 1);
+                value = record.substr(v0 + 1, v1 - v0 - 1);
+                i = v1 + 1;
+            } else {
+                size_t v1 = record.find(',', v0);
+                value = string::trim(record.substr(v0, v1 == std::string::npos ? std::string::npos : v1 - v0));
+                i = v1 == std::string::npos ? record.size() : v1 + 1;
+            }
+            fields[key] = value;
+        }
+
+        BenchmarkResult r;
+        r.variant = fields["variant"];
+        r.name = fields["name"];
+        r.value = std::stod(fields["value"]);
+        r.unit = fields["unit"];
+        r.higher_is_better = fields["higher_is_better"] == "true";
+        results.push_back(r);
+    }
+    return results;
+}
+
+/// Compare against a baseline and return the number of regressions
+static size_t compare_results(const std::vector<BenchmarkResult> &results,
+                              const std::vector<BenchmarkResult> &baseline,
+                              double tolerance) {
+    std::map<std::pair<std::string, std::string>, const BenchmarkResult *> index;
+    for (const auto &r : baseline)
+        index[{ r.variant, r.name }] = &r;
+
+    size_t regressions = 0, compared = 0;
+    std::cout << std::endl << "Comparison against baseline (tolerance: "
+              << tfm::format("%.1f%%", tolerance * 100) << "):" << std::endl;
+    for (const auto &r : results) {
+        auto it = index.find({ r.variant, r.name });
+        if (it == index.end() || it->second->value <= 0 || r.value <= 0)
+            continue;
+        compared++;
+
+        // Speedup relative to the baseline (> 1: faster)
+        double speedup = r.higher_is_better ? r.value / it->second->value
+                                            : it->second->value / r.value;
+        const char *status = "";
+        if (speedup < 1.0 - tolerance) {
+            status = "  REGRESSION";
+            regressions++;
+        } else if (speedup > 1.0 + tolerance) {
+            status = "  improvement";
+        }
+        std::string label = r.variant + " " + r.name;
+        std::cout << "  " << label << std::string(label.size() < 58 ? 58 - label.size() : 1, ' ')
+                  << tfm::format("%+7.1f%%", (speedup - 1.0) * 100.0) << status << std::endl;
+    }
+    std::cout << tfm::format("Compared %i results, found %i regression%s.", compared,
+                             regressions, regressions == 1 ? "" : "s")
+              << std::endl;
+    return regressions;
+}
+
+//! @}
+// =======================================================================
+
+// =======================================================================
+//! @{ \name Procedural scene generation
+// =======================================================================
+
+/// Write a displaced height field with 2*res^2 triangles as a binary PLY file
+static void write_terrain(const fs::path &path, size_t res) {
+    ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
+    fs->set_byte_order(Stream::ELittleEndian);
+    size_t vertex_count = (res + 1) * (res + 1), face_count = 2 * res * res;
+    fs->write_line("ply");
+    fs->write_line("format binary_little_endian 1.0");
+    fs->write_line(tfm::format("element vertex %i", vertex_count));
+    fs->write_line("property float x");
+    fs->write_line("property float y");
+    fs->write_line("property float z");
+    fs->write_line(tfm::format("element face %i", face_count));
+    fs->write_line("property list uchar int vertex_indices");
+    fs->write_line("end_header");
+
+    for (size_t j = 0; j <= res; ++j) {
+        for (size_t i = 0; i <= res; ++i) {
+            float x = 2.f * i / res - 1.f, y = 2.f * j / res - 1.f,
+                  z = .1f * std::sin(17.f * x) * std::cos(13.f * y) +
+                      .03f * std::sin(91.f * x + 37.f * y);
+            fs->write(x);
+            fs->write(y);
+            fs->write(z);
+        }
+    }
+
+    for (size_t j = 0; j < res; ++j) {
+        for (size_t i = 0; i < res; ++i) {
+            int32_t v00 = int32_t(j * (res + 1) + i), v10 = v00 + 1,
+                    v01 = v00 + int32_t(res + 1), v11 = v01 + 1;
+            int32_t faces[2][3] = { { v00, v10, v11 }, { v00, v11, v01 } };
+            for (auto &f : faces) {
+                fs->write((uint8_t) 3);
+                fs->write(f[0]);
+                fs->write(f[1]);
+                fs->write(f[2]);
+            }
+        }
+    }
+    fs->close();
+}
+
+/// Write a procedural RGB texture
+static void write_texture(const fs::path &path, uint32_t res, uint32_t seed) {
+    ref<Bitmap> bitmap = new Bitmap(Bitmap::PixelFormat::RGB, Struct::Type::Float32,
+                                    Vector2u(res, res));
+    float *data = (float *) bitmap->data();
+    for (uint32_t y = 0; y < res; ++y) {
+        for (uint32_t x = 0; x < res; ++x) {
+            float u = float(x) / res, v = float(y) / res;
+            for (uint32_t c = 0; c < 3; ++c)
+                *data++ = .5f + .4f * std::sin((7.f + seed + c) * u * 6.28f) *
+                                      std::cos((5.f + 2 * seed) * v * 6.28f);
+        }
+    }
+    bitmap->write(path);
+}
+
+static std::string scene_sensor(const std::string &origin, const std::string &target,
+                                int size, int spp) {
+    return tfm::format(R"(
+        <sensor type="perspective">
+            <float name="fov" value="45"/>
+            <transform name="to_world">
+                <lookat origin="%s" target="%s" up="0, 0, 1"/>
+            </transform>
+            <film type="hdrfilm">
+                <integer name="width" value="%i"/>
+                <integer name="height" value="%i"/>
+                <rfilter type="box"/>
+            </film>
+            <sampler type="independent">
+                <integer name="sample_count" value="%i"/>
+            </sampler>
+        </sensor>)", origin, target, size, size, spp);
+}
+
+/// Generate the XML description of a benchmark scene
+static std::string scene_xml(const BenchmarkContext &ctx, const std::string &name,
+                             const std::string &integrator) {
+    int size = (int) std::max(16.0, 64 * std::sqrt(ctx.options.scale));
+    std::ostringstream oss;
+    oss << "<scene version=\"2.0.0\">" << std::endl
+        << "    <integrator type=\"" << integrator << "\"/>" << std::endl;
+
+    if (name == "triangles") {
+        oss << scene_sensor("0, -2.5, 1.5", "0, 0, 0", size, 16)
+            << "<emitter type=\"constant\"/>"
+            << "<shape type=\"ply\"><string name=\"filename\" value=\""
+            << (ctx.options.data_dir / "terrain.ply").string() << "\"/>"
+            << "<bsdf type=\"roughconductor\"/></shape>";
+    } else if (name == "lights") {
+        int n = (int) std::max(2.0, 16 * std::sqrt(ctx.options.scale));
+        oss << scene_sensor("0, -3, 2", "0, 0, 0", size, 16)
+            << "<shape type=\"rectangle\"><transform name=\"to_world\">"
+            << "<scale value=\"2\"/></transform><bsdf type=\"diffuse\"/></shape>";
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                oss << tfm::format(
+                    "<shape type=\"sphere\"><point name=\"center\" x=\"%f\" y=\"%f\" z=\"0.5\"/>"
+                    "<float name=\"radius\" value=\"0.02\"/><emitter type=\"area\">"
+                    "<rgb name=\"radiance\" value=\"%f, %f, 1\"/></emitter></shape>",
+                    3.6f * i / (n - 1) - 1.8f, 3.6f * j / (n - 1) - 1.8f,
+                    float(i) / n, float(j) / n);
+            }
+        }
+    } else if (name == "volume") {
+        oss << scene_sensor("0, -4, 0", "0, 0, 0", size, 16)
+            << "<emitter type=\"constant\"/>"
+            << "<shape type=\"sphere\"><bsdf type=\"null\"/>"
+            << "<medium type=\"homogeneous\" name=\"interior\">"
+            << "<rgb name=\"albedo\" value=\"0.9, 0.8, 0.7\"/>"
+            << "<float name=\"sigma_t\" value=\"20\"/></medium></shape>";
+    } else if (name == "textures") {
+        int n = 4;
+        oss << scene_sensor("0, -4, 3", "0, 0, 0", size, 16)
+            << "<emitter type=\"constant\"/>";
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                oss << tfm::format(
+                    "<shape type=\"sphere\"><point name=\"center\" x=\"%f\" y=\"%f\" z=\"0\"/>"
+                    "<float name=\"radius\" value=\"0.4\"/><bsdf type=\"blendbsdf\">"
+                    "<texture type=\"checkerboard\" name=\"weight\">"
+                    "<transform name=\"to_uv\"><scale value=\"8\"/></transform></texture>"
+                    "<bsdf type=\"diffuse\"><texture type=\"bitmap\" name=\"reflectance\">"
+                    "<string name=\"filename\" value=\"%s\"/></texture></bsdf>"
+                    "<bsdf type=\"roughplastic\"><texture type=\"bitmap\" name=\"diffuse_reflectance\">"
+                    "<string name=\"filename\" value=\"%s\"/></texture></bsdf>"
+                    "</bsdf></shape>",
+                    2.f * i - (n - 1), 2.f * j - (n - 1),
+                    (ctx.options.data_dir / tfm::format("texture_%i.exr", (i + j * n) % 8)).string(),
+                    (ctx.options.data_dir / tfm::format("texture_%i.exr", (i + j * n + 3) % 8)).string());
+            }
+        }
+    }
+
+    oss << std::endl << "</scene>";
+    return oss.str();
+}
+
+static void generate_data(const BenchmarkContext &ctx) {
+    fs::path dir = ctx.options.data_dir;
+    if (!fs::exists(dir) && !fs::create_directory(dir))
+        Throw("Could not create the data directory \"%s\"", dir.string());
+
+    size_t res = ctx.scaled(512);
+    fs::path terrain = dir / "terrain.ply";
+    std::string terrain_info = tfm::format("%i", res);
+    fs::path info = dir / "terrain.txt";
+
+    // Regenerate the mesh only when the resolution changed
+    bool regenerate = true;
+    if (fs::exists(terrain) && fs::exists(info)) {
+        std::ifstream is(info.string());
+        std::string line;
+        std::getline(is, line);
+        regenerate = line != terrain_info;
+    }
+    if (regenerate) {
+        std::cout << "Generating a mesh with " << 2 * res * res << " triangles .." << std::endl;
+        write_terrain(terrain, res);
+        std::ofstream os(info.string());
+        os << terrain_info << std::endl;
+    }
+
+    for (uint32_t i = 0; i < 8; ++i) {
+        fs::path path = dir / tfm::format("texture_%i.exr", i);
+        if (!fs::exists(path))
+            write_texture(path, 1024, i);
+    }
+}
+
+//! @}
+// =======================================================================
+
+// =======================================================================
+//! @{ \name Benchmarks
+// =======================================================================
+
+template <typename Mask> size_t mask_count(const Mask &mask) {
+    if constexpr (is_array_v<Mask>)
+        return (size_t) count(mask);
+    else
+        return mask ? 1 : 0;
+}
+
+/**
+ * Evaluate \c func on \c total work items (in packets or a single wavefront,
+ * depending on the variant) and return the number of active result lanes.
+ */
+template <typename Float, typename Func>
+size_t run_wavefront(size_t total, Func func) {
+    using UInt32 = uint32_array_t<Float>;
+    size_t result = 0;
+    if constexpr (is_cuda_array_v<Float>) {
+        result = mask_count(func(arange<UInt32>((uint32_t) total)));
+    } else if constexpr (is_array_v<Float>) {
+        for (size_t i = 0; i < total; i += array_size_v<Float>)
+            result += mask_count(func(arange<UInt32>() + (uint32_t) i));
+    } else {
+        for (size_t i = 0; i < total; ++i)
+            result += mask_count(func((uint32_t) i));
+    }
+    return result;
+}
+
+template <typename Float, typename Spectrum>
+ref<Sampler<Float, Spectrum>> make_sampler(Sampler<Float, Spectrum> *prototype,
+                                           size_t wavefront) {
+    using UInt64 = uint64_array_t<Float>;
+    ref<Sampler<Float, Spectrum>> sampler = prototype->clone();
+    if constexpr (is_cuda_array_v<Float>)
+        sampler->seed(arange<UInt64>(wavefront));
+    else
+        sampler->seed(0);
+    return sampler;
+}
+
+template <typename Float, typename Spectrum>
+void bench_rays(BenchmarkContext &ctx, const std::string &scene_name,
+                Scene<Float, Spectrum> *scene) {
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_OBJECT_TYPES()
+
+    Sensor *sensor = scene->sensors()[0].get();
+    size_t ray_count = ctx.scaled(1 << 20);
+    uint32_t res = (uint32_t) std::sqrt((double) ray_count);
+    ScalarBoundingBox3f bbox = scene->bbox();
+
+    for (int incoherent = 0; incoherent < 2; ++incoherent) {
+        auto make_ray = [&](Sampler *sampler, const UInt32 &index) {
+            if (incoherent) {
+                Point3f o = bbox.min + bbox.extents() * Point3f(sampler->next_1d(),
+                                                               sampler->next_1d(),
+                                                               sampler->next_1d());
+                Vector3f d = warp::square_to_uniform_sphere(sampler->next_2d());
+                return Ray3f(o, d, 0.f, Wavelength(0.f));
+            } else {
+                // Scanline order over a virtual film
+                Point2f pos((Float(index % res) + .5f) / res,
+                            (Float(index / res) + .5f) / res);
+                return sensor->sample_ray(0.f, .5f, pos, Point2f(.5f)).first;
+            }
+        };
+
+        for (int shadow = 0; shadow < 2; ++shadow) {
+            std::string name = tfm::format("rays/%s/%s_%s", scene_name,
+                                           shadow ? "test" : "intersect",
+                                           incoherent ? "incoherent" : "coherent");
+            if (!ctx.enabled(name))
+                continue;
+
+            double t = time_best(ctx.options.repeat, [&]() {
+                ref<Sampler> sampler = make_sampler(sensor->sampler(), ray_count);
+                run_wavefront<Float>(ray_count, [&](const UInt32 &index) {
+                    Ray3f ray = make_ray(sampler, index);
+                    if (shadow)
+                        return scene->ray_test(ray);
+                    else
+                        return scene->ray_intersect(ray).is_valid();
+                });
+            });
+            ctx.add(name, ray_count / t * 1e-6, "Mrays/s", true);
+        }
+    }
+}
+
+template <typename Float, typename Spectrum>
+void bench_kdtree(BenchmarkContext &ctx, const std::string &scene_name,
+                  const Scene<Float, Spectrum> *scene) {
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_OBJECT_TYPES()
+
+    std::string name = "kdtree/" + scene_name;
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(ctx);
+        ENOKI_MARK_USED(scene);
+        return;
+    } else {
+        if (!ctx.enabled(name))
+            return;
+        double t = time_best(ctx.options.repeat, [&]() {
+            ref<ShapeKDTree> kdtree = new ShapeKDTree(Properties());
+            for (auto shape : scene->shapes())
+                kdtree->add_shape(shape.get());
+            kdtree->build();
+        });
+        ctx.add(name, t, "s", false);
+    }
+}
+
+template <typename Float, typename Spectrum>
+void bench_render(BenchmarkContext &ctx, const std::string &scene_name,
+                  const std::string &integrator_name, Object *scene_) {
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_OBJECT_TYPES()
+
+    auto *scene = dynamic_cast<Scene *>(scene_);
+    Sensor *sensor = scene->sensors()[0].get();
+    Integrator *integrator = scene->integrator();
+    ScalarVector2i size = sensor->film()->crop_size();
+    size_t samples = (size_t) hprod(size) * sensor->sampler()->sample_count();
+
+    double t = time_best(ctx.options.repeat, [&]() {
+        if (!integrator->render(scene, sensor))
+            Throw("Rendering failed!");
+    });
+    ctx.add("render/" + scene_name + "/" + integrator_name, samples / t * 1e-6,
+            "Msamples/s", true);
+}
+
+template <typename Float, typename Spectrum>
+void bench_scene(BenchmarkContext &ctx, const std::string &scene_name,
+                 const std::vector<std::string> &integrators) {
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_OBJECT_TYPES()
+
+    for (size_t i = 0; i < integrators.size(); ++i) {
+        std::string xml = scene_xml(ctx, scene_name, integrators[i]);
+
+        ref<Object> scene_obj;
+        if (i == 0) {
+            std::string name = "load/" + scene_name;
+            bool enabled = ctx.enabled(name);
+            /* Loading is timed without the asset cache (assets would
+               otherwise only be decoded during the first iteration) */
+            bool cache_enabled = AssetCache::instance()->enabled();
+            AssetCache::instance()->set_enabled(false);
+            double t = time_best(enabled ? ctx.options.repeat : 1, [&]() {
+                scene_obj = xml::load_string(xml, ctx.variant);
+            });
+            AssetCache::instance()->set_enabled(cache_enabled);
+            if (enabled)
+                ctx.add(name, t, "s", false);
+
+            auto *scene = dynamic_cast<Scene *>(scene_obj.get());
+            bench_kdtree<Float, Spectrum>(ctx, scene_name, scene);
+            if (scene_name == "triangles" || scene_name == "lights")
+                bench_rays<Float, Spectrum>(ctx, scene_name, scene);
+        }
+
+        std::string name = "render/" + scene_name + "/" + integrators[i];
+        if (!ctx.enabled(name))
+            continue;
+        if (!scene_obj)
+            scene_obj = xml::load_string(xml, ctx.variant);
+        bench_render<Float, Spectrum>(ctx, scene_name, integrators[i], scene_obj.get());
+    }
+}
+
+template <typename Float, typename Spectrum>
+void bench_bsdfs(BenchmarkContext &ctx) {
+    MTS_IMPORT_TYPES()
+    MTS_IMPORT_OBJECT_TYPES()
+
+    const char *plugins[] = { "diffuse",    "conductor",       "roughconductor",
+                              "dielectric", "roughdielectric", "thindielectric",
+                              "plastic",    "roughplastic" };
+    size_t eval_count = ctx.scaled(1 << 20);
+
+    ref<Sampler> prototype = dynamic_cast<Sampler *>(
+        xml::load_string("<sampler version=\"2.0.0\" type=\"independent\"/>",
+                         ctx.variant).get());
+
+    for (const char *plugin : plugins) {
+        std::string name_sample = tfm::format("bsdf/%s/sample", plugin),
+                    name_eval   = tfm::format("bsdf/%s/eval", plugin);
+        if (!ctx.enabled(name_sample) && !ctx.enabled(name_eval))
+            continue;
+
+        ref<BSDF> bsdf = dynamic_cast<BSDF *>(
+            xml::load_string(tfm::format("<bsdf version=\"2.0.0\" type=\"%s\"/>", plugin),
+                             ctx.variant).get());
+        BSDFContext bsdf_ctx;
+
+        auto make_si = [&](Sampler *sampler) {
+            SurfaceInteraction3f si;
+            si.t = 0.f;
+            si.time = 0.f;
+            si.p = Point3f(0.f);
+            si.n = Normal3f(0.f, 0.f, 1.f);
+            si.sh_frame = Frame3f(si.n);
+            si.uv = sampler->next_2d();
+            si.wi = warp::square_to_cosine_hemisphere(sampler->next_2d());
+            if constexpr (is_spectral_v<Spectrum>)
+                si.wavelengths = sample_wavelength<Float, Spectrum>(sampler->next_1d()).first;
+            return si;
+        };
+
+        if (ctx.enabled(name_sample)) {
+            double t = time_best(ctx.options.repeat, [&]() {
+                ref<Sampler> sampler = make_sampler(prototype.get(), eval_count);
+                run_wavefront<Float>(eval_count, [&](const UInt32 &) {
+                    SurfaceInteraction3f si = make_si(sampler);
+                    auto [bs, weight] = bsdf->sample(bsdf_ctx, si, sampler->next_1d(),
+                                                     sampler->next_2d());
+                    return bs.pdf > 0.f && neq(hmax(depolarize(weight)), 0.f);
+                });
+            });
+            ctx.add(name_sample, eval_count / t * 1e-6, "Mevals/s", true);
+        }
+
+        if (ctx.enabled(name_eval)) {
+            double t = time_best(ctx.options.repeat, [&]() {
+                ref<Sampler> sampler = make_sampler(prototype.get(), eval_count);
+                run_wavefront<Float>(eval_count, [&](const UInt32 &) {
+                    SurfaceInteraction3f si = make_si(sampler);
+                    Vector3f wo = warp::square_to_cosine_hemisphere(sampler->next_2d());
+                    Spectrum value = bsdf->eval(bsdf_ctx, si, wo);
+                    return neq(hmax(depolarize(value)), 0.f);
+                });
+            });
+            ctx.add(name_eval, eval_count / t * 1e-6, "Mevals/s", true);
+        }
+    }
+}
+
+template <typename Float, typename Spectrum>
+bool bench_variant(BenchmarkContext &ctx) {
+    const std::pair<const char *, std::vector<std::string>> scenes[] = {
+        { "triangles", { "path", "direct" } },
+        { "lights",    { "direct", "path" } },
+        { "volume",    { "volpath", "volpathmis" } },
+        { "textures",  { "path" } }
+    };
+
+    for (const auto &[scene_name, integrators] : scenes) {
+        try {
+            bench_scene<Float, Spectrum>(ctx, scene_name, integrators);
+        } catch (const std::exception &e) {
+            std::cout << "  Skipping scene \"" << scene_name << "\": " << e.what() << std::endl;
+        }
+    }
+
+    try {
+        bench_bsdfs<Float, Spectrum>(ctx);
+    } catch (const std::exception &e) {
+        std::cout << "  Skipping BSDF benchmarks: " << e.what() << std::endl;
+    }
+    return true;
+}
+
+//! @}
+// =======================================================================
+
+/// Forwards warnings and errors to stderr and suppresses progress bars
+class BenchmarkAppender : public Appender {
+public:
+    void append(LogLevel level, const std::string &text) override {
+        if (level >= Warn)
+            std::cerr << text << std::endl;
+    }
+
+    void log_progress(float, const std::string &, const std::string &,
+                      const std::string &, const void *) override { }
+};
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+    AssetCache::static_initialization();
+
+    // Ensure that the mitsuba-render shared library is loaded
+    librender_nop();
+
+    ArgParser parser;
+    using StringVec = std::vector<std::string>;
+    auto arg_help      = parser.add(StringVec{ "-h", "--help" });
+    auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_threads   = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_filter    = parser.add(StringVec{ "-f", "--filter" }, true);
+    auto arg_scale     = parser.add(StringVec{ "-s", "--scale" }, true);
+    auto arg_repeat    = parser.add(StringVec{ "-r", "--repeat" }, true);
+    auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_baseline  = parser.add(StringVec{ "-b", "--baseline" }, true);
+    auto arg_tolerance = parser.add(StringVec{ "-e", "--tolerance" }, true);
+    auto arg_data      = parser.add(StringVec{ "-d", "--data" }, true);
+    int exit_code = 0;
+
+    try {
+        parser.parse(argc, argv);
+
+        if (*arg_help) {
+            help();
+        } else {
+            if (*arg_threads)
+                __global_thread_count = arg_threads->as_int();
+            tbb::task_scheduler_init init((int) __global_thread_count);
+
+            // Append the mitsuba directory to the FileResolver search path list
+            ref<FileResolver> fr = Thread::thread()->file_resolver();
+            fs::path base_path = util::library_path().parent_path();
+            if (!fr->contains(base_path))
+                fr->append(base_path);
+
+            ref<Logger> logger = Thread::thread()->logger();
+            logger->clear_appenders();
+            logger->add_appender(new BenchmarkAppender());
+            logger->set_log_level(Warn);
+
+            BenchmarkContext ctx;
+            ctx.options.data_dir = *arg_data ? fs::path(arg_data->as_string())
+                                             : fs::current_path() / "mtsbench_data";
+            if (*arg_filter)
+                ctx.options.filter = arg_filter->as_string();
+            if (*arg_scale)
+                ctx.options.scale = arg_scale->as_float();
+            if (*arg_repeat)
+                ctx.options.repeat = (size_t) arg_repeat->as_int();
+            double tolerance = *arg_tolerance ? arg_tolerance->as_float() : 0.1;
+
+            std::vector<std::string> variants;
+            for (auto arg = arg_mode; arg && *arg; arg = arg->next()) {
+                if (arg->as_string() == "all") {
+                    for (auto v : string::tokenize(MTS_VARIANTS, "\n "))
+                        variants.push_back(v);
+                } else {
+                    variants.push_back(arg->as_string());
+                }
+            }
+            if (variants.empty())
+                variants.push_back(MTS_DEFAULT_VARIANT);
+
+            std::cout << util::info_build((int) __global_thread_count) << std::endl;
+            generate_data(ctx);
+
+            for (const std::string &variant : variants) {
+                std::cout << std::endl << "Variant \"" << variant << "\":" << std::endl;
+                ctx.variant = variant;
+                MTS_INVOKE_VARIANT(variant, bench_variant, ctx);
+            }
+
+            if (*arg_output) {
+                ref<FileStream> fs = new FileStream(arg_output->as_string(),
+                                                    FileStream::ETruncReadWrite);
+                fs->write_line(results_to_json(ctx.results));
+                fs->close();
+                std::cout << std::endl << "Wrote results to \"" << arg_output->as_string()
+                          << "\"." << std::endl;
+            }
+
+            if (*arg_baseline) {
+                std::ifstream is(arg_baseline->as_string());
+                if (!is.good())
+                    Throw("Could not open the baseline file \"%s\"", arg_baseline->as_string());
+                std::string json((std::istreambuf_iterator<char>(is)),
+                                 std::istreambuf_iterator<char>());
+                if (compare_results(ctx.results, results_from_json(json), tolerance) > 0)
+                    exit_code = 2;
+            }
+        }
+    } catch (const std::exception &e) {
+        std::cerr << std::endl << "Caught a critical exception: " << e.what() << std::endl;
+        exit_code = 1;
+    }
+
+    AssetCache::static_shutdown();
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+
+    return exit_code;
+}
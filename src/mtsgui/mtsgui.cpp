@@ -3,6 +3,7 @@
 
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/jit.h>
@@ -63,6 +64,7 @@ int main(int argc, char *argv[]) {
     Thread::static_initialization();
     Logger::static_initialization();
     Bitmap::static_initialization();
+    AssetCache::static_initialization();
 
     librender_nop();
 
@@ -196,6 +198,7 @@ int main(int argc, char *argv[]) {
     }
 
     Profiler::static_shutdown();
+    AssetCache::static_shutdown();
     Bitmap::static_shutdown();
     Logger::static_shutdown();
     Thread::static_shutdown();
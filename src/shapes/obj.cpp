@@ -78,7 +78,7 @@ public:
                     m_texcoord_offset, m_color_offset, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_struct, m_face_struct, m_disable_vertex_normals,
                     recompute_vertex_normals, is_emitter, emitter, sensor, is_sensor,
-                    has_vertex_normals, vertex)
+                    has_vertex_normals, vertex, load_cached, store_cached)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -114,6 +114,16 @@ public:
         if (!fs::exists(file_path))
             fail("file not found");
 
+        /* Reuse a previously decoded copy of this file, if available */
+        std::string cache_key = tfm::format("obj:flip_tex_coords=%i", flip_tex_coords);
+        if (load_cached(file_path, cache_key)) {
+            if (is_emitter())
+                emitter()->set_shape(this);
+            if (is_sensor())
+                sensor()->set_shape(this);
+            return;
+        }
+
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
 
         using ScalarIndex3 = std::array<ScalarIndex, 3>;
@@ -343,6 +353,8 @@ public:
         if (!m_disable_vertex_normals && normals.empty())
             recompute_vertex_normals();
 
+        store_cached(file_path, cache_key);
+
         if (is_emitter())
             emitter()->set_shape(this);
         if (is_sensor())
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mstream.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/struct.h>
+#include <enoki/half.h>
+#include <unordered_map>
+#include <fstream>
+#include <sstream>
+
+/// @file Parser for the header and ASCII data of PLY files, shared by the PLY-based shapes.
+
+NAMESPACE_BEGIN(mitsuba)
+
+struct PLYElement {
+    std::string name;
+    size_t count;
+    ref<Struct> struct_;
+};
+
+struct PLYHeader {
+    bool ascii = false;
+    std::vector<std::string> comments;
+    std::vector<PLYElement> elements;
+};
+
+/// Parse the header of a PLY file, leaving \c stream at the start of the data
+inline PLYHeader parse_ply_header(Stream *stream) {
+    Struct::ByteOrder byte_order = Struct::host_byte_order();
+    bool ply_tag_seen = false;
+    bool header_processed = false;
+    PLYHeader header;
+
+    std::unordered_map<std::string, Struct::Type> fmt_map;
+    fmt_map["char"]   = Struct::Type::Int8;
+    fmt_map["uchar"]  = Struct::Type::UInt8;
+    fmt_map["short"]  = Struct::Type::Int16;
+    fmt_map["ushort"] = Struct::Type::UInt16;
+    fmt_map["int"]    = Struct::Type::Int32;
+    fmt_map["uint"]   = Struct::Type::UInt32;
+    fmt_map["float"]  = Struct::Type::Float32;
+    fmt_map["double"] = Struct::Type::Float64;
+
+    /* Unofficial extensions :) */
+    fmt_map["uint8"]   = Struct::Type::UInt8;
+    fmt_map["uint16"]  = Struct::Type::UInt16;
+    fmt_map["uint32"]  = Struct::Type::UInt32;
+    fmt_map["int8"]    = Struct::Type::Int8;
+    fmt_map["int16"]   = Struct::Type::Int16;
+    fmt_map["int32"]   = Struct::Type::Int32;
+    fmt_map["long"]    = Struct::Type::Int64;
+    fmt_map["ulong"]   = Struct::Type::UInt64;
+    fmt_map["half"]    = Struct::Type::Float16;
+    fmt_map["float16"] = Struct::Type::Float16;
+    fmt_map["float32"] = Struct::Type::Float32;
+    fmt_map["float64"] = Struct::Type::Float64;
+
+    ref<Struct> struct_;
+
+    while (true) {
+        std::string line = stream->read_line();
+        std::istringstream iss(line);
+        std::string token;
+        if (!(iss >> token))
+            continue;
+
+        if (token == "comment") {
+            std::getline(iss, line);
+            header.comments.push_back(string::trim(line));
+            continue;
+        } else if (token == "ply") {
+            if (ply_tag_seen)
+                Throw("invalid PLY header: duplicate \"ply\" tag");
+            ply_tag_seen = true;
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"ply\"");
+        } else if (token == "format") {
+            if (!ply_tag_seen)
+                Throw("invalid PLY header: \"format\" before \"ply\" tag");
+            if (header_processed)
+                Throw("invalid PLY header: duplicate \"format\" tag");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"format\"");
+            if (token == "ascii")
+                header.ascii = true;
+            else if (token == "binary_little_endian")
+                byte_order = Struct::ByteOrder::LittleEndian;
+            else if (token == "binary_big_endian")
+                byte_order = Struct::ByteOrder::BigEndian;
+            else
+                Throw("invalid PLY header: invalid token after \"format\"");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing version number after \"format\"");
+            if (token != "1.0")
+                Throw("PLY file has unknown version number \"%s\"", token);
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"format\"");
+            header_processed = true;
+        } else if (token == "element") {
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"element\"");
+            header.elements.emplace_back();
+            auto &element = header.elements.back();
+            element.name = token;
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"element\"");
+            element.count = (size_t) stoull(token);
+            struct_ = element.struct_ = new Struct(true, byte_order);
+        } else if (token == "property") {
+            if (!header_processed)
+                Throw("invalid PLY header: encountered \"property\" before \"format\"");
+            if (header.elements.empty())
+                Throw("invalid PLY header: encountered \"property\" before \"element\"");
+            if (!(iss >> token))
+                Throw("invalid PLY header: missing token after \"property\"");
+
+            if (token == "list") {
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+                auto it1 = fmt_map.find(token);
+                if (it1 == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+                auto it2 = fmt_map.find(token);
+                if (it2 == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property list\"");
+
+                struct_->append(token + ".count", it1->second, +Struct::Flags::Assert, 3);
+                for (int i = 0; i<3; ++i)
+                    struct_->append(tfm::format("i%i", i), it2->second);
+            } else {
+                auto it = fmt_map.find(token);
+                if (it == fmt_map.end())
+                    Throw("invalid PLY header: unknown format type \"%s\"", token);
+                if (!(iss >> token))
+                    Throw("invalid PLY header: missing token after \"property\"");
+                uint32_t flags = +Struct::Flags::None;
+                if (it->second >= Struct::Type::Int8 &&
+                    it->second <= Struct::Type::UInt64)
+                    flags = Struct::Flags::Normalized | Struct::Flags::Gamma;
+                struct_->append(token, it->second, flags);
+            }
+
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"property\"");
+        } else if (token == "end_header") {
+            if (iss >> token)
+                Throw("invalid PLY header: excess tokens after \"end_header\"");
+            break;
+        } else {
+            Throw("invalid PLY header: unknown token \"%s\"", token);
+        }
+    }
+    if (!header_processed)
+        Throw("invalid PLY file: no header information");
+    return header;
+}
+
+/// Convert the elements of an ASCII PLY file into a binary memory stream
+inline ref<Stream> parse_ascii(FileStream *in, const std::vector<PLYElement> &elements) {
+    ref<Stream> out = new MemoryStream();
+    std::fstream &is = *in->native();
+    for (auto const &el : elements) {
+        for (size_t i = 0; i < el.count; ++i) {
+            for (auto const &field : *(el.struct_)) {
+                switch (field.type) {
+                    case Struct::Type::Int8: {
+                            int value;
+                            if (!(is >> value)) Throw("Could not parse \"char\" value for field %s", field.name);
+                            if (value < -128 || value > 127)
+                                Throw("Could not parse \"char\" value for field %s", field.name);
+                            out->write((int8_t) value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt8: {
+                            int value;
+                            if (!(is >> value))
+                                Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
+                            if (value < 0 || value > 255)
+                                Throw("Could not parse \"uchar\" value for field %s (may be due to non-triangular faces)", field.name);
+                            out->write((uint8_t) value);
+                        }
+                        break;
+
+                    case Struct::Type::Int16: {
+                            int16_t value;
+                            if (!(is >> value)) Throw("Could not parse \"short\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt16: {
+                            uint16_t value;
+                            if (!(is >> value)) Throw("Could not parse \"ushort\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Int32: {
+                            int32_t value;
+                            if (!(is >> value)) Throw("Could not parse \"int\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt32: {
+                            uint32_t value;
+                            if (!(is >> value)) Throw("Could not parse \"uint\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Int64: {
+                            int64_t value;
+                            if (!(is >> value)) Throw("Could not parse \"long\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::UInt64: {
+                            uint64_t value;
+                            if (!(is >> value)) Throw("Could not parse \"ulong\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Float16: {
+                            float value;
+                            if (!(is >> value)) Throw("Could not parse \"half\" value for field %s", field.name);
+                            out->write(enoki::half::float32_to_float16(value));
+                        }
+                        break;
+
+                    case Struct::Type::Float32: {
+                            float value;
+                            if (!(is >> value)) Throw("Could not parse \"float\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    case Struct::Type::Float64: {
+                            double value;
+                            if (!(is >> value)) Throw("Could not parse \"double\" value for field %s", field.name);
+                            out->write(value);
+                        }
+                        break;
+
+                    default:
+                        Throw("internal error");
+                }
+            }
+        }
+    }
+    std::string token;
+    if (is >> token)
+        Throw("Trailing tokens after end of PLY file");
+    out->seek(0);
+    return out;
+}
+
+NAMESPACE_END(mitsuba)
@@ -148,7 +148,7 @@ public:
                     m_face_count, m_vertex_struct, m_face_struct, m_disable_vertex_normals,
                     recompute_vertex_normals, is_emitter, emitter, is_sensor, sensor, 
                     vertex, has_vertex_normals, has_vertex_texcoords, vertex_texcoord, 
-                    vertex_normal, vertex_position)
+                    vertex_normal, vertex_position, load_cached, store_cached)
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -196,6 +196,16 @@ public:
 
         m_name = tfm::format("%s@%i", file_path.filename(), shape_index);
 
+        /* Reuse a previously decoded copy of this mesh, if available */
+        std::string cache_key = tfm::format("serialized:shape_index=%i", shape_index);
+        if (load_cached(file_path, cache_key)) {
+            if (is_emitter())
+                emitter()->set_shape(this);
+            if (is_sensor())
+                sensor()->set_shape(this);
+            return;
+        }
+
         ref<Stream> stream = new FileStream(file_path);
         Timer timer;
         stream->set_byte_order(Stream::ELittleEndian);
@@ -346,6 +356,8 @@ public:
         if (!m_disable_vertex_normals && !has_flag(flags, TriMeshFlags::HasNormals))
             recompute_vertex_normals();
 
+        store_cached(file_path, cache_key);
+
         if (is_emitter())
             emitter()->set_shape(this);
         if (is_sensor())
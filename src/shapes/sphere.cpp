@@ -98,6 +98,7 @@ public:
     MTS_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
 
     Sphere(const Properties &props) : Base(props) {
         m_object_to_world =
@@ -327,6 +328,10 @@ public:
         return solution_found && !out_bounds && !in_bounds && active;
     }
 
+    ScalarBoundingSphere3f primitive_sphere(ScalarIndex /*index*/) const override {
+        return ScalarBoundingSphere3f(m_center, m_radius);
+    }
+
     void fill_surface_interaction(const Ray3f &ray, const Float * /*cache*/,
                                   SurfaceInteraction3f &si_out, Mask active) const override {
         MTS_MASK_ARGUMENT(active);
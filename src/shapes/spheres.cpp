@@ -0,0 +1,437 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/shape.h>
+
+#include "ply.h"
+
+#if defined(MTS_ENABLE_EMBREE)
+    #include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-spheres:
+
+Sphere set / particles (:monosp:`spheres`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Filename of a PLY point cloud that specifies the sphere centers
+ * - radius
+   - |float|
+   - Radius of the spheres in object-space units, used when the file does not
+     specify a per-point radius (Default: 1)
+ * - flip_normals
+   - |bool|
+   - Should the normal vectors be flipped, i.e. point inside the spheres? (Default: |false|)
+ * - to_world
+   - |transform|
+   -  Specifies an optional linear object-to-world transformation.
+      Note that non-uniform scales and shear are not permitted!
+      (Default: none, i.e. object space = world space)
+
+This shape plugin describes a large set of spheres (e.g. the particles of a
+simulation) as a single shape. Each sphere is a primitive with its own bounding
+box, hence the spheres are distributed over the leaves of the scene's kd-tree
+instead of being intersected one shape at a time. The centers and radii are
+stored as a structure of arrays, and scalar variants intersect the spheres of
+a kd-tree leaf in SIMD-sized blocks.
+
+The spheres are loaded from the :monosp:`vertex` element of a PLY file (ASCII
+or binary), which must provide the :monosp:`x`, :monosp:`y`, and :monosp:`z`
+properties. When it also provides a :monosp:`radius` property, it specifies the
+radius of each sphere in object-space units. All other elements and properties
+(e.g. faces) are ignored.
+
+.. code-block:: xml
+
+    <shape type="spheres">
+        <string name="filename" value="particles.ply"/>
+        <float name="radius" value="0.01"/>
+        <bsdf type="diffuse"/>
+    </shape>
+
+The texture coordinates of each sphere follow the parameterization of the
+:ref:`sphere <shape-sphere>` plugin, with the poles along the world-space Z axis.
+
+.. warning:: This plugin is currently not supported by the OptiX raytracing backend.
+
+ */
+
+template <typename Float, typename Spectrum>
+class Spheres final : public Shape<Float, Spectrum> {
+public:
+    MTS_IMPORT_BASE(Shape, emitter, is_emitter, sensor, is_sensor)
+    MTS_IMPORT_TYPES()
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using FloatStorage = DynamicBuffer<Float>;
+    using UInt32 = uint32_array_t<Float>;
+
+    Spheres(const Properties &props) : Base(props) {
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        auto fail = [&](const char *descr) {
+            Throw("Error while loading PLY point cloud \"%s\": %s!", m_name, descr);
+        };
+
+        Log(Debug, "Loading spheres from \"%s\" ..", m_name);
+        if (!fs::exists(file_path))
+            fail("file not found");
+
+        ScalarTransform4f to_world = props.transform("to_world", ScalarTransform4f());
+        ScalarVector3f axis_x = to_world * ScalarVector3f(1.f, 0.f, 0.f),
+                       axis_y = to_world * ScalarVector3f(0.f, 1.f, 0.f),
+                       axis_z = to_world * ScalarVector3f(0.f, 0.f, 1.f);
+        ScalarFloat scale = norm(axis_x);
+
+        // The radii are scaled by a single factor, which requires a similarity transform
+        ScalarFloat eps = math::RayEpsilon<ScalarFloat>;
+        if (!(scale > 0.f) ||
+            std::abs(norm(axis_y) - scale) > eps * scale ||
+            std::abs(norm(axis_z) - scale) > eps * scale)
+            Log(Error, "\"%s\": the `to_world` transformation contains a "
+                "non-uniform scale, which is not supported by the Spheres shape.", m_name);
+        if (std::abs(dot(axis_x, axis_y)) > eps * sqr(scale) ||
+            std::abs(dot(axis_x, axis_z)) > eps * sqr(scale) ||
+            std::abs(dot(axis_y, axis_z)) > eps * sqr(scale))
+            Log(Error, "\"%s\": the `to_world` transformation contains shear, "
+                "which is not supported by the Spheres shape.", m_name);
+        ScalarFloat default_radius = props.float_("radius", 1.f);
+        m_flip_normals = props.bool_("flip_normals", false);
+
+        ref<Stream> stream = new FileStream(file_path);
+        Timer timer;
+
+        PLYHeader header;
+        try {
+            header = parse_ply_header(stream);
+            if (header.ascii) {
+                if (stream->size() > 100 * 1024)
+                    Log(Warn,
+                        "\"%s\": performance warning -- this file uses the ASCII PLY format, which "
+                        "is slow to parse. Consider converting it to the binary PLY format.",
+                        m_name);
+                stream = parse_ascii((FileStream *) stream.get(), header.elements);
+            }
+        } catch (const std::exception &e) {
+            fail(e.what());
+        }
+
+        bool has_vertices = false;
+        for (auto &el : header.elements) {
+            size_t i_struct_size = el.struct_->size();
+            if (el.name != "vertex" || has_vertices) {
+                stream->seek(stream->tell() + el.count * i_struct_size);
+                continue;
+            }
+
+            if (el.count == 0)
+                fail("point cloud is empty");
+
+            ref<Struct> sphere_struct = new Struct();
+            for (auto name : { "x", "y", "z" })
+                sphere_struct->append(name, struct_type_v<ScalarFloat>);
+            sphere_struct->append("radius", struct_type_v<ScalarFloat>,
+                                  +Struct::Flags::Default, default_radius);
+
+            ref<StructConverter> conv;
+            try {
+                conv = new StructConverter(el.struct_, sphere_struct);
+            } catch (const std::exception &e) {
+                fail(e.what());
+            }
+
+            std::unique_ptr<uint8_t[]> buf(new uint8_t[el.count * i_struct_size]);
+            std::unique_ptr<ScalarFloat[]> data(new ScalarFloat[el.count * 4]);
+            stream->read(buf.get(), el.count * i_struct_size);
+            if (unlikely(!conv->convert(el.count, buf.get(), data.get())))
+                fail("incompatible contents -- is this a point cloud?");
+
+            m_sphere_count = (ScalarSize) el.count;
+            for (auto *buffer : { &m_center_x, &m_center_y, &m_center_z, &m_radius }) {
+                *buffer = empty<FloatStorage>(m_sphere_count);
+                buffer->managed();
+            }
+            std::unique_ptr<ScalarFloat[]> area(new ScalarFloat[m_sphere_count]);
+
+            for (ScalarSize i = 0; i < m_sphere_count; ++i) {
+                ScalarPoint3f p = load_unaligned<ScalarPoint3f>(data.get() + 4 * i);
+                ScalarFloat r = data[4 * i + 3] * scale;
+                p = to_world.transform_affine(p);
+
+                if (unlikely(!all(enoki::isfinite(p)) || !(r > 0.f)))
+                    fail("point cloud contains invalid positions or radii");
+
+                m_center_x.data()[i] = p.x();
+                m_center_y.data()[i] = p.y();
+                m_center_z.data()[i] = p.z();
+                m_radius.data()[i]   = r;
+                area[i] = 4.f * math::Pi<ScalarFloat> * sqr(r);
+
+                m_bbox.expand(p - r);
+                m_bbox.expand(p + r);
+            }
+
+            m_area_distr = DiscreteDistribution<Float>(area.get(), m_sphere_count);
+            has_vertices = true;
+        }
+
+        if (!has_vertices)
+            fail("no \"vertex\" element found");
+
+        if (stream->tell() != stream->size())
+            fail("invalid file -- trailing content");
+
+        m_surface_area = m_area_distr.sum();
+        m_inv_surface_area = 1.f / m_surface_area;
+
+        Log(Debug, "\"%s\": read %i spheres (%s in %s)", m_name, m_sphere_count,
+            util::mem_string(m_sphere_count * 5 * sizeof(ScalarFloat)),
+            util::time_string(timer.value()));
+
+        if (is_emitter())
+            emitter()->set_shape(this);
+        if (is_sensor())
+            sensor()->set_shape(this);
+    }
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    std::pair<Mask, Float> ray_intersect_primitive(ScalarIndex index, const Ray3f &ray,
+                                                   Float * /*cache*/,
+                                                   Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        using Float64 = float64_array_t<Float>;
+
+        Float64 mint = Float64(ray.mint);
+        Float64 maxt = Float64(ray.maxt);
+
+        Vector3d o = Vector3d(ray.o) - Vector3d(center(index));
+        Vector3d d(ray.d);
+
+        Float64 A = squared_norm(d);
+        Float64 B = 2.0 * dot(o, d);
+        Float64 C = squared_norm(o) - sqr((double) radius(index));
+
+        auto [solution_found, near_t, far_t] = math::solve_quadratic(A, B, C);
+
+        // Sphere doesn't intersect with the segment on the ray
+        Mask out_bounds = !(near_t <= maxt && far_t >= mint); // NaN-aware conditionals
+
+        // Sphere fully contains the segment of the ray
+        Mask in_bounds = near_t < mint && far_t > maxt;
+
+        Mask valid_intersection =
+            active && solution_found && !out_bounds && !in_bounds;
+
+        return { valid_intersection, select(near_t < mint, far_t, near_t) };
+    }
+
+    Mask ray_test_primitive(ScalarIndex index, const Ray3f &ray, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return ray_intersect_primitive(index, ray, nullptr, active).first;
+    }
+
+    ScalarBoundingSphere3f primitive_sphere(ScalarIndex index) const override {
+        return ScalarBoundingSphere3f(center(index), radius(index));
+    }
+
+    void fill_surface_interaction(const Ray3f &ray, const Float * /*cache*/,
+                                  SurfaceInteraction3f &si_out, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        SurfaceInteraction3f si(si_out);
+
+        // The sphere is identified by the primitive index set by the caller
+        UInt32 index = si.prim_index;
+        Point3f c(gather<Float>(m_center_x, index, active),
+                  gather<Float>(m_center_y, index, active),
+                  gather<Float>(m_center_z, index, active));
+        Float r = gather<Float>(m_radius, index, active);
+
+        si.sh_frame.n = normalize(ray(si.t) - c);
+
+        // Re-project onto the sphere to improve accuracy
+        si.p = fmadd(si.sh_frame.n, r, c);
+
+        Vector3f local = si.p - c,
+                 d     = si.sh_frame.n;
+
+        Float rd_2  = sqr(d.x()) + sqr(d.y()),
+              theta = unit_angle_z(d),
+              phi   = atan2(d.y(), d.x());
+
+        masked(phi, phi < 0.f) += 2.f * math::Pi<Float>;
+
+        si.uv = Point2f(phi * math::InvTwoPi<Float>, theta * math::InvPi<Float>);
+        si.dp_du = Vector3f(-local.y(), local.x(), 0.f);
+
+        Float rd      = sqrt(rd_2),
+              inv_rd  = rcp(rd),
+              cos_phi = d.x() * inv_rd,
+              sin_phi = d.y() * inv_rd;
+
+        si.dp_dv = Vector3f(local.z() * cos_phi,
+                            local.z() * sin_phi,
+                            -rd * r);
+
+        Mask singularity_mask = active && eq(rd, 0.f);
+        if (unlikely(any(singularity_mask)))
+            si.dp_dv[singularity_mask] = Vector3f(r, 0.f, 0.f);
+
+        si.dp_du *= 2.f * math::Pi<Float>;
+        si.dp_dv *= math::Pi<Float>;
+
+        if (m_flip_normals)
+            si.sh_frame.n = -si.sh_frame.n;
+
+        si.n = si.sh_frame.n;
+        si.time = ray.time;
+
+        si_out[active] = si;
+    }
+
+    std::pair<Vector3f, Vector3f> normal_derivative(const SurfaceInteraction3f &si,
+                                                    bool /*shading_frame*/,
+                                                    Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        Float inv_radius = (m_flip_normals ? -1.f : 1.f) /
+                           gather<Float>(m_radius, UInt32(si.prim_index), active);
+        return { si.dp_du * inv_radius, si.dp_dv * inv_radius };
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Sampling routines
+    // =============================================================
+
+    PositionSample3f sample_position(Float time, const Point2f &sample,
+                                     Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+
+        // Pick a sphere proportionally to its area, then a point on it
+        auto [index, sample_x] = m_area_distr.sample_reuse(sample.x(), active);
+
+        Point3f c(gather<Float>(m_center_x, index, active),
+                  gather<Float>(m_center_y, index, active),
+                  gather<Float>(m_center_z, index, active));
+        Float r = gather<Float>(m_radius, index, active);
+
+        Point3f p = warp::square_to_uniform_sphere(Point2f(sample_x, sample.y()));
+
+        PositionSample3f ps;
+        ps.p = fmadd(p, r, c);
+        ps.n = p;
+
+        if (m_flip_normals)
+            ps.n = -ps.n;
+
+        ps.time = time;
+        ps.delta = false;
+        ps.pdf = m_inv_surface_area;
+
+        return ps;
+    }
+
+    Float pdf_position(const PositionSample3f & /*ps*/, Mask active) const override {
+        MTS_MASK_ARGUMENT(active);
+        return m_inv_surface_area;
+    }
+
+    //! @}
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarBoundingBox3f bbox(ScalarIndex index) const override {
+        ScalarPoint3f c = center(index);
+        ScalarFloat r = radius(index);
+        return ScalarBoundingBox3f(c - r, c + r);
+    }
+
+    ScalarFloat surface_area() const override { return m_surface_area; }
+
+    ScalarSize primitive_count() const override { return m_sphere_count; }
+
+    ScalarSize effective_primitive_count() const override { return m_sphere_count; }
+
+#if defined(MTS_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) const override {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_SPHERE_POINT);
+        float *buffer = (float *) rtcSetNewGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0,
+                                                          RTC_FORMAT_FLOAT4, 4 * sizeof(float),
+                                                          m_sphere_count);
+        for (ScalarSize i = 0; i < m_sphere_count; ++i) {
+            ScalarPoint3f c = center(i);
+            buffer[4 * i + 0] = (float) c.x();
+            buffer[4 * i + 1] = (float) c.y();
+            buffer[4 * i + 2] = (float) c.z();
+            buffer[4 * i + 3] = (float) radius(i);
+        }
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Spheres[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  sphere_count = " << m_sphere_count << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  surface_area = " << m_surface_area << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MTS_DECLARE_CLASS()
+private:
+    ScalarPoint3f center(ScalarIndex index) const {
+        return ScalarPoint3f(m_center_x.data()[index], m_center_y.data()[index],
+                             m_center_z.data()[index]);
+    }
+
+    ScalarFloat radius(ScalarIndex index) const { return m_radius.data()[index]; }
+
+private:
+    std::string m_name;
+    ScalarSize m_sphere_count = 0;
+    FloatStorage m_center_x, m_center_y, m_center_z;
+    FloatStorage m_radius;
+    DiscreteDistribution<Float> m_area_distr;
+    ScalarBoundingBox3f m_bbox;
+    ScalarFloat m_surface_area;
+    ScalarFloat m_inv_surface_area;
+    bool m_flip_normals;
+};
+
+MTS_IMPLEMENT_CLASS_VARIANT(Spheres, Shape)
+MTS_EXPORT_PLUGIN(Spheres, "Sphere set / particles");
+NAMESPACE_END(mitsuba)
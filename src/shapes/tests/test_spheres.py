@@ -0,0 +1,153 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+from enoki.dynamic import Float32 as Float
+
+
+def write_point_cloud(path, points, radius=None):
+    """Write an ASCII PLY point cloud with optional per-point radii."""
+    with open(path, 'w') as f:
+        f.write("ply\nformat ascii 1.0\n")
+        f.write("element vertex {}\n".format(len(points)))
+        f.write("property float x\nproperty float y\nproperty float z\n")
+        if radius is not None:
+            f.write("property float radius\n")
+        f.write("end_header\n")
+        for i, p in enumerate(points):
+            values = list(p) + ([radius[i]] if radius is not None else [])
+            f.write(" ".join(str(v) for v in values) + "\n")
+    return str(path)
+
+
+def example_scene(filename, extra=""):
+    from mitsuba.core.xml import load_string
+
+    return load_string("""<scene version='2.0.0'>
+        {}
+        <shape type='spheres'>
+            <string name="filename" value="{}"/>
+            <float name="radius" value="0.25"/>
+        </shape>
+    </scene>""".format(extra, filename))
+
+
+def test01_create(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+
+    points = [[0, 0, 0], [1, 0, 0], [0, 2, 1]]
+    filename = write_point_cloud(tmpdir.join("spheres.ply"), points, [0.5, 0.25, 1])
+    s = load_string("""<shape version='2.0.0' type='spheres'>
+        <string name="filename" value="{}"/>
+        <transform name="to_world">
+            <scale value="2"/>
+        </transform>
+    </shape>""".format(filename))
+
+    assert s.primitive_count() == 3
+    assert ek.allclose(s.surface_area(), 4 * ek.pi * 4 * (0.25 + 0.0625 + 1))
+
+    b = s.bbox()
+    assert ek.allclose(b.min, [-2, -1, -1])
+    assert ek.allclose(b.max, [2.5, 6, 4])
+
+    sphere = s.primitive_sphere(2)
+    assert ek.allclose(sphere.center, [0, 4, 2])
+    assert ek.allclose(sphere.radius, 2)
+    assert ek.allclose(s.bbox(1).min, [1.5, -0.5, -0.5])
+
+    # Non-uniform scales and shear are rejected
+    for transform in ['<scale x="1" y="2" z="1"/>',
+                      '<matrix value="1 0.6 0 0 0 0.8 0 0 0 0 1 0 0 0 0 1"/>']:
+        with pytest.raises(RuntimeError):
+            load_string("""<shape version='2.0.0' type='spheres'>
+                <string name="filename" value="{}"/>
+                <transform name="to_world">
+                    {}
+                </transform>
+            </shape>""".format(filename, transform))
+
+    # Rotations are fine
+    load_string("""<shape version='2.0.0' type='spheres'>
+        <string name="filename" value="{}"/>
+        <transform name="to_world">
+            <rotate x="1" y="1" angle="37"/>
+            <scale value="3"/>
+        </transform>
+    </shape>""".format(filename))
+
+    # Missing files are rejected
+    with pytest.raises(RuntimeError):
+        load_string("""<shape version='2.0.0' type='spheres'>
+            <string name="filename" value="{}"/>
+        </shape>""".format(tmpdir.join("missing.ply")))
+
+
+@pytest.mark.parametrize("sphere_blocks", [True, False])
+def test02_ray_intersect(variant_scalar_rgb, tmpdir, sphere_blocks):
+    from mitsuba.core import Ray3f, Vector3f
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Many small spheres, several of which end up in the same kd-tree leaves
+    rng = np.random.RandomState(0)
+    points = rng.uniform(-1, 1, (200, 3))
+    filename = write_point_cloud(tmpdir.join("spheres.ply"), points)
+    scene = example_scene(filename, """<boolean name="kd_sphere_blocks" value="{}"/>""".format(
+        "true" if sphere_blocks else "false"))
+
+    n = 32
+    for x in range(n):
+        for y in range(n):
+            o = [2 * x / (n - 1) - 1, 2 * y / (n - 1) - 1, -3]
+            r = Ray3f(o, [0.05, -0.02, 1], 0.5, [])
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+
+            assert ek.all(res_shadow == res_naive.is_valid())
+            assert res.is_valid() == res_naive.is_valid()
+            if not res.is_valid():
+                continue
+
+            assert ek.allclose(res.t, res_naive.t, rtol=1e-5)
+            assert res.prim_index == res_naive.prim_index
+
+            # The hit point lies on the sphere and the normal points away from its center
+            c = Vector3f(points[res.prim_index])
+            assert ek.allclose(ek.norm(res.p - c), 0.25, atol=1e-5)
+            assert ek.allclose(res.n, (res.p - c) / 0.25, atol=1e-4)
+
+    # Rays starting inside a sphere hit its far side (or another sphere before)
+    r = Ray3f(Vector3f(points[0]), [0, 0, 1], 0.5, [])
+    res = scene.ray_intersect(r)
+    assert res.is_valid() and res.t <= 0.25 + 1e-5
+
+
+def test03_sample_position(variant_scalar_rgb, tmpdir):
+    from mitsuba.core import Vector3f
+    from mitsuba.core.xml import load_string
+
+    points = [[0, 0, 0], [3, 0, 0]]
+    filename = write_point_cloud(tmpdir.join("spheres.ply"), points, [1, 2])
+    s = load_string("""<shape version='2.0.0' type='spheres'>
+        <string name="filename" value="{}"/>
+    </shape>""".format(filename))
+
+    # Spheres are chosen proportionally to their area
+    count = [0, 0]
+    for xi_1 in ek.linspace(Float, 0.01, 0.99, 50):
+        for xi_2 in ek.linspace(Float, 0.01, 0.99, 4):
+            ps = s.sample_position(0, [xi_1, xi_2])
+            i = 0 if ek.norm(ps.p) < 1.5 else 1
+            c, r = Vector3f(points[i]), [1, 2][i]
+            assert ek.allclose(ek.norm(ps.p - c), r, atol=1e-5)
+            assert ek.allclose(ps.n, (ps.p - c) / r, atol=1e-5)
+            assert ek.allclose(ps.pdf, 1 / s.surface_area())
+            count[i] += 1
+
+    assert ek.allclose(count[1] / (count[0] + count[1]), 0.8, atol=0.05)
@@ -1,4 +1,5 @@
 #include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
@@ -64,13 +65,67 @@ public:
         FileResolver* fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
+
+        /* Should Mitsuba disable transformations to the stored color data? (e.g.
+           sRGB to linear, spectral upsampling, etc.) */
+        m_raw = props.bool_("raw", false);
+
+        /* The converted bitmap only depends on the file, the variant and the
+           'raw' flag. Share it with other instances via the asset cache. */
+        std::string key = tfm::format("bitmap_texture:%s:raw=%i",
+                                      detail::get_variant<Float, Spectrum>(), m_raw);
+        auto load = [&](size_t &size) -> ref<Object> {
+            ref<Bitmap> bitmap = load_bitmap(file_path);
+            size = bitmap->buffer_size();
+            return bitmap.get();
+        };
+
+        AssetCache *cache = AssetCache::instance();
+        if (cache) {
+            m_bitmap = cache->get<Bitmap>(file_path, key, load);
+        } else {
+            size_t size;
+            m_bitmap = static_cast<Bitmap *>(load(size).get());
+        }
+
+        const ScalarFloat *ptr = (const ScalarFloat *) m_bitmap->data();
+
+        double mean = 0.0;
+        if (m_bitmap->channel_count() == 3) {
+            if (is_spectral_v<Spectrum> && !m_raw) {
+                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
+                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+                    mean += (double) srgb_model_mean(value);
+                    ptr += 3;
+                }
+            } else {
+                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
+                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+                    mean += (double) luminance(value);
+                    ptr += 3;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < m_bitmap->pixel_count(); ++i)
+                mean += (double) ptr[i];
+        }
+
+        m_mean = ScalarFloat(mean / m_bitmap->pixel_count());
+    }
+
+    /**
+     * Load a bitmap from disk and convert it into the working floating
+     * point representation. In spectral modes, RGB data is additionally
+     * converted into coefficients of the spectral upsampling model.
+     */
+    ref<Bitmap> load_bitmap(const fs::path &file_path) const {
         Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
 
-        m_bitmap = new Bitmap(file_path);
+        ref<Bitmap> bitmap = new Bitmap(file_path);
 
         /* Convert to linear RGB float bitmap, will be converted
            into spectral profile coefficients below (in place) */
-        Bitmap::PixelFormat pixel_format = m_bitmap->pixel_format();
+        Bitmap::PixelFormat pixel_format = bitmap->pixel_format();
         switch (pixel_format) {
             case Bitmap::PixelFormat::Y:
             case Bitmap::PixelFormat::YA:
@@ -89,51 +144,33 @@ public:
                       "format (Y[A], RGB[A], XYZ[A])");
         }
 
-        /* Should Mitsuba disable transformations to the stored color data? (e.g.
-           sRGB to linear, spectral upsampling, etc.) */
-        m_raw = props.bool_("raw", false);
         if (m_raw) {
             /* Don't undo gamma correction in the conversion below.
                This is needed, e.g., for normal maps. */
-            m_bitmap->set_srgb_gamma(false);
+            bitmap->set_srgb_gamma(false);
         }
 
         // Convert the image into the working floating point representation
-        m_bitmap = m_bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
+        bitmap = bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
 
-        if (any(m_bitmap->size() < 2)) {
+        if (any(bitmap->size() < 2)) {
             Log(Warn, "Image must be at least 2x2 pixels in size, up-sampling..");
             using ReconstructionFilter = Bitmap::ReconstructionFilter;
             ref<ReconstructionFilter> rfilter =
                 PluginManager::instance()->create_object<ReconstructionFilter>(Properties("tent"));
-            m_bitmap = m_bitmap->resample(max(m_bitmap->size(), 2), rfilter);
+            bitmap = bitmap->resample(max(bitmap->size(), 2), rfilter);
         }
 
-        ScalarFloat *ptr = (ScalarFloat *) m_bitmap->data();
-
-        double mean = 0.0;
-        if (m_bitmap->channel_count() == 3) {
-            if (is_spectral_v<Spectrum> && !m_raw) {
-                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
-                    value = srgb_model_fetch(value);
-                    mean += (double) srgb_model_mean(value);
-                    store_unaligned(ptr, value);
-                    ptr += 3;
-                }
-            } else {
-                for (size_t i = 0; i < m_bitmap->pixel_count(); ++i) {
-                    ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
-                    mean += (double) luminance(value);
-                    ptr += 3;
-                }
+        if (bitmap->channel_count() == 3 && is_spectral_v<Spectrum> && !m_raw) {
+            ScalarFloat *ptr = (ScalarFloat *) bitmap->data();
+            for (size_t i = 0; i < bitmap->pixel_count(); ++i) {
+                ScalarColor3f value = load_unaligned<ScalarColor3f>(ptr);
+                store_unaligned(ptr, srgb_model_fetch(value));
+                ptr += 3;
             }
-        } else {
-            for (size_t i = 0; i < m_bitmap->pixel_count(); ++i)
-                mean += (double) ptr[i];
         }
 
-        m_mean = ScalarFloat(mean / m_bitmap->pixel_count());
+        return bitmap;
     }
 
     template <uint32_t Channels, bool Raw>
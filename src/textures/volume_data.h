@@ -4,6 +4,7 @@
 #include <sstream>
 
 /// @file Helper functions for volume data handling.
+#include <mitsuba/core/cache.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/thread.h>
@@ -38,15 +39,13 @@ NAMESPACE_END(detail)
  * Reads a Mitsuba binary volume file.
  */
 // TODO: document data format.
-// TODO: what if Float is a GPU array, should we upload to it directly?
-template <typename Float>
-std::pair<VolumeMetadata, std::unique_ptr<scalar_t<Float>[]>>
-read_binary_volume_data(const std::string &filename) {
+inline ref<VolumeData> read_binary_volume_file(const fs::path &path,
+                                               const std::string &filename) {
+    using Float = float;
     MTS_IMPORT_CORE_TYPES()
 
     VolumeMetadata meta;
-    auto fs       = Thread::thread()->file_resolver();
-    meta.filename = fs->resolve(filename).string();
+    meta.filename = path.string();
     std::ifstream f(meta.filename, std::ios::binary);
 
     char header[3];
@@ -78,27 +77,63 @@ read_binary_volume_data(const std::string &filename) {
     f.read(reinterpret_cast<char *>(dims), sizeof(float) * 6);
     meta.bbox      = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
                                     ScalarPoint3f(dims[3], dims[4], dims[5]));
-    meta.transform = detail::bbox_transform(meta.bbox);
+    meta.transform = detail::bbox_transform<Float>(meta.bbox);
     meta.mean      = 0.;
-    meta.max       = -math::Infinity<ScalarFloat>;
-
-    auto raw_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * meta.channel_count]);
-    size_t k      = 0;
-    for (size_t i = 0; i < size; ++i) {
-        for (size_t j = 0; j < meta.channel_count; ++j) {
-            auto val    = detail::read<float>(f);
-            raw_data[k] = val;
-            meta.mean += (double) val;
-            meta.max = std::max(meta.max, val);
-            ++k;
-        }
+    meta.max       = -math::Infinity<float>;
+
+    auto raw_data = std::unique_ptr<float[]>(new float[size * meta.channel_count]);
+    f.read(reinterpret_cast<char *>(raw_data.get()), sizeof(float) * size * meta.channel_count);
+    if (!f)
+        Throw("Invalid volume file %s: unexpected end of file", filename);
+
+    for (size_t k = 0; k < size * meta.channel_count; ++k) {
+        float val = raw_data[k];
+        meta.mean += (double) val;
+        meta.max = std::max(meta.max, val);
     }
     meta.mean /= double(size * meta.channel_count);
 
     Log(Debug, "Loaded grid volume data from file %s: dimensions %s, mean value %f, max value %f",
         filename, meta.shape, meta.mean, meta.max);
 
-    return { meta, std::move(raw_data) };
+    return new VolumeData(meta, std::move(raw_data));
+}
+
+/**
+ * Reads a Mitsuba binary volume file. The decoded file contents are shared
+ * with other volumes referencing the same file via the asset cache.
+ */
+// TODO: what if Float is a GPU array, should we upload to it directly?
+template <typename Float>
+std::pair<VolumeMetadata, std::unique_ptr<scalar_t<Float>[]>>
+read_binary_volume_data(const std::string &filename) {
+    MTS_IMPORT_CORE_TYPES()
+
+    auto fs = Thread::thread()->file_resolver();
+    fs::path path = fs->resolve(filename);
+
+    auto load = [&](size_t &size) -> ref<Object> {
+        ref<VolumeData> data = read_binary_volume_file(path, filename);
+        size = data->size() * sizeof(float);
+        return data.get();
+    };
+
+    ref<VolumeData> data;
+    AssetCache *cache = AssetCache::instance();
+    if (cache) {
+        data = cache->get<VolumeData>(path, "volume", load);
+    } else {
+        size_t size;
+        data = static_cast<VolumeData *>(load(size).get());
+    }
+
+    size_t size = data->size();
+    auto raw_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size]);
+    const float *src = data->data();
+    for (size_t i = 0; i < size; ++i)
+        raw_data[i] = (ScalarFloat) src[i];
+
+    return { data->metadata(), std::move(raw_data) };
 }
 
 NAMESPACE_END(mitsuba)